@@ -22,6 +22,7 @@
 #define ANKI_OPTIMIZE ${ANKI_OPTIMIZE}
 #define ANKI_TESTS ${ANKI_TESTS}
 #define ANKI_ENABLE_TRACE ${_ANKI_ENABLE_TRACE}
+#define ANKI_HEADLESS ${_ANKI_HEADLESS}
 #define ANKI_SOURCE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
 
 // Compiler
@@ -140,6 +141,16 @@
 #	define ANKI_SIMD_NEON 1
 #endif
 
+// AVX2 and FMA on top of SSE
+#if ANKI_SIMD_SSE && ${_ANKI_ENABLE_SIMD_AVX2}
+#	define ANKI_SIMD_AVX2 1
+#else
+#	define ANKI_SIMD_AVX2 0
+#endif
+
+// Physics
+#define ANKI_PHYSICS_MULTITHREADED ${_ANKI_ENABLE_PHYSICS_MULTITHREADED}
+
 // Graphics backend
 #define ANKI_GR_BACKEND_GL 0
 #define ANKI_GR_BACKEND_VULKAN 1
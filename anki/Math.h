@@ -13,5 +13,6 @@
 #include <anki/math/Transform.h>
 
 #include <anki/math/Functions.h>
+#include <anki/math/BatchFunctions.h>
 
 /// @defgroup math Math library
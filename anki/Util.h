@@ -36,6 +36,7 @@
 #include <anki/util/Visitor.h>
 #include <anki/util/INotify.h>
 #include <anki/util/SparseArray.h>
+#include <anki/util/FlatHashMap.h>
 #include <anki/util/ObjectAllocator.h>
 #include <anki/util/Tracer.h>
 #include <anki/util/Serializer.h>
@@ -0,0 +1,289 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/collision/BatchFunctions.h>
+#include <anki/collision/Plane.h>
+#include <anki/collision/Aabb.h>
+#include <anki/collision/Ray.h>
+#include <anki/math/Simd.h>
+
+namespace anki
+{
+
+/// Load 4 elements starting from idx. The lanes past the end of the array are zero.
+static inline SimdF32x4 load4(ConstWeakArray<F32> arr, U32 idx)
+{
+	if(ANKI_LIKELY(idx + 4 <= arr.getSize()))
+	{
+		return SimdF32x4::load(&arr[idx]);
+	}
+
+	Array<F32, 4> tmp = {};
+	for(U32 i = idx; i < arr.getSize(); ++i)
+	{
+		tmp[i - idx] = arr[i];
+	}
+	return SimdF32x4::load(&tmp[0]);
+}
+
+/// Call the kernel for every 4 shapes and gather the results to the mask.
+template<typename TKernel>
+static U32 runBatch(U32 shapeCount, WeakArray<U64> mask, TKernel kernel)
+{
+	ANKI_ASSERT(mask.getSize() >= computeBatchMaskSize(shapeCount));
+	for(U32 i = 0; i < computeBatchMaskSize(shapeCount); ++i)
+	{
+		mask[i] = 0;
+	}
+
+	U32 passCount = 0;
+	for(U32 i = 0; i < shapeCount; i += 4)
+	{
+		U32 bits = kernel(i).getBitMask();
+		if(i + 4 > shapeCount)
+		{
+			// Ignore the padding
+			bits &= (1u << (shapeCount - i)) - 1u;
+		}
+
+		mask[i / 64] |= U64(bits) << (i % 64);
+		passCount += U32(__builtin_popcount(bits));
+	}
+
+	return passCount;
+}
+
+/// The plane in a form that the kernels can use.
+class SimdPlane
+{
+public:
+	SimdF32x4 m_normalX;
+	SimdF32x4 m_normalY;
+	SimdF32x4 m_normalZ;
+	SimdF32x4 m_offset;
+	Array<Bool, 3> m_positiveNormal;
+
+	SimdPlane() = default;
+
+	explicit SimdPlane(const Plane& plane)
+		: m_normalX(plane.getNormal().x())
+		, m_normalY(plane.getNormal().y())
+		, m_normalZ(plane.getNormal().z())
+		, m_offset(plane.getOffset())
+	{
+		for(U32 i = 0; i < 3; ++i)
+		{
+			m_positiveNormal[i] = plane.getNormal()[i] >= 0.0f;
+		}
+	}
+
+	SimdF32x4 computeDistance(SimdF32x4 x, SimdF32x4 y, SimdF32x4 z) const
+	{
+		return x.mad(m_normalX, y.mad(m_normalY, z * m_normalZ)) - m_offset;
+	}
+};
+
+/// 4 AABBs loaded from an AabbSoa.
+class SimdAabb
+{
+public:
+	Array<SimdF32x4, 3> m_min;
+	Array<SimdF32x4, 3> m_max;
+
+	SimdAabb(const AabbSoa& aabbs, U32 idx)
+		: m_min{{load4(aabbs.m_minX, idx), load4(aabbs.m_minY, idx), load4(aabbs.m_minZ, idx)}}
+		, m_max{{load4(aabbs.m_maxX, idx), load4(aabbs.m_maxY, idx), load4(aabbs.m_maxZ, idx)}}
+	{
+	}
+
+	/// Check if they are not completely behind the plane.
+	SimdMask4 testPlane(const SimdPlane& plane) const
+	{
+		// The corner that is the furthest along the normal
+		const SimdF32x4 x = (plane.m_positiveNormal[0]) ? m_max[0] : m_min[0];
+		const SimdF32x4 y = (plane.m_positiveNormal[1]) ? m_max[1] : m_min[1];
+		const SimdF32x4 z = (plane.m_positiveNormal[2]) ? m_max[2] : m_min[2];
+		return plane.computeDistance(x, y, z) >= SimdF32x4(0.0f);
+	}
+};
+
+/// 4 spheres loaded from a SphereSoa.
+class SimdSphere
+{
+public:
+	Array<SimdF32x4, 3> m_center;
+	SimdF32x4 m_radius;
+
+	SimdSphere(const SphereSoa& spheres, U32 idx)
+		: m_center{{load4(spheres.m_centerX, idx), load4(spheres.m_centerY, idx), load4(spheres.m_centerZ, idx)}}
+		, m_radius(load4(spheres.m_radius, idx))
+	{
+	}
+
+	/// Check if they are not completely behind the plane.
+	SimdMask4 testPlane(const SimdPlane& plane) const
+	{
+		const SimdF32x4 dist = plane.computeDistance(m_center[0], m_center[1], m_center[2]);
+		return (dist + m_radius) >= SimdF32x4(0.0f);
+	}
+};
+
+U32 testPlaneBatch(const Plane& plane, const AabbSoa& aabbs, WeakArray<U64> mask)
+{
+	const SimdPlane splane(plane);
+	return runBatch(aabbs.getSize(), mask, [&](U32 i) { return SimdAabb(aabbs, i).testPlane(splane); });
+}
+
+U32 testPlaneBatch(const Plane& plane, const SphereSoa& spheres, WeakArray<U64> mask)
+{
+	const SimdPlane splane(plane);
+	return runBatch(spheres.getSize(), mask, [&](U32 i) { return SimdSphere(spheres, i).testPlane(splane); });
+}
+
+template<typename TSimdShape, typename TSoa>
+static U32 testFrustumBatchInternal(ConstWeakArray<Plane> planes, const TSoa& shapes, WeakArray<U64> mask)
+{
+	ANKI_ASSERT(planes.getSize() <= 8);
+	Array<SimdPlane, 8> splanes;
+	for(U32 i = 0; i < planes.getSize(); ++i)
+	{
+		splanes[i] = SimdPlane(planes[i]);
+	}
+
+	return runBatch(shapes.getSize(), mask, [&](U32 i) {
+		const TSimdShape shape(shapes, i);
+		SimdMask4 inside = SimdF32x4(0.0f) >= SimdF32x4(0.0f);
+		for(U32 p = 0; p < planes.getSize() && inside.any(); ++p)
+		{
+			inside = inside & shape.testPlane(splanes[p]);
+		}
+		return inside;
+	});
+}
+
+U32 testFrustumBatch(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> mask)
+{
+	return testFrustumBatchInternal<SimdAabb>(planes, aabbs, mask);
+}
+
+U32 testFrustumBatch(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> mask)
+{
+	return testFrustumBatchInternal<SimdSphere>(planes, spheres, mask);
+}
+
+U32 testCollisionBatch(const Aabb& aabb, const AabbSoa& aabbs, WeakArray<U64> mask)
+{
+	const Array<SimdF32x4, 3> bmin = {
+		{SimdF32x4(aabb.getMin().x()), SimdF32x4(aabb.getMin().y()), SimdF32x4(aabb.getMin().z())}};
+	const Array<SimdF32x4, 3> bmax = {
+		{SimdF32x4(aabb.getMax().x()), SimdF32x4(aabb.getMax().y()), SimdF32x4(aabb.getMax().z())}};
+
+	return runBatch(aabbs.getSize(), mask, [&](U32 i) {
+		const SimdAabb a(aabbs, i);
+
+		// Not separated in any of the axes
+		SimdMask4 overlap = (a.m_min[0] <= bmax[0]) & (bmin[0] <= a.m_max[0]);
+		overlap = overlap & (a.m_min[1] <= bmax[1]) & (bmin[1] <= a.m_max[1]);
+		overlap = overlap & (a.m_min[2] <= bmax[2]) & (bmin[2] <= a.m_max[2]);
+		return overlap;
+	});
+}
+
+U32 testCollisionBatch(const Aabb& aabb, const SphereSoa& spheres, WeakArray<U64> mask)
+{
+	const Array<SimdF32x4, 3> bmin = {
+		{SimdF32x4(aabb.getMin().x()), SimdF32x4(aabb.getMin().y()), SimdF32x4(aabb.getMin().z())}};
+	const Array<SimdF32x4, 3> bmax = {
+		{SimdF32x4(aabb.getMax().x()), SimdF32x4(aabb.getMax().y()), SimdF32x4(aabb.getMax().z())}};
+
+	return runBatch(spheres.getSize(), mask, [&](U32 i) {
+		const SimdSphere s(spheres, i);
+
+		// The distance of the center from the closest point of the box
+		SimdF32x4 distSq(0.0f);
+		for(U32 axis = 0; axis < 3; ++axis)
+		{
+			const SimdF32x4 closest = s.m_center[axis].max(bmin[axis]).min(bmax[axis]);
+			const SimdF32x4 d = s.m_center[axis] - closest;
+			distSq = d.mad(d, distSq);
+		}
+
+		return distSq <= s.m_radius * s.m_radius;
+	});
+}
+
+U32 testCollisionBatch(const Ray& ray, const AabbSoa& aabbs, WeakArray<U64> mask)
+{
+	// The per axis part of the slab test that doesn't depend on the AABBs
+	class Axis
+	{
+	public:
+		SimdF32x4 m_origin;
+		SimdF32x4 m_invDir;
+		Bool m_parallel;
+		Bool m_positive;
+	};
+
+	Array<Axis, 3> axes;
+	for(U32 i = 0; i < 3; ++i)
+	{
+		const F32 dir = ray.getDirection()[i];
+		const F32 invDir = (dir == 0.0f) ? 0.0f : 1.0f / dir;
+		axes[i].m_origin = SimdF32x4(ray.getOrigin()[i]);
+		axes[i].m_invDir = SimdF32x4(invDir);
+		axes[i].m_parallel = dir == 0.0f;
+		axes[i].m_positive = invDir >= 0.0f;
+	}
+
+	return runBatch(aabbs.getSize(), mask, [&](U32 i) {
+		const SimdAabb a(aabbs, i);
+
+		SimdF32x4 tmin(0.0f);
+		SimdF32x4 tmax(MAX_F32);
+		SimdMask4 hit = tmin <= tmax;
+		for(U32 axis = 0; axis < 3; ++axis)
+		{
+			const Axis& ax = axes[axis];
+			if(ax.m_parallel)
+			{
+				hit = hit & (ax.m_origin >= a.m_min[axis]) & (ax.m_origin <= a.m_max[axis]);
+			}
+			else
+			{
+				const SimdF32x4 near = (ax.m_positive) ? a.m_min[axis] : a.m_max[axis];
+				const SimdF32x4 far = (ax.m_positive) ? a.m_max[axis] : a.m_min[axis];
+				tmin = tmin.max((near - ax.m_origin) * ax.m_invDir);
+				tmax = tmax.min((far - ax.m_origin) * ax.m_invDir);
+			}
+		}
+
+		return hit & (tmin <= tmax);
+	});
+}
+
+U32 testCollisionBatch(const Ray& ray, const SphereSoa& spheres, WeakArray<U64> mask)
+{
+	const Array<SimdF32x4, 3> origin = {
+		{SimdF32x4(ray.getOrigin().x()), SimdF32x4(ray.getOrigin().y()), SimdF32x4(ray.getOrigin().z())}};
+	const Array<SimdF32x4, 3> dir = {
+		{SimdF32x4(ray.getDirection().x()), SimdF32x4(ray.getDirection().y()), SimdF32x4(ray.getDirection().z())}};
+	const SimdF32x4 zero(0.0f);
+
+	return runBatch(spheres.getSize(), mask, [&](U32 i) {
+		const SimdSphere s(spheres, i);
+
+		const SimdF32x4 ocX = origin[0] - s.m_center[0];
+		const SimdF32x4 ocY = origin[1] - s.m_center[1];
+		const SimdF32x4 ocZ = origin[2] - s.m_center[2];
+		const SimdF32x4 a = ocX.mad(dir[0], ocY.mad(dir[1], ocZ * dir[2]));
+		const SimdF32x4 ocLenSq = ocX.mad(ocX, ocY.mad(ocY, ocZ * ocZ));
+		const SimdF32x4 rsq = s.m_radius * s.m_radius;
+
+		// The origin is inside or the sphere is in front of the origin and the line passes close enough
+		return (ocLenSq <= rsq) | ((a <= zero) & ((a.mad(a, rsq) - ocLenSq) >= zero));
+	});
+}
+
+} // end namespace anki
@@ -0,0 +1,95 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/collision/Common.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup collision
+/// @{
+
+/// Many AABBs in structure of arrays layout. All arrays should have the same size. It doesn't own the memory.
+class AabbSoa
+{
+public:
+	ConstWeakArray<F32> m_minX;
+	ConstWeakArray<F32> m_minY;
+	ConstWeakArray<F32> m_minZ;
+	ConstWeakArray<F32> m_maxX;
+	ConstWeakArray<F32> m_maxY;
+	ConstWeakArray<F32> m_maxZ;
+
+	U32 getSize() const
+	{
+		check();
+		return m_minX.getSize();
+	}
+
+private:
+	void check() const
+	{
+		ANKI_ASSERT(m_minX.getSize() == m_minY.getSize() && m_minX.getSize() == m_minZ.getSize());
+		ANKI_ASSERT(m_minX.getSize() == m_maxX.getSize() && m_minX.getSize() == m_maxY.getSize()
+					&& m_minX.getSize() == m_maxZ.getSize());
+	}
+};
+
+/// Many spheres in structure of arrays layout. All arrays should have the same size. It doesn't own the memory.
+class SphereSoa
+{
+public:
+	ConstWeakArray<F32> m_centerX;
+	ConstWeakArray<F32> m_centerY;
+	ConstWeakArray<F32> m_centerZ;
+	ConstWeakArray<F32> m_radius;
+
+	U32 getSize() const
+	{
+		ANKI_ASSERT(m_centerX.getSize() == m_centerY.getSize() && m_centerX.getSize() == m_centerZ.getSize()
+					&& m_centerX.getSize() == m_radius.getSize());
+		return m_centerX.getSize();
+	}
+};
+
+/// Get the number of U64 that the batch functions need to write the results of some shapes.
+inline constexpr U32 computeBatchMaskSize(U32 shapeCount)
+{
+	return (shapeCount + 63) / 64;
+}
+
+/// The batch functions test many shapes against a single one. They set the bit i of the mask if the shape i passes the
+/// test and they return the number of shapes that passed. Shape i maps to bit (i % 64) of mask[i / 64]. The mask should
+/// have at least computeBatchMaskSize() elements. The work is done 4 shapes at a time using SSE, NEON or scalar code.
+
+/// Test many AABBs against a plane. An AABB passes if it's not completely behind the plane (see testPlane()).
+U32 testPlaneBatch(const Plane& plane, const AabbSoa& aabbs, WeakArray<U64> mask);
+
+/// Test many spheres against a plane. A sphere passes if it's not completely behind the plane (see testPlane()).
+U32 testPlaneBatch(const Plane& plane, const SphereSoa& spheres, WeakArray<U64> mask);
+
+/// Test many AABBs against a frustum. An AABB passes if it's not completely behind any of the planes.
+U32 testFrustumBatch(ConstWeakArray<Plane> planes, const AabbSoa& aabbs, WeakArray<U64> mask);
+
+/// Test many spheres against a frustum. A sphere passes if it's not completely behind any of the planes.
+U32 testFrustumBatch(ConstWeakArray<Plane> planes, const SphereSoa& spheres, WeakArray<U64> mask);
+
+/// Test many AABBs for collision with an AABB.
+U32 testCollisionBatch(const Aabb& aabb, const AabbSoa& aabbs, WeakArray<U64> mask);
+
+/// Test many spheres for collision with an AABB.
+U32 testCollisionBatch(const Aabb& aabb, const SphereSoa& spheres, WeakArray<U64> mask);
+
+/// Test many AABBs for collision with a ray.
+U32 testCollisionBatch(const Ray& ray, const AabbSoa& aabbs, WeakArray<U64> mask);
+
+/// Test many spheres for collision with a ray.
+U32 testCollisionBatch(const Ray& ray, const SphereSoa& spheres, WeakArray<U64> mask);
+/// @}
+
+} // end namespace anki
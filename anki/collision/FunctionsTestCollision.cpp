@@ -9,6 +9,7 @@
 #include <anki/collision/LineSegment.h>
 #include <anki/collision/Cone.h>
 #include <anki/collision/Sphere.h>
+#include <anki/collision/Ray.h>
 #include <anki/collision/GjkEpa.h>
 
 namespace anki
@@ -168,6 +169,36 @@ Bool testCollision(const Aabb& aabb, const Cone& cone)
 	return false;
 }
 
+Bool testCollision(const Aabb& aabb, const Ray& ray)
+{
+	// Clip the ray with the slabs of the 3 axes
+	F32 tmin = 0.0f;
+	F32 tmax = MAX_F32;
+	for(U i = 0; i < 3; ++i)
+	{
+		const F32 dir = ray.getDirection()[i];
+		const F32 origin = ray.getOrigin()[i];
+		if(dir == 0.0f)
+		{
+			// Parallel to the slab
+			if(origin < aabb.getMin()[i] || origin > aabb.getMax()[i])
+			{
+				return false;
+			}
+		}
+		else
+		{
+			const F32 invDir = 1.0f / dir;
+			const F32 near = (invDir >= 0.0f) ? aabb.getMin()[i] : aabb.getMax()[i];
+			const F32 far = (invDir >= 0.0f) ? aabb.getMax()[i] : aabb.getMin()[i];
+			tmin = max(tmin, (near - origin) * invDir);
+			tmax = min(tmax, (far - origin) * invDir);
+		}
+	}
+
+	return tmin <= tmax;
+}
+
 Bool testCollision(const Sphere& a, const Sphere& b)
 {
 	const F32 tmp = a.getRadius() + b.getRadius();
@@ -224,6 +255,17 @@ Bool testCollision(const Sphere& sphere, const Cone& cone)
 	return !(angleCull || frontCull || backCull);
 }
 
+Bool testCollision(const Sphere& sphere, const Ray& ray)
+{
+	const Vec4 oc = ray.getOrigin() - sphere.getCenter();
+	const F32 a = ray.getDirection().dot(oc);
+	const F32 ocLenSq = oc.dot(oc);
+	const F32 rsq = sphere.getRadius() * sphere.getRadius();
+
+	// The origin is inside or the sphere is in front of the origin and the line passes close enough
+	return ocLenSq <= rsq || (a <= 0.0f && a * a - ocLenSq + rsq >= 0.0f);
+}
+
 Bool testCollision(const Obb& a, const Obb& b)
 {
 	return testCollisionGjk(a, b);
@@ -341,6 +341,7 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 				   ANKI_VERSION_MAJOR, ANKI_VERSION_MINOR, buildType, ANKI_COMPILER_STR, __DATE__, ANKI_REVISION);
 
 	m_timerTick = 1.0 / F32(config.getNumberU32("core_targetFps")); // in sec. 1.0 / period
+	m_fixedTimeStep = config.getNumberF64("core_fixedTimeStep");
 
 // Check SIMD support
 #if ANKI_SIMD_SSE && ANKI_COMPILER_GCC_COMPATIBLE
@@ -358,7 +359,7 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 #if ANKI_ENABLE_TRACE
 	m_coreTracer = m_heapAlloc.newInstance<CoreTracer>();
-	ANKI_CHECK(m_coreTracer->init(m_heapAlloc, m_settingsDir));
+	ANKI_CHECK(m_coreTracer->init(m_heapAlloc, m_settingsDir, config));
 #endif
 
 	//
@@ -408,7 +409,7 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	m_physics = m_heapAlloc.newInstance<PhysicsWorld>();
 
-	ANKI_CHECK(m_physics->create(m_allocCb, m_allocCbData));
+	ANKI_CHECK(m_physics->create(m_allocCb, m_allocCbData, m_threadHive));
 
 	//
 	// Resource FS
@@ -555,7 +556,7 @@ Error App::mainLoop()
 			const Second startTime = HighRezTimer::getCurrentTime();
 
 			prevUpdateTime = crntTime;
-			crntTime = HighRezTimer::getCurrentTime();
+			crntTime = (m_fixedTimeStep > 0.0) ? prevUpdateTime + m_fixedTimeStep : HighRezTimer::getCurrentTime();
 
 			// Update
 			ANKI_CHECK(m_input->handleEvents());
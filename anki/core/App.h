@@ -192,6 +192,7 @@ private:
 	String m_settingsDir; ///< The path that holds the configuration
 	String m_cacheDir; ///< This is used as a cache
 	Second m_timerTick;
+	Second m_fixedTimeStep = 0.0; ///< If not zero the scene time doesn't follow the wall clock.
 	U64 m_resourceCompletedAsyncTaskCount = 0;
 
 	class MemStats
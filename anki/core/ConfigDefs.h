@@ -12,7 +12,15 @@ ANKI_CONFIG_OPTION(width, 1920, 16, 16 * 1024, "Width")
 ANKI_CONFIG_OPTION(height, 1080, 16, 16 * 1024, "Height")
 ANKI_CONFIG_OPTION(core_targetFps, 60u, 30u, MAX_U32, "Target FPS")
 
+ANKI_CONFIG_OPTION(core_fixedTimeStep, 0.0, 0.0, 1.0,
+				   "If not zero the scene time advances that many seconds every frame. Useful for deterministic runs")
+
 ANKI_CONFIG_OPTION(core_mainThreadCount, max(2u, getCpuCoresCount() / 2u), 2u, 1024u)
 ANKI_CONFIG_OPTION(core_displayStats, 0, 0, 1)
 ANKI_CONFIG_OPTION(core_clearCaches, 0, 0, 1)
+ANKI_CONFIG_OPTION(core_traceFlightRecorderDuration, 0.0, 0.0, 60.0,
+				   "If not zero trace all the time but keep only the last N seconds. Dump them only when asked. The "
+				   "memory is sized from N so threads that trace a lot and frame rates above 240 keep less")
+ANKI_CONFIG_OPTION(core_traceSpikeThreshold, 0.0, 0.0, MAX_F64,
+				   "Dump the flight recorder when a frame takes more seconds than that. Zero disables it")
 ANKI_CONFIG_OPTION(window_fullscreen, 0, 0, 1)
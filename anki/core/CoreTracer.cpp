@@ -4,8 +4,10 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/core/CoreTracer.h>
+#include <anki/core/ConfigSet.h>
 #include <anki/util/DynamicArray.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 #include <anki/math/Functions.h>
 #include <ctime>
 
@@ -31,6 +33,19 @@ static void getSpreadsheetColumnName(U32 column, Array<char, 3>& arr)
 	arr[2] = '\0';
 }
 
+static Error writeTraceEvent(File& file, const TracerEvent& event, ThreadId tid)
+{
+	const I64 startMicroSec = I64(event.m_start * 1000000.0);
+	const I64 durMicroSec = I64(event.m_duration * 1000000.0);
+
+	// Do a hack
+	tid = (event.m_name == "GPU_TIME") ? 1 : tid;
+
+	return file.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", "
+						  "\"pid\": 1, \"tid\": %llu, \"ts\": %lld, \"dur\": %lld},\n",
+						  event.m_name.cstr(), tid, startMicroSec, durMicroSec);
+}
+
 class CoreTracer::ThreadWorkItem : public IntrusiveListEnabled<ThreadWorkItem>
 {
 public:
@@ -74,6 +89,11 @@ CoreTracer::~CoreTracer()
 	Error err = m_thread.join();
 	(void)err;
 
+	if(m_flightRecorderDuration > 0.0)
+	{
+		LoggerSingleton::get().removeFatalErrorHandler(this, fatalErrorCallback);
+	}
+
 	// Finalize trace file
 	if(m_traceJsonFile.isOpen())
 	{
@@ -101,19 +121,37 @@ CoreTracer::~CoreTracer()
 		s.destroy(m_alloc);
 	}
 	m_counterNames.destroy(m_alloc);
+	m_filenamePrefix.destroy(m_alloc);
+	m_frameMarkers.destroy(m_alloc);
 
 	// Destroy the tracer
 	TracerSingleton::destroy();
 }
 
-Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
+Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory, const ConfigSet& config)
 {
+	m_flightRecorderDuration = config.getNumberF64("core_traceFlightRecorderDuration");
+	m_spikeThreshold = config.getNumberF64("core_traceSpikeThreshold");
+	const Bool flightRecorder = m_flightRecorderDuration > 0.0;
+
 	TracerSingleton::init(alloc);
-	const Bool enableTracer = getenv("ANKI_CORE_TRACER_ENABLED") && getenv("ANKI_CORE_TRACER_ENABLED")[0] == '1';
+	const Bool enableTracer = flightRecorder
+							  || (getenv("ANKI_CORE_TRACER_ENABLED") && getenv("ANKI_CORE_TRACER_ENABLED")[0] == '1');
 	TracerSingleton::get().setEnabled(enableTracer);
+	TracerSingleton::get().setFlightRecorderEnabled(flightRecorder, m_flightRecorderDuration);
 	ANKI_CORE_LOGI("Tracing is %s from the beginning", (enableTracer) ? "enabled" : "disabled");
+	if(flightRecorder)
+	{
+		ANKI_CORE_LOGI("Tracing in flight recorder mode. Will keep the last %f seconds", m_flightRecorderDuration);
+	}
 
 	m_alloc = alloc;
+
+	if(flightRecorder)
+	{
+		m_frameMarkers.create(m_alloc, U32(m_flightRecorderDuration * F64(MAX_FLIGHT_RECORDER_FPS)) + 1);
+	}
+
 	m_thread.start(this, [](ThreadCallbackInfo& info) -> Error {
 		return static_cast<CoreTracer*>(info.m_userData)->threadWorker();
 	});
@@ -124,6 +162,15 @@ Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 	fname.sprintf("%s/%d%02d%02d-%02d%02d_", directory.cstr(), tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
 				  tm->tm_hour, tm->tm_min);
 
+	m_filenamePrefix.create(m_alloc, fname);
+
+	if(flightRecorder)
+	{
+		// Nothing gets written until a dump. Dump on fatal errors as well
+		LoggerSingleton::get().addFatalErrorHandler(this, fatalErrorCallback);
+		return Error::NONE;
+	}
+
 	ANKI_CHECK(m_traceJsonFile.open(StringAuto(alloc).sprintf("%strace.json", fname.cstr()), FileOpenFlag::WRITE));
 	ANKI_CHECK(m_traceJsonFile.writeText("[\n"));
 
@@ -140,18 +187,24 @@ Error CoreTracer::threadWorker()
 	while(!err && !quit)
 	{
 		ThreadWorkItem* item = nullptr;
+		const char* dumpReason = nullptr;
 
 		// Get some work
 		{
 			// Wait for something
 			LockGuard<Mutex> lock(m_mtx);
-			while(m_workItems.isEmpty() && !m_quit)
+			while(m_workItems.isEmpty() && !m_dumpReason && !m_quit)
 			{
 				m_cvar.wait(m_mtx);
 			}
 
 			// Get some work
-			if(!m_workItems.isEmpty())
+			if(m_dumpReason)
+			{
+				dumpReason = m_dumpReason;
+				m_dumpReason = nullptr;
+			}
+			else if(!m_workItems.isEmpty())
 			{
 				item = m_workItems.popFront();
 			}
@@ -161,6 +214,12 @@ Error CoreTracer::threadWorker()
 			}
 		}
 
+		// Dump the flight recorder. Not a fatal error if it fails
+		if(dumpReason && dumpFlightRecorder(dumpReason))
+		{
+			ANKI_CORE_LOGE("Failed to dump the trace flight recorder");
+		}
+
 		// Do some work using the frame and delete it
 		if(item)
 		{
@@ -188,15 +247,7 @@ Error CoreTracer::writeEvents(ThreadWorkItem& item)
 	// Write events
 	for(const TracerEvent& event : item.m_events)
 	{
-		const I64 startMicroSec = I64(event.m_start * 1000000.0);
-		const I64 durMicroSec = I64(event.m_duration * 1000000.0);
-
-		// Do a hack
-		const ThreadId tid = (event.m_name == "GPU_TIME") ? 1 : item.m_tid;
-
-		ANKI_CHECK(m_traceJsonFile.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", "
-											 "\"pid\": 1, \"tid\": %llu, \"ts\": %lld, \"dur\": %lld},\n",
-											 event.m_name.cstr(), tid, startMicroSec, durMicroSec));
+		ANKI_CHECK(writeTraceEvent(m_traceJsonFile, event, item.m_tid));
 	}
 
 	// Store counters
@@ -293,6 +344,12 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 
 void CoreTracer::flushFrame(U64 frame)
 {
+	if(m_flightRecorderDuration > 0.0)
+	{
+		flushFlightRecorderFrame(frame);
+		return;
+	}
+
 	struct Ctx
 	{
 		U64 m_frame;
@@ -389,4 +446,222 @@ Error CoreTracer::writeCountersForReal()
 	return Error::NONE;
 }
 
+void CoreTracer::flushFlightRecorderFrame(U64 frame)
+{
+	const Second now = HighRezTimer::getCurrentTime();
+	const char* dumpReason = nullptr;
+
+	// Check for a spike. Don't dump again before the previous dump goes out of the flight recorder
+	{
+		LockGuard<SpinLock> lock(m_frameMarkersLock);
+
+		if(m_spikeThreshold > 0.0 && m_frameMarkerCount > 0
+		   && now - m_frameMarkers[(m_frameMarkerCount - 1) % m_frameMarkers.getSize()].m_time > m_spikeThreshold
+		   && now - m_lastDumpTime > m_flightRecorderDuration)
+		{
+			dumpReason = "spike";
+		}
+
+		FrameMarker& marker = m_frameMarkers[m_frameMarkerCount++ % m_frameMarkers.getSize()];
+		marker.m_frame = frame;
+		marker.m_time = now;
+	}
+
+	if(TracerSingleton::get().consumeFlightRecorderDumpRequest())
+	{
+		dumpReason = "request";
+	}
+
+	// Let the thread do the dump
+	if(dumpReason)
+	{
+		m_lastDumpTime = now;
+
+		LockGuard<Mutex> lock(m_mtx);
+		m_dumpReason = dumpReason;
+		m_cvar.notifyOne();
+	}
+}
+
+Error CoreTracer::dumpFlightRecorder(CString reason, Bool skipLocked)
+{
+	if(skipLocked)
+	{
+		if(!m_dumpMtx.tryLock())
+		{
+			return Error::NONE;
+		}
+	}
+	else
+	{
+		m_dumpMtx.lock();
+	}
+
+	const Error err = dumpFlightRecorderInternal(reason, skipLocked);
+	m_dumpMtx.unlock();
+	return err;
+}
+
+Error CoreTracer::dumpFlightRecorderInternal(CString reason, Bool skipLocked)
+{
+
+	class DumpEvent
+	{
+	public:
+		TracerEvent m_event;
+		ThreadId m_tid;
+	};
+
+	class DumpThread
+	{
+	public:
+		ThreadId m_tid;
+		CString m_name;
+	};
+
+	class Ctx
+	{
+	public:
+		DynamicArrayAuto<DumpEvent> m_events;
+		DynamicArrayAuto<TracerCounter> m_counters;
+		DynamicArrayAuto<DumpThread> m_threads;
+
+		Ctx(GenericMemoryPoolAllocator<U8>& alloc)
+			: m_events(alloc)
+			, m_counters(alloc)
+			, m_threads(alloc)
+		{
+		}
+	};
+
+	// Copy the frame markers
+	DynamicArrayAuto<FrameMarker> frames(m_alloc);
+	if(!skipLocked || m_frameMarkersLock.tryLock())
+	{
+		if(!skipLocked)
+		{
+			m_frameMarkersLock.lock();
+		}
+
+		const U64 frameCount = min<U64>(m_frameMarkerCount, m_frameMarkers.getSize());
+		if(frameCount)
+		{
+			frames.create(U32(frameCount));
+			for(U64 i = 0; i < frameCount; ++i)
+			{
+				frames[U32(i)] = m_frameMarkers[(m_frameMarkerCount - frameCount + i) % m_frameMarkers.getSize()];
+			}
+		}
+
+		m_frameMarkersLock.unlock();
+	}
+
+	// Copy the events and counters first to keep the tracer locked for as little as possible
+	Ctx ctx(m_alloc);
+	TracerSingleton::get().readFlightRecorder(
+		[](void* ud, ThreadId tid, CString threadName, ConstWeakArray<TracerEvent> events,
+		   ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+
+			for(const TracerEvent& event : events)
+			{
+				ctx.m_events.emplaceBack(DumpEvent{event, tid});
+			}
+
+			for(const TracerCounter& counter : counters)
+			{
+				ctx.m_counters.emplaceBack(counter);
+			}
+
+			if(ctx.m_threads.getSize() == 0 || ctx.m_threads.getBack().m_tid != tid)
+			{
+				ctx.m_threads.emplaceBack(DumpThread{tid, threadName});
+			}
+		},
+		&ctx, skipLocked);
+
+	const Second oldestTime = HighRezTimer::getCurrentTime() - m_flightRecorderDuration;
+
+	File file;
+	ANKI_CHECK(file.open(StringAuto(m_alloc).sprintf("%sflight_recorder_%u_%s.json", m_filenamePrefix.cstr(),
+													 m_dumpCount++, reason.cstr()),
+						 FileOpenFlag::WRITE));
+	ANKI_CHECK(file.writeText("[\n"));
+
+	// Thread names
+	ANKI_CHECK(file.writeText("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, "
+							  "\"args\": {\"name\": \"GPU\"}},\n"));
+	for(const DumpThread& thread : ctx.m_threads)
+	{
+		if(thread.m_name.getLength() > 0)
+		{
+			ANKI_CHECK(file.writeText("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %llu, "
+									  "\"args\": {\"name\": \"%s\"}},\n",
+									  thread.m_tid, thread.m_name.cstr()));
+		}
+	}
+
+	// Events. Sort them to fix overlaping in chrome
+	std::sort(ctx.m_events.getBegin(), ctx.m_events.getEnd(), [](const DumpEvent& a, const DumpEvent& b) {
+		return (a.m_event.m_start != b.m_event.m_start) ? a.m_event.m_start < b.m_event.m_start
+														: a.m_event.m_duration > b.m_event.m_duration;
+	});
+
+	for(const DumpEvent& event : ctx.m_events)
+	{
+		if(event.m_event.m_start + event.m_event.m_duration >= oldestTime)
+		{
+			ANKI_CHECK(writeTraceEvent(file, event.m_event, event.m_tid));
+		}
+	}
+
+	// Counters. Sum them per frame and write them at the beginning of each frame
+	std::sort(ctx.m_counters.getBegin(), ctx.m_counters.getEnd(),
+			  [](const TracerCounter& a, const TracerCounter& b) { return a.m_time < b.m_time; });
+
+	U32 counterIdx = 0;
+	for(U32 f = 0; f < frames.getSize(); ++f)
+	{
+		const U32 begin = counterIdx;
+		while(counterIdx < ctx.m_counters.getSize() && ctx.m_counters[counterIdx].m_time <= frames[f].m_time)
+		{
+			++counterIdx;
+		}
+
+		if(f == 0 || frames[f - 1].m_time < oldestTime || begin == counterIdx)
+		{
+			continue;
+		}
+
+		std::sort(ctx.m_counters.getBegin() + begin, ctx.m_counters.getBegin() + counterIdx,
+				  [](const TracerCounter& a, const TracerCounter& b) { return a.m_name < b.m_name; });
+
+		const I64 frameStartMicroSec = I64(frames[f - 1].m_time * 1000000.0);
+		for(U32 i = begin; i < counterIdx;)
+		{
+			const CString name = ctx.m_counters[i].m_name;
+			U64 value = 0;
+			for(; i < counterIdx && ctx.m_counters[i].m_name == name; ++i)
+			{
+				value += ctx.m_counters[i].m_value;
+			}
+
+			ANKI_CHECK(file.writeText("{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"ts\": %lld, "
+									  "\"args\": {\"value\": %llu}},\n",
+									  name.cstr(), frameStartMicroSec, value));
+		}
+	}
+
+	ANKI_CHECK(file.writeText("{}\n]\n"));
+
+	return Error::NONE;
+}
+
+void CoreTracer::fatalErrorCallback(void* userData)
+{
+	// The process is about to abort so dump right away
+	const Error err = static_cast<CoreTracer*>(userData)->dumpFlightRecorder("fatal", true);
+	(void)err;
+}
+
 } // end namespace anki
@@ -10,14 +10,23 @@
 #include <anki/util/Allocator.h>
 #include <anki/util/List.h>
 #include <anki/util/File.h>
+#include <anki/util/Logger.h>
 
 namespace anki
 {
 
+// Forward
+class ConfigSet;
+
 /// @addtogroup core
 /// @{
 
 /// A system that sits on top of the tracer and processes the counters and events.
+///
+/// By default it streams the events and counters of every frame to files. In flight recorder mode
+/// (core_traceFlightRecorderDuration) it keeps only the last few seconds in memory and dumps them to a Chrome trace
+/// file when asked by ANKI_TRACE_REQUEST_FLIGHT_RECORDER_DUMP(), when a frame takes too long
+/// (core_traceSpikeThreshold) or on a fatal error.
 class CoreTracer
 {
 public:
@@ -26,7 +35,7 @@ public:
 	~CoreTracer();
 
 	/// @param directory The directory to store the trace and counters.
-	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString directory);
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString directory, const ConfigSet& config);
 
 	/// It will flush everything.
 	void flushFrame(U64 frame);
@@ -35,6 +44,18 @@ private:
 	class ThreadWorkItem;
 	class PerFrameCounters;
 
+	/// The end of a frame. The flight recorder uses them to group the counters per frame.
+	class FrameMarker
+	{
+	public:
+		U64 m_frame;
+		Second m_time;
+	};
+
+	/// The frame ring of the flight recorder is sized to hold that many frames per second of its duration. Above it
+	/// the dumps have the counters of fewer frames.
+	static constexpr U32 MAX_FLIGHT_RECORDER_FPS = 240;
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
 	Thread m_thread;
@@ -49,11 +70,36 @@ private:
 	File m_countersCsvFile;
 	Bool m_quit = false;
 
+	/// @name Flight recorder members
+	/// @{
+	String m_filenamePrefix;
+	Second m_flightRecorderDuration = 0.0;
+	Second m_spikeThreshold = 0.0;
+	Second m_lastDumpTime = 0.0;
+	DynamicArray<FrameMarker> m_frameMarkers; ///< Ring buffer.
+	U64 m_frameMarkerCount = 0;
+	SpinLock m_frameMarkersLock;
+	const char* m_dumpReason = nullptr; ///< If not nullptr the thread will dump the flight recorder.
+	U32 m_dumpCount = 0;
+	Mutex m_dumpMtx; ///< Serialize the dumps.
+	/// @}
+
 	Error threadWorker();
 
 	Error writeEvents(ThreadWorkItem& item);
 	void gatherCounters(ThreadWorkItem& item);
 	Error writeCountersForReal();
+
+	void flushFlightRecorderFrame(U64 frame);
+
+	/// Write the contents of the flight recorder to a new trace file.
+	/// @param skipLocked Don't wait for any lock. Parts of the trace that are locked at that moment are skipped.
+	Error dumpFlightRecorder(CString reason, Bool skipLocked = false);
+
+	Error dumpFlightRecorderInternal(CString reason, Bool skipLocked);
+
+	/// Runs after the logger released its lock. The aborting thread might hold any lock so the dump doesn't wait.
+	static void fatalErrorCallback(void* userData);
 };
 /// @}
 
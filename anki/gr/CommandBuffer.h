@@ -101,6 +101,10 @@ enum class CommandBufferFlag : U8
 
 	/// Will contain compute work.
 	COMPUTE_WORK = 1 << 6,
+
+	/// Don't wait for the graphics pipelines that are not created yet. Skip the draws and create the pipelines in the
+	/// background.
+	SKIP_DRAWS_WITH_PENDING_PIPELINES = 1 << 7,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(CommandBufferFlag)
 
@@ -416,6 +420,12 @@ public:
 	void setTextureSurfaceBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
 								  const TextureSurfaceInfo& surf);
 
+	/// The first barrier of a texture surface that uses the memory of another texture (see
+	/// TextureInitInfo::m_memoryOwner). The surface transitions from TextureUsageBit::NONE to @a nextUsage after all
+	/// the @a aliasedUsage accesses of @a aliasedTex are done.
+	void setTextureSurfaceAliasingBarrier(TexturePtr aliasedTex, TextureUsageBit aliasedUsage, TexturePtr tex,
+										  TextureUsageBit nextUsage, const TextureSurfaceInfo& surf);
+
 	void setTextureVolumeBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
 								 const TextureVolumeInfo& vol);
 
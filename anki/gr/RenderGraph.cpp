@@ -25,13 +25,49 @@ static inline U32 getTextureSurfOrVolCount(const TexturePtr& tex)
 	return tex->getMipmapCount() * tex->getLayerCount() * (textureTypeIsCube(tex->getTextureType()) ? 6 : 1);
 }
 
+/// Same as above but for a texture that is not created yet.
+static U32 getTextureSurfOrVolCount(const TextureInitInfo& init)
+{
+	// The texture will clamp the mip count the same way
+	const U32 maxMipCount = (init.m_type == TextureType::_3D)
+								? computeMaxMipmapCount3d(init.m_width, init.m_height, init.m_depth)
+								: computeMaxMipmapCount2d(init.m_width, init.m_height);
+	const U32 mipCount = min<U32>(init.m_mipmapCount, maxMipCount);
+	return mipCount * init.m_layerCount * (textureTypeIsCube(init.m_type) ? 6 : 1);
+}
+
+/// A rough estimate of the memory a texture will need. Only used to order the aliasing candidates.
+static PtrSize estimateTextureMemorySize(const TextureInitInfo& init)
+{
+	PtrSize size = 0;
+	for(U32 mip = 0; mip < init.m_mipmapCount; ++mip)
+	{
+		const U32 width = max(init.m_width >> mip, 1u);
+		const U32 height = max(init.m_height >> mip, 1u);
+		const U32 depth = (init.m_type == TextureType::_3D) ? max(init.m_depth >> mip, 1u) : 1u;
+		size += PtrSize(width) * height * depth * getFormatBytes(init.m_format);
+	}
+
+	return size * init.m_layerCount * (textureTypeIsCube(init.m_type) ? 6 : 1);
+}
+
 /// Contains some extra things for render targets.
 class RenderGraph::RT
 {
 public:
 	DynamicArray<TextureUsageBit> m_surfOrVolUsages;
 	DynamicArray<U16> m_lastBatchThatTransitionedIt;
-	TexturePtr m_texture; ///< Hold a reference.
+	TexturePtr m_texture; ///< Hold a reference. The non-imported are created after the batches are known.
+
+	/// @name The lifetime of the non-imported RTs in batches
+	/// @{
+	U32 m_firstBatch = MAX_U32;
+	U32 m_lastBatch = 0;
+	/// @}
+
+	/// The RT that used the same memory right before this one. MAX_U32 if there is none.
+	U32 m_aliasPredecessor = MAX_U32;
+
 	Bool m_imported;
 };
 
@@ -59,6 +95,14 @@ public:
 	TextureUsageBit m_usageAfter;
 	TextureSurfaceInfo m_surface;
 
+	/// @name The RT that used the same memory before this one. Only set in the first barrier of every surface
+	/// @{
+	U32 m_aliasedIdx = MAX_U32;
+	TextureUsageBit m_aliasedUsage = TextureUsageBit::NONE; ///< All the usages of the aliased RT at the end.
+	/// @}
+
+	TextureBarrier() = default;
+
 	TextureBarrier(U32 rtIdx, TextureUsageBit usageBefore, TextureUsageBit usageAfter, const TextureSurfaceInfo& surf)
 		: m_idx(rtIdx)
 		, m_usageBefore(usageBefore)
@@ -76,6 +120,8 @@ public:
 	BufferUsageBit m_usageBefore;
 	BufferUsageBit m_usageAfter;
 
+	BufferBarrier() = default;
+
 	BufferBarrier(U32 buffIdx, BufferUsageBit usageBefore, BufferUsageBit usageAfter)
 		: m_idx(buffIdx)
 		, m_usageBefore(usageBefore)
@@ -92,6 +138,8 @@ public:
 	AccelerationStructureUsageBit m_usageBefore;
 	AccelerationStructureUsageBit m_usageAfter;
 
+	ASBarrier() = default;
+
 	ASBarrier(U32 asIdx, AccelerationStructureUsageBit usageBefore, AccelerationStructureUsageBit usageAfter)
 		: m_idx(asIdx)
 		, m_usageBefore(usageBefore)
@@ -167,6 +215,52 @@ public:
 	}
 };
 
+/// The part of the BakeContext that depends only on the topology of the description (passes, dependencies, resource
+/// usages). The Renderer builds almost the same description every frame so it's kept between compilations and reused
+/// when the hash matches.
+class RenderGraph::BakeCache
+{
+public:
+	/// Where the things of a batch live in the arrays below.
+	class BatchRange
+	{
+	public:
+		U32 m_firstPass;
+		U32 m_passCount;
+		U32 m_firstTextureBarrier;
+		U32 m_textureBarrierCount;
+		U32 m_firstBufferBarrier;
+		U32 m_bufferBarrierCount;
+		U32 m_firstASBarrier;
+		U32 m_asBarrierCount;
+	};
+
+	U64 m_hash = 0;
+
+	DynamicArray<BatchRange> m_batches;
+	DynamicArray<U32> m_passIndices;
+	DynamicArray<TextureBarrier> m_textureBarriers;
+	DynamicArray<BufferBarrier> m_bufferBarriers;
+	DynamicArray<ASBarrier> m_asBarriers;
+
+	/// The usages of all the RT surfaces after all batches. Needed for the imported RTs in RenderGraph::reset().
+	DynamicArray<TextureUsageBit> m_rtFinalUsages;
+	DynamicArray<BufferUsageBit> m_bufferFinalUsages;
+	DynamicArray<AccelerationStructureUsageBit> m_asFinalUsages;
+
+	void destroy(GrAllocator<U8> alloc)
+	{
+		m_batches.destroy(alloc);
+		m_passIndices.destroy(alloc);
+		m_textureBarriers.destroy(alloc);
+		m_bufferBarriers.destroy(alloc);
+		m_asBarriers.destroy(alloc);
+		m_rtFinalUsages.destroy(alloc);
+		m_bufferFinalUsages.destroy(alloc);
+		m_asFinalUsages.destroy(alloc);
+	}
+};
+
 void FramebufferDescription::bake()
 {
 	ANKI_ASSERT(m_hash == 0 && "Already baked");
@@ -263,6 +357,12 @@ RenderGraph::~RenderGraph()
 	}
 
 	m_importedRenderTargets.destroy(getAllocator());
+
+	if(m_bakeCache)
+	{
+		m_bakeCache->destroy(getAllocator());
+		getAllocator().deleteInstance(m_bakeCache);
+	}
 }
 
 RenderGraph* RenderGraph::newInstance(GrManager* manager)
@@ -348,6 +448,151 @@ void RenderGraph::reset()
 	++m_version;
 }
 
+void RenderGraph::createTransientRenderTargets(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+{
+	BakeContext& ctx = *m_ctx;
+
+	// Find the first and the last batch that each RT is used
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		for(U32 passIdx : ctx.m_batches[batchIdx].m_passIndices)
+		{
+			for(const RenderPassDependency& dep : descr.m_passes[passIdx]->m_rtDeps)
+			{
+				RT& rt = ctx.m_rts[dep.m_texture.m_handle.m_idx];
+				rt.m_firstBatch = min(rt.m_firstBatch, batchIdx);
+				rt.m_lastBatch = max(rt.m_lastBatch, batchIdx);
+			}
+		}
+	}
+
+	// Gather the non-imported RTs and sort them by size. The biggest RT of a memory slot owns the memory
+	DynamicArrayAuto<U32> rtIndices(alloc);
+	DynamicArrayAuto<PtrSize> sizes(alloc);
+	sizes.create(ctx.m_rts.getSize(), 0);
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		if(!ctx.m_rts[rtIdx].m_imported)
+		{
+			ANKI_ASSERT(ctx.m_rts[rtIdx].m_firstBatch != MAX_U32 && "Non-imported RT is not used");
+			rtIndices.emplaceBack(rtIdx);
+			sizes[rtIdx] = estimateTextureMemorySize(descr.m_renderTargets[rtIdx].m_initInfo);
+		}
+	}
+
+	if(rtIndices.getSize() == 0)
+	{
+		return;
+	}
+
+	std::sort(rtIndices.getBegin(), rtIndices.getEnd(), [&](U32 a, U32 b) {
+		return (sizes[a] != sizes[b]) ? sizes[a] > sizes[b] : a < b;
+	});
+
+	// Place every RT in the first memory slot that is not in use during the RT's lifetime
+	DynamicArrayAuto<U32> slotOwners(alloc); // The RT that owns the memory of each slot
+	DynamicArrayAuto<U32> rtSlots(alloc);
+	rtSlots.create(ctx.m_rts.getSize(), MAX_U32);
+	for(U32 i = 0; i < rtIndices.getSize(); ++i)
+	{
+		const U32 rtIdx = rtIndices[i];
+		const RT& rt = ctx.m_rts[rtIdx];
+
+		for(U32 slot = 0; slot < slotOwners.getSize() && rtSlots[rtIdx] == MAX_U32; ++slot)
+		{
+			Bool overlaps = false;
+			for(U32 j = 0; j < i && !overlaps; ++j)
+			{
+				const RT& other = ctx.m_rts[rtIndices[j]];
+				overlaps = rtSlots[rtIndices[j]] == slot && rt.m_firstBatch <= other.m_lastBatch
+						   && other.m_firstBatch <= rt.m_lastBatch;
+			}
+
+			if(!overlaps)
+			{
+				rtSlots[rtIdx] = slot;
+			}
+		}
+
+		if(rtSlots[rtIdx] == MAX_U32)
+		{
+			rtSlots[rtIdx] = slotOwners.getSize();
+			slotOwners.emplaceBack(rtIdx);
+		}
+	}
+
+	// Find the RT that used the memory right before each RT. The lifetimes in a slot don't overlap
+	for(U32 rtIdx : rtIndices)
+	{
+		RT& rt = ctx.m_rts[rtIdx];
+		for(U32 otherIdx : rtIndices)
+		{
+			const RT& other = ctx.m_rts[otherIdx];
+			if(rtSlots[otherIdx] == rtSlots[rtIdx] && other.m_lastBatch < rt.m_firstBatch
+			   && (rt.m_aliasPredecessor == MAX_U32 || ctx.m_rts[rt.m_aliasPredecessor].m_lastBatch < other.m_lastBatch))
+			{
+				rt.m_aliasPredecessor = otherIdx;
+			}
+		}
+	}
+
+	// Create the textures. First the owners of the memory and then the rest
+	for(U32 i = 0; i < rtIndices.getSize(); ++i)
+	{
+		const U32 rtIdx = rtIndices[i];
+		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+		const U32 ownerIdx = slotOwners[rtSlots[rtIdx]];
+
+		// Create a new TextureInitInfo with the derived usage
+		TextureInitInfo initInf = inRt.m_initInfo;
+		initInf.m_usage = inRt.m_usageDerivedByDeps;
+		U64 hash = appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
+
+		if(ownerIdx == rtIdx && i + 1 < rtIndices.getSize())
+		{
+			// Others might be placed in its memory
+			Bool shared = false;
+			for(U32 j = i + 1; j < rtIndices.getSize() && !shared; ++j)
+			{
+				shared = rtSlots[rtIndices[j]] == rtSlots[rtIdx];
+			}
+
+			initInf.m_memoryAliasable = shared;
+			hash = appendHash(&initInf.m_memoryAliasable, sizeof(initInf.m_memoryAliasable), hash);
+		}
+		else if(ownerIdx != rtIdx)
+		{
+			// The owner is bigger so it's already created. The texture is bound to the owner's memory so the owner is
+			// part of the hash
+			initInf.m_memoryOwner = ctx.m_rts[ownerIdx].m_texture;
+			ANKI_ASSERT(initInf.m_memoryOwner.isCreated());
+			const U64 ownerUuid = initInf.m_memoryOwner->getUuid();
+			hash = appendHash(&ownerUuid, sizeof(ownerUuid), hash);
+		}
+
+		ctx.m_rts[rtIdx].m_texture = getOrCreateRenderTarget(initInf, hash);
+	}
+
+	// Log the memory savings when they change
+	PtrSize memoryWithoutAliasing = 0;
+	PtrSize memoryWithAliasing = 0;
+	for(U32 rtIdx : rtIndices)
+	{
+		const TexturePtr& tex = ctx.m_rts[rtIdx].m_texture;
+		memoryWithoutAliasing += tex->getMemorySize();
+		memoryWithAliasing += (tex->isMemoryAliased()) ? 0 : tex->getMemorySize();
+	}
+
+	if(memoryWithoutAliasing != m_transientMemoryWithoutAliasing || memoryWithAliasing != m_transientMemoryWithAliasing)
+	{
+		m_transientMemoryWithoutAliasing = memoryWithoutAliasing;
+		m_transientMemoryWithAliasing = memoryWithAliasing;
+		ANKI_GR_LOGI("Transient render targets need %uKB of memory, %uKB without aliasing (%u RTs, %u memory slots)",
+					 U32(memoryWithAliasing / 1024), U32(memoryWithoutAliasing / 1024), rtIndices.getSize(),
+					 slotOwners.getSize());
+	}
+}
+
 TexturePtr RenderGraph::getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash)
 {
 	ANKI_ASSERT(hash);
@@ -670,22 +915,13 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		}
 		else
 		{
-			// Need to create new
-
-			// Create a new TextureInitInfo with the derived usage
-			TextureInitInfo initInf = inRt.m_initInfo;
-			initInf.m_usage = inRt.m_usageDerivedByDeps;
-			ANKI_ASSERT(initInf.m_usage != TextureUsageBit::NONE);
-
-			// Create the new hash
-			const U64 hash = appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
-
-			// Get or create the texture
-			outRt.m_texture = getOrCreateRenderTarget(initInf, hash);
+			// The texture will be created when the lifetime of the RT is known
+			ANKI_ASSERT(inRt.m_usageDerivedByDeps != TextureUsageBit::NONE);
 		}
 
 		// Init the usage
-		const U32 surfOrVolumeCount = getTextureSurfOrVolCount(outRt.m_texture);
+		const U32 surfOrVolumeCount =
+			(imported) ? getTextureSurfOrVolCount(outRt.m_texture) : getTextureSurfOrVolCount(inRt.m_initInfo);
 		outRt.m_surfOrVolUsages.create(alloc, surfOrVolumeCount, TextureUsageBit::NONE);
 		if(imported && inRt.m_importedAndUndefinedUsage)
 		{
@@ -740,7 +976,8 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc,
+											 Bool setDeps)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -794,7 +1031,7 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 		}
 
 		// Set dependencies by checking all previous subpasses.
-		U32 prevPassIdx = passIdx;
+		U32 prevPassIdx = (setDeps) ? passIdx : 0;
 		while(prevPassIdx--)
 		{
 			const RenderPassDescriptionBase& prevPass = *descr.m_passes[prevPassIdx];
@@ -813,14 +1050,11 @@ void RenderGraph::initBatches()
 	U passesAssignedToBatchCount = 0;
 	const U passCount = m_ctx->m_passes.getSize();
 	ANKI_ASSERT(passCount > 0);
-	Bool setTimestamp = m_ctx->m_gatherStatistics;
 	while(passesAssignedToBatchCount < passCount)
 	{
 		m_ctx->m_batches.emplaceBack(m_ctx->m_alloc);
 		Batch& batch = m_ctx->m_batches.getBack();
 
-		Bool drawsToPresentable = false;
-
 		for(U32 i = 0; i < passCount; ++i)
 		{
 			if(!m_ctx->m_passIsInBatch.get(i) && !passHasUnmetDependencies(*m_ctx, i))
@@ -828,12 +1062,32 @@ void RenderGraph::initBatches()
 				// Add to the batch
 				++passesAssignedToBatchCount;
 				batch.m_passIndices.emplaceBack(m_ctx->m_alloc, i);
-
-				// Will batch draw to the swapchain?
-				drawsToPresentable = drawsToPresentable || m_ctx->m_passes[i].m_drawsToPresentable;
 			}
 		}
 
+		// Mark batch's passes done
+		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
+		{
+			m_ctx->m_passIsInBatch.set(passIdx);
+			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+		}
+	}
+}
+
+void RenderGraph::initBatchCommandBuffers()
+{
+	ANKI_ASSERT(m_ctx);
+
+	Bool setTimestamp = m_ctx->m_gatherStatistics;
+	for(Batch& batch : m_ctx->m_batches)
+	{
+		// Will batch draw to the swapchain?
+		Bool drawsToPresentable = false;
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			drawsToPresentable = drawsToPresentable || m_ctx->m_passes[passIdx].m_drawsToPresentable;
+		}
+
 		// Get or create cmdb for the batch.
 		// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
 		// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
@@ -863,13 +1117,6 @@ void RenderGraph::initBatches()
 		{
 			batch.m_cmdb = m_ctx->m_graphicsCmdbs.getBack().get();
 		}
-
-		// Mark batch's passes done
-		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
-		{
-			m_ctx->m_passIsInBatch.set(passIdx);
-			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
-		}
 	}
 }
 
@@ -1001,7 +1248,21 @@ void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& de
 				{
 					// Create a new barrier for this surface
 
-					batch.m_textureBarriersBefore.emplaceBack(ctx.m_alloc, rtIdx, crntUsage, depUsage, surf);
+					TextureBarrier& barrier =
+						*batch.m_textureBarriersBefore.emplaceBack(ctx.m_alloc, rtIdx, crntUsage, depUsage, surf);
+
+					if(crntUsage == TextureUsageBit::NONE && rt.m_aliasPredecessor != MAX_U32)
+					{
+						// First use of the surface and the memory was used by another RT. Wait for that RT
+						const RT& prevRt = ctx.m_rts[rt.m_aliasPredecessor];
+						ANKI_ASSERT(prevRt.m_lastBatch < batchIdx);
+
+						barrier.m_aliasedIdx = rt.m_aliasPredecessor;
+						for(TextureUsageBit usage : prevRt.m_surfOrVolUsages)
+						{
+							barrier.m_aliasedUsage |= usage;
+						}
+					}
 
 					crntUsage = depUsage;
 					rt.m_lastBatchThatTransitionedIt[surfOrVolIdx] = U16(batchIdx);
@@ -1162,6 +1423,304 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 	} // For all batches
 }
 
+U64 RenderGraph::computeBakeHash(const RenderGraphDescription& descr, StackAllocator<U8>& alloc) const
+{
+	const BakeContext& ctx = *m_ctx;
+
+	// Gather everything in an array and hash once. The imported resources themselves are not part of the hash, only
+	// their structure and initial usage
+	DynamicArrayAuto<U64> words(alloc);
+	words.resizeStorage(512);
+
+	// Passes and their dependencies
+	words.emplaceBack(descr.m_passes.getSize());
+	for(const RenderPassDescriptionBase* pass : descr.m_passes)
+	{
+		const Bool hasFb = pass->m_type == RenderPassDescriptionBase::Type::GRAPHICS
+						   && static_cast<const GraphicsRenderPassDescription&>(*pass).hasFramebuffer();
+		words.emplaceBack(U64(pass->m_type) | (U64(hasFb) << 8));
+
+		words.emplaceBack(pass->m_rtDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_rtDeps)
+		{
+			const TextureSubresourceInfo& sub = dep.m_texture.m_subresource;
+			words.emplaceBack(U64(dep.m_texture.m_handle.m_idx) | (U64(dep.m_texture.m_usage) << 32));
+			words.emplaceBack(U64(sub.m_firstMipmap) | (U64(sub.m_mipmapCount) << 32));
+			words.emplaceBack(U64(sub.m_firstLayer) | (U64(sub.m_layerCount) << 32));
+			words.emplaceBack(U64(sub.m_firstFace) | (U64(sub.m_faceCount) << 8)
+							  | (U64(sub.m_depthStencilAspect) << 16));
+		}
+
+		words.emplaceBack(pass->m_buffDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_buffDeps)
+		{
+			words.emplaceBack(dep.m_buffer.m_handle.m_idx);
+			words.emplaceBack(U64(dep.m_buffer.m_usage));
+		}
+
+		words.emplaceBack(pass->m_asDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_asDeps)
+		{
+			words.emplaceBack(U64(dep.m_as.m_handle.m_idx) | (U64(dep.m_as.m_usage) << 32));
+		}
+	}
+
+	// Render targets. The barriers index the surfaces so the structure of the textures matters
+	words.emplaceBack(ctx.m_rts.getSize());
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		const RT& rt = ctx.m_rts[rtIdx];
+		if(rt.m_imported)
+		{
+			words.emplaceBack(U64(rt.m_texture->getTextureType()) | (U64(rt.m_texture->getLayerCount()) << 32));
+		}
+		else
+		{
+			// The memory aliasing depends on the size and the format as well so hash all of it
+			const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+			words.emplaceBack(U64(inRt.m_initInfo.m_type) | (U64(inRt.m_initInfo.m_layerCount) << 32));
+			words.emplaceBack(inRt.m_hash);
+		}
+
+		words.emplaceBack(rt.m_surfOrVolUsages.getSize());
+		for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			words.emplaceBack(U64(usage));
+		}
+	}
+
+	// Buffers and AS
+	words.emplaceBack(ctx.m_buffers.getSize());
+	for(const Buffer& buff : ctx.m_buffers)
+	{
+		words.emplaceBack(U64(buff.m_usage));
+	}
+
+	words.emplaceBack(ctx.m_as.getSize());
+	for(const AS& as : ctx.m_as)
+	{
+		words.emplaceBack(U64(as.m_usage));
+	}
+
+	return computeHash(&words[0], words.getSizeInBytes());
+}
+
+void RenderGraph::storeBakeCache(U64 hash)
+{
+	const BakeContext& ctx = *m_ctx;
+	auto alloc = getAllocator();
+
+	if(!m_bakeCache)
+	{
+		m_bakeCache = alloc.newInstance<BakeCache>();
+	}
+
+	BakeCache& cache = *m_bakeCache;
+	cache.destroy(alloc);
+	cache.m_hash = hash;
+
+	// Count
+	U32 passCount = 0;
+	U32 textureBarrierCount = 0;
+	U32 bufferBarrierCount = 0;
+	U32 asBarrierCount = 0;
+	for(const Batch& batch : ctx.m_batches)
+	{
+		passCount += batch.m_passIndices.getSize();
+		textureBarrierCount += batch.m_textureBarriersBefore.getSize();
+		bufferBarrierCount += batch.m_bufferBarriersBefore.getSize();
+		asBarrierCount += batch.m_asBarriersBefore.getSize();
+	}
+
+	U32 surfOrVolCount = 0;
+	for(const RT& rt : ctx.m_rts)
+	{
+		surfOrVolCount += rt.m_surfOrVolUsages.getSize();
+	}
+
+	cache.m_batches.create(alloc, ctx.m_batches.getSize());
+	cache.m_passIndices.create(alloc, passCount);
+	cache.m_textureBarriers.create(alloc, textureBarrierCount);
+	cache.m_bufferBarriers.create(alloc, bufferBarrierCount);
+	cache.m_asBarriers.create(alloc, asBarrierCount);
+	cache.m_rtFinalUsages.create(alloc, surfOrVolCount);
+	cache.m_bufferFinalUsages.create(alloc, ctx.m_buffers.getSize());
+	cache.m_asFinalUsages.create(alloc, ctx.m_as.getSize());
+
+	// Copy the batches
+	passCount = 0;
+	textureBarrierCount = 0;
+	bufferBarrierCount = 0;
+	asBarrierCount = 0;
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		const Batch& batch = ctx.m_batches[batchIdx];
+		BakeCache::BatchRange& range = cache.m_batches[batchIdx];
+
+		range.m_firstPass = passCount;
+		range.m_passCount = batch.m_passIndices.getSize();
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			cache.m_passIndices[passCount++] = passIdx;
+		}
+
+		range.m_firstTextureBarrier = textureBarrierCount;
+		range.m_textureBarrierCount = batch.m_textureBarriersBefore.getSize();
+		for(const TextureBarrier& barrier : batch.m_textureBarriersBefore)
+		{
+			cache.m_textureBarriers[textureBarrierCount++] = barrier;
+		}
+
+		range.m_firstBufferBarrier = bufferBarrierCount;
+		range.m_bufferBarrierCount = batch.m_bufferBarriersBefore.getSize();
+		for(const BufferBarrier& barrier : batch.m_bufferBarriersBefore)
+		{
+			cache.m_bufferBarriers[bufferBarrierCount++] = barrier;
+		}
+
+		range.m_firstASBarrier = asBarrierCount;
+		range.m_asBarrierCount = batch.m_asBarriersBefore.getSize();
+		for(const ASBarrier& barrier : batch.m_asBarriersBefore)
+		{
+			cache.m_asBarriers[asBarrierCount++] = barrier;
+		}
+	}
+
+	// Copy the final usages
+	surfOrVolCount = 0;
+	for(const RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			cache.m_rtFinalUsages[surfOrVolCount++] = usage;
+		}
+	}
+
+	for(U32 i = 0; i < ctx.m_buffers.getSize(); ++i)
+	{
+		cache.m_bufferFinalUsages[i] = ctx.m_buffers[i].m_usage;
+	}
+
+	for(U32 i = 0; i < ctx.m_as.getSize(); ++i)
+	{
+		cache.m_asFinalUsages[i] = ctx.m_as[i].m_usage;
+	}
+}
+
+void RenderGraph::restoreBakeCache()
+{
+	ANKI_ASSERT(m_bakeCache);
+	BakeContext& ctx = *m_ctx;
+	const BakeCache& cache = *m_bakeCache;
+	const StackAllocator<U8>& alloc = ctx.m_alloc;
+
+	ctx.m_batches.create(alloc, cache.m_batches.getSize());
+	for(U32 batchIdx = 0; batchIdx < cache.m_batches.getSize(); ++batchIdx)
+	{
+		const BakeCache::BatchRange& range = cache.m_batches[batchIdx];
+		Batch& batch = ctx.m_batches[batchIdx];
+
+		batch.m_passIndices.create(alloc, range.m_passCount);
+		for(U32 i = 0; i < range.m_passCount; ++i)
+		{
+			const U32 passIdx = cache.m_passIndices[range.m_firstPass + i];
+			batch.m_passIndices[i] = passIdx;
+			ctx.m_passIsInBatch.set(passIdx);
+			ctx.m_passes[passIdx].m_batchIdx = batchIdx;
+		}
+
+		batch.m_textureBarriersBefore.create(alloc, range.m_textureBarrierCount);
+		for(U32 i = 0; i < range.m_textureBarrierCount; ++i)
+		{
+			batch.m_textureBarriersBefore[i] = cache.m_textureBarriers[range.m_firstTextureBarrier + i];
+		}
+
+		batch.m_bufferBarriersBefore.create(alloc, range.m_bufferBarrierCount);
+		for(U32 i = 0; i < range.m_bufferBarrierCount; ++i)
+		{
+			batch.m_bufferBarriersBefore[i] = cache.m_bufferBarriers[range.m_firstBufferBarrier + i];
+		}
+
+		batch.m_asBarriersBefore.create(alloc, range.m_asBarrierCount);
+		for(U32 i = 0; i < range.m_asBarrierCount; ++i)
+		{
+			batch.m_asBarriersBefore[i] = cache.m_asBarriers[range.m_firstASBarrier + i];
+		}
+	}
+
+	// The final usages. The hash guarantees that the RTs have the same number of surfaces
+	U32 surfOrVolCount = 0;
+	for(RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit& usage : rt.m_surfOrVolUsages)
+		{
+			usage = cache.m_rtFinalUsages[surfOrVolCount++];
+		}
+	}
+	ANKI_ASSERT(surfOrVolCount == cache.m_rtFinalUsages.getSize());
+
+	for(U32 i = 0; i < ctx.m_buffers.getSize(); ++i)
+	{
+		ctx.m_buffers[i].m_usage = cache.m_bufferFinalUsages[i];
+	}
+
+	for(U32 i = 0; i < ctx.m_as.getSize(); ++i)
+	{
+		ctx.m_as[i].m_usage = cache.m_asFinalUsages[i];
+	}
+}
+
+U64 RenderGraph::computeBakedGraphHash() const
+{
+	const BakeContext& ctx = *m_ctx;
+
+	// Hash member by member, the barriers have padding
+	const U32 batchCount = ctx.m_batches.getSize();
+	U64 hash = computeHash(&batchCount, sizeof(batchCount));
+	auto append = [&](const auto& x) { hash = appendHash(&x, sizeof(x), hash); };
+
+	for(const Batch& batch : ctx.m_batches)
+	{
+		append(batch.m_passIndices.getSize());
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			append(passIdx);
+		}
+
+		append(batch.m_textureBarriersBefore.getSize());
+		for(const TextureBarrier& b : batch.m_textureBarriersBefore)
+		{
+			append(b.m_idx);
+			append(b.m_usageBefore);
+			append(b.m_usageAfter);
+			append(b.m_surface.m_level);
+			append(b.m_surface.m_depth);
+			append(b.m_surface.m_face);
+			append(b.m_surface.m_layer);
+			append(b.m_aliasedIdx);
+			append(b.m_aliasedUsage);
+		}
+
+		append(batch.m_bufferBarriersBefore.getSize());
+		for(const BufferBarrier& b : batch.m_bufferBarriersBefore)
+		{
+			append(b.m_idx);
+			append(b.m_usageBefore);
+			append(b.m_usageAfter);
+		}
+
+		append(batch.m_asBarriersBefore.getSize());
+		for(const ASBarrier& b : batch.m_asBarriersBefore)
+		{
+			append(b.m_idx);
+			append(b.m_usageBefore);
+			append(b.m_usageAfter);
+		}
+	}
+
+	return hash;
+}
+
 void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_COMPILE);
@@ -1170,18 +1729,47 @@ void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllo
 	BakeContext& ctx = *newContext(descr, alloc);
 	m_ctx = &ctx;
 
+	// If the description has the same topology as last time's reuse the batches and the barriers. The dependency dump
+	// needs the dependencies so don't use the cache when debugging
+	const U64 hash = computeBakeHash(descr, alloc);
+	const Bool cacheHit = !ANKI_DBG_RENDER_GRAPH && m_bakeCache && m_bakeCache->m_hash == hash;
+
 	// Init the passes and find the dependencies between passes
-	initRenderPassesAndSetDeps(descr, alloc);
+	initRenderPassesAndSetDeps(descr, alloc, !cacheHit);
 
-	// Walk the graph and create pass batches
-	initBatches();
+	m_statistics.m_bakeCacheHit = cacheHit;
+	if(cacheHit)
+	{
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_CACHE_HITS, 1);
+		restoreBakeCache();
+
+		// The aliasing is the same as last time but the textures might not be
+		createTransientRenderTargets(descr, alloc);
+	}
+	else
+	{
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_CACHE_MISSES, 1);
+
+		// Walk the graph and create pass batches
+		initBatches();
+
+		// Now that the lifetimes are known create the RTs
+		createTransientRenderTargets(descr, alloc);
+
+		// Create barriers between batches
+		setBatchBarriers(descr);
+
+		storeBakeCache(hash);
+	}
+
+	m_statistics.m_bakedGraphHash = computeBakedGraphHash();
+
+	// The command buffers are new every frame
+	initBatchCommandBuffers();
 
 	// Now that we know the batches every pass belongs init the graphics passes
 	initGraphicsPasses(descr, alloc);
 
-	// Create barriers between batches
-	setBatchBarriers(descr);
-
 #if ANKI_DBG_RENDER_GRAPH
 	if(dumpDependencyDotFile(descr, ctx, "./"))
 	{
@@ -1261,8 +1849,17 @@ void RenderGraph::run() const
 		// Set the barriers
 		for(const TextureBarrier& barrier : batch.m_textureBarriersBefore)
 		{
-			cmdb->setTextureSurfaceBarrier(m_ctx->m_rts[barrier.m_idx].m_texture, barrier.m_usageBefore,
-										   barrier.m_usageAfter, barrier.m_surface);
+			if(barrier.m_aliasedIdx == MAX_U32)
+			{
+				cmdb->setTextureSurfaceBarrier(m_ctx->m_rts[barrier.m_idx].m_texture, barrier.m_usageBefore,
+											   barrier.m_usageAfter, barrier.m_surface);
+			}
+			else
+			{
+				cmdb->setTextureSurfaceAliasingBarrier(m_ctx->m_rts[barrier.m_aliasedIdx].m_texture,
+													   barrier.m_aliasedUsage, m_ctx->m_rts[barrier.m_idx].m_texture,
+													   barrier.m_usageAfter, barrier.m_surface);
+			}
 		}
 		for(const BufferBarrier& barrier : batch.m_bufferBarriersBefore)
 		{
@@ -1414,6 +2011,9 @@ void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
 		statistics.m_gpuTime = -1.0;
 		statistics.m_cpuStartTime = -1.0;
 	}
+
+	statistics.m_bakeCacheHit = m_statistics.m_bakeCacheHit;
+	statistics.m_bakedGraphHash = m_statistics.m_bakedGraphHash;
 }
 
 #if ANKI_DBG_RENDER_GRAPH
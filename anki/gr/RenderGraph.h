@@ -561,6 +561,12 @@ class RenderGraphStatistics
 public:
 	Second m_gpuTime; ///< Time spent in the GPU.
 	Second m_cpuStartTime; ///< Time the work was submited from the CPU (almost)
+
+	/// @name Info about the last compileNewGraph()
+	/// @{
+	Bool m_bakeCacheHit; ///< The batches and the barriers were reused from the previous compilation.
+	U64 m_bakedGraphHash; ///< A hash of the batches and the barriers. Two compilations that produced the same match.
+	/// @}
 };
 
 /// Accepts a descriptor of the frame's render passes and sets the dependencies between them.
@@ -625,6 +631,7 @@ private:
 
 	// Forward declarations of internal classes.
 	class BakeContext;
+	class BakeCache;
 	class Pass;
 	class Batch;
 	class RT;
@@ -654,8 +661,15 @@ private:
 	HashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
 
 	BakeContext* m_ctx = nullptr;
+	BakeCache* m_bakeCache = nullptr; ///< The batches and barriers of the previous compilation.
 	U64 m_version = 0;
 
+	/// @name The memory of the non-imported RTs that was last logged
+	/// @{
+	PtrSize m_transientMemoryWithAliasing = 0;
+	PtrSize m_transientMemoryWithoutAliasing = 0;
+	/// @}
+
 	static constexpr U MAX_TIMESTAMPS_BUFFERED = MAX_FRAMES_IN_FLIGHT + 1;
 	class
 	{
@@ -663,6 +677,9 @@ private:
 		Array<TimestampQueryPtr, MAX_TIMESTAMPS_BUFFERED * 2> m_timestamps;
 		Array<Second, MAX_TIMESTAMPS_BUFFERED> m_cpuStartTimes;
 		U8 m_nextTimestamp = 0;
+
+		Bool m_bakeCacheHit = false;
+		U64 m_bakedGraphHash = 0;
 	} m_statistics;
 
 	RenderGraph(GrManager* manager, CString name);
@@ -672,11 +689,25 @@ private:
 	static ANKI_USE_RESULT RenderGraph* newInstance(GrManager* manager);
 
 	BakeContext* newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc, Bool setDeps);
 	void initBatches();
+
+	/// Find the lifetime of the non-imported RTs in batches and create their textures. RTs that are not in use at the
+	/// same time will share memory.
+	void createTransientRenderTargets(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+
+	void initBatchCommandBuffers();
 	void initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
 	void setBatchBarriers(const RenderGraphDescription& descr);
 
+	/// Hash everything in the description and the context that the batches and the barriers depend on.
+	U64 computeBakeHash(const RenderGraphDescription& descr, StackAllocator<U8>& alloc) const;
+	void storeBakeCache(U64 hash);
+	void restoreBakeCache();
+
+	/// Hash the batches and the barriers of the context.
+	U64 computeBakedGraphHash() const;
+
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
 	FramebufferPtr getOrCreateFramebuffer(const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles,
 										  CString name, Bool& drawsToPresentableTex);
@@ -14,7 +14,7 @@ namespace anki
 /// @{
 
 /// Texture initializer.
-class alignas(4) TextureInitInfo : public GrBaseInitInfo
+class alignas(8) TextureInitInfo : public GrBaseInitInfo
 {
 public:
 	U32 m_width = 0;
@@ -32,7 +32,15 @@ public:
 
 	U8 m_samples = 1;
 
-	U8 _m_padding[1] = {0};
+	/// Other textures will be placed in the memory of this one (see m_memoryOwner). Its memory will be sub-allocated
+	/// even if the driver prefers a dedicated allocation, since other textures can't be bound to that. It's not part
+	/// of the hash.
+	Bool m_memoryAliasable = false;
+
+	/// If set the texture will be placed in the memory of that texture instead of allocating its own. The two textures
+	/// can't be in use at the same time and the new one starts with undefined contents. If the memory doesn't fit the
+	/// texture will allocate its own. It's not part of the hash.
+	TexturePtr m_memoryOwner;
 
 	TextureInitInfo() = default;
 
@@ -158,6 +166,18 @@ public:
 		return m_aspect;
 	}
 
+	/// The size of the device memory the texture occupies. Zero if the backend doesn't know.
+	PtrSize getMemorySize() const
+	{
+		return m_memorySize;
+	}
+
+	/// True if the texture lives in the memory of TextureInitInfo::m_memoryOwner.
+	Bool isMemoryAliased() const
+	{
+		return m_memoryAliased;
+	}
+
 	Bool isSubresourceValid(const TextureSubresourceInfo& subresource) const
 	{
 #define ANKI_TEX_SUBRESOURCE_ASSERT(x_) \
@@ -255,6 +275,8 @@ protected:
 	TextureUsageBit m_usage = TextureUsageBit::NONE;
 	Format m_format = Format::NONE;
 	DepthStencilAspectBit m_aspect = DepthStencilAspectBit::NONE;
+	PtrSize m_memorySize = 0;
+	Bool m_memoryAliased = false;
 
 	/// Construct.
 	Texture(GrManager* manager, CString name)
@@ -1356,6 +1356,14 @@ void CommandBuffer::setTextureSurfaceBarrier(TexturePtr tex, TextureUsageBit pre
 	setTextureBarrier(tex, prevUsage, nextUsage, subresource);
 }
 
+void CommandBuffer::setTextureSurfaceAliasingBarrier(TexturePtr aliasedTex, TextureUsageBit aliasedUsage,
+													 TexturePtr tex, TextureUsageBit nextUsage,
+													 const TextureSurfaceInfo& surf)
+{
+	// No memory aliasing in GL
+	setTextureSurfaceBarrier(tex, TextureUsageBit::NONE, nextUsage, surf);
+}
+
 void CommandBuffer::setTextureVolumeBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
 											const TextureVolumeInfo& vol)
 {
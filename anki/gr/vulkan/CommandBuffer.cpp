@@ -343,6 +343,14 @@ void CommandBuffer::setTextureSurfaceBarrier(TexturePtr tex, TextureUsageBit pre
 	self.setTextureSurfaceBarrier(tex, prevUsage, nextUsage, surf);
 }
 
+void CommandBuffer::setTextureSurfaceAliasingBarrier(TexturePtr aliasedTex, TextureUsageBit aliasedUsage,
+													 TexturePtr tex, TextureUsageBit nextUsage,
+													 const TextureSurfaceInfo& surf)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.setTextureSurfaceAliasingBarrier(aliasedTex, aliasedUsage, tex, nextUsage, surf);
+}
+
 void CommandBuffer::setTextureVolumeBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
 											const TextureVolumeInfo& vol)
 {
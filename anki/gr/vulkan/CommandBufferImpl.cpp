@@ -351,6 +351,13 @@ void CommandBufferImpl::flushBarriers()
 		return;
 	}
 
+	// Don't drop the read-to-read barriers. They make the last write visible to the new destination stages (eg a
+	// SAMPLED_FRAGMENT to SAMPLED_COMPUTE transition) and the command buffer can't know what was made visible before.
+	// Only exact duplicates and ranges that are already covered are removed below
+	//
+
+	const U32 requestedImgBarrierCount = m_imgBarrierCount;
+
 	// Sort
 	//
 
@@ -378,6 +385,17 @@ void CommandBufferImpl::flushBarriers()
 						  return a.newLayout < b.newLayout;
 					  }
 
+					  // The access masks too, so that the ranges that can be squashed end up next to each other
+					  if(a.srcAccessMask != b.srcAccessMask)
+					  {
+						  return a.srcAccessMask < b.srcAccessMask;
+					  }
+
+					  if(a.dstAccessMask != b.dstAccessMask)
+					  {
+						  return a.dstAccessMask < b.dstAccessMask;
+					  }
+
 					  if(a.subresourceRange.baseArrayLayer != b.subresourceRange.baseArrayLayer)
 					  {
 						  return a.subresourceRange.baseArrayLayer < b.subresourceRange.baseArrayLayer;
@@ -404,24 +422,34 @@ void CommandBufferImpl::flushBarriers()
 
 		squashedBarriers.create(m_imgBarrierCount);
 
-		// Squash the mips by reducing the barriers
+		// Squash the mips by reducing the barriers. Compare against the last squashed barrier so that chains of mips
+		// collapse and duplicates are dropped
 		for(U32 i = 0; i < m_imgBarrierCount; ++i)
 		{
-			const VkImageMemoryBarrier* prev = (i > 0) ? &m_imgBarriers[i - 1] : nullptr;
+			VkImageMemoryBarrier* prev =
+				(squashedBarrierCount > 0) ? &squashedBarriers[squashedBarrierCount - 1] : nullptr;
 			const VkImageMemoryBarrier& crnt = m_imgBarriers[i];
 
-			if(prev && prev->image == crnt.image
-			   && prev->subresourceRange.aspectMask == crnt.subresourceRange.aspectMask
-			   && prev->oldLayout == crnt.oldLayout && prev->newLayout == crnt.newLayout
-			   && prev->srcAccessMask == crnt.srcAccessMask && prev->dstAccessMask == crnt.dstAccessMask
-			   && prev->subresourceRange.baseMipLevel + prev->subresourceRange.levelCount
-					  == crnt.subresourceRange.baseMipLevel
-			   && prev->subresourceRange.baseArrayLayer == crnt.subresourceRange.baseArrayLayer
-			   && prev->subresourceRange.layerCount == crnt.subresourceRange.layerCount)
+			const Bool compatible = prev && prev->image == crnt.image
+									&& prev->subresourceRange.aspectMask == crnt.subresourceRange.aspectMask
+									&& prev->oldLayout == crnt.oldLayout && prev->newLayout == crnt.newLayout
+									&& prev->srcAccessMask == crnt.srcAccessMask
+									&& prev->dstAccessMask == crnt.dstAccessMask
+									&& prev->subresourceRange.baseArrayLayer == crnt.subresourceRange.baseArrayLayer
+									&& prev->subresourceRange.layerCount == crnt.subresourceRange.layerCount;
+
+			if(compatible && crnt.subresourceRange.baseMipLevel >= prev->subresourceRange.baseMipLevel
+			   && crnt.subresourceRange.baseMipLevel + crnt.subresourceRange.levelCount
+					  <= prev->subresourceRange.baseMipLevel + prev->subresourceRange.levelCount)
+			{
+				// Already covered by the previous barrier, skip it
+			}
+			else if(compatible
+					&& prev->subresourceRange.baseMipLevel + prev->subresourceRange.levelCount
+						   == crnt.subresourceRange.baseMipLevel)
 			{
 				// Can batch
-				squashedBarriers[squashedBarrierCount - 1].subresourceRange.levelCount +=
-					crnt.subresourceRange.levelCount;
+				prev->subresourceRange.levelCount += crnt.subresourceRange.levelCount;
 			}
 			else
 			{
@@ -437,7 +465,8 @@ void CommandBufferImpl::flushBarriers()
 
 		for(U32 i = 0; i < squashedBarrierCount; ++i)
 		{
-			const VkImageMemoryBarrier* prev = (i > 0) ? &squashedBarriers[i - 1] : nullptr;
+			VkImageMemoryBarrier* prev =
+				(finalImgBarrierCount > 0) ? &finalImgBarriers[finalImgBarrierCount - 1] : nullptr;
 			const VkImageMemoryBarrier& crnt = squashedBarriers[i];
 
 			if(prev && prev->image == crnt.image
@@ -450,8 +479,7 @@ void CommandBufferImpl::flushBarriers()
 					  == crnt.subresourceRange.baseArrayLayer)
 			{
 				// Can batch
-				finalImgBarriers[finalImgBarrierCount - 1].subresourceRange.layerCount +=
-					crnt.subresourceRange.layerCount;
+				prev->subresourceRange.layerCount += crnt.subresourceRange.layerCount;
 			}
 			else
 			{
@@ -471,6 +499,8 @@ void CommandBufferImpl::flushBarriers()
 						 (finalImgBarrierCount) ? &finalImgBarriers[0] : nullptr);
 
 	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_BARRIERS, 1);
+	ANKI_TRACE_INC_COUNTER(VK_IMAGE_BARRIERS, finalImgBarrierCount);
+	ANKI_TRACE_INC_COUNTER(VK_IMAGE_BARRIERS_SKIPPED, requestedImgBarrierCount - finalImgBarrierCount);
 
 	m_imgBarrierCount = 0;
 	m_buffBarrierCount = 0;
@@ -324,6 +324,9 @@ public:
 	void setTextureSurfaceBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
 								  const TextureSurfaceInfo& surf);
 
+	void setTextureSurfaceAliasingBarrier(TexturePtr aliasedTex, TextureUsageBit aliasedUsage, TexturePtr tex,
+										  TextureUsageBit nextUsage, const TextureSurfaceInfo& surf);
+
 	void setTextureVolumeBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
 								 const TextureVolumeInfo& vol);
 
@@ -480,7 +483,8 @@ private:
 	/// batch.
 	void flushBatches(CommandBufferCommandType type);
 
-	void drawcallCommon();
+	/// @return False if the draw should be skipped.
+	Bool drawcallCommon();
 
 	Bool insideRenderPass() const
 	{
@@ -120,6 +120,7 @@ inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage, Vk
 #else
 	ANKI_CMD(vkCmdPipelineBarrier(m_handle, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &inf), ANY_OTHER_COMMAND);
 	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_BARRIERS, 1);
+	ANKI_TRACE_INC_COUNTER(VK_IMAGE_BARRIERS, 1);
 #endif
 }
 
@@ -187,6 +188,47 @@ inline void CommandBufferImpl::setTextureSurfaceBarrier(TexturePtr tex, TextureU
 	setTextureBarrierRange(tex, prevUsage, nextUsage, range);
 }
 
+inline void CommandBufferImpl::setTextureSurfaceAliasingBarrier(TexturePtr aliasedTex, TextureUsageBit aliasedUsage,
+																TexturePtr tex, TextureUsageBit nextUsage,
+																const TextureSurfaceInfo& surf)
+{
+	if(ANKI_UNLIKELY(surf.m_level > 0 && nextUsage == TextureUsageBit::GENERATE_MIPMAPS))
+	{
+		// This transition happens inside CommandBufferImpl::generateMipmapsX. The barrier of the 1st level waits for
+		// the aliased texture
+		return;
+	}
+
+	const TextureImpl& aliasedImpl = static_cast<const TextureImpl&>(*aliasedTex);
+	const TextureImpl& impl = static_cast<const TextureImpl&>(*tex);
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+
+	VkImageSubresourceRange range;
+	impl.computeVkImageSubresourceRange(TextureSubresourceInfo(surf, impl.getDepthStencilAspect()), range);
+
+	// The source scope is the accesses of the aliased texture. Use the last level so GENERATE_MIPMAPS is treated as
+	// a write
+	VkPipelineStageFlags srcStage;
+	VkAccessFlags srcAccess;
+	aliasedImpl.computeBarrierInfo(aliasedUsage, true, aliasedImpl.getMipmapCount() - 1, srcStage, srcAccess);
+	if(srcStage == 0)
+	{
+		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	}
+
+	// The destination scope is the first use of the new texture. Its old contents are undefined
+	VkPipelineStageFlags dstStage;
+	VkAccessFlags dstAccess;
+	impl.computeBarrierInfo(nextUsage, false, range.baseMipLevel, dstStage, dstAccess);
+	ANKI_ASSERT(dstStage);
+
+	setImageBarrier(srcStage, srcAccess, VK_IMAGE_LAYOUT_UNDEFINED, dstStage, dstAccess,
+					impl.computeLayout(nextUsage, range.baseMipLevel), impl.m_imageHandle, range);
+
+	m_microCmdb->pushObjectRef(tex);
+	m_microCmdb->pushObjectRef(aliasedTex);
+}
+
 inline void CommandBufferImpl::setTextureVolumeBarrier(TexturePtr tex, TextureUsageBit prevUsage,
 													   TextureUsageBit nextUsage, const TextureVolumeInfo& vol)
 {
@@ -292,7 +334,11 @@ inline void CommandBufferImpl::drawArrays(PrimitiveTopology topology, U32 count,
 										  U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(!drawcallCommon())
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDraw(m_handle, count, instanceCount, first, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -300,7 +346,11 @@ inline void CommandBufferImpl::drawElements(PrimitiveTopology topology, U32 coun
 											U32 baseVertex, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(!drawcallCommon())
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDrawIndexed(m_handle, count, instanceCount, firstIndex, baseVertex, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -308,7 +358,11 @@ inline void CommandBufferImpl::drawArraysIndirect(PrimitiveTopology topology, U3
 												  BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(!drawcallCommon())
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -322,7 +376,11 @@ inline void CommandBufferImpl::drawElementsIndirect(PrimitiveTopology topology,
 													BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(!drawcallCommon())
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -610,7 +668,7 @@ inline void CommandBufferImpl::pushSecondLevelCommandBuffer(CommandBufferPtr cmd
 	m_microCmdb->pushObjectRef(cmdb);
 }
 
-inline void CommandBufferImpl::drawcallCommon()
+inline Bool CommandBufferImpl::drawcallCommon()
 {
 	// Preconditions
 	commandCommon();
@@ -632,7 +690,11 @@ inline void CommandBufferImpl::drawcallCommon()
 	// Get or create ppline
 	Pipeline ppline;
 	Bool stateDirty;
-	m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty);
+	const Bool skipIfNotReady = !!(m_flags & CommandBufferFlag::SKIP_DRAWS_WITH_PENDING_PIPELINES);
+	if(!m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty, skipIfNotReady))
+	{
+		return false;
+	}
 
 	if(stateDirty)
 	{
@@ -723,6 +785,7 @@ inline void CommandBufferImpl::drawcallCommon()
 #endif
 
 	ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+	return true;
 }
 
 inline void CommandBufferImpl::commandCommon()
@@ -65,6 +65,7 @@ enum class VulkanExtensions : U16
 	KHR_SWAPCHAIN = 1 << 4,
 	KHR_SURFACE = 1 << 5,
 	EXT_DEBUG_MARKER = 1 << 6,
+	EXT_HEADLESS_SURFACE = 1 << 7,
 	EXT_DEBUG_REPORT = 1 << 9,
 	AMD_SHADER_INFO = 1 << 10,
 	AMD_RASTERIZATION_ORDER = 1 << 11,
@@ -7,7 +7,7 @@
 #include <anki/gr/Buffer.h>
 #include <anki/gr/vulkan/BufferImpl.h>
 #include <anki/util/List.h>
-#include <anki/util/HashMap.h>
+#include <anki/util/FlatHashMap.h>
 #include <anki/util/Tracer.h>
 #include <algorithm>
 
@@ -294,7 +294,7 @@ public:
 	U32 m_lastPoolFreeDSCount = 0;
 
 	IntrusiveList<DS> m_list; ///< At the left of the list are the least used sets.
-	HashMap<U64, DS*> m_hashmap;
+	FlatHashMap<U64, DS*> m_hashmap;
 
 	DSThreadAllocator(const DSLayoutCacheEntry* layout, ThreadId tid)
 		: m_layoutEntry(layout)
@@ -430,10 +430,12 @@ const DS* DSThreadAllocator::tryFindSet(U64 hash)
 	auto it = m_hashmap.find(hash);
 	if(it == m_hashmap.getEnd())
 	{
+		ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_CACHE_MISSES, 1);
 		return nullptr;
 	}
 	else
 	{
+		ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_CACHE_HITS, 1);
 		DS* ds = *it;
 
 		// Remove from the list and place at the end of the list
@@ -450,29 +452,23 @@ Error DSThreadAllocator::newSet(U64 hash, const Array<AnyBindingExtended, MAX_BI
 {
 	DS* out = nullptr;
 
-	// First try to see if there are unused to recycle
+	// First try to recycle the least used set. The list is sorted by the last use so only the first needs checking
 	const U64 crntFrame = m_layoutEntry->m_factory->m_frameCount;
-	auto it = m_list.getBegin();
-	const auto end = m_list.getEnd();
-	while(it != end)
+	if(!m_list.isEmpty() && crntFrame - m_list.getFront().m_lastFrameUsed > DESCRIPTOR_FRAME_BUFFERING)
 	{
-		DS* set = &(*it);
-		U64 frameDiff = crntFrame - set->m_lastFrameUsed;
-		if(frameDiff > DESCRIPTOR_FRAME_BUFFERING)
-		{
-			// Found something, recycle
-			auto it2 = m_hashmap.find(set->m_hash);
-			ANKI_ASSERT(it2 != m_hashmap.getEnd());
-			m_hashmap.erase(m_layoutEntry->m_factory->m_alloc, it2);
-			m_list.erase(set);
+		DS* set = &m_list.getFront();
+		ANKI_ASSERT(set->m_lastFrameUsed <= m_list.getBack().m_lastFrameUsed);
 
-			m_list.pushBack(set);
-			m_hashmap.emplace(m_layoutEntry->m_factory->m_alloc, hash, set);
+		auto it = m_hashmap.find(set->m_hash);
+		ANKI_ASSERT(it != m_hashmap.getEnd());
+		m_hashmap.erase(m_layoutEntry->m_factory->m_alloc, it);
+		m_list.popFront();
 
-			out = set;
-			break;
-		}
-		++it;
+		m_list.pushBack(set);
+		m_hashmap.emplace(m_layoutEntry->m_factory->m_alloc, hash, set);
+		ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_RECYCLE, 1);
+
+		out = set;
 	}
 
 	if(out == nullptr)
@@ -1061,9 +1057,13 @@ Error DescriptorSetFactory::newDescriptorSet(ThreadId tid, StackAllocator<U8>& t
 			DescriptorSetLayout layout = state.m_layout;
 			DSLayoutCacheEntry& entry = *layout.m_entry;
 
-			// Get thread allocator
-			DSThreadAllocator* alloc;
-			ANKI_CHECK(entry.getOrCreateThreadAllocator(tid, alloc));
+			// Get thread allocator. The state remembers the last one to avoid the lock
+			DSThreadAllocator* alloc = state.m_threadAlloc;
+			if(alloc == nullptr || alloc->m_layoutEntry != &entry || alloc->m_tid != tid)
+			{
+				ANKI_CHECK(entry.getOrCreateThreadAllocator(tid, alloc));
+				state.m_threadAlloc = alloc;
+			}
 
 			// Finally, allocate
 			const DS* s;
@@ -308,6 +308,7 @@ public:
 private:
 	StackAllocator<U8> m_alloc;
 	DescriptorSetLayout m_layout;
+	DSThreadAllocator* m_threadAlloc = nullptr; ///< The allocator that was used last time.
 
 	Array<AnyBindingExtended, MAX_BINDINGS_PER_DESCRIPTOR_SET> m_bindings;
 
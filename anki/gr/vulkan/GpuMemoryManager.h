@@ -28,6 +28,12 @@ public:
 		return m_memory != VK_NULL_HANDLE && m_offset < MAX_PTR_SIZE && m_memTypeIdx < MAX_U8;
 	}
 
+	U32 getMemoryTypeIndex() const
+	{
+		ANKI_ASSERT(m_memTypeIdx < MAX_U8);
+		return m_memTypeIdx;
+	}
+
 private:
 	ClassGpuAllocatorHandle m_classHandle;
 	U8 m_memTypeIdx = MAX_U8;
@@ -5,6 +5,8 @@
 
 #include <anki/gr/GrManager.h>
 #include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/gr/vulkan/ShaderProgramImpl.h>
+#include <anki/gr/vulkan/Pipeline.h>
 
 #include <anki/gr/Buffer.h>
 #include <anki/gr/Texture.h>
@@ -124,7 +126,15 @@ ShaderPtr GrManager::newShader(const ShaderInitInfo& init)
 
 ShaderProgramPtr GrManager::newShaderProgram(const ShaderProgramInitInfo& init)
 {
-	return ShaderProgramPtr(ShaderProgram::newInstance(this, init));
+	ShaderProgramPtr prog(ShaderProgram::newInstance(this, init));
+
+	// Start creating the pipelines of the previous runs. The jobs need a reference to the program so do it here
+	if(prog.isCreated() && static_cast<ShaderProgramImpl&>(*prog).isGraphics())
+	{
+		static_cast<ShaderProgramImpl&>(*prog).getPipelineFactory().prewarm(prog);
+	}
+
+	return prog;
 }
 
 CommandBufferPtr GrManager::newCommandBuffer(const CommandBufferInitInfo& init)
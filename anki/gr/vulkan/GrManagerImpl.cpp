@@ -29,6 +29,8 @@ GrManagerImpl::~GrManagerImpl()
 	m_cmdbFactory.destroy();
 
 	// SECOND THING: The destroy everything that has a reference to GrObjects.
+	m_asyncPplineCreator.destroy();
+
 	for(auto& x : m_perFrame)
 	{
 		x.m_presentFence.reset(nullptr);
@@ -112,6 +114,7 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 	m_crntSwapchain = m_swapchainFactory.newInstance();
 
 	ANKI_CHECK(m_pplineCache.init(m_device, m_physicalDevice, init.m_cacheDirectory, *init.m_config, getAllocator()));
+	m_asyncPplineCreator.init(getAllocator(), m_device);
 
 	ANKI_CHECK(initMemory(*init.m_config));
 
@@ -314,6 +317,13 @@ Error GrManagerImpl::initInstance(const GrManagerInitInfo& init)
 				m_extensions |= VulkanExtensions::EXT_DEBUG_REPORT;
 				instExtensions[instExtensionCount++] = VK_EXT_DEBUG_REPORT_EXTENSION_NAME;
 			}
+#if ANKI_HEADLESS
+			else if(CString(instExtensionInf[i].extensionName) == VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME)
+			{
+				m_extensions |= VulkanExtensions::EXT_HEADLESS_SURFACE;
+				instExtensions[instExtensionCount++] = VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME;
+			}
+#endif
 		}
 
 		if(instExtensionCount)
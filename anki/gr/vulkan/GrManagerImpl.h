@@ -160,6 +160,17 @@ public:
 		return m_pplineCache.m_cacheHandle;
 	}
 
+	/// The cache that holds the states of the graphics pipelines as well.
+	PipelineCache& getDiskPipelineCache()
+	{
+		return m_pplineCache;
+	}
+
+	AsyncPipelineCreator& getAsyncPipelineCreator()
+	{
+		return m_asyncPplineCreator;
+	}
+
 	PipelineLayoutFactory& getPipelineLayoutFactory()
 	{
 		return m_pplineLayoutFactory;
@@ -186,6 +197,12 @@ public:
 		return m_queueIdx;
 	}
 
+	/// The size of the window. Used when the surface lets the swapchain decide its size (eg headless surfaces).
+	UVec2 getNativeWindowSize() const
+	{
+		return UVec2(m_nativeWindowWidth, m_nativeWindowHeight);
+	}
+
 	/// @name Debug report
 	/// @{
 	void beginMarker(VkCommandBuffer cmdb, CString name) const
@@ -277,6 +294,8 @@ private:
 	};
 
 	VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+	U32 m_nativeWindowWidth = 0;
+	U32 m_nativeWindowHeight = 0;
 	MicroSwapchainPtr m_crntSwapchain;
 	U8 m_acquiredImageIdx = MAX_U8;
 
@@ -309,6 +328,7 @@ private:
 	QueryFactory m_timestampQueryFactory;
 
 	PipelineCache m_pplineCache;
+	AsyncPipelineCreator m_asyncPplineCreator;
 
 	Bool m_r8g8b8ImagesSupported = false;
 	Bool m_s8ImagesSupported = false;
@@ -0,0 +1,32 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/gr/GrManager.h>
+#include <anki/core/NativeWindow.h>
+
+namespace anki
+{
+
+Error GrManagerImpl::initSurface(const GrManagerInitInfo& init)
+{
+	if(!(m_extensions & VulkanExtensions::EXT_HEADLESS_SURFACE))
+	{
+		ANKI_VK_LOGE(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME " is not supported. Can't run headless");
+		return Error::FUNCTION_FAILED;
+	}
+
+	VkHeadlessSurfaceCreateInfoEXT ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+	ANKI_VK_CHECK(vkCreateHeadlessSurfaceEXT(m_instance, &ci, nullptr, &m_surface));
+
+	// Headless surfaces don't have a size. The swapchain will use the size of the window
+	m_nativeWindowWidth = init.m_window->getWidth();
+	m_nativeWindowHeight = init.m_window->getHeight();
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -26,6 +26,9 @@ Error GrManagerImpl::initSurface(const GrManagerInitInfo& init)
 		return Error::FUNCTION_FAILED;
 	}
 
+	m_nativeWindowWidth = init.m_window->getWidth();
+	m_nativeWindowHeight = init.m_window->getHeight();
+
 	return Error::NONE;
 }
 
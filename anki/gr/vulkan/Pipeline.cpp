@@ -195,6 +195,116 @@ void PipelineStateTracker::updateSuperHash()
 	m_hashes.m_superHash = computeHash(&buff[0], count * sizeof(buff[0]));
 }
 
+void PipelineStateTracker::saveRecord(U64 programBinaryHash, PipelineStateRecord& record) const
+{
+	ANKI_ASSERT(m_fb.isCreated());
+	zeroMemory(record);
+	record.m_programBinaryHash = programBinaryHash;
+
+	// Vertex
+	for(U32 i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
+	{
+		if(m_shaderAttributeMask.get(i))
+		{
+			const PPVertexAttributeBinding& attrib = m_state.m_vertex.m_attributes[i];
+			memcpy(&record.m_vertexAttributes[i][0], &attrib, sizeof(attrib));
+
+			// The hash has the binding with the index of the attribute as well
+			memcpy(&record.m_vertexBindings[attrib.m_binding][0], &m_state.m_vertex.m_bindings[attrib.m_binding],
+				   sizeof(PPVertexBufferBinding));
+			memcpy(&record.m_vertexBindings[i][0], &m_state.m_vertex.m_bindings[i], sizeof(PPVertexBufferBinding));
+		}
+	}
+
+	// IA & rasterizer
+	memcpy(&record.m_inputAssembler[0], &m_state.m_inputAssembler, sizeof(m_state.m_inputAssembler));
+	memcpy(&record.m_rasterizer[0], &m_state.m_rasterizer, sizeof(m_state.m_rasterizer));
+
+	// Depth & stencil
+	const FramebufferImpl& fbImpl = static_cast<const FramebufferImpl&>(*m_fb);
+	if(m_fbDepth)
+	{
+		memcpy(&record.m_depth[0], &m_state.m_depth, sizeof(m_state.m_depth));
+	}
+
+	if(m_fbStencil)
+	{
+		memcpy(&record.m_stencil[0], &m_state.m_stencil, sizeof(m_state.m_stencil));
+	}
+
+	if(m_fbDepth || m_fbStencil)
+	{
+		const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*fbImpl.getDepthStencilAttachment());
+		record.m_depthStencilFormat = view.getTextureImpl().getFormat();
+	}
+
+	// Color
+	if(!!m_fbColorAttachmentMask)
+	{
+		record.m_alphaToCoverageEnabled = m_state.m_color.m_alphaToCoverageEnabled;
+
+		for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+		{
+			if(m_fbColorAttachmentMask.get(i))
+			{
+				memcpy(&record.m_colorAttachments[i][0], &m_state.m_color.m_attachments[i],
+					   sizeof(m_state.m_color.m_attachments[i]));
+
+				const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*fbImpl.getColorAttachment(i));
+				record.m_colorAttachmentFormats[i] = view.getTextureImpl().getFormat();
+				record.m_colorAttachmentMask |= U8(1u << i);
+			}
+		}
+	}
+
+	record.m_depthAttachment = m_fbDepth;
+	record.m_stencilAttachment = m_fbStencil;
+	record.m_presentableAttachment = m_defaultFb;
+}
+
+void PipelineStateTracker::loadRecord(const PipelineStateRecord& record, const ShaderProgramPtr& prog,
+									  VkRenderPass rpass)
+{
+	ANKI_ASSERT(!m_state.m_prog.isCreated() && m_rpass == VK_NULL_HANDLE && "Should be a new tracker");
+	ANKI_ASSERT(prog.isCreated() && rpass);
+
+	// Vertex
+	for(U32 i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
+	{
+		memcpy(&m_state.m_vertex.m_bindings[i], &record.m_vertexBindings[i][0], sizeof(PPVertexBufferBinding));
+		memcpy(&m_state.m_vertex.m_attributes[i], &record.m_vertexAttributes[i][0], sizeof(PPVertexAttributeBinding));
+	}
+
+	m_set.m_attribs.setAll();
+	m_set.m_vertBindings.setAll();
+
+	// The rest of the state
+	memcpy(&m_state.m_inputAssembler, &record.m_inputAssembler[0], sizeof(m_state.m_inputAssembler));
+	memcpy(&m_state.m_rasterizer, &record.m_rasterizer[0], sizeof(m_state.m_rasterizer));
+	memcpy(&m_state.m_depth, &record.m_depth[0], sizeof(m_state.m_depth));
+	memcpy(&m_state.m_stencil, &record.m_stencil[0], sizeof(m_state.m_stencil));
+
+	m_state.m_color.m_alphaToCoverageEnabled = record.m_alphaToCoverageEnabled;
+	for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+	{
+		memcpy(&m_state.m_color.m_attachments[i], &record.m_colorAttachments[i][0],
+			   sizeof(m_state.m_color.m_attachments[i]));
+
+		if(record.m_colorAttachmentMask & (1u << i))
+		{
+			m_fbColorAttachmentMask.set(i);
+		}
+	}
+
+	bindShaderProgram(prog);
+
+	// Render pass
+	m_rpass = rpass;
+	m_fbDepth = record.m_depthAttachment;
+	m_fbStencil = record.m_stencilAttachment;
+	m_defaultFb = record.m_presentableAttachment;
+}
+
 const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateInfo()
 {
 	VkGraphicsPipelineCreateInfo& ci = m_ci.m_ppline;
@@ -386,11 +496,16 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 class PipelineFactory::PipelineInternal
 {
 public:
-	VkPipeline m_handle = VK_NULL_HANDLE;
+	VkPipeline m_handle = VK_NULL_HANDLE; ///< Null while the pipeline is pending.
 
 	/// The pipeline needs a render pass and the framebuffers are the owners of that. So the internal pipeline will
 	/// hold a ref to the FB in order to hold a ref to the render pass.
 	FramebufferPtr m_fb;
+
+	VkRenderPass m_ownedRpass = VK_NULL_HANDLE; ///< The render pass of a prewarmed pipeline.
+
+	/// A pending pipeline that no thread creates yet. The AsyncPipelineCreator will.
+	Bool m_queued = false;
 };
 
 class PipelineFactory::Hasher
@@ -402,6 +517,82 @@ public:
 	}
 };
 
+/// Open addressing table with linear probing. Only the writers lock. The handle of a slot is written before its hash
+/// so a reader that sees the hash sees the handle as well.
+class PipelineFactory::LookupTable
+{
+public:
+	class Slot
+	{
+	public:
+		Atomic<U64> m_hash = {0}; ///< Zero means empty.
+		VkPipeline m_handle = VK_NULL_HANDLE;
+	};
+
+	DynamicArray<Slot> m_slots;
+	U32 m_count = 0;
+	LookupTable* m_prev = nullptr; ///< The table this replaced.
+};
+
+/// Create a render pass that is compatible with the render pass of the framebuffer a record was made with.
+static VkRenderPass newCompatibleRenderPass(VkDevice dev, const PipelineStateRecord& record)
+{
+	Array<VkAttachmentDescription, MAX_COLOR_ATTACHMENTS + 1> attachments;
+	Array<VkAttachmentReference, MAX_COLOR_ATTACHMENTS + 1> references;
+	U32 attachmentCount = 0;
+
+	// Same attachments and layouts as FramebufferImpl. The load and store operations don't affect the compatibility
+	auto setupAttachment = [&](Format fmt, VkImageLayout layout) {
+		VkAttachmentDescription& desc = attachments[attachmentCount];
+		desc = {};
+		desc.format = convertFormat(fmt);
+		desc.samples = VK_SAMPLE_COUNT_1_BIT;
+		desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+		desc.initialLayout = layout;
+		desc.finalLayout = layout;
+
+		references[attachmentCount].attachment = attachmentCount;
+		references[attachmentCount].layout = layout;
+		++attachmentCount;
+	};
+
+	for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+	{
+		if(record.m_colorAttachmentMask & (1u << i))
+		{
+			ANKI_ASSERT(i == attachmentCount && "No gaps are allowed");
+			setupAttachment(record.m_colorAttachmentFormats[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		}
+	}
+
+	const U32 colorAttachmentCount = attachmentCount;
+	const Bool hasDepthStencil = record.m_depthAttachment || record.m_stencilAttachment;
+	if(hasDepthStencil)
+	{
+		setupAttachment(record.m_depthStencilFormat, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = colorAttachmentCount;
+	subpass.pColorAttachments = (colorAttachmentCount) ? &references[0] : nullptr;
+	subpass.pDepthStencilAttachment = (hasDepthStencil) ? &references[colorAttachmentCount] : nullptr;
+
+	VkRenderPassCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	ci.attachmentCount = attachmentCount;
+	ci.pAttachments = (attachmentCount) ? &attachments[0] : nullptr;
+	ci.subpassCount = 1;
+	ci.pSubpasses = &subpass;
+
+	VkRenderPass rpass;
+	ANKI_VK_CHECKF(vkCreateRenderPass(dev, &ci, nullptr, &rpass));
+	return rpass;
+}
+
 void PipelineFactory::destroy()
 {
 	for(auto it : m_pplines)
@@ -411,12 +602,133 @@ void PipelineFactory::destroy()
 			vkDestroyPipeline(m_dev, it.m_handle, nullptr);
 			it.m_fb.reset(nullptr);
 		}
+
+		if(it.m_ownedRpass)
+		{
+			vkDestroyRenderPass(m_dev, it.m_ownedRpass, nullptr);
+		}
 	}
 
 	m_pplines.destroy(m_alloc);
+
+	LookupTable* table = m_lookupTable.load();
+	while(table)
+	{
+		LookupTable* prev = table->m_prev;
+		table->m_slots.destroy(m_alloc);
+		m_alloc.deleteInstance(table);
+		table = prev;
+	}
+	m_lookupTable.store(nullptr);
 }
 
-void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty)
+VkPipeline PipelineFactory::tryFindPipeline(U64 hash) const
+{
+	ANKI_ASSERT(hash != 0);
+	const LookupTable* table = m_lookupTable.load(AtomicMemoryOrder::ACQUIRE);
+	if(table == nullptr)
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	// The table is never full so the loop will stop
+	const U32 mask = table->m_slots.getSize() - 1;
+	for(U32 i = U32(hash) & mask;; i = (i + 1) & mask)
+	{
+		const LookupTable::Slot& slot = table->m_slots[i];
+		const U64 slotHash = slot.m_hash.load(AtomicMemoryOrder::ACQUIRE);
+		if(slotHash == hash)
+		{
+			return slot.m_handle;
+		}
+		else if(slotHash == 0)
+		{
+			return VK_NULL_HANDLE;
+		}
+	}
+}
+
+void PipelineFactory::addToLookupTable(U64 hash, VkPipeline handle)
+{
+	ANKI_ASSERT(hash != 0 && handle);
+
+	auto insert = [](LookupTable& table, U64 hash, VkPipeline handle) {
+		const U32 mask = table.m_slots.getSize() - 1;
+		U32 i = U32(hash) & mask;
+		while(table.m_slots[i].m_hash.load(AtomicMemoryOrder::RELAXED) != 0)
+		{
+			i = (i + 1) & mask;
+		}
+
+		table.m_slots[i].m_handle = handle;
+		table.m_slots[i].m_hash.store(hash, AtomicMemoryOrder::RELEASE);
+		++table.m_count;
+	};
+
+	// Keep the load factor under 50%
+	LookupTable* table = m_lookupTable.load(AtomicMemoryOrder::RELAXED);
+	if(table == nullptr || (table->m_count + 1) * 2 > table->m_slots.getSize())
+	{
+		LookupTable* newTable = m_alloc.newInstance<LookupTable>();
+		newTable->m_slots.create(m_alloc, (table) ? table->m_slots.getSize() * 2 : 64);
+		newTable->m_prev = table;
+
+		if(table)
+		{
+			for(const LookupTable::Slot& slot : table->m_slots)
+			{
+				const U64 slotHash = slot.m_hash.load(AtomicMemoryOrder::RELAXED);
+				if(slotHash != 0)
+				{
+					insert(*newTable, slotHash, slot.m_handle);
+				}
+			}
+		}
+
+		insert(*newTable, hash, handle);
+		m_lookupTable.store(newTable, AtomicMemoryOrder::RELEASE);
+	}
+	else
+	{
+		insert(*table, hash, handle);
+	}
+}
+
+VkPipeline PipelineFactory::createPipeline(PipelineStateTracker& state, U64 hash) const
+{
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
+
+	VkPipeline handle;
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache->m_cacheHandle, 1, &ci, nullptr, &handle));
+	}
+
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+
+	// Print shader info
+	const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
+	shaderImpl.getGrManagerImpl().printPipelineShaderInfo(handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+
+	return handle;
+}
+
+void PipelineFactory::publishPipeline(U64 hash, VkPipeline handle, VkRenderPass ownedRpass)
+{
+	{
+		LockGuard<Mutex> lock(m_pplinesMtx);
+
+		auto it = m_pplines.find(hash);
+		ANKI_ASSERT(it != m_pplines.getEnd() && !(*it).m_handle && !(*it).m_queued);
+		(*it).m_handle = handle;
+		(*it).m_ownedRpass = ownedRpass;
+		addToLookupTable(hash, handle);
+	}
+
+	m_pplineCreatedCondVar.notifyAll();
+}
+
+Bool PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty, Bool skipIfNotReady)
 {
 	U64 hash;
 	state.flush(hash, stateDirty);
@@ -424,37 +736,259 @@ void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline,
 	if(ANKI_UNLIKELY(!stateDirty))
 	{
 		ppline.m_handle = VK_NULL_HANDLE;
-		return;
+		return true;
 	}
 
-	LockGuard<SpinLock> lock(m_pplinesMtx);
+	// Fast path, no locking
+	ppline.m_handle = tryFindPipeline(hash);
+	if(ppline.m_handle)
+	{
+		return true;
+	}
 
-	auto it = m_pplines.find(hash);
-	if(it != m_pplines.getEnd())
+	// Slow path. Only one thread creates the pipeline
+	Bool newPpline = false;
+	Bool createIt = false;
 	{
-		ppline.m_handle = (*it).m_handle;
+		LockGuard<Mutex> lock(m_pplinesMtx);
+
+		auto it = m_pplines.find(hash);
+		if(it == m_pplines.getEnd())
+		{
+			// First time it's needed. Either this thread or the async creator will create it
+			PipelineInternal pp;
+			pp.m_fb = state.getFb();
+			pp.m_queued = skipIfNotReady;
+			m_pplines.emplace(m_alloc, hash, pp);
+
+			newPpline = true;
+			createIt = !skipIfNotReady;
+		}
+		else if((*it).m_handle)
+		{
+			// Created after the lookup
+			ppline.m_handle = (*it).m_handle;
+			return true;
+		}
+		else if(!skipIfNotReady && (*it).m_queued)
+		{
+			// The async creator didn't get to it yet, don't wait for the whole queue
+			(*it).m_queued = false;
+			(*it).m_fb = state.getFb();
+			createIt = true;
+		}
+		else if(!skipIfNotReady)
+		{
+			// Some other thread creates it. Wait for that pipeline only, the lock is released while waiting
+			do
+			{
+				m_pplineCreatedCondVar.wait(m_pplinesMtx);
+
+				// Find it again, the map might have grown
+				it = m_pplines.find(hash);
+				ANKI_ASSERT(it != m_pplines.getEnd());
+			} while(!(*it).m_handle);
+
+			ppline.m_handle = (*it).m_handle;
+			return true;
+		}
 	}
-	else
+
+	// Record the new state so the next runs can prewarm it
+	PipelineStateRecord record;
+	if(newPpline)
+	{
+		state.saveRecord(m_programBinaryHash, record);
+		m_pplineCache->addStateRecord(record, m_alloc);
+	}
+
+	if(createIt)
+	{
+		ppline.m_handle = createPipeline(state, hash);
+		publishPipeline(hash, ppline.m_handle, VK_NULL_HANDLE);
+		return true;
+	}
+
+	if(newPpline)
+	{
+		// The job gets a state of its own, this one will change while the pipeline is created
+		AsyncPipelineJob* job = m_asyncCreator->newJob();
+		job->m_prog = state.m_state.m_prog;
+		job->m_fb = state.getFb();
+		job->m_hash = hash;
+		job->m_state.loadRecord(record, job->m_prog, state.m_rpass);
+		m_asyncCreator->submitJob(job);
+	}
+
+	// Skip the draw. Make the next draw look for the pipeline again
+	state.invalidatePipeline();
+	ppline.m_handle = VK_NULL_HANDLE;
+	return false;
+}
+
+void PipelineFactory::prewarm(const ShaderProgramPtr& prog)
+{
+	ANKI_ASSERT(&static_cast<ShaderProgramImpl&>(*prog).getPipelineFactory() == this);
+
+	DynamicArrayAuto<PipelineStateRecord> records(m_alloc);
+	m_pplineCache->getStateRecords(m_programBinaryHash, records);
+
+	for(const PipelineStateRecord& record : records)
+	{
+		AsyncPipelineJob* job = m_asyncCreator->newJob();
+		job->m_prog = prog;
+		job->m_ownedRpass = newCompatibleRenderPass(m_dev, record);
+		job->m_state.loadRecord(record, prog, job->m_ownedRpass);
+
+		Bool stateDirty;
+		job->m_state.flush(job->m_hash, stateDirty);
+
+		Bool queueIt = false;
+		{
+			LockGuard<Mutex> lock(m_pplinesMtx);
+
+			if(m_pplines.find(job->m_hash) == m_pplines.getEnd())
+			{
+				PipelineInternal pp;
+				pp.m_queued = true;
+				m_pplines.emplace(m_alloc, job->m_hash, pp);
+				queueIt = true;
+			}
+		}
+
+		if(queueIt)
+		{
+			m_asyncCreator->submitJob(job);
+		}
+		else
+		{
+			m_asyncCreator->deleteJob(job);
+		}
+	}
+}
+
+void PipelineFactory::createAsyncPipeline(AsyncPipelineJob& job)
+{
 	{
-		PipelineInternal pp;
-		const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
-		pp.m_fb = state.getFb();
+		LockGuard<Mutex> lock(m_pplinesMtx);
 
+		auto it = m_pplines.find(job.m_hash);
+		ANKI_ASSERT(it != m_pplines.getEnd());
+		if(!(*it).m_queued)
 		{
-			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
+			// A draw that couldn't wait took it over
+			return;
 		}
 
-		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+		(*it).m_queued = false;
+	}
+
+	const VkPipeline handle = createPipeline(job.m_state, job.m_hash);
 
-		m_pplines.emplace(m_alloc, hash, pp);
-		ppline.m_handle = pp.m_handle;
+	// The pipeline keeps the render pass of the job
+	publishPipeline(job.m_hash, handle, job.m_ownedRpass);
+	job.m_ownedRpass = VK_NULL_HANDLE;
+}
 
-		// Print shader info
-		const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
-		shaderImpl.getGrManagerImpl().printPipelineShaderInfo(pp.m_handle, shaderImpl.getName(), shaderImpl.getStages(),
-															  hash);
+AsyncPipelineCreator::AsyncPipelineCreator()
+	: m_thread("anki_asyppln")
+{
+}
+
+AsyncPipelineCreator::~AsyncPipelineCreator()
+{
+	ANKI_ASSERT(m_jobs.isEmpty() && "Forgot to call destroy()");
+}
+
+void AsyncPipelineCreator::init(GrAllocator<U8> alloc, VkDevice dev)
+{
+	m_alloc = alloc;
+	m_dev = dev;
+	m_thread.start(this, threadCallback);
+}
+
+void AsyncPipelineCreator::destroy()
+{
+	if(m_dev == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_quit = true;
+		m_condVar.notifyOne();
 	}
+
+	Error err = m_thread.join();
+	(void)err;
+
+	// The dropped jobs may hold the last reference to some programs. Deleting them deletes the programs
+	while(!m_jobs.isEmpty())
+	{
+		AsyncPipelineJob* job = &m_jobs.getFront();
+		m_jobs.popFront();
+		deleteJob(job);
+	}
+
+	m_dev = VK_NULL_HANDLE;
+}
+
+void AsyncPipelineCreator::deleteJob(AsyncPipelineJob* job)
+{
+	ANKI_ASSERT(job);
+
+	if(job->m_ownedRpass)
+	{
+		vkDestroyRenderPass(m_dev, job->m_ownedRpass, nullptr);
+	}
+
+	m_alloc.deleteInstance(job);
+}
+
+void AsyncPipelineCreator::submitJob(AsyncPipelineJob* job)
+{
+	ANKI_ASSERT(job && job->m_prog.isCreated() && job->m_hash);
+
+	LockGuard<Mutex> lock(m_mtx);
+	m_jobs.pushBack(job);
+	m_condVar.notifyOne();
+}
+
+Error AsyncPipelineCreator::threadCallback(ThreadCallbackInfo& info)
+{
+	AsyncPipelineCreator& self = *reinterpret_cast<AsyncPipelineCreator*>(info.m_userData);
+	return self.threadWorker();
+}
+
+Error AsyncPipelineCreator::threadWorker()
+{
+	while(true)
+	{
+		AsyncPipelineJob* job = nullptr;
+
+		{
+			// Wait for something
+			LockGuard<Mutex> lock(m_mtx);
+			while(m_jobs.isEmpty() && !m_quit)
+			{
+				m_condVar.wait(m_mtx);
+			}
+
+			if(m_quit)
+			{
+				break;
+			}
+
+			job = &m_jobs.getFront();
+			m_jobs.popFront();
+		}
+
+		static_cast<ShaderProgramImpl&>(*job->m_prog).getPipelineFactory().createAsyncPipeline(*job);
+		deleteJob(job);
+	}
+
+	return Error::NONE;
 }
 
 } // end namespace anki
@@ -11,10 +11,17 @@
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/vulkan/FramebufferImpl.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/List.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
 
+// Forward
+class PipelineCache;
+class AsyncPipelineCreator;
+class AsyncPipelineJob;
+
 /// @addtogroup vulkan
 /// @{
 
@@ -173,6 +180,37 @@ public:
 	}
 };
 
+/// The static state of a graphics pipeline in a form that can be saved to disk. It's used to create the pipeline again
+/// in a later run. Instead of the program it holds a hash of the program's binaries.
+class PipelineStateRecord
+{
+public:
+	U64 m_programBinaryHash;
+
+	// The state that is not part of the pipeline hash is left zero so equal pipelines have equal records
+	Array<Array<U8, sizeof(PPVertexBufferBinding)>, MAX_VERTEX_ATTRIBUTES> m_vertexBindings;
+	Array<Array<U8, sizeof(PPVertexAttributeBinding)>, MAX_VERTEX_ATTRIBUTES> m_vertexAttributes;
+	Array<U8, sizeof(PPInputAssemblerStateInfo)> m_inputAssembler;
+	Array<U8, sizeof(PPRasterizerStateInfo)> m_rasterizer;
+	Array<U8, sizeof(PPDepthStateInfo)> m_depth;
+	Array<U8, sizeof(PPStencilStateInfo)> m_stencil;
+	Array<Array<U8, sizeof(PPColorAttachmentStateInfo)>, MAX_COLOR_ATTACHMENTS> m_colorAttachments;
+	Bool m_alphaToCoverageEnabled;
+
+	// Enough to create a compatible render pass
+	Array<Format, MAX_COLOR_ATTACHMENTS> m_colorAttachmentFormats;
+	Format m_depthStencilFormat;
+	U8 m_colorAttachmentMask;
+	Bool m_depthAttachment;
+	Bool m_stencilAttachment;
+	Bool m_presentableAttachment;
+
+	PipelineStateRecord()
+	{
+		zeroMemory(*this);
+	}
+};
+
 /// Track changes in the static state.
 class PipelineStateTracker : public NonCopyable
 {
@@ -440,6 +478,19 @@ public:
 		return m_fb;
 	}
 
+	/// Forget the pipeline of the last flush(). The next flush() will report the state as dirty.
+	void invalidatePipeline()
+	{
+		m_hashes.m_lastSuperHash = 0;
+	}
+
+	/// Save the state that flush() hashes.
+	void saveRecord(U64 programBinaryHash, PipelineStateRecord& record) const;
+
+	/// Set the state of a record. The tracker should be new. There is no framebuffer, only a render pass that is
+	/// compatible with the framebuffer the record was made with.
+	void loadRecord(const PipelineStateRecord& record, const ShaderProgramPtr& prog, VkRenderPass rpass);
+
 	void reset();
 
 private:
@@ -550,7 +601,10 @@ private:
 	VkPipeline m_handle ANKI_DEBUG_CODE(= 0);
 };
 
-/// Given some state it creates/hashes pipelines.
+/// Given some state it creates/hashes pipelines. The lookups don't lock. Every pipeline is created once: a thread that
+/// misses creates it and the threads that need the same pipeline in the meantime wait for that one and nothing else.
+/// The draws that can be skipped don't wait, the pipeline is created by the AsyncPipelineCreator. The states are
+/// recorded in the PipelineCache so the next runs create the pipelines in the background as soon as the program exists.
 class PipelineFactory
 {
 public:
@@ -562,28 +616,105 @@ public:
 	{
 	}
 
-	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache)
+	void init(GrAllocator<U8> alloc, VkDevice dev, PipelineCache* pplineCache, AsyncPipelineCreator* asyncCreator,
+			  U64 programBinaryHash)
 	{
 		m_alloc = alloc;
 		m_dev = dev;
 		m_pplineCache = pplineCache;
+		m_asyncCreator = asyncCreator;
+		m_programBinaryHash = programBinaryHash;
 	}
 
 	void destroy();
 
+	/// Find or create the pipeline of the state.
+	/// @param skipIfNotReady If true and the pipeline is not created yet don't wait for it. It's created in the
+	///                       background and the caller should skip the draw.
+	/// @return False if the draw should be skipped.
 	/// @note Thread-safe.
-	void newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty);
+	Bool newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty, Bool skipIfNotReady);
+
+	/// Start creating the pipelines that the program used in the previous runs.
+	/// @note Thread-safe.
+	void prewarm(const ShaderProgramPtr& prog);
+
+	/// Called by the AsyncPipelineCreator.
+	void createAsyncPipeline(AsyncPipelineJob& job);
 
 private:
 	class PipelineInternal;
 	class Hasher;
+	class LookupTable;
 
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
-	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+	PipelineCache* m_pplineCache = nullptr;
+	AsyncPipelineCreator* m_asyncCreator = nullptr;
+	U64 m_programBinaryHash = 0;
+
+	HashMap<U64, PipelineInternal, Hasher> m_pplines; ///< Owns the pipelines. Has entries for the pending ones as well.
+	Mutex m_pplinesMtx; ///< Protects m_pplines and the writes to m_lookupTable.
+	ConditionVariable m_pplineCreatedCondVar; ///< Signaled every time a pending pipeline is created.
+
+	/// A copy of the handles in m_pplines that can be read without locking. The tables that were replaced when it grew
+	/// are kept alive till destroy() because some reader might still be using them.
+	Atomic<LookupTable*> m_lookupTable = {nullptr};
+
+	VkPipeline tryFindPipeline(U64 hash) const;
+	void addToLookupTable(U64 hash, VkPipeline handle);
+
+	VkPipeline createPipeline(PipelineStateTracker& state, U64 hash) const;
+
+	/// Make a pending pipeline available and wake up the threads that wait for it.
+	void publishPipeline(U64 hash, VkPipeline handle, VkRenderPass ownedRpass);
+};
+
+/// A pipeline that the AsyncPipelineCreator will create.
+class AsyncPipelineJob : public IntrusiveListEnabled<AsyncPipelineJob>
+{
+public:
+	ShaderProgramPtr m_prog; ///< Keeps the PipelineFactory alive.
+	FramebufferPtr m_fb; ///< Holds the render pass of a pipeline that a draw missed.
+	VkRenderPass m_ownedRpass = VK_NULL_HANDLE; ///< The render pass of a prewarmed pipeline. The job owns it.
+	U64 m_hash = 0;
+	PipelineStateTracker m_state;
+};
 
-	HashMap<U64, PipelineInternal, Hasher> m_pplines;
-	SpinLock m_pplinesMtx;
+/// Creates graphics pipelines in a thread of its own.
+class AsyncPipelineCreator
+{
+public:
+	AsyncPipelineCreator();
+
+	~AsyncPipelineCreator();
+
+	void init(GrAllocator<U8> alloc, VkDevice dev);
+
+	/// Stop the thread and drop the jobs that didn't run. Call it before the GrObjects are gone.
+	void destroy();
+
+	AsyncPipelineJob* newJob()
+	{
+		return m_alloc.newInstance<AsyncPipelineJob>();
+	}
+
+	void deleteJob(AsyncPipelineJob* job);
+
+	/// @note Thread-safe.
+	void submitJob(AsyncPipelineJob* job);
+
+private:
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+	Thread m_thread;
+	Mutex m_mtx;
+	ConditionVariable m_condVar;
+	IntrusiveList<AsyncPipelineJob> m_jobs;
+	Bool m_quit = false;
+
+	static Error threadCallback(ThreadCallbackInfo& info);
+	Error threadWorker();
 };
 /// @}
 
@@ -11,6 +11,17 @@
 namespace anki
 {
 
+/// The header of the file that holds the pipeline states.
+class PipelineStateRecordsHeader
+{
+public:
+	Array<char, 8> m_magic;
+	U32 m_recordSize; ///< Used to identify a file of an older build.
+	U32 m_recordCount;
+};
+
+static const char* PIPELINE_STATE_RECORDS_MAGIC = "ANKIPSR1";
+
 Error PipelineCache::init(VkDevice dev, VkPhysicalDevice pdev, CString cacheDir, const ConfigSet& cfg,
 						  GrAllocator<U8> alloc)
 {
@@ -67,6 +78,15 @@ Error PipelineCache::init(VkDevice dev, VkPhysicalDevice pdev, CString cacheDir,
 
 	ANKI_VK_CHECK(vkCreatePipelineCache(dev, &ci, nullptr, &m_cacheHandle));
 
+	// Load the pipeline states
+	m_stateRecordsFilename.sprintf(alloc, "%s/vk_pipeline_states", &cacheDir[0]);
+	if(loadStateRecords(alloc))
+	{
+		ANKI_VK_LOGW("Failed to read the pipeline states. Will ignore them: %s", &m_stateRecordsFilename[0]);
+		m_stateRecords.destroy(alloc);
+		m_stateRecordsDirty = true;
+	}
+
 	return Error::NONE;
 }
 
@@ -77,6 +97,15 @@ void PipelineCache::destroy(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8>
 	{
 		ANKI_VK_LOGE("An error occurred while storing the pipeline cache to disk. Will ignore");
 	}
+
+	err = saveStateRecords();
+	if(err)
+	{
+		ANKI_VK_LOGE("An error occurred while storing the pipeline states to disk. Will ignore");
+	}
+
+	m_stateRecords.destroy(alloc);
+	m_stateRecordsFilename.destroy(alloc);
 }
 
 Error PipelineCache::destroyInternal(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8> alloc)
@@ -120,4 +149,94 @@ Error PipelineCache::destroyInternal(VkDevice dev, VkPhysicalDevice pdev, GrAllo
 	return Error::NONE;
 }
 
+void PipelineCache::addStateRecord(const PipelineStateRecord& record, GrAllocator<U8> alloc)
+{
+	const U64 hash = computeHash(&record, sizeof(record));
+
+	LockGuard<Mutex> lock(m_stateRecordsMtx);
+	if(m_stateRecords.find(hash) == m_stateRecords.getEnd())
+	{
+		m_stateRecords.emplace(alloc, hash, record);
+		m_stateRecordsDirty = true;
+	}
+}
+
+void PipelineCache::getStateRecords(U64 programBinaryHash, DynamicArrayAuto<PipelineStateRecord>& records) const
+{
+	LockGuard<Mutex> lock(m_stateRecordsMtx);
+	for(const PipelineStateRecord& record : m_stateRecords)
+	{
+		if(record.m_programBinaryHash == programBinaryHash)
+		{
+			records.emplaceBack(record);
+		}
+	}
+}
+
+Error PipelineCache::loadStateRecords(GrAllocator<U8> alloc)
+{
+	if(!fileExists(m_stateRecordsFilename.toCString()))
+	{
+		ANKI_VK_LOGI("Pipeline states not found: %s", &m_stateRecordsFilename[0]);
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_stateRecordsFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::READ));
+
+	PipelineStateRecordsHeader header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], PIPELINE_STATE_RECORDS_MAGIC, sizeof(header.m_magic)) != 0
+	   || header.m_recordSize != sizeof(PipelineStateRecord))
+	{
+		ANKI_VK_LOGI("Pipeline states are from another build. Will overwrite them: %s", &m_stateRecordsFilename[0]);
+		m_stateRecordsDirty = true;
+		return Error::NONE;
+	}
+
+	for(U32 i = 0; i < header.m_recordCount; ++i)
+	{
+		PipelineStateRecord record;
+		ANKI_CHECK(file.read(&record, sizeof(record)));
+		addStateRecord(record, alloc);
+	}
+
+	// Nothing new to save
+	m_stateRecordsDirty = false;
+
+	ANKI_VK_LOGI("Loaded %u pipeline states", header.m_recordCount);
+	return Error::NONE;
+}
+
+Error PipelineCache::saveStateRecords() const
+{
+	if(!m_stateRecordsDirty)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_ASSERT(!m_stateRecordsFilename.isEmpty());
+
+	PipelineStateRecordsHeader header;
+	memcpy(&header.m_magic[0], PIPELINE_STATE_RECORDS_MAGIC, sizeof(header.m_magic));
+	header.m_recordSize = sizeof(PipelineStateRecord);
+	header.m_recordCount = 0;
+	for(auto it = m_stateRecords.getBegin(); it != m_stateRecords.getEnd(); ++it)
+	{
+		++header.m_recordCount;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_stateRecordsFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::WRITE));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	for(const PipelineStateRecord& record : m_stateRecords)
+	{
+		ANKI_CHECK(file.write(&record, sizeof(record)));
+	}
+
+	ANKI_VK_LOGI("Saved %u pipeline states", header.m_recordCount);
+	return Error::NONE;
+}
+
 } // end namespace anki
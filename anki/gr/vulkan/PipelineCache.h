@@ -5,7 +5,8 @@
 
 #pragma once
 
-#include <anki/gr/vulkan/Common.h>
+#include <anki/gr/vulkan/Pipeline.h>
+#include <anki/util/HashMap.h>
 
 namespace anki
 {
@@ -16,7 +17,8 @@ class ConfigSet;
 /// @addtogroup vulkan
 /// @{
 
-/// On disk pipeline cache.
+/// On disk pipeline cache. Along with the driver's cache it keeps the states of the graphics pipelines so they can be
+/// created before they are needed.
 class PipelineCache
 {
 public:
@@ -27,11 +29,27 @@ public:
 
 	void destroy(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8> alloc);
 
+	/// Remember the state of a graphics pipeline. It's saved to disk on destroy().
+	/// @note Thread-safe.
+	void addStateRecord(const PipelineStateRecord& record, GrAllocator<U8> alloc);
+
+	/// Get the states of the pipelines a program used, in this and in the previous runs.
+	/// @note Thread-safe.
+	void getStateRecords(U64 programBinaryHash, DynamicArrayAuto<PipelineStateRecord>& records) const;
+
 private:
 	String m_dumpFilename;
 	PtrSize m_dumpSize = 0;
 
+	String m_stateRecordsFilename;
+	HashMap<U64, PipelineStateRecord> m_stateRecords; ///< The key is the hash of the whole record.
+	mutable Mutex m_stateRecordsMtx;
+	Bool m_stateRecordsDirty = false;
+
 	ANKI_USE_RESULT Error destroyInternal(VkDevice dev, VkPhysicalDevice pdev, GrAllocator<U8> alloc);
+
+	ANKI_USE_RESULT Error loadStateRecords(GrAllocator<U8> alloc);
+	ANKI_USE_RESULT Error saveStateRecords() const;
 };
 /// @}
 
@@ -115,6 +115,15 @@ Error ShaderImpl::init(const ShaderInitInfo& inf)
 		}
 	}
 
+	// Hash the binary and the constant values
+	m_binaryHash = computeHash(&inf.m_binary[0], inf.m_binary.getSize());
+	if(m_specConstInfo.mapEntryCount)
+	{
+		m_binaryHash = appendHash(m_specConstInfo.pMapEntries,
+								  m_specConstInfo.mapEntryCount * sizeof(VkSpecializationMapEntry), m_binaryHash);
+		m_binaryHash = appendHash(m_specConstInfo.pData, m_specConstInfo.dataSize, m_binaryHash);
+	}
+
 	return Error::NONE;
 }
 
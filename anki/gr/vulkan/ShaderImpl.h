@@ -29,6 +29,9 @@ public:
 	Array<BitSet<MAX_BINDINGS_PER_DESCRIPTOR_SET, U8>, MAX_DESCRIPTOR_SETS> m_activeBindingMask = {{{false}, {false}}};
 	U32 m_pushConstantsSize = 0;
 
+	/// Hash of the SPIR-V and the values of the specialization constants. Unlike the UUID it's the same in every run.
+	U64 m_binaryHash = 0;
+
 	ShaderImpl(GrManager* manager, CString name)
 		: Shader(manager, name)
 	{
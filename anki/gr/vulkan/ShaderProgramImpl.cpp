@@ -216,9 +216,20 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	//
 	if(graphicsProg)
 	{
+		// Identify the program in a way that doesn't change between runs. The recorded pipeline states use that
+		Array<U64, U32(ShaderType::LAST_GRAPHICS) + 1> shaderHashes;
+		U32 shaderCount = 0;
+		for(const ShaderPtr& shader : m_shaders)
+		{
+			shaderHashes[shaderCount++] = static_cast<const ShaderImpl&>(*shader).m_binaryHash;
+		}
+
+		const U64 binaryHash = computeHash(&shaderHashes[0], shaderCount * sizeof(shaderHashes[0]));
+
 		m_graphics.m_pplineFactory = getAllocator().newInstance<PipelineFactory>();
 		m_graphics.m_pplineFactory->init(getGrManagerImpl().getAllocator(), getGrManagerImpl().getDevice(),
-										 getGrManagerImpl().getPipelineCache());
+										 &getGrManagerImpl().getDiskPipelineCache(),
+										 &getGrManagerImpl().getAsyncPipelineCreator(), binaryHash);
 	}
 
 	// Create the pipeline if compute
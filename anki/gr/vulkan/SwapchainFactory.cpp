@@ -47,7 +47,16 @@ Error MicroSwapchain::initInternal()
 		ANKI_VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_factory->m_gr->getPhysicalDevice(),
 																m_factory->m_gr->getSurface(), &surfaceProperties));
 
-		if(surfaceProperties.currentExtent.width == MAX_U32 || surfaceProperties.currentExtent.height == MAX_U32)
+		if(surfaceProperties.currentExtent.width == MAX_U32 && surfaceProperties.currentExtent.height == MAX_U32)
+		{
+			// The size will be determined by the swapchain (eg headless surfaces). Use the size of the window
+			const UVec2 size = m_factory->m_gr->getNativeWindowSize();
+			surfaceProperties.currentExtent.width =
+				clamp(size.x(), surfaceProperties.minImageExtent.width, surfaceProperties.maxImageExtent.width);
+			surfaceProperties.currentExtent.height =
+				clamp(size.y(), surfaceProperties.minImageExtent.height, surfaceProperties.maxImageExtent.height);
+		}
+		else if(surfaceProperties.currentExtent.width == MAX_U32 || surfaceProperties.currentExtent.height == MAX_U32)
 		{
 			ANKI_VK_LOGE("Wrong surface size");
 			return Error::FUNCTION_FAILED;
@@ -128,6 +137,13 @@ Error MicroSwapchain::initInternal()
 		}
 
 		presentMode = (presentMode != VK_PRESENT_MODE_MAX_ENUM_KHR) ? presentMode : presentModeSecondChoice;
+		if(presentMode == VK_PRESENT_MODE_MAX_ENUM_KHR && !m_factory->m_vsync)
+		{
+			// Some surfaces (eg headless) only support FIFO which is always available
+			ANKI_VK_LOGW("Couldn't find a present mode without vsync. Will use FIFO");
+			presentMode = VK_PRESENT_MODE_FIFO_KHR;
+		}
+
 		if(presentMode == VK_PRESENT_MODE_MAX_ENUM_KHR)
 		{
 			ANKI_VK_LOGE("Couldn't find a present mode");
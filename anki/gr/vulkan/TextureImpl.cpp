@@ -338,7 +338,34 @@ Error TextureImpl::initImage(const TextureInitInfo& init_)
 
 	ANKI_ASSERT(memIdx != MAX_U32);
 
-	if(!dedicatedRequirements.prefersDedicatedAllocation)
+	m_memorySize = requirements.memoryRequirements.size;
+
+	// Try to place the image in the memory of another texture
+	if(init.m_memoryOwner.isCreated() && !dedicatedRequirements.requiresDedicatedAllocation)
+	{
+		const TextureImpl& owner = static_cast<const TextureImpl&>(*init.m_memoryOwner);
+		const GpuMemoryHandle& ownerMem = owner.m_memHandle;
+
+		// The owner shouldn't be an alias itself or have a dedicated allocation
+		const Bool fits = ownerMem && owner.m_memorySize >= requirements.memoryRequirements.size
+						  && !!(requirements.memoryRequirements.memoryTypeBits & (1u << ownerMem.getMemoryTypeIndex()))
+						  && (ownerMem.m_offset % requirements.memoryRequirements.alignment) == 0;
+
+		if(fits)
+		{
+			m_memoryOwner = init.m_memoryOwner;
+			m_memoryAliased = true;
+
+			ANKI_TRACE_SCOPED_EVENT(VK_BIND_OBJECT);
+			ANKI_VK_CHECK(vkBindImageMemory(getDevice(), m_imageHandle, ownerMem.m_memory, ownerMem.m_offset));
+			return Error::NONE;
+		}
+	}
+
+	// A dedicated allocation can't be shared with other textures so skip it if it's not required
+	const Bool dedicated = dedicatedRequirements.requiresDedicatedAllocation
+						   || (dedicatedRequirements.prefersDedicatedAllocation && !init.m_memoryAliasable);
+	if(!dedicated)
 	{
 		// Allocate
 		getGrManagerImpl().getGpuMemoryManager().allocateMemory(memIdx, requirements.memoryRequirements.size,
@@ -77,6 +77,8 @@ public:
 
 	GpuMemoryHandle m_memHandle;
 
+	TexturePtr m_memoryOwner; ///< Hold a reference to the texture whose memory the image is bound to.
+
 	VkFormat m_vkFormat = VK_FORMAT_UNDEFINED;
 
 	TextureImplWorkaround m_workarounds = TextureImplWorkaround::NONE;
@@ -150,6 +152,11 @@ public:
 							VkAccessFlags& srcAccesses, VkPipelineStageFlags& dstStages,
 							VkAccessFlags& dstAccesses) const;
 
+	/// Calculate the stages and accesses of one side of a pipeline barrier.
+	/// @param src True if the usage is in the source side of the barrier.
+	void computeBarrierInfo(TextureUsageBit usage, Bool src, U32 level, VkPipelineStageFlags& stages,
+							VkAccessFlags& accesses) const;
+
 	/// Predict the image layout.
 	VkImageLayout computeLayout(TextureUsageBit usage, U level) const;
 
@@ -210,9 +217,6 @@ private:
 	TextureType computeNewTexTypeOfSubresource(const TextureSubresourceInfo& subresource) const;
 
 	ANKI_USE_RESULT Error initInternal(VkImage externalImage, const TextureInitInfo& init);
-
-	void computeBarrierInfo(TextureUsageBit usage, Bool src, U32 level, VkPipelineStageFlags& stages,
-							VkAccessFlags& accesses) const;
 };
 /// @}
 
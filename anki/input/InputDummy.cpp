@@ -8,19 +8,46 @@
 namespace anki
 {
 
-void Input::handleEvents()
+Error Input::initInternal(NativeWindow* nativeWindow)
 {
-	// You are dummy... do nothing
+	ANKI_ASSERT(nativeWindow);
+	m_nativeWindow = nativeWindow;
+	return Error::NONE;
 }
 
-void Input::init(NativeWindow* nativeWindow)
+void Input::destroy()
 {
-	// You are dummy... do nothing
+	m_nativeWindow = nullptr;
+}
+
+Error Input::handleEvents()
+{
+	ANKI_ASSERT(m_nativeWindow != nullptr);
+
+	m_textInput[0] = '\0';
+
+	// There are no events but keep counting the keys that are being pressed
+	for(auto& k : m_keys)
+	{
+		if(k)
+		{
+			++k;
+		}
+	}
+	for(auto& k : m_mouseBtns)
+	{
+		if(k)
+		{
+			++k;
+		}
+	}
+
+	return Error::NONE;
 }
 
 void Input::moveCursor(const Vec2& posNdc)
 {
-	// You are dummy... do nothing
+	m_mousePosNdc = posNdc;
 }
 
 void Input::hideCursor(Bool hide)
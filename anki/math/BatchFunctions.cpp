@@ -0,0 +1,157 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/math/BatchFunctions.h>
+#include <anki/math/Simd.h>
+
+namespace anki
+{
+
+/// 4 wide multiplication of matrices. It maps to SSE, NEON or scalar code.
+static void multiplyMatrices4(const Mat4& a, const Mat4& b, Mat4& out)
+{
+	const SimdF32x4 b0 = SimdF32x4::load(b.getBegin());
+	const SimdF32x4 b1 = SimdF32x4::load(b.getBegin() + 4);
+	const SimdF32x4 b2 = SimdF32x4::load(b.getBegin() + 8);
+	const SimdF32x4 b3 = SimdF32x4::load(b.getBegin() + 12);
+
+	Array<SimdF32x4, 4> rows;
+	for(U32 i = 0; i < 4; ++i)
+	{
+		SimdF32x4 row = b0 * SimdF32x4(a(i, 0));
+		row = b1.mad(SimdF32x4(a(i, 1)), row);
+		row = b2.mad(SimdF32x4(a(i, 2)), row);
+		rows[i] = b3.mad(SimdF32x4(a(i, 3)), row);
+	}
+
+	// Store at the end because out might be a or b
+	for(U32 i = 0; i < 4; ++i)
+	{
+		rows[i].store(out.getBegin() + i * 4);
+	}
+}
+
+#if ANKI_SIMD_AVX2
+/// The elements of a column of 2 rows broadcasted to their half of the register: [a(0,k) x 4 | a(1,k) x 4].
+class Avx2MatRowPair
+{
+public:
+	Array<__m256, 4> m_cols;
+
+	Avx2MatRowPair(const F32* rows)
+	{
+		const __m256 r = _mm256_loadu_ps(rows);
+		m_cols[0] = _mm256_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0));
+		m_cols[1] = _mm256_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1));
+		m_cols[2] = _mm256_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2));
+		m_cols[3] = _mm256_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	/// Compute 2 rows of a * b where the rows of b are duplicated in both halves.
+	__m256 multiply(const Array<__m256, 4>& b) const
+	{
+		__m256 out = _mm256_mul_ps(m_cols[0], b[0]);
+		out = _mm256_fmadd_ps(m_cols[1], b[1], out);
+		out = _mm256_fmadd_ps(m_cols[2], b[2], out);
+		return _mm256_fmadd_ps(m_cols[3], b[3], out);
+	}
+};
+
+static void loadDuplicatedRows(const Mat4& m, Array<__m256, 4>& rows)
+{
+	for(U32 i = 0; i < 4; ++i)
+	{
+		rows[i] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m.getBegin() + i * 4));
+	}
+}
+#endif
+
+void transformPoints(const Mat4& m, ConstWeakArray<Vec4> in, WeakArray<Vec4> out)
+{
+	ANKI_ASSERT(in.getSize() == out.getSize());
+	const U32 count = in.getSize();
+	const Mat4 t = m.getTransposed();
+	U32 i = 0;
+
+#if ANKI_SIMD_AVX2
+	// 2 points per iteration, one in each half of the register
+	Array<__m256, 4> cols;
+	loadDuplicatedRows(t, cols);
+
+	for(; i + 2 <= count; i += 2)
+	{
+		const Avx2MatRowPair points(&in[i][0]);
+		_mm256_storeu_ps(&out[i][0], points.multiply(cols));
+	}
+#endif
+
+	const SimdF32x4 col0 = SimdF32x4::load(t.getBegin());
+	const SimdF32x4 col1 = SimdF32x4::load(t.getBegin() + 4);
+	const SimdF32x4 col2 = SimdF32x4::load(t.getBegin() + 8);
+	const SimdF32x4 col3 = SimdF32x4::load(t.getBegin() + 12);
+	for(; i < count; ++i)
+	{
+		const Vec4 p = in[i];
+		SimdF32x4 r = col0 * SimdF32x4(p.x());
+		r = col1.mad(SimdF32x4(p.y()), r);
+		r = col2.mad(SimdF32x4(p.z()), r);
+		r = col3.mad(SimdF32x4(p.w()), r);
+		r.store(&out[i][0]);
+	}
+}
+
+void multiplyMatrices(const Mat4& a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out)
+{
+	ANKI_ASSERT(b.getSize() == out.getSize());
+	const U32 count = b.getSize();
+
+#if ANKI_SIMD_AVX2
+	// The broadcasted elements of a are the same for all matrices
+	const Avx2MatRowPair a01(a.getBegin());
+	const Avx2MatRowPair a23(a.getBegin() + 8);
+
+	for(U32 i = 0; i < count; ++i)
+	{
+		Array<__m256, 4> rows;
+		loadDuplicatedRows(b[i], rows);
+
+		const __m256 out01 = a01.multiply(rows);
+		const __m256 out23 = a23.multiply(rows);
+		_mm256_storeu_ps(out[i].getBegin(), out01);
+		_mm256_storeu_ps(out[i].getBegin() + 8, out23);
+	}
+#else
+	for(U32 i = 0; i < count; ++i)
+	{
+		multiplyMatrices4(a, b[i], out[i]);
+	}
+#endif
+}
+
+void multiplyMatrices(ConstWeakArray<Mat4> a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out)
+{
+	ANKI_ASSERT(a.getSize() == b.getSize() && b.getSize() == out.getSize());
+	const U32 count = b.getSize();
+
+	for(U32 i = 0; i < count; ++i)
+	{
+#if ANKI_SIMD_AVX2
+		const Avx2MatRowPair a01(a[i].getBegin());
+		const Avx2MatRowPair a23(a[i].getBegin() + 8);
+
+		Array<__m256, 4> rows;
+		loadDuplicatedRows(b[i], rows);
+
+		const __m256 out01 = a01.multiply(rows);
+		const __m256 out23 = a23.multiply(rows);
+		_mm256_storeu_ps(out[i].getBegin(), out01);
+		_mm256_storeu_ps(out[i].getBegin() + 8, out23);
+#else
+		multiplyMatrices4(a[i], b[i], out[i]);
+#endif
+	}
+}
+
+} // end namespace anki
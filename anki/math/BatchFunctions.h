@@ -0,0 +1,31 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/math/Vec.h>
+#include <anki/math/Mat.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup math
+/// @{
+
+/// Transform many points: out[i] = m * in[i]. It uses AVX2/FMA if ANKI_SIMD_AVX2 is enabled and 4 wide SIMD otherwise.
+/// @note The input and the output can be the same array.
+void transformPoints(const Mat4& m, ConstWeakArray<Vec4> in, WeakArray<Vec4> out);
+
+/// Multiply many matrices with the same matrix: out[i] = a * b[i].
+/// @note The input and the output can be the same array.
+void multiplyMatrices(const Mat4& a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out);
+
+/// Multiply many pairs of matrices: out[i] = a[i] * b[i].
+/// @note The output can be the same array as one of the inputs.
+void multiplyMatrices(ConstWeakArray<Mat4> a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out);
+/// @}
+
+} // end namespace anki
@@ -267,6 +267,18 @@ public:
 	{
 		return m_arr1[n];
 	}
+
+	/// Get the elements in row major order.
+	T* getBegin()
+	{
+		return &m_arr1[0];
+	}
+
+	/// @copydoc getBegin
+	const T* getBegin() const
+	{
+		return &m_arr1[0];
+	}
 	/// @}
 
 	/// @name Operators with same type
@@ -407,12 +419,18 @@ public:
 
 			t1 = _mm_set1_ps(m(i, 0));
 			t2 = _mm_mul_ps(b.m_simd[0], t1);
+#if ANKI_SIMD_AVX2
+			t2 = _mm_fmadd_ps(b.m_simd[1], _mm_set1_ps(m(i, 1)), t2);
+			t2 = _mm_fmadd_ps(b.m_simd[2], _mm_set1_ps(m(i, 2)), t2);
+			t2 = _mm_fmadd_ps(b.m_simd[3], _mm_set1_ps(m(i, 3)), t2);
+#else
 			t1 = _mm_set1_ps(m(i, 1));
 			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[1], t1), t2);
 			t1 = _mm_set1_ps(m(i, 2));
 			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[2], t1), t2);
 			t1 = _mm_set1_ps(m(i, 3));
 			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[3], t1), t2);
+#endif
 
 			out.m_simd[i] = t2;
 		}
@@ -1235,10 +1253,15 @@ public:
 
 			t1 = _mm_set1_ps(a(i, 0));
 			t2 = _mm_mul_ps(b.m_simd[0], t1);
+#if ANKI_SIMD_AVX2
+			t2 = _mm_fmadd_ps(b.m_simd[1], _mm_set1_ps(a(i, 1)), t2);
+			t2 = _mm_fmadd_ps(b.m_simd[2], _mm_set1_ps(a(i, 2)), t2);
+#else
 			t1 = _mm_set1_ps(a(i, 1));
 			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[1], t1), t2);
 			t1 = _mm_set1_ps(a(i, 2));
 			t2 = _mm_add_ps(_mm_mul_ps(b.m_simd[2], t1), t2);
+#endif
 
 			TVec<T, 4> v4(0.0, 0.0, 0.0, a(i, 3));
 			t2 = _mm_add_ps(v4.getSimd(), t2);
@@ -6,8 +6,13 @@
 #pragma once
 
 #include <anki/util/StdTypes.h>
+#include <anki/util/Array.h>
+#include <anki/util/Functions.h>
+#include <cstring>
 
-#if ANKI_SIMD_SSE
+#if ANKI_SIMD_AVX2
+#	include <immintrin.h>
+#elif ANKI_SIMD_SSE
 #	include <smmintrin.h>
 #elif ANKI_SIMD_NEON
 #	include <arm_neon.h>
@@ -47,4 +52,393 @@ public:
 };
 #endif
 
+/// A mask of 4 lanes. It's the result of the comparisons of SimdF32x4.
+class SimdMask4
+{
+public:
+#if ANKI_SIMD_SSE
+	using Type = __m128;
+#elif ANKI_SIMD_NEON
+	using Type = uint32x4_t;
+#else
+	using Type = Array<Bool, 4>;
+#endif
+
+	Type m_simd;
+
+	SimdMask4() = default;
+
+	explicit SimdMask4(Type simd)
+		: m_simd(simd)
+	{
+	}
+
+	SimdMask4 operator&(SimdMask4 b) const
+	{
+#if ANKI_SIMD_SSE
+		return SimdMask4(_mm_and_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdMask4(vandq_u32(m_simd, b.m_simd));
+#else
+		return SimdMask4(SimdMask4::Type{{m_simd[0] && b.m_simd[0], m_simd[1] && b.m_simd[1], m_simd[2] && b.m_simd[2],
+						   m_simd[3] && b.m_simd[3]}});
+#endif
+	}
+
+	SimdMask4 operator|(SimdMask4 b) const
+	{
+#if ANKI_SIMD_SSE
+		return SimdMask4(_mm_or_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdMask4(vorrq_u32(m_simd, b.m_simd));
+#else
+		return SimdMask4(SimdMask4::Type{{m_simd[0] || b.m_simd[0], m_simd[1] || b.m_simd[1], m_simd[2] || b.m_simd[2],
+						   m_simd[3] || b.m_simd[3]}});
+#endif
+	}
+
+	/// Get the lanes as bits. Lane 0 is the LSB.
+	U32 getBitMask() const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_ps(m_simd));
+#elif ANKI_SIMD_NEON
+		const uint32x4_t bits = vandq_u32(m_simd, uint32x4_t{1, 2, 4, 8});
+		return vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1) | vgetq_lane_u32(bits, 2) | vgetq_lane_u32(bits, 3);
+#else
+		return U32(m_simd[0]) | (U32(m_simd[1]) << 1u) | (U32(m_simd[2]) << 2u) | (U32(m_simd[3]) << 3u);
+#endif
+	}
+
+	Bool any() const
+	{
+		return getBitMask() != 0;
+	}
+
+	Bool all() const
+	{
+		return getBitMask() == 0xF;
+	}
+};
+
+/// 4 F32 lanes that map to SSE, NEON or plain scalar code. It's used by algorithms that process data in batches.
+class SimdF32x4
+{
+public:
+	using Type = MathSimd<F32, 4>::Type;
+
+	Type m_simd;
+
+	SimdF32x4() = default;
+
+	explicit SimdF32x4(Type simd)
+	{
+#if ANKI_SIMD_SSE || ANKI_SIMD_NEON
+		m_simd = simd;
+#else
+		memcpy(m_simd, simd, sizeof(m_simd));
+#endif
+	}
+
+	/// Set all lanes to the same value.
+	explicit SimdF32x4(F32 f)
+	{
+#if ANKI_SIMD_SSE
+		m_simd = _mm_set1_ps(f);
+#elif ANKI_SIMD_NEON
+		m_simd = vdupq_n_f32(f);
+#else
+		m_simd[0] = m_simd[1] = m_simd[2] = m_simd[3] = f;
+#endif
+	}
+
+	SimdF32x4(F32 x, F32 y, F32 z, F32 w)
+	{
+#if ANKI_SIMD_SSE
+		m_simd = _mm_setr_ps(x, y, z, w);
+#elif ANKI_SIMD_NEON
+		m_simd = float32x4_t{x, y, z, w};
+#else
+		m_simd[0] = x;
+		m_simd[1] = y;
+		m_simd[2] = z;
+		m_simd[3] = w;
+#endif
+	}
+
+	/// Load 4 floats. The memory doesn't need to be aligned.
+	static SimdF32x4 load(const F32* arr)
+	{
+		SimdF32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_loadu_ps(arr);
+#elif ANKI_SIMD_NEON
+		out.m_simd = vld1q_f32(arr);
+#else
+		memcpy(out.m_simd, arr, sizeof(out.m_simd));
+#endif
+		return out;
+	}
+
+	/// Store 4 floats. The memory doesn't need to be aligned.
+	void store(F32* arr) const
+	{
+#if ANKI_SIMD_SSE
+		_mm_storeu_ps(arr, m_simd);
+#elif ANKI_SIMD_NEON
+		vst1q_f32(arr, m_simd);
+#else
+		memcpy(arr, m_simd, sizeof(m_simd));
+#endif
+	}
+
+	F32 operator[](U32 i) const
+	{
+		ANKI_ASSERT(i < 4);
+		alignas(16) F32 arr[4];
+		store(arr);
+		return arr[i];
+	}
+
+#if ANKI_SIMD_SSE
+#	define ANKI_SIMD_F32X4_OP(op_, sse_, neon_) \
+		SimdF32x4 operator op_(SimdF32x4 b) const \
+		{ \
+			return SimdF32x4(sse_(m_simd, b.m_simd)); \
+		}
+#elif ANKI_SIMD_NEON
+#	define ANKI_SIMD_F32X4_OP(op_, sse_, neon_) \
+		SimdF32x4 operator op_(SimdF32x4 b) const \
+		{ \
+			return SimdF32x4(neon_(m_simd, b.m_simd)); \
+		}
+#else
+#	define ANKI_SIMD_F32X4_OP(op_, sse_, neon_) \
+		SimdF32x4 operator op_(SimdF32x4 b) const \
+		{ \
+			return SimdF32x4(m_simd[0] op_ b.m_simd[0], m_simd[1] op_ b.m_simd[1], m_simd[2] op_ b.m_simd[2], \
+							 m_simd[3] op_ b.m_simd[3]); \
+		}
+#endif
+
+	ANKI_SIMD_F32X4_OP(+, _mm_add_ps, vaddq_f32)
+	ANKI_SIMD_F32X4_OP(-, _mm_sub_ps, vsubq_f32)
+	ANKI_SIMD_F32X4_OP(*, _mm_mul_ps, vmulq_f32)
+
+#undef ANKI_SIMD_F32X4_OP
+
+#if ANKI_SIMD_SSE
+#	define ANKI_SIMD_F32X4_CMP(op_, sse_, neon_) \
+		SimdMask4 operator op_(SimdF32x4 b) const \
+		{ \
+			return SimdMask4(sse_(m_simd, b.m_simd)); \
+		}
+#elif ANKI_SIMD_NEON
+#	define ANKI_SIMD_F32X4_CMP(op_, sse_, neon_) \
+		SimdMask4 operator op_(SimdF32x4 b) const \
+		{ \
+			return SimdMask4(neon_(m_simd, b.m_simd)); \
+		}
+#else
+#	define ANKI_SIMD_F32X4_CMP(op_, sse_, neon_) \
+		SimdMask4 operator op_(SimdF32x4 b) const \
+		{ \
+			return SimdMask4(SimdMask4::Type{{m_simd[0] op_ b.m_simd[0], m_simd[1] op_ b.m_simd[1], m_simd[2] op_ b.m_simd[2], \
+							   m_simd[3] op_ b.m_simd[3]}}); \
+		}
+#endif
+
+	ANKI_SIMD_F32X4_CMP(<, _mm_cmplt_ps, vcltq_f32)
+	ANKI_SIMD_F32X4_CMP(<=, _mm_cmple_ps, vcleq_f32)
+	ANKI_SIMD_F32X4_CMP(>, _mm_cmpgt_ps, vcgtq_f32)
+	ANKI_SIMD_F32X4_CMP(>=, _mm_cmpge_ps, vcgeq_f32)
+
+#undef ANKI_SIMD_F32X4_CMP
+
+	SimdF32x4 min(SimdF32x4 b) const
+	{
+#if ANKI_SIMD_SSE
+		return SimdF32x4(_mm_min_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdF32x4(vminq_f32(m_simd, b.m_simd));
+#else
+		return SimdF32x4(anki::min(m_simd[0], b.m_simd[0]), anki::min(m_simd[1], b.m_simd[1]),
+						 anki::min(m_simd[2], b.m_simd[2]), anki::min(m_simd[3], b.m_simd[3]));
+#endif
+	}
+
+	SimdF32x4 max(SimdF32x4 b) const
+	{
+#if ANKI_SIMD_SSE
+		return SimdF32x4(_mm_max_ps(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdF32x4(vmaxq_f32(m_simd, b.m_simd));
+#else
+		return SimdF32x4(anki::max(m_simd[0], b.m_simd[0]), anki::max(m_simd[1], b.m_simd[1]),
+						 anki::max(m_simd[2], b.m_simd[2]), anki::max(m_simd[3], b.m_simd[3]));
+#endif
+	}
+
+	/// Multiply and add: (this * b) + c
+	SimdF32x4 mad(SimdF32x4 b, SimdF32x4 c) const
+	{
+#if ANKI_SIMD_AVX2
+		return SimdF32x4(_mm_fmadd_ps(m_simd, b.m_simd, c.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdF32x4(vmlaq_f32(c.m_simd, m_simd, b.m_simd));
+#else
+		return (*this * b) + c;
+#endif
+	}
+
+	/// Pick the lanes of a where the mask is set and the lanes of b for the rest.
+	static SimdF32x4 select(SimdMask4 mask, SimdF32x4 a, SimdF32x4 b)
+	{
+#if ANKI_SIMD_SSE
+		return SimdF32x4(_mm_blendv_ps(b.m_simd, a.m_simd, mask.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdF32x4(vbslq_f32(mask.m_simd, a.m_simd, b.m_simd));
+#else
+		return SimdF32x4((mask.m_simd[0]) ? a.m_simd[0] : b.m_simd[0], (mask.m_simd[1]) ? a.m_simd[1] : b.m_simd[1],
+						 (mask.m_simd[2]) ? a.m_simd[2] : b.m_simd[2], (mask.m_simd[3]) ? a.m_simd[3] : b.m_simd[3]);
+#endif
+	}
+};
+
+/// 4 U32 lanes that map to SSE, NEON or plain scalar code.
+class SimdU32x4
+{
+public:
+#if ANKI_SIMD_SSE
+	using Type = __m128i;
+#elif ANKI_SIMD_NEON
+	using Type = uint32x4_t;
+#else
+	using Type = Array<U32, 4>;
+#endif
+
+	Type m_simd;
+
+	SimdU32x4() = default;
+
+	explicit SimdU32x4(Type simd)
+		: m_simd(simd)
+	{
+	}
+
+	/// Set all lanes to the same value.
+	explicit SimdU32x4(U32 u)
+	{
+#if ANKI_SIMD_SSE
+		m_simd = _mm_set1_epi32(I32(u));
+#elif ANKI_SIMD_NEON
+		m_simd = vdupq_n_u32(u);
+#else
+		m_simd[0] = m_simd[1] = m_simd[2] = m_simd[3] = u;
+#endif
+	}
+
+	/// Load 4 U32. The memory doesn't need to be aligned.
+	static SimdU32x4 load(const U32* arr)
+	{
+		SimdU32x4 out;
+#if ANKI_SIMD_SSE
+		out.m_simd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(arr));
+#elif ANKI_SIMD_NEON
+		out.m_simd = vld1q_u32(arr);
+#else
+		memcpy(&out.m_simd[0], arr, sizeof(out.m_simd));
+#endif
+		return out;
+	}
+
+	/// Store 4 U32. The memory doesn't need to be aligned.
+	void store(U32* arr) const
+	{
+#if ANKI_SIMD_SSE
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(arr), m_simd);
+#elif ANKI_SIMD_NEON
+		vst1q_u32(arr, m_simd);
+#else
+		memcpy(arr, &m_simd[0], sizeof(m_simd));
+#endif
+	}
+
+	/// Convert floats in the [0.0, 1.0) range to a U32 in the [0, MAX_U32] range. It's what U32(f * F32(MAX_U32))
+	/// does but the precision is the precision of the F32.
+	static SimdU32x4 fromUnorm(SimdF32x4 f)
+	{
+		SimdU32x4 out;
+		const SimdF32x4 scaled = f * SimdF32x4(F32(MAX_U32));
+#if ANKI_SIMD_SSE
+		// There is no unsigned conversion, bias it to the signed range
+		const __m128i signedi = _mm_cvttps_epi32(_mm_sub_ps(scaled.m_simd, _mm_set1_ps(2147483648.0f)));
+		out.m_simd = _mm_xor_si128(signedi, _mm_set1_epi32(I32(0x80000000)));
+#elif ANKI_SIMD_NEON
+		out.m_simd = vcvtq_u32_f32(scaled.m_simd);
+#else
+		for(U32 i = 0; i < 4; ++i)
+		{
+			out.m_simd[i] = U32(scaled.m_simd[i]);
+		}
+#endif
+		return out;
+	}
+
+	SimdU32x4 min(SimdU32x4 b) const
+	{
+#if ANKI_SIMD_SSE
+		return SimdU32x4(_mm_min_epu32(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdU32x4(vminq_u32(m_simd, b.m_simd));
+#else
+		return SimdU32x4(Type{{anki::min(m_simd[0], b.m_simd[0]), anki::min(m_simd[1], b.m_simd[1]),
+						   anki::min(m_simd[2], b.m_simd[2]), anki::min(m_simd[3], b.m_simd[3])}});
+#endif
+	}
+
+	SimdU32x4 max(SimdU32x4 b) const
+	{
+#if ANKI_SIMD_SSE
+		return SimdU32x4(_mm_max_epu32(m_simd, b.m_simd));
+#elif ANKI_SIMD_NEON
+		return SimdU32x4(vmaxq_u32(m_simd, b.m_simd));
+#else
+		return SimdU32x4(Type{{anki::max(m_simd[0], b.m_simd[0]), anki::max(m_simd[1], b.m_simd[1]),
+						   anki::max(m_simd[2], b.m_simd[2]), anki::max(m_simd[3], b.m_simd[3])}});
+#endif
+	}
+
+	/// Pick the lanes of a where the mask is set and the lanes of b for the rest.
+	static SimdU32x4 select(SimdMask4 mask, SimdU32x4 a, SimdU32x4 b)
+	{
+#if ANKI_SIMD_SSE
+		return SimdU32x4(_mm_castps_si128(
+			_mm_blendv_ps(_mm_castsi128_ps(b.m_simd), _mm_castsi128_ps(a.m_simd), mask.m_simd)));
+#elif ANKI_SIMD_NEON
+		return SimdU32x4(vbslq_u32(mask.m_simd, a.m_simd, b.m_simd));
+#else
+		return SimdU32x4(Type{{(mask.m_simd[0]) ? a.m_simd[0] : b.m_simd[0], (mask.m_simd[1]) ? a.m_simd[1] : b.m_simd[1],
+						   (mask.m_simd[2]) ? a.m_simd[2] : b.m_simd[2],
+						   (mask.m_simd[3]) ? a.m_simd[3] : b.m_simd[3]}});
+#endif
+	}
+
+	/// Get the min of all lanes.
+	U32 horizontalMin() const
+	{
+		alignas(16) Array<U32, 4> arr;
+		store(&arr[0]);
+		return anki::min(anki::min(arr[0], arr[1]), anki::min(arr[2], arr[3]));
+	}
+
+	/// Get the max of all lanes.
+	U32 horizontalMax() const
+	{
+		alignas(16) Array<U32, 4> arr;
+		store(&arr[0]);
+		return anki::max(anki::max(arr[0], arr[1]), anki::max(arr[2], arr[3]));
+	}
+};
+
 } // end namespace anki
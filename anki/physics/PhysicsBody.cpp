@@ -50,6 +50,7 @@ PhysicsBody::PhysicsBody(PhysicsWorld* world, const PhysicsBodyInitInfo& init)
 
 	// Add to world
 	auto lock = getWorld().lockBtWorld();
+	getWorld().increaseGImpactObjectCount(*shape, 1);
 	getWorld().getBtWorld()->addRigidBody(m_body.get());
 }
 
@@ -57,6 +58,7 @@ PhysicsBody::~PhysicsBody()
 {
 	auto lock = getWorld().lockBtWorld();
 	getWorld().getBtWorld()->removeRigidBody(m_body.get());
+	getWorld().increaseGImpactObjectCount(*m_body->getCollisionShape(), -1);
 }
 
 void PhysicsBody::setMass(F32 mass)
@@ -26,6 +26,7 @@ PhysicsTrigger::PhysicsTrigger(PhysicsWorld* world, PhysicsCollisionShapePtr sha
 	setMaterialMask(PhysicsMaterialBit::ALL);
 
 	auto lock = getWorld().lockBtWorld();
+	getWorld().increaseGImpactObjectCount(*m_ghostShape->getCollisionShape(), 1);
 	getWorld().getBtWorld()->addCollisionObject(m_ghostShape.get());
 }
 
@@ -34,6 +35,7 @@ PhysicsTrigger::~PhysicsTrigger()
 	{
 		auto lock = getWorld().lockBtWorld();
 		getWorld().getBtWorld()->removeCollisionObject(m_ghostShape.get());
+		getWorld().increaseGImpactObjectCount(*m_ghostShape->getCollisionShape(), -1);
 	}
 
 	m_ghostShape.destroy();
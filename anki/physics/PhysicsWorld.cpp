@@ -8,6 +8,7 @@
 #include <anki/physics/PhysicsBody.h>
 #include <anki/physics/PhysicsTrigger.h>
 #include <anki/util/Rtti.h>
+#include <anki/util/ThreadHive.h>
 #include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 
 namespace anki
@@ -139,6 +140,123 @@ public:
 	}
 };
 
+/// The state of a PhysicsWorld::parallelFor. It's allocated in the ThreadHive's scratch memory because some of the
+/// hive tasks might start running after parallelFor returns.
+class PhysicsWorld::ParallelForContext
+{
+public:
+	void (*m_callback)(void* userData, U32 begin, U32 end);
+	void* m_userData;
+	Atomic<U32> m_nextBegin;
+	Atomic<U32> m_doneCount;
+	U32 m_end;
+	U32 m_grainSize;
+
+	/// Process ranges until there are no more left.
+	void run()
+	{
+		U32 begin;
+		while((begin = m_nextBegin.fetchAdd(m_grainSize)) < m_end)
+		{
+			const U32 end = min(begin + m_grainSize, m_end);
+			m_callback(m_userData, begin, end);
+			m_doneCount.fetchAdd(end - begin, AtomicMemoryOrder::RELEASE);
+		}
+	}
+};
+
+template<typename TFunc>
+void PhysicsWorld::parallelFor(U32 begin, U32 end, U32 grainSize, TFunc func)
+{
+	ANKI_ASSERT(begin <= end && grainSize > 0);
+	const U32 rangeCount = (end - begin + grainSize - 1) / grainSize;
+	if(m_threadHive == nullptr || rangeCount <= 1)
+	{
+		if(begin < end)
+		{
+			func(begin, end);
+		}
+		return;
+	}
+
+	ParallelForContext* ctx = static_cast<ParallelForContext*>(
+		m_threadHive->allocateScratchMemory(sizeof(ParallelForContext), alignof(ParallelForContext)));
+	::new(ctx) ParallelForContext();
+	ctx->m_callback = [](void* userData, U32 begin, U32 end) { (*static_cast<TFunc*>(userData))(begin, end); };
+	ctx->m_userData = &func;
+	ctx->m_nextBegin.setNonAtomically(begin);
+	ctx->m_doneCount.setNonAtomically(0);
+	ctx->m_end = end;
+	ctx->m_grainSize = grainSize;
+
+	// Wake some threads. The calling thread will work as well
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+	const U32 taskCount = min(rangeCount - 1, m_threadHive->getThreadCount());
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		tasks[i] = ANKI_THREAD_HIVE_TASK({ self->run(); }, ctx, nullptr, nullptr);
+	}
+	m_threadHive->submitTasks(&tasks[0], taskCount);
+
+	ctx->run();
+
+	// Only wait for the ranges that the other threads picked. Waiting for the tasks themselves could deadlock when the
+	// caller is a hive task
+	while(ctx->m_doneCount.load(AtomicMemoryOrder::ACQUIRE) < end - begin)
+	{
+		std::this_thread::yield();
+	}
+}
+
+#if ANKI_PHYSICS_MULTITHREADED
+/// Runs Bullet's parallel loops on the ThreadHive.
+class PhysicsWorld::MyTaskScheduler : public btITaskScheduler
+{
+public:
+	PhysicsWorld* m_world;
+
+	MyTaskScheduler(PhysicsWorld* world)
+		: btITaskScheduler("AnKi")
+		, m_world(world)
+	{
+	}
+
+	int getMaxNumThreads() const override
+	{
+		return getNumThreads();
+	}
+
+	int getNumThreads() const override
+	{
+		return (m_world->m_threadHive) ? int(m_world->m_threadHive->getThreadCount() + 1) : 1;
+	}
+
+	void setNumThreads(int numThreads) override
+	{
+		// The ThreadHive decides
+	}
+
+	void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+	{
+		m_world->parallelFor(U32(iBegin), U32(iEnd), U32(max(grainSize, 1)),
+							 [&](U32 begin, U32 end) { body.forLoop(int(begin), int(end)); });
+	}
+
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+	{
+		SpinLock mtx;
+		btScalar sum = 0.0f;
+		m_world->parallelFor(U32(iBegin), U32(iEnd), U32(max(grainSize, 1)), [&](U32 begin, U32 end) {
+			const btScalar rangeSum = body.sumLoop(int(begin), int(end));
+			LockGuard<SpinLock> lock(mtx);
+			sum += rangeSum;
+		});
+
+		return sum;
+	}
+};
+#endif
+
 PhysicsWorld::PhysicsWorld()
 {
 }
@@ -160,12 +278,25 @@ PhysicsWorld::~PhysicsWorld()
 	m_gpc.destroy();
 	m_alloc.deleteInstance(m_filterCallback);
 
+#if ANKI_PHYSICS_MULTITHREADED
+	if(m_taskScheduler)
+	{
+		btSetTaskScheduler(nullptr);
+		m_alloc.deleteInstance(m_taskScheduler);
+	}
+#endif
+
 	gAlloc = nullptr;
 }
 
-Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
+Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* threadHive)
 {
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbData);
+#if ANKI_PHYSICS_MULTITHREADED
+	m_threadHive = threadHive;
+#else
+	(void)threadHive;
+#endif
 	m_tmpAlloc = StackAllocator<U8>(allocCb, allocCbData, 1_KB, 2.0f);
 
 	// Set allocators
@@ -181,12 +312,27 @@ Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
 
 	m_collisionConfig.init();
 
+#if ANKI_PHYSICS_MULTITHREADED
+	// Bullet needs a scheduler even if it's single threaded
+	m_taskScheduler = m_alloc.newInstance<MyTaskScheduler>(this);
+	btSetTaskScheduler(m_taskScheduler);
+
+	m_dispatcher.init(m_collisionConfig.get());
+	btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher.get());
+
+	m_solver.init(m_taskScheduler->getNumThreads());
+
+	m_world.init(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), nullptr, m_collisionConfig.get());
+
+	ANKI_PHYS_LOGI("Multithreaded world. Thread count %d", m_taskScheduler->getNumThreads());
+#else
 	m_dispatcher.init(m_collisionConfig.get());
 	btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher.get());
 
 	m_solver.init();
 
 	m_world.init(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), m_collisionConfig.get());
+#endif
 	m_world->setGravity(btVector3(0.0f, -9.8f, 0.0f));
 
 	return Error::NONE;
@@ -231,14 +377,32 @@ void PhysicsWorld::destroyObject(PhysicsObject* obj)
 
 void PhysicsWorld::rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts)
 {
-	auto lock = lockBtWorld();
+	// Every ray gets its own callback because Bullet culls using the closest hit fraction of the previous rays
+	auto castRays = [&](U32 begin, U32 end) {
+		for(U32 i = begin; i < end; ++i)
+		{
+			MyRaycastCallback callback;
+			callback.m_raycast = rayCasts[i];
+			m_world->rayTest(toBt(rayCasts[i]->m_from), toBt(rayCasts[i]->m_to), callback);
+		}
+	};
 
-	MyRaycastCallback callback;
-	for(PhysicsWorldRayCastCallback* cb : rayCasts)
+#if ANKI_PHYSICS_MULTITHREADED
 	{
-		callback.m_raycast = cb;
-		m_world->rayTest(toBt(cb->m_from), toBt(cb->m_to), callback);
+		// GImpact shapes lock their meshes when they are ray cast and that is not thread-safe. The count changes only
+		// under the write lock so it can't change while the read lock is held
+		RLockGuard<RWMutex> lock(m_btWorldMtx);
+		if(m_gimpactObjectCount.load() == 0)
+		{
+			const U32 RAYS_PER_TASK = 16;
+			parallelFor(0, rayCasts.getSize(), RAYS_PER_TASK, castRays);
+			return;
+		}
 	}
+#endif
+
+	auto lock = lockBtWorld();
+	castRays(0, rayCasts.getSize());
 }
 
 } // end namespace anki
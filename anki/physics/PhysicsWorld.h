@@ -10,10 +10,14 @@
 #include <anki/util/List.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/ClassWrapper.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
 
+// Forward
+class ThreadHive;
+
 /// @addtogroup physics
 /// @{
 
@@ -34,6 +38,7 @@ public:
 	}
 
 	/// Process a raycast result.
+	/// @note It might be called from a different thread than the one that called PhysicsWorld::rayCast.
 	virtual void processResult(PhysicsFilteredObject& obj, const Vec3& worldNormal, const Vec3& worldPosition) = 0;
 };
 
@@ -44,7 +49,9 @@ public:
 	PhysicsWorld();
 	~PhysicsWorld();
 
-	ANKI_USE_RESULT Error create(AllocAlignedCallback allocCb, void* allocCbData);
+	/// @param threadHive If it's not nullptr and AnKi is built with ANKI_PHYSICS_MULTITHREADED the world will be
+	///                   stepped and ray cast in parallel using that hive.
+	ANKI_USE_RESULT Error create(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* threadHive = nullptr);
 
 	template<typename T, typename... TArgs>
 	PhysicsPtr<T> newInstance(TArgs&&... args)
@@ -71,6 +78,9 @@ public:
 		return m_alloc;
 	}
 
+	/// Cast many rays. If the world is multithreaded the rays will be cast in parallel and they will only block the
+	/// operations that modify the world.
+	/// @note It's thread-safe.
 	void rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts);
 
 	void rayCast(PhysicsWorldRayCastCallback& raycast)
@@ -95,9 +105,20 @@ public:
 		return 0.04f;
 	}
 
-	ANKI_INTERNAL ANKI_USE_RESULT LockGuard<Mutex> lockBtWorld() const
+	ANKI_INTERNAL ANKI_USE_RESULT WLockGuard<RWMutex> lockBtWorld() const
+	{
+		return WLockGuard<RWMutex>(m_btWorldMtx);
+	}
+
+	/// PhysicsBody and PhysicsTrigger call that when they add or remove their collision object. It only counts GImpact
+	/// shapes because Bullet can't ray cast those concurrently.
+	/// @note Call it while holding lockBtWorld() so ray casts see a count that matches the world's contents.
+	ANKI_INTERNAL void increaseGImpactObjectCount(const btCollisionShape& shape, I32 increase)
 	{
-		return LockGuard<Mutex>(m_btWorldMtx);
+		if(shape.getShapeType() == GIMPACT_SHAPE_PROXYTYPE)
+		{
+			m_gimpactObjectCount.fetchAdd(increase);
+		}
 	}
 
 	ANKI_INTERNAL void destroyObject(PhysicsObject* obj);
@@ -105,6 +126,8 @@ public:
 private:
 	class MyOverlapFilterCallback;
 	class MyRaycastCallback;
+	class MyTaskScheduler;
+	class ParallelForContext;
 
 	HeapAllocator<U8> m_alloc;
 	StackAllocator<U8> m_tmpAlloc;
@@ -114,13 +137,27 @@ private:
 	MyOverlapFilterCallback* m_filterCallback = nullptr;
 
 	ClassWrapper<btDefaultCollisionConfiguration> m_collisionConfig;
+#if ANKI_PHYSICS_MULTITHREADED
+	ClassWrapper<btCollisionDispatcherMt> m_dispatcher;
+	ClassWrapper<btConstraintSolverPoolMt> m_solver;
+	ClassWrapper<btDiscreteDynamicsWorldMt> m_world;
+	MyTaskScheduler* m_taskScheduler = nullptr;
+#else
 	ClassWrapper<btCollisionDispatcher> m_dispatcher;
 	ClassWrapper<btSequentialImpulseConstraintSolver> m_solver;
 	ClassWrapper<btDiscreteDynamicsWorld> m_world;
-	mutable Mutex m_btWorldMtx;
+#endif
+	mutable RWMutex m_btWorldMtx; ///< Ray casts lock it for reading, everything else for writing.
+
+	ThreadHive* m_threadHive = nullptr;
+	Atomic<I32> m_gimpactObjectCount = {0}; ///< Modified only while m_btWorldMtx is locked for writing.
 
 	Array<IntrusiveList<PhysicsObject>, U(PhysicsObjectType::COUNT)> m_objectLists;
 	mutable Mutex m_objectListsMtx;
+
+	/// Run func(begin, end) for sub-ranges of [begin, end) in parallel.
+	template<typename TFunc>
+	void parallelFor(U32 begin, U32 end, U32 grainSize, TFunc func);
 };
 /// @}
 
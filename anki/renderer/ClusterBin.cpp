@@ -39,6 +39,47 @@ static Bool insideClusterFrustum(const Array<Plane, 4>& planeArr, const TShape&
 	return true;
 }
 
+/// Test a sphere against 4 AABBs at once. The AABBs are in SoA layout: minX, minY, minZ, maxX, maxY, maxZ. Returns a
+/// mask with one bit per AABB that the sphere touches.
+static U32 testSphereVsAabbX4(const Vec4& sphere, const Vec4* boxes)
+{
+	const Vec4 cx(sphere.x());
+	const Vec4 cy(sphere.y());
+	const Vec4 cz(sphere.z());
+
+	// The vector from the center to the closest point of each box
+	const Vec4 dx = cx.max(boxes[0]).min(boxes[3]) - cx;
+	const Vec4 dy = cy.max(boxes[1]).min(boxes[4]) - cy;
+	const Vec4 dz = cz.max(boxes[2]).min(boxes[5]) - cz;
+	const Vec4 distSq = dx * dx + dy * dy + dz * dz;
+	const F32 radiusSq = sphere.w() * sphere.w();
+
+#if ANKI_SIMD_SSE
+	return U32(_mm_movemask_ps(_mm_cmple_ps(distSq.getSimd(), _mm_set1_ps(radiusSq))));
+#else
+	return U32(distSq.x() <= radiusSq) | (U32(distSq.y() <= radiusSq) << 1u) | (U32(distSq.z() <= radiusSq) << 2u)
+		   | (U32(distSq.w() <= radiusSq) << 3u);
+#endif
+}
+
+/// The bounds of an object in cluster space. They are conservative.
+class ClusterBin::ObjectBounds
+{
+public:
+	Vec4 m_sphere; ///< World space bounding sphere. The w is the radius.
+	Array<U16, 2> m_firstTile;
+	Array<U16, 2> m_lastTile;
+	U16 m_firstClusterZ;
+	U16 m_lastClusterZ;
+	Bool m_visible;
+
+	Bool touchesTile(U32 tileX, U32 tileY) const
+	{
+		return m_visible && tileX >= m_firstTile[0] && tileX <= m_lastTile[0] && tileY >= m_firstTile[1]
+			   && tileY <= m_lastTile[1];
+	}
+};
+
 /// Bin context.
 class ClusterBin::BinCtx
 {
@@ -55,6 +96,10 @@ public:
 	WeakArray<U32> m_lightIds;
 	WeakArray<U32> m_clusters;
 
+	WeakArray<ObjectBounds> m_objectBounds; ///< The bounds of all objects. The types are one after the other.
+	Array<U32, TYPED_OBJECT_COUNT + 1> m_objectTypeOffsets; ///< Where each type starts in m_objectBounds.
+
+	Atomic<U32> m_objectIdxToProcess = {0};
 	Atomic<U32> m_tileIdxToProcess = {0};
 	Atomic<U32> m_allocatedIndexCount = {TYPED_OBJECT_COUNT};
 
@@ -74,6 +119,7 @@ public:
 
 	DynamicArrayAuto<Vec4> m_clusterEdgesWSpace;
 	DynamicArrayAuto<Aabb> m_clusterBoxes;
+	DynamicArrayAuto<Vec4> m_clusterBoxesSoa; ///< The m_clusterBoxes in groups of 4. 6 Vec4s per group.
 	DynamicArrayAuto<Sphere> m_clusterSpheres;
 
 	DynamicArrayAuto<ClusterMetaInfo> m_clusterInfos;
@@ -84,6 +130,7 @@ public:
 	TileCtx(StackAllocator<U8>& alloc)
 		: m_clusterEdgesWSpace(alloc)
 		, m_clusterBoxes(alloc)
+		, m_clusterBoxesSoa(alloc)
 		, m_clusterSpheres(alloc)
 		, m_clusterInfos(alloc)
 		, m_indices(alloc)
@@ -96,6 +143,38 @@ public:
 		const U32 perClusterCount = m_indices.getSize() / m_clusterCountZ;
 		return WeakArray<U32>(&m_indices[perClusterCount * clusterZ], perClusterCount);
 	}
+
+	/// Call func for every cluster of the tile whose AABB touches the bounding sphere of the object. It only visits the
+	/// Z slices of the object and tests 4 clusters at once.
+	template<typename TFunc>
+	void iterateClusters(const ObjectBounds& bounds, TFunc func) const
+	{
+		ANKI_ASSERT(bounds.m_visible && bounds.m_lastClusterZ < m_clusterCountZ);
+		const U32 firstGroup = bounds.m_firstClusterZ / 4;
+		const U32 lastGroup = bounds.m_lastClusterZ / 4;
+		for(U32 group = firstGroup; group <= lastGroup; ++group)
+		{
+			U32 mask = testSphereVsAabbX4(bounds.m_sphere, &m_clusterBoxesSoa[group * 6]);
+
+			// Skip the clusters of the group that are outside the Z range of the object
+			const U32 firstCluster = group * 4;
+			if(firstCluster < bounds.m_firstClusterZ)
+			{
+				mask &= ~((1u << (bounds.m_firstClusterZ - firstCluster)) - 1u);
+			}
+			if(firstCluster + 3 > bounds.m_lastClusterZ)
+			{
+				mask &= (1u << (bounds.m_lastClusterZ - firstCluster + 1)) - 1u;
+			}
+
+			while(mask)
+			{
+				const U32 lane = findFirstSetBit(mask);
+				mask &= mask - 1u;
+				func(firstCluster + lane);
+			}
+		}
+	}
 };
 
 ClusterBin::~ClusterBin()
@@ -162,46 +241,94 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 		sizeof(U32) * m_totalClusterCount, StagingGpuMemoryType::STORAGE, ctx.m_out->m_clustersToken));
 	ctx.m_clusters = WeakArray<U32>(clusters, m_totalClusterCount);
 
+	// Allocate the bounds of the objects
+	const RenderQueue& rqueue = *in.m_renderQueue;
+	ctx.m_objectTypeOffsets[0] = 0;
+	ctx.m_objectTypeOffsets[1] = ctx.m_objectTypeOffsets[0] + rqueue.m_pointLights.getSize();
+	ctx.m_objectTypeOffsets[2] = ctx.m_objectTypeOffsets[1] + rqueue.m_spotLights.getSize();
+	ctx.m_objectTypeOffsets[3] = ctx.m_objectTypeOffsets[2] + rqueue.m_reflectionProbes.getSize();
+	ctx.m_objectTypeOffsets[4] = ctx.m_objectTypeOffsets[3] + rqueue.m_giProbes.getSize();
+	ctx.m_objectTypeOffsets[5] = ctx.m_objectTypeOffsets[4] + rqueue.m_decals.getSize();
+	ctx.m_objectTypeOffsets[6] = ctx.m_objectTypeOffsets[5] + rqueue.m_fogDensityVolumes.getSize();
+	static_assert(TYPED_OBJECT_COUNT == 6, "Update the above");
+
+	const U32 objectCount = ctx.m_objectTypeOffsets[TYPED_OBJECT_COUNT];
+	if(objectCount)
+	{
+		ctx.m_objectBounds =
+			WeakArray<ObjectBounds>(in.m_tempAlloc.newArray<ObjectBounds>(objectCount), objectCount);
+	}
+
+	const U32 threadCount = in.m_threadHive->getThreadCount();
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS * 2 + 1> tasks;
+	U32 taskCount = 0;
+
 	// Create task for writing GPU buffers
-	Array<ThreadHiveTask, ThreadHive::MAX_THREADS + 1> tasks;
-	tasks[0] = ANKI_THREAD_HIVE_TASK(
+	tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
 		{
 			ANKI_TRACE_SCOPED_EVENT(R_WRITE_LIGHT_BUFFERS);
 			self->m_bin->writeTypedObjectsToGpuBuffers(*self);
 		},
 		&ctx, nullptr, nullptr);
 
-	// Create tasks for binning
-	tasks[1] = ANKI_THREAD_HIVE_TASK(
+	// Create tasks that compute the bounds of the objects. The binning depends on them
+	ThreadHiveSemaphore* boundsSem = nullptr;
+	if(objectCount)
+	{
+		boundsSem = in.m_threadHive->newSemaphore(threadCount);
+		for(U32 threadIdx = 0; threadIdx < threadCount; ++threadIdx)
 		{
-			ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
-			BinCtx& ctx = *self;
-
-			TileCtx tileCtx(ctx.m_in->m_tempAlloc);
-			const U32 clusterCountZ = ctx.m_bin->m_clusterCounts[2];
-			tileCtx.m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
-			tileCtx.m_clusterBoxes.create(clusterCountZ);
-			tileCtx.m_clusterSpheres.create(clusterCountZ);
-			tileCtx.m_indices.create(clusterCountZ * ctx.m_bin->m_avgObjectsPerCluster);
-			tileCtx.m_clusterInfos.create(clusterCountZ);
-			tileCtx.m_clusterCountZ = clusterCountZ;
-
-			const U32 tileCount = ctx.m_bin->m_clusterCounts[0] * ctx.m_bin->m_clusterCounts[1];
-			U32 tileIdx;
-			while((tileIdx = ctx.m_tileIdxToProcess.fetchAdd(1)) < tileCount)
-			{
-				ctx.m_bin->binTile(tileIdx, ctx, tileCtx);
-			}
-		},
-		&ctx, nullptr, nullptr);
+			tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
+				{
+					ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
+					BinCtx& ctx = *self;
+
+					const U32 OBJECTS_PER_BATCH = 32;
+					const U32 objectCount = ctx.m_objectBounds.getSize();
+					U32 firstObject;
+					while((firstObject = ctx.m_objectIdxToProcess.fetchAdd(OBJECTS_PER_BATCH)) < objectCount)
+					{
+						const U32 lastObject = min(firstObject + OBJECTS_PER_BATCH, objectCount);
+						for(U32 objectIdx = firstObject; objectIdx < lastObject; ++objectIdx)
+						{
+							ctx.m_bin->computeObjectBounds(objectIdx, ctx);
+						}
+					}
+				},
+				&ctx, nullptr, boundsSem);
+		}
+	}
 
-	for(U threadIdx = 1; threadIdx < in.m_threadHive->getThreadCount(); ++threadIdx)
+	// Create tasks for binning
+	for(U32 threadIdx = 0; threadIdx < threadCount; ++threadIdx)
 	{
-		tasks[threadIdx + 1] = tasks[1];
+		tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
+			{
+				ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
+				BinCtx& ctx = *self;
+
+				TileCtx tileCtx(ctx.m_in->m_tempAlloc);
+				const U32 clusterCountZ = ctx.m_bin->m_clusterCounts[2];
+				tileCtx.m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
+				tileCtx.m_clusterBoxes.create(clusterCountZ);
+				tileCtx.m_clusterBoxesSoa.create((clusterCountZ + 3) / 4 * 6);
+				tileCtx.m_clusterSpheres.create(clusterCountZ);
+				tileCtx.m_indices.create(clusterCountZ * ctx.m_bin->m_avgObjectsPerCluster);
+				tileCtx.m_clusterInfos.create(clusterCountZ);
+				tileCtx.m_clusterCountZ = clusterCountZ;
+
+				const U32 tileCount = ctx.m_bin->m_clusterCounts[0] * ctx.m_bin->m_clusterCounts[1];
+				U32 tileIdx;
+				while((tileIdx = ctx.m_tileIdxToProcess.fetchAdd(1)) < tileCount)
+				{
+					ctx.m_bin->binTile(tileIdx, ctx, tileCtx);
+				}
+			},
+			&ctx, boundsSem, nullptr);
 	}
 
 	// Submit and wait
-	in.m_threadHive->submitTasks(&tasks[0], in.m_threadHive->getThreadCount() + 1);
+	in.m_threadHive->submitTasks(&tasks[0], taskCount);
 	in.m_threadHive->waitAllTasks();
 }
 
@@ -252,6 +379,131 @@ void ClusterBin::prepare(BinCtx& ctx)
 	ctx.m_unprojParams = ctx.m_in->m_renderQueue->m_projectionMatrix.extractPerspectiveUnprojectionParams();
 }
 
+void ClusterBin::computeObjectBounds(U32 objectIdx, BinCtx& ctx) const
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+
+	// Compute a bounding sphere
+	Vec4 sphere;
+	if(objectIdx < ctx.m_objectTypeOffsets[1])
+	{
+		const PointLightQueueElement& plight = rqueue.m_pointLights[objectIdx - ctx.m_objectTypeOffsets[0]];
+		sphere = Vec4(plight.m_worldPosition, plight.m_radius);
+	}
+	else if(objectIdx < ctx.m_objectTypeOffsets[2])
+	{
+		// The minimal sphere of the cone that the binning tests against. The cone's length is along its direction
+		const SpotLightQueueElement& slight = rqueue.m_spotLights[objectIdx - ctx.m_objectTypeOffsets[1]];
+		const F32 halfAngle = slight.m_outerAngle / 2.0f;
+		const Vec3 origin = slight.m_worldTransform.getTranslationPart().xyz();
+		const Vec3 dir = -slight.m_worldTransform.getZAxis().xyz();
+		if(halfAngle > PI / 4.0f)
+		{
+			// Wide cone, the sphere is centered in the cap
+			sphere = Vec4(origin + dir * slight.m_distance, tan(halfAngle) * slight.m_distance);
+		}
+		else
+		{
+			// Narrow cone, the sphere passes from the apex and the rim of the cap
+			const F32 radius = slight.m_distance / (2.0f * cos(halfAngle) * cos(halfAngle));
+			sphere = Vec4(origin + dir * radius, radius);
+		}
+	}
+	else if(objectIdx < ctx.m_objectTypeOffsets[3])
+	{
+		const ReflectionProbeQueueElement& probe = rqueue.m_reflectionProbes[objectIdx - ctx.m_objectTypeOffsets[2]];
+		sphere = Vec4((probe.m_aabbMin + probe.m_aabbMax) / 2.0f, (probe.m_aabbMax - probe.m_aabbMin).getLength() / 2.0f);
+	}
+	else if(objectIdx < ctx.m_objectTypeOffsets[4])
+	{
+		const GlobalIlluminationProbeQueueElement& probe = rqueue.m_giProbes[objectIdx - ctx.m_objectTypeOffsets[3]];
+		sphere = Vec4((probe.m_aabbMin + probe.m_aabbMax) / 2.0f, (probe.m_aabbMax - probe.m_aabbMin).getLength() / 2.0f);
+	}
+	else if(objectIdx < ctx.m_objectTypeOffsets[5])
+	{
+		const DecalQueueElement& decal = rqueue.m_decals[objectIdx - ctx.m_objectTypeOffsets[4]];
+		sphere = Vec4(decal.m_obbCenter, decal.m_obbExtend.getLength());
+	}
+	else
+	{
+		ANKI_ASSERT(objectIdx < ctx.m_objectTypeOffsets[6]);
+		const FogDensityQueueElement& fogVol = rqueue.m_fogDensityVolumes[objectIdx - ctx.m_objectTypeOffsets[5]];
+		if(fogVol.m_isBox)
+		{
+			sphere = Vec4((fogVol.m_aabbMin + fogVol.m_aabbMax) / 2.0f,
+						  (fogVol.m_aabbMax - fogVol.m_aabbMin).getLength() / 2.0f);
+		}
+		else
+		{
+			sphere = Vec4(fogVol.m_sphereCenter, fogVol.m_sphereRadius);
+		}
+	}
+
+	ObjectBounds& bounds = ctx.m_objectBounds[objectIdx];
+	bounds.m_sphere = sphere;
+	bounds.m_visible = false;
+
+	// Find the Z range. The depth of a cluster's near plane is: near + magic.x * k^2
+	const Vec4 centerVSpace = rqueue.m_viewMatrix * sphere.xyz1();
+	const F32 radius = sphere.w();
+	const F32 near = ctx.m_out->m_shaderMagicValues.m_val1.y();
+	const F32 far = rqueue.m_cameraFar;
+	const F32 minDepth = -centerVSpace.z() - radius;
+	const F32 maxDepth = -centerVSpace.z() + radius;
+	if(maxDepth < near || minDepth > far)
+	{
+		return;
+	}
+
+	auto depthToClusterZ = [&](F32 depth) -> U16 {
+		const F32 k = sqrt(max(0.0f, (depth - near) / ctx.m_out->m_shaderMagicValues.m_val1.x()));
+		return U16(min(U32(k), m_clusterCounts[2] - 1));
+	};
+	bounds.m_firstClusterZ = depthToClusterZ(minDepth);
+	bounds.m_lastClusterZ = depthToClusterZ(maxDepth);
+
+	// Find the tile range
+	if(minDepth <= near)
+	{
+		// Crosses the near plane, can't project it
+		bounds.m_firstTile = {0, 0};
+		bounds.m_lastTile = {U16(m_clusterCounts[0] - 1), U16(m_clusterCounts[1] - 1)};
+		bounds.m_visible = true;
+		return;
+	}
+
+	// The NDC of a view space point is xy / (unprojParams.xy * z). It's monotonic in x, y and z since z doesn't change
+	// sign. So the extremes are at the corners of the view space AABB of the sphere
+	const Vec4& unprojParams = ctx.m_unprojParams;
+	Vec2 ndcMin(MAX_F32);
+	Vec2 ndcMax(MIN_F32);
+	for(F32 z : {centerVSpace.z() - radius, centerVSpace.z() + radius})
+	{
+		for(F32 sign : {-1.0f, 1.0f})
+		{
+			const Vec2 ndc = (centerVSpace.xy() + sign * radius) / (unprojParams.xy() * z);
+			ndcMin = ndcMin.min(ndc);
+			ndcMax = ndcMax.max(ndc);
+		}
+	}
+
+	for(U32 i = 0; i < 2; ++i)
+	{
+		const F32 count = F32(m_clusterCounts[i]);
+		const F32 firstTile = floor((ndcMin[i] * 0.5f + 0.5f) * count);
+		const F32 lastTile = floor((ndcMax[i] * 0.5f + 0.5f) * count);
+		if(lastTile < 0.0f || firstTile >= count)
+		{
+			return;
+		}
+
+		bounds.m_firstTile[i] = U16(clamp(firstTile, 0.0f, count - 1.0f));
+		bounds.m_lastTile[i] = U16(clamp(lastTile, 0.0f, count - 1.0f));
+	}
+
+	bounds.m_visible = true;
+}
+
 void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 {
 	ANKI_ASSERT(tileIdx < m_clusterCounts[0] * m_clusterCounts[1]);
@@ -324,6 +576,22 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		clusterSpheres[clusterZ] = Sphere(sphereCenter, (aabbMin - sphereCenter).getLength());
 	}
 
+	// Store the AABBs in groups of 4 for the SIMD tests. The padding boxes are empty and never touch anything
+	DynamicArrayAuto<Vec4>& clusterBoxesSoa = tileCtx.m_clusterBoxesSoa;
+	for(U32 clusterZ = 0; clusterZ < clusterBoxesSoa.getSize() / 6 * 4; ++clusterZ)
+	{
+		const U32 group = clusterZ / 4;
+		const U32 lane = clusterZ % 4;
+		const Bool padding = clusterZ >= m_clusterCounts[2];
+		const Vec4 aabbMin = (padding) ? Vec4(MAX_F32) : clusterBoxes[clusterZ].getMin();
+		const Vec4 aabbMax = (padding) ? Vec4(MIN_F32) : clusterBoxes[clusterZ].getMax();
+		for(U32 i = 0; i < 3; ++i)
+		{
+			clusterBoxesSoa[group * 6 + i][lane] = aabbMin[i];
+			clusterBoxesSoa[group * 6 + 3 + i][lane] = aabbMax[i];
+		}
+	}
+
 	// Zero the infos
 	memset(&tileCtx.m_clusterInfos[0], 0, tileCtx.m_clusterInfos.getSizeInBytes());
 
@@ -332,7 +600,7 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	if(ANKI_UNLIKELY(U32(inf.m_offset) + 1 >= m_avgObjectsPerCluster)) \
 	{ \
 		ANKI_R_LOGW("Out of cluster indices. Increase r_avgObjectsPerCluster"); \
-		continue; \
+		return; \
 	} \
 	tileCtx.getClusterIndices(clusterZ)[inf.m_offset++] = i; \
 	++inf.m_counts[typeIdx]; \
@@ -343,6 +611,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		Sphere lightSphere;
 		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_pointLights.getSize(); ++i)
 		{
+			const ObjectBounds& bounds = ctx.m_objectBounds[ctx.m_objectTypeOffsets[0] + i];
+			if(!bounds.touchesTile(tileX, tileY))
+			{
+				continue;
+			}
+
 			const PointLightQueueElement& plight = ctx.m_in->m_renderQueue->m_pointLights[i];
 			lightSphere.setCenter(plight.m_worldPosition.xyz0());
 			lightSphere.setRadius(plight.m_radius);
@@ -352,15 +626,8 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(lightSphere, clusterBoxes[clusterZ]))
-				{
-					continue;
-				}
-
-				ANKI_SET_IDX(0);
-			}
+			// The bounding sphere is the light sphere so the SIMD test is the exact test
+			tileCtx.iterateClusters(bounds, [&](U32 clusterZ) { ANKI_SET_IDX(0); });
 		}
 	}
 
@@ -372,6 +639,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 
 		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_spotLights.getSize(); ++i)
 		{
+			const ObjectBounds& bounds = ctx.m_objectBounds[ctx.m_objectTypeOffsets[1] + i];
+			if(!bounds.touchesTile(tileX, tileY))
+			{
+				continue;
+			}
+
 			const SpotLightQueueElement& slight = ctx.m_in->m_renderQueue->m_spotLights[i];
 
 			computeEdgesOfFrustum(slight.m_distance, slight.m_outerAngle, slight.m_outerAngle, &lightEdges[1]);
@@ -382,17 +655,16 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(clusterSpheres[clusterZ],
-								  Cone(slight.m_worldTransform.getTranslationPart().xyz0(),
-									   -slight.m_worldTransform.getZAxis(), slight.m_distance, slight.m_outerAngle)))
+			const Cone cone(slight.m_worldTransform.getTranslationPart().xyz0(), -slight.m_worldTransform.getZAxis(),
+							slight.m_distance, slight.m_outerAngle);
+			tileCtx.iterateClusters(bounds, [&](U32 clusterZ) {
+				if(!testCollision(clusterSpheres[clusterZ], cone))
 				{
-					continue;
+					return;
 				}
 
 				ANKI_SET_IDX(1);
-			}
+			});
 		}
 	}
 
@@ -401,6 +673,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		Aabb probeBox;
 		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_reflectionProbes.getSize(); ++i)
 		{
+			const ObjectBounds& bounds = ctx.m_objectBounds[ctx.m_objectTypeOffsets[2] + i];
+			if(!bounds.touchesTile(tileX, tileY))
+			{
+				continue;
+			}
+
 			const ReflectionProbeQueueElement& probe = ctx.m_in->m_renderQueue->m_reflectionProbes[i];
 			probeBox.setMin(probe.m_aabbMin);
 			probeBox.setMax(probe.m_aabbMax);
@@ -410,15 +688,14 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
+			tileCtx.iterateClusters(bounds, [&](U32 clusterZ) {
 				if(!testCollision(probeBox, clusterBoxes[clusterZ]))
 				{
-					continue;
+					return;
 				}
 
 				ANKI_SET_IDX(2);
-			}
+			});
 		}
 	}
 
@@ -427,6 +704,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		Aabb probeBox;
 		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_giProbes.getSize(); ++i)
 		{
+			const ObjectBounds& bounds = ctx.m_objectBounds[ctx.m_objectTypeOffsets[3] + i];
+			if(!bounds.touchesTile(tileX, tileY))
+			{
+				continue;
+			}
+
 			const GlobalIlluminationProbeQueueElement& probe = ctx.m_in->m_renderQueue->m_giProbes[i];
 			probeBox.setMin(probe.m_aabbMin);
 			probeBox.setMax(probe.m_aabbMax);
@@ -436,15 +719,14 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
+			tileCtx.iterateClusters(bounds, [&](U32 clusterZ) {
 				if(!testCollision(probeBox, clusterBoxes[clusterZ]))
 				{
-					continue;
+					return;
 				}
 
 				ANKI_SET_IDX(3);
-			}
+			});
 		}
 	}
 
@@ -453,6 +735,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		Obb decalBox;
 		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_decals.getSize(); ++i)
 		{
+			const ObjectBounds& bounds = ctx.m_objectBounds[ctx.m_objectTypeOffsets[4] + i];
+			if(!bounds.touchesTile(tileX, tileY))
+			{
+				continue;
+			}
+
 			const DecalQueueElement& decal = ctx.m_in->m_renderQueue->m_decals[i];
 			decalBox.setCenter(decal.m_obbCenter.xyz0());
 			decalBox.setRotation(Mat3x4(Vec3(0.0f), decal.m_obbRotation));
@@ -463,15 +751,14 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
+			tileCtx.iterateClusters(bounds, [&](U32 clusterZ) {
 				if(!testCollision(decalBox, clusterBoxes[clusterZ]))
 				{
-					continue;
+					return;
 				}
 
 				ANKI_SET_IDX(4);
-			}
+			});
 		}
 	}
 
@@ -479,6 +766,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	{
 		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_fogDensityVolumes.getSize(); ++i)
 		{
+			const ObjectBounds& bounds = ctx.m_objectBounds[ctx.m_objectTypeOffsets[5] + i];
+			if(!bounds.touchesTile(tileX, tileY))
+			{
+				continue;
+			}
+
 			const FogDensityQueueElement& fogVol = ctx.m_in->m_renderQueue->m_fogDensityVolumes[i];
 
 			if(fogVol.m_isBox)
@@ -492,15 +785,14 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 					continue;
 				}
 
-				for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-				{
+				tileCtx.iterateClusters(bounds, [&](U32 clusterZ) {
 					if(!testCollision(box, clusterBoxes[clusterZ]))
 					{
-						continue;
+						return;
 					}
 
 					ANKI_SET_IDX(5);
-				}
+				});
 			}
 			else
 			{
@@ -513,15 +805,8 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 					continue;
 				}
 
-				for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-				{
-					if(!testCollision(sphere, clusterBoxes[clusterZ]))
-					{
-						continue;
-					}
-
-					ANKI_SET_IDX(5);
-				}
+				// The bounding sphere is the volume itself so the SIMD test is the exact test
+				tileCtx.iterateClusters(bounds, [&](U32 clusterZ) { ANKI_SET_IDX(5); });
 			}
 		}
 	}
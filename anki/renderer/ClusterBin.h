@@ -64,6 +64,7 @@ public:
 private:
 	class BinCtx;
 	class TileCtx;
+	class ObjectBounds;
 
 	HeapAllocator<U8> m_alloc;
 
@@ -77,6 +78,9 @@ private:
 
 	void prepare(BinCtx& ctx);
 
+	/// Compute the conservative range of tiles and Z slices that an object can touch.
+	void computeObjectBounds(U32 objectIdx, BinCtx& ctx) const;
+
 	void binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx);
 
 	void writeTypedObjectsToGpuBuffers(BinCtx& ctx) const;
@@ -22,6 +22,7 @@ AnimationResource::~AnimationResource()
 	}
 
 	m_channels.destroy(getAllocator());
+	m_keyframes.destroy(getAllocator());
 }
 
 Error AnimationResource::load(const ResourceFilename& filename, Bool async)
@@ -200,17 +201,73 @@ Error AnimationResource::load(const ResourceFilename& filename, Bool async)
 
 	m_duration = maxTime - m_startTime;
 
+	m_keyframes.create(getAllocator(), m_channels, m_startTime, m_duration);
+
 	return Error::NONE;
 }
 
-void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+void AnimationChannel::interpolate(Second time, Vec3& pos, Quat& rot, F32& scale) const
 {
 	pos = Vec3(0.0f);
 	rot = Quat::getIdentity();
 	scale = 1.0f;
 
+	// Position
+	if(m_positions.getSize() > 1)
+	{
+		for(U32 i = 0; i < m_positions.getSize() - 1; ++i)
+		{
+			const AnimationKeyframe<Vec3>& left = m_positions[i];
+			const AnimationKeyframe<Vec3>& right = m_positions[i + 1];
+			if(time >= left.getTime() && time <= right.getTime())
+			{
+				const Second u = (time - left.getTime()) / (right.getTime() - left.getTime());
+				pos = linearInterpolate(left.getValue(), right.getValue(), F32(u));
+				break;
+			}
+		}
+	}
+
+	// Rotation
+	if(m_rotations.getSize() > 1)
+	{
+		for(U32 i = 0; i < m_rotations.getSize() - 1; ++i)
+		{
+			const AnimationKeyframe<Quat>& left = m_rotations[i];
+			const AnimationKeyframe<Quat>& right = m_rotations[i + 1];
+			if(time >= left.getTime() && time <= right.getTime())
+			{
+				const Second u = (time - left.getTime()) / (right.getTime() - left.getTime());
+				rot = left.getValue().slerp(right.getValue(), F32(u));
+				break;
+			}
+		}
+	}
+
+	// Scale
+	if(m_scales.getSize() > 1)
+	{
+		for(U32 i = 0; i < m_scales.getSize() - 1; ++i)
+		{
+			const AnimationKeyframe<F32>& left = m_scales[i];
+			const AnimationKeyframe<F32>& right = m_scales[i + 1];
+			if(time >= left.getTime() && time <= right.getTime())
+			{
+				const Second u = (time - left.getTime()) / (right.getTime() - left.getTime());
+				scale = linearInterpolate(left.getValue(), right.getValue(), F32(u));
+				break;
+			}
+		}
+	}
+}
+
+void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+{
 	if(ANKI_UNLIKELY(time < m_startTime))
 	{
+		pos = Vec3(0.0f);
+		rot = Quat::getIdentity();
+		scale = 1.0f;
 		return;
 	}
 
@@ -223,53 +280,231 @@ void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Qu
 	ANKI_ASSERT(time >= m_startTime && time <= m_startTime + m_duration);
 	ANKI_ASSERT(channelIndex < m_channels.getSize());
 
-	const AnimationChannel& channel = m_channels[channelIndex];
+	m_channels[channelIndex].interpolate(time, pos, rot, scale);
+}
 
-	// Position
-	if(channel.m_positions.getSize() > 1)
+/// Find the key k so that times[k] <= time <= times[k + 1]. The search starts from the cursor's key.
+/// @return False if there is no such key.
+static Bool findKey(const F32* times, U32 keyCount, F32 time, U32& key)
+{
+	if(keyCount < 2)
+	{
+		return false;
+	}
+
+	if(key >= keyCount - 1 || time < times[key])
+	{
+		// The time went back (the animation looped or restarted), search from the start
+		key = 0;
+	}
+
+	while(key < keyCount - 1 && time > times[key + 1])
+	{
+		++key;
+	}
+
+	return key < keyCount - 1 && time >= times[key];
+}
+
+static Array<I16, 4> quantizeRotation(const Quat& q)
+{
+	Array<I16, 4> out;
+	for(U32 i = 0; i < 4; ++i)
 	{
-		for(U32 i = 0; i < channel.m_positions.getSize() - 1; ++i)
+		out[i] = I16(round(clamp(q[i], -1.0f, 1.0f) * F32(MAX_I16)));
+	}
+	return out;
+}
+
+static Quat dequantizeRotation(const Array<I16, 4>& q)
+{
+	// Don't use getNormalized(), it's not accurate enough
+	const Quat out = Quat(F32(q[0]), F32(q[1]), F32(q[2]), F32(q[3]));
+	return Quat(out / out.getLength());
+}
+
+void AnimationKeyframeSoa::create(ResourceAllocator<U8> alloc, ConstWeakArray<AnimationChannel> channels,
+								  Second startTime, Second duration)
+{
+	m_startTime = startTime;
+	m_duration = duration;
+
+	// Count the keys
+	U32 positionCount = 0;
+	U32 rotationCount = 0;
+	U32 scaleCount = 0;
+	for(const AnimationChannel& ch : channels)
+	{
+		positionCount += ch.m_positions.getSize();
+		rotationCount += ch.m_rotations.getSize();
+		scaleCount += ch.m_scales.getSize();
+	}
+
+	m_channels.create(alloc, channels.getSize());
+	m_positionTimes.create(alloc, positionCount);
+	m_positions.create(alloc, positionCount);
+	m_rotationTimes.create(alloc, rotationCount);
+	m_rotations.create(alloc, rotationCount);
+	m_scaleTimes.create(alloc, scaleCount);
+	m_scales.create(alloc, scaleCount);
+
+	// Copy the keys
+	positionCount = 0;
+	rotationCount = 0;
+	scaleCount = 0;
+	for(U32 c = 0; c < channels.getSize(); ++c)
+	{
+		const AnimationChannel& ch = channels[c];
+		Array<KeyRange, 3>& ranges = m_channels[c];
+
+		ranges[0] = {positionCount, ch.m_positions.getSize()};
+		for(const AnimationKeyframe<Vec3>& key : ch.m_positions)
 		{
-			const AnimationKeyframe<Vec3>& left = channel.m_positions[i];
-			const AnimationKeyframe<Vec3>& right = channel.m_positions[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				pos = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
-			}
+			m_positionTimes[positionCount] = F32(key.getTime() - startTime);
+			m_positions[positionCount] = key.getValue();
+			++positionCount;
 		}
+
+		ranges[1] = {rotationCount, ch.m_rotations.getSize()};
+		for(const AnimationKeyframe<Quat>& key : ch.m_rotations)
+		{
+			m_rotationTimes[rotationCount] = F32(key.getTime() - startTime);
+			m_rotations[rotationCount] = quantizeRotation(key.getValue());
+			++rotationCount;
+		}
+
+		ranges[2] = {scaleCount, ch.m_scales.getSize()};
+		for(const AnimationKeyframe<F32>& key : ch.m_scales)
+		{
+			m_scaleTimes[scaleCount] = F32(key.getTime() - startTime);
+			m_scales[scaleCount] = key.getValue();
+			++scaleCount;
+		}
+	}
+}
+
+void AnimationKeyframeSoa::destroy(ResourceAllocator<U8> alloc)
+{
+	m_channels.destroy(alloc);
+	m_positionTimes.destroy(alloc);
+	m_positions.destroy(alloc);
+	m_rotationTimes.destroy(alloc);
+	m_rotations.destroy(alloc);
+	m_scaleTimes.destroy(alloc);
+	m_scales.destroy(alloc);
+}
+
+void AnimationKeyframeSoa::createCursor(ResourceAllocator<U8> alloc, AnimationCursor& cursor) const
+{
+	ANKI_ASSERT(m_channels.getSize() > 0);
+	cursor.m_keys.destroy(alloc);
+	cursor.m_keys.create(alloc, m_channels.getSize(), {0, 0, 0});
+}
+
+Bool AnimationKeyframeSoa::adjustTime(Second time, F32& relativeTime) const
+{
+	if(ANKI_UNLIKELY(time < m_startTime))
+	{
+		return false;
+	}
+
+	time -= m_startTime;
+	if(time > m_duration && m_duration > 0.0)
+	{
+		time = mod(time, m_duration);
+	}
+
+	relativeTime = F32(time);
+	return true;
+}
+
+void AnimationKeyframeSoa::interpolateInternal(U32 channelIndex, F32 time, AnimationCursor& cursor, Vec3& pos,
+											   Quat& rot, F32& scale) const
+{
+	const Array<KeyRange, 3>& ranges = m_channels[channelIndex];
+	Array<U32, 3>& keys = cursor.m_keys[channelIndex];
+
+	// Position
+	const F32* times = &m_positionTimes[0] + ranges[0].m_offset;
+	if(findKey(times, ranges[0].m_count, time, keys[0]))
+	{
+		const U32 k = keys[0];
+		const F32 u = (time - times[k]) / (times[k + 1] - times[k]);
+		pos = linearInterpolate(m_positions[ranges[0].m_offset + k], m_positions[ranges[0].m_offset + k + 1], u);
+	}
+	else
+	{
+		pos = Vec3(0.0f);
 	}
 
 	// Rotation
-	if(channel.m_rotations.getSize() > 1)
+	times = &m_rotationTimes[0] + ranges[1].m_offset;
+	if(findKey(times, ranges[1].m_count, time, keys[1]))
 	{
-		for(U32 i = 0; i < channel.m_rotations.getSize() - 1; ++i)
-		{
-			const AnimationKeyframe<Quat>& left = channel.m_rotations[i];
-			const AnimationKeyframe<Quat>& right = channel.m_rotations[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				rot = left.m_value.slerp(right.m_value, F32(u));
-				break;
-			}
-		}
+		const U32 k = keys[1];
+		const F32 u = (time - times[k]) / (times[k + 1] - times[k]);
+		const Quat left = dequantizeRotation(m_rotations[ranges[1].m_offset + k]);
+		const Quat right = dequantizeRotation(m_rotations[ranges[1].m_offset + k + 1]);
+		rot = left.slerp(right, u);
+	}
+	else
+	{
+		rot = Quat::getIdentity();
 	}
 
 	// Scale
-	if(channel.m_scales.getSize() > 1)
+	times = &m_scaleTimes[0] + ranges[2].m_offset;
+	if(findKey(times, ranges[2].m_count, time, keys[2]))
+	{
+		const U32 k = keys[2];
+		const F32 u = (time - times[k]) / (times[k + 1] - times[k]);
+		scale = linearInterpolate(m_scales[ranges[2].m_offset + k], m_scales[ranges[2].m_offset + k + 1], u);
+	}
+	else
+	{
+		scale = 1.0f;
+	}
+}
+
+void AnimationKeyframeSoa::interpolate(U32 channelIndex, Second time, AnimationCursor& cursor, Vec3& pos, Quat& rot,
+									   F32& scale) const
+{
+	ANKI_ASSERT(channelIndex < m_channels.getSize());
+	ANKI_ASSERT(cursor.m_keys.getSize() == m_channels.getSize() && "Cursor created for a different animation");
+
+	F32 relativeTime;
+	if(adjustTime(time, relativeTime))
 	{
-		for(U32 i = 0; i < channel.m_scales.getSize() - 1; ++i)
+		interpolateInternal(channelIndex, relativeTime, cursor, pos, rot, scale);
+	}
+	else
+	{
+		pos = Vec3(0.0f);
+		rot = Quat::getIdentity();
+		scale = 1.0f;
+	}
+}
+
+void AnimationKeyframeSoa::interpolateAll(Second time, AnimationCursor& cursor,
+										  WeakArray<AnimationSample> samples) const
+{
+	ANKI_ASSERT(samples.getSize() == m_channels.getSize());
+	ANKI_ASSERT(cursor.m_keys.getSize() == m_channels.getSize() && "Cursor created for a different animation");
+
+	F32 relativeTime;
+	if(adjustTime(time, relativeTime))
+	{
+		for(U32 i = 0; i < m_channels.getSize(); ++i)
 		{
-			const AnimationKeyframe<F32>& left = channel.m_scales[i];
-			const AnimationKeyframe<F32>& right = channel.m_scales[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				scale = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
-			}
+			AnimationSample& sample = samples[i];
+			interpolateInternal(i, relativeTime, cursor, sample.m_position, sample.m_rotation, sample.m_scale);
+		}
+	}
+	else
+	{
+		for(AnimationSample& sample : samples)
+		{
+			sample = {Vec3(0.0f), Quat::getIdentity(), 1.0f};
 		}
 	}
 }
@@ -8,6 +8,7 @@
 #include <anki/resource/ResourceObject.h>
 #include <anki/Math.h>
 #include <anki/util/String.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -25,6 +26,14 @@ class AnimationKeyframe
 	friend class AnimationResource;
 
 public:
+	AnimationKeyframe() = default;
+
+	AnimationKeyframe(Second time, const T& value)
+		: m_time(time)
+		, m_value(value)
+	{
+	}
+
 	Second getTime() const
 	{
 		return m_time;
@@ -61,6 +70,94 @@ public:
 		m_scales.destroy(alloc);
 		m_cameraFovs.destroy(alloc);
 	}
+
+	/// Interpolate the keyframes. It searches all keyframes every time so it's slow. See AnimationKeyframeSoa.
+	/// @param time The time in the same space as the keyframe times.
+	void interpolate(Second time, Vec3& position, Quat& rotation, F32& scale) const;
+};
+
+/// The interpolated transform of an animation channel.
+class AnimationSample
+{
+public:
+	Vec3 m_position;
+	Quat m_rotation;
+	F32 m_scale;
+};
+
+/// Remembers the keyframes that were used the last time an animation was sampled. When the animation plays forward the
+/// next search starts from there and it's almost free. Every animation instance needs its own cursor.
+class AnimationCursor
+{
+	friend class AnimationKeyframeSoa;
+
+public:
+	void destroy(ResourceAllocator<U8> alloc)
+	{
+		m_keys.destroy(alloc);
+	}
+
+	Bool isCreated() const
+	{
+		return m_keys.getSize() > 0;
+	}
+
+private:
+	DynamicArray<Array<U32, 3>> m_keys; ///< The position, rotation and scale key of every channel.
+};
+
+/// The keyframes of all the channels of an animation in a compact structure of arrays layout. The key times are stored
+/// apart from the values so the searches touch less memory. The rotations are quantized to 16bit.
+class AnimationKeyframeSoa
+{
+public:
+	void create(ResourceAllocator<U8> alloc, ConstWeakArray<AnimationChannel> channels, Second startTime,
+				Second duration);
+
+	void destroy(ResourceAllocator<U8> alloc);
+
+	U32 getChannelCount() const
+	{
+		return m_channels.getSize();
+	}
+
+	/// Create a cursor that can be used to sample this animation.
+	void createCursor(ResourceAllocator<U8> alloc, AnimationCursor& cursor) const;
+
+	/// Same as AnimationResource::interpolate() but it uses a cursor to find the keyframes.
+	void interpolate(U32 channelIndex, Second time, AnimationCursor& cursor, Vec3& position, Quat& rotation,
+					 F32& scale) const;
+
+	/// Interpolate all channels at once.
+	/// @param[out] samples One sample for each channel.
+	void interpolateAll(Second time, AnimationCursor& cursor, WeakArray<AnimationSample> samples) const;
+
+private:
+	/// Some keys of a channel.
+	class KeyRange
+	{
+	public:
+		U32 m_offset;
+		U32 m_count;
+	};
+
+	DynamicArray<Array<KeyRange, 3>> m_channels; ///< The position, rotation and scale keys of every channel.
+
+	DynamicArray<F32> m_positionTimes; ///< Relative to the start time.
+	DynamicArray<Vec3> m_positions;
+	DynamicArray<F32> m_rotationTimes; ///< Relative to the start time.
+	DynamicArray<Array<I16, 4>> m_rotations; ///< Normalized 16bit integers.
+	DynamicArray<F32> m_scaleTimes; ///< Relative to the start time.
+	DynamicArray<F32> m_scales;
+
+	Second m_startTime = 0.0;
+	Second m_duration = 0.0;
+
+	/// Bring the time inside the animation. Returns false if the animation hasn't started yet.
+	Bool adjustTime(Second time, F32& relativeTime) const;
+
+	void interpolateInternal(U32 channelIndex, F32 relativeTime, AnimationCursor& cursor, Vec3& position,
+							 Quat& rotation, F32& scale) const;
 };
 
 /// Animation consists of keyframe data.
@@ -94,8 +191,29 @@ public:
 	/// Get the interpolated data
 	void interpolate(U32 channelIndex, Second time, Vec3& position, Quat& rotation, F32& scale) const;
 
+	/// Create a cursor for the faster interpolate functions.
+	void createCursor(ResourceAllocator<U8> alloc, AnimationCursor& cursor) const
+	{
+		m_keyframes.createCursor(alloc, cursor);
+	}
+
+	/// Get the interpolated data using a cursor. It's faster when the time increases from call to call.
+	void interpolate(U32 channelIndex, Second time, AnimationCursor& cursor, Vec3& position, Quat& rotation,
+					 F32& scale) const
+	{
+		m_keyframes.interpolate(channelIndex, time, cursor, position, rotation, scale);
+	}
+
+	/// Get the interpolated data of all channels.
+	/// @param[out] samples One sample for each channel.
+	void interpolateAll(Second time, AnimationCursor& cursor, WeakArray<AnimationSample> samples) const
+	{
+		m_keyframes.interpolateAll(time, cursor, samples);
+	}
+
 private:
 	DynamicArray<AnimationChannel> m_channels;
+	AnimationKeyframeSoa m_keyframes;
 	Second m_duration;
 	Second m_startTime;
 };
@@ -10,3 +10,9 @@ ANKI_CONFIG_OPTION(
 	"The engine loads assets only in from these paths. Separate them with : (it's smart enough to identify drive "
 	"letters in Windows)")
 ANKI_CONFIG_OPTION(rsrc_transferScratchMemorySize, 256_MB, 1_MB, 4_GB)
+ANKI_CONFIG_OPTION(rsrc_memoryMapFiles, 1, 0, 1,
+				   "Memory map the resource files and the uncompressed files of archives instead of streaming them")
+ANKI_CONFIG_OPTION(rsrc_shaderVariantCache, 1, 0, 1,
+				   "Remember the shader program variants that were used and create them when the programs load")
+ANKI_CONFIG_OPTION(rsrc_asyncShaderVariants, 1, 0, 1,
+				   "Create the detailed LOD material variants in the background and draw with the lowest LOD meanwhile")
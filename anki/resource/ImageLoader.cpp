@@ -159,6 +159,17 @@ public:
 		ANKI_ASSERT(!"Not Implemented");
 		return MAX_PTR_SIZE;
 	}
+
+	virtual Bool isMemoryMapped() const
+	{
+		return false;
+	}
+
+	virtual ANKI_USE_RESULT Error readView(PtrSize size, ConstWeakArray<U8>& view)
+	{
+		ANKI_ASSERT(!"Not Implemented");
+		return Error::FUNCTION_FAILED;
+	}
 };
 
 class ImageLoader::RsrcFile : public FileInterface
@@ -180,6 +191,16 @@ public:
 	{
 		return m_rfile->getSize();
 	}
+
+	Bool isMemoryMapped() const final
+	{
+		return m_rfile->isMemoryMapped();
+	}
+
+	ANKI_USE_RESULT Error readView(PtrSize size, ConstWeakArray<U8>& view) final
+	{
+		return m_rfile->readView(size, view);
+	}
 };
 
 class ImageLoader::SystemFile : public FileInterface
@@ -508,8 +529,15 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 						surf.m_width = mipWidth;
 						surf.m_height = mipHeight;
 
-						surf.m_data.create(alloc, dataSize);
-						ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						if(file.isMemoryMapped())
+						{
+							ANKI_CHECK(file.readView(dataSize, surf.m_mappedData));
+						}
+						else
+						{
+							surf.m_data.create(alloc, dataSize);
+							ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						}
 
 						mipCount = max(header.m_mipCount - mip, mipCount);
 					}
@@ -546,8 +574,15 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 				vol.m_height = mipHeight;
 				vol.m_depth = mipDepth;
 
-				vol.m_data.create(alloc, dataSize);
-				ANKI_CHECK(file.read(&vol.m_data[0], dataSize));
+				if(file.isMemoryMapped())
+				{
+					ANKI_CHECK(file.readView(dataSize, vol.m_mappedData));
+				}
+				else
+				{
+					vol.m_data.create(alloc, dataSize);
+					ANKI_CHECK(file.read(&vol.m_data[0], dataSize));
+				}
 
 				mipCount = max(header.m_mipCount - mip, mipCount);
 			}
@@ -572,15 +607,24 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 Error ImageLoader::loadStb(FileInterface& fs, U32& width, U32& height, DynamicArray<U8>& data,
 						   GenericMemoryPoolAllocator<U8>& alloc)
 {
-	// Read the file
+	// Read the file. If it's mapped decode it straight from the mapping
 	DynamicArrayAuto<U8> fileData = {alloc};
+	ConstWeakArray<U8> fileView;
 	const PtrSize fileSize = fs.getSize();
-	fileData.create(U32(fileSize));
-	ANKI_CHECK(fs.read(&fileData[0], fileSize));
+	if(fs.isMemoryMapped())
+	{
+		ANKI_CHECK(fs.readView(fileSize, fileView));
+	}
+	else
+	{
+		fileData.create(U32(fileSize));
+		ANKI_CHECK(fs.read(&fileData[0], fileSize));
+		fileView = ConstWeakArray<U8>(fileData);
+	}
 
 	// Use STB to read the image
 	int stbw, stbh, comp;
-	U8* stbdata = reinterpret_cast<U8*>(stbi_load_from_memory(&fileData[0], I32(fileSize), &stbw, &stbh, &comp, 4));
+	U8* stbdata = reinterpret_cast<U8*>(stbi_load_from_memory(&fileView[0], I32(fileSize), &stbw, &stbh, &comp, 4));
 	if(!stbdata)
 	{
 		ANKI_RESOURCE_LOGE("STB failed to read image");
@@ -604,6 +648,11 @@ Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxT
 	RsrcFile file;
 	file.m_rfile = rfile;
 
+	if(rfile->isMemoryMapped())
+	{
+		m_mappedFile = rfile;
+	}
+
 	const Error err = loadInternal(file, filename, maxTextureSize);
 	if(err)
 	{
@@ -752,6 +801,8 @@ void ImageLoader::destroy()
 	}
 
 	m_volumes.destroy(m_alloc);
+
+	m_mappedFile.reset(nullptr);
 }
 
 } // end namespace anki
@@ -50,6 +50,13 @@ public:
 	U32 m_width;
 	U32 m_height;
 	DynamicArray<U8> m_data;
+	ConstWeakArray<U8> m_mappedData; ///< Points to the memory mapped file if the data weren't copied to m_data.
+
+	/// Get the data no matter where they are stored.
+	ConstWeakArray<U8> getData() const
+	{
+		return (m_data.getSize()) ? ConstWeakArray<U8>(m_data) : m_mappedData;
+	}
 };
 
 /// An image volume
@@ -61,6 +68,13 @@ public:
 	U32 m_height;
 	U32 m_depth;
 	DynamicArray<U8> m_data;
+	ConstWeakArray<U8> m_mappedData; ///< Points to the memory mapped file if the data weren't copied to m_data.
+
+	/// Get the data no matter where they are stored.
+	ConstWeakArray<U8> getData() const
+	{
+		return (m_data.getSize()) ? ConstWeakArray<U8>(m_data) : m_mappedData;
+	}
 };
 
 /// Loads bitmaps from regular system files or resource files. Supported formats are .tga and .ankitex.
@@ -127,7 +141,8 @@ public:
 
 	const ImageLoaderVolume& getVolume(U32 level) const;
 
-	/// Load a resource image file.
+	/// Load a resource image file. If the file is memory mapped the surfaces and volumes of .ankitex files will point
+	/// to the mapping instead of holding a copy of the data. The loader keeps the file alive in that case.
 	ANKI_USE_RESULT Error load(ResourceFilePtr file, const CString& filename, U32 maxTextureSize = MAX_U32);
 
 	/// Load a system image file.
@@ -146,6 +161,8 @@ private:
 
 	DynamicArray<ImageLoaderVolume> m_volumes;
 
+	ResourceFilePtr m_mappedFile; ///< Keep the file alive if the surfaces or the volumes point to its mapping.
+
 	U32 m_mipCount = 0;
 	U32 m_width = 0;
 	U32 m_height = 0;
@@ -832,17 +832,46 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 		}
 	}
 
-	// Not initialized, init it
+	// Not initialized. Get the program variant without holding the lock, the program has its own
+	ShaderProgramResourceVariantInitInfo initInfo(m_prog);
+	initProgramVariantInitInfo(key, initInfo);
+
+	// The lowest detail LOD uses the same vertex attributes and uniforms. Draw with it while the requested LOD is
+	// created in the background
+	RenderingKey fallbackKey = key;
+	fallbackKey.setLod(m_lodCount - 1u);
+
+	const ShaderProgramResourceVariant* progVariant;
+	if(fallbackKey.getLod() != key.getLod() && getManager().getAsyncShaderVariantsEnabled())
+	{
+		ShaderProgramResourceVariantInitInfo fallbackInitInfo(m_prog);
+		initProgramVariantInitInfo(fallbackKey, fallbackInitInfo);
+
+		if(!m_prog->getOrCreateVariantAsync(initInfo, fallbackInitInfo, progVariant))
+		{
+			return getOrCreateVariant(fallbackKey);
+		}
+	}
+	else
+	{
+		m_prog->getOrCreateVariant(initInfo, progVariant);
+	}
+
+	// Init the variant
 	WLockGuard<RWMutex> lock(m_variantMatrixMtx);
 
 	// Check again
-	if(variant.m_prog.isCreated())
+	if(!variant.m_prog.isCreated())
 	{
-		return variant;
+		initVariant(*progVariant, variant, key.getInstanceCount());
 	}
 
-	ShaderProgramResourceVariantInitInfo initInfo(m_prog);
+	return variant;
+}
 
+void MaterialResource::initProgramVariantInitInfo(const RenderingKey& key,
+												  ShaderProgramResourceVariantInitInfo& initInfo) const
+{
 	for(const SubMutation& m : m_nonBuiltinsMutation)
 	{
 		initInfo.addMutation(m.m_mutator->m_name, m.m_value);
@@ -898,14 +927,6 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 			ANKI_ASSERT(0);
 		}
 	}
-
-	const ShaderProgramResourceVariant* progVariant;
-	m_prog->getOrCreateVariant(initInfo, progVariant);
-
-	// Init the variant
-	initVariant(*progVariant, variant, key.getInstanceCount());
-
-	return variant;
 }
 
 void MaterialResource::initVariant(const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant,
@@ -1148,8 +1169,12 @@ Error MaterialResource::parseRtMaterial(XmlElement rtMaterialEl)
 			variantInitInfo.addMutation(subMutation.m_mutator->m_name, subMutation.m_value);
 		}
 
+		// Ray tracing variants only look up their group in the prebuilt library so the async call never falls back
 		const ShaderProgramResourceVariant* progVariant;
-		m_rtPrograms[type]->getOrCreateVariant(variantInitInfo, progVariant);
+		const Bool requestedVariant =
+			m_rtPrograms[type]->getOrCreateVariantAsync(variantInitInfo, variantInitInfo, progVariant);
+		ANKI_ASSERT(requestedVariant);
+		(void)requestedVariant;
 		m_rtShaderGroupHandleIndices[type] = progVariant->getHitShaderGroupHandleIndex();
 
 		// Advance
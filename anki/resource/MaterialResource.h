@@ -340,6 +340,9 @@ public:
 		return m_uboBinding;
 	}
 
+	/// Get or create the variant of a key. If the program variant of a LOD is not created yet it's created in the
+	/// background and the variant of the lowest detail LOD is returned in the meantime.
+	/// @note It's thread-safe.
 	const MaterialVariant& getOrCreateVariant(const RenderingKey& key) const;
 
 	U32 getShaderGroupHandleIndex(RayType type) const
@@ -421,6 +424,9 @@ private:
 	void initVariant(const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant,
 					 U32 instanceCount) const;
 
+	/// Set the mutation and the constants of the program variant that matches a key.
+	void initProgramVariantInitInfo(const RenderingKey& key, ShaderProgramResourceVariantInitInfo& initInfo) const;
+
 	const MaterialVariable* tryFindVariableInternal(CString name) const
 	{
 		for(const MaterialVariable& v : m_vars)
@@ -193,6 +193,120 @@ public:
 	}
 };
 
+/// A file that is memory mapped. It's either a whole file of a directory or a stored (uncompressed) file of an archive
+/// that lives inside the mapping of the whole archive.
+class MmapResourceFile final : public ResourceFile
+{
+public:
+	MemoryMappedFile m_mapping; ///< Only used if it's not a file inside an archive.
+	const U8* m_data = nullptr;
+	PtrSize m_size = 0;
+	PtrSize m_pos = 0;
+
+	MmapResourceFile(GenericMemoryPoolAllocator<U8> alloc)
+		: ResourceFile(alloc)
+	{
+	}
+
+	/// Map a file of a directory. It's quiet on failure since there is a fallback.
+	Bool tryOpen(const CString& filename)
+	{
+		if(!m_mapping.tryOpen(filename))
+		{
+			return false;
+		}
+
+		m_data = m_mapping.getData();
+		m_size = m_mapping.getSize();
+		return true;
+	}
+
+	void openArchived(const MemoryMappedFile& archive, PtrSize offset, PtrSize size)
+	{
+		ANKI_ASSERT(offset + size <= archive.getSize());
+		m_data = archive.getData() + offset;
+		m_size = size;
+	}
+
+	ANKI_USE_RESULT Error read(void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+		ConstWeakArray<U8> view;
+		ANKI_CHECK(readView(size, view));
+		memcpy(buff, view.getBegin(), size);
+		return Error::NONE;
+	}
+
+	ANKI_USE_RESULT Error readAllText(StringAuto& out) override
+	{
+		ANKI_ASSERT(m_pos == 0);
+		out.create('?', m_size);
+		return read(&out[0], m_size);
+	}
+
+	ANKI_USE_RESULT Error readU32(U32& u) override
+	{
+		// Assume machine and file have same endianness
+		return read(&u, sizeof(u));
+	}
+
+	ANKI_USE_RESULT Error readF32(F32& f) override
+	{
+		// Assume machine and file have same endianness
+		return read(&f, sizeof(f));
+	}
+
+	ANKI_USE_RESULT Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize newPos;
+		switch(origin)
+		{
+		case FileSeekOrigin::BEGINNING:
+			newPos = offset;
+			break;
+		case FileSeekOrigin::CURRENT:
+			newPos = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::END);
+			newPos = m_size + offset;
+		}
+
+		if(newPos > m_size)
+		{
+			ANKI_RESOURCE_LOGE("Seeking outside the file");
+			return Error::FUNCTION_FAILED;
+		}
+
+		m_pos = newPos;
+		return Error::NONE;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_size;
+	}
+
+	Bool isMemoryMapped() const override
+	{
+		return true;
+	}
+
+	ANKI_USE_RESULT Error readView(PtrSize size, ConstWeakArray<U8>& view) override
+	{
+		if(size > m_size - m_pos)
+		{
+			ANKI_RESOURCE_LOGE("File read failed");
+			return Error::FILE_ACCESS;
+		}
+
+		ANKI_ASSERT(size <= MAX_U32);
+		view = ConstWeakArray<U8>(m_data + m_pos, U32(size));
+		m_pos += size;
+		return Error::NONE;
+	}
+};
+
 ResourceFilesystem::~ResourceFilesystem()
 {
 	for(Path& p : m_paths)
@@ -207,6 +321,8 @@ ResourceFilesystem::~ResourceFilesystem()
 
 Error ResourceFilesystem::init(const ConfigSet& config, const CString& cacheDir)
 {
+	m_memoryMapFiles = config.getBool("rsrc_memoryMapFiles");
+
 	StringListAuto paths(m_alloc);
 	paths.splitString(config.getString("rsrc_dataPaths"), ':');
 
@@ -310,8 +426,15 @@ Error ResourceFilesystem::addNewPath(const CString& path)
 			}
 		} while(unzGoToNextFile(zfile) == UNZ_OK);
 
-		m_paths.emplaceFront(m_alloc, std::move(p));
 		unzClose(zfile);
+
+		// Map the whole archive. The stored files will be read straight from the mapping
+		if(m_memoryMapFiles && !p.m_archiveMapping.tryOpen(path))
+		{
+			ANKI_RESOURCE_LOGW("Failed to map archive. Will stream all of its files: %s", &path[0]);
+		}
+
+		m_paths.emplaceFront(m_alloc, std::move(p));
 	}
 	else
 	{
@@ -390,8 +513,14 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 					continue;
 				}
 
-				// Found
-				if(p.m_isArchive)
+				// Found. Prefer to map it
+				rfile = tryOpenMemoryMappedFile(p, filename);
+
+				if(rfile)
+				{
+					// Mapped, nothing else to do
+				}
+				else if(p.m_isArchive)
 				{
 					ZipResourceFile* file = m_alloc.newInstance<ZipResourceFile>(m_alloc);
 					rfile = file;
@@ -438,4 +567,62 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 	return Error::NONE;
 }
 
+ResourceFile* ResourceFilesystem::tryOpenMemoryMappedFile(const Path& path, const ResourceFilename& filename)
+{
+	if(!m_memoryMapFiles)
+	{
+		return nullptr;
+	}
+
+	if(!path.m_isArchive)
+	{
+		StringAuto fname(m_alloc);
+		fname.sprintf("%s/%s", &path.m_path[0], &filename[0]);
+
+		MmapResourceFile* file = m_alloc.newInstance<MmapResourceFile>(m_alloc);
+		if(!file->tryOpen(fname.toCString()))
+		{
+			m_alloc.deleteInstance(file);
+			return nullptr;
+		}
+
+		return file;
+	}
+
+	if(!path.m_archiveMapping.isOpen())
+	{
+		return nullptr;
+	}
+
+	// Only the stored files can be read from the mapping. Find where their data start
+	unzFile zfile = unzOpen(&path.m_path[0]);
+	if(!zfile)
+	{
+		return nullptr;
+	}
+
+	ResourceFile* out = nullptr;
+	const int caseSensitive = 1;
+	unz_file_info info;
+	if(unzLocateFile(zfile, &filename[0], caseSensitive) == UNZ_OK
+	   && unzGetCurrentFileInfo(zfile, &info, nullptr, 0, nullptr, 0, nullptr, 0) == UNZ_OK
+	   && info.compression_method == 0 // Stored
+	   && (info.flag & 1) == 0 // Not encrypted
+	   && unzOpenCurrentFile(zfile) == UNZ_OK)
+	{
+		const PtrSize offset = PtrSize(unzGetCurrentFileZStreamPos64(zfile));
+		unzCloseCurrentFile(zfile);
+
+		if(offset + info.uncompressed_size <= path.m_archiveMapping.getSize())
+		{
+			MmapResourceFile* file = m_alloc.newInstance<MmapResourceFile>(m_alloc);
+			file->openArchived(path.m_archiveMapping, offset, info.uncompressed_size);
+			out = file;
+		}
+	}
+
+	unzClose(zfile);
+	return out;
+}
+
 } // end namespace anki
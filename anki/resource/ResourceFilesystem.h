@@ -10,6 +10,7 @@
 #include <anki/util/StringList.h>
 #include <anki/util/File.h>
 #include <anki/util/Ptr.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -53,6 +54,21 @@ public:
 	/// Get the size of the file.
 	virtual PtrSize getSize() const = 0;
 
+	/// Return true if the contents of the file are memory mapped and readView() can be used.
+	virtual Bool isMemoryMapped() const
+	{
+		return false;
+	}
+
+	/// Get a view to the next size bytes of the file without copying them. It moves the position indicator like
+	/// read() does. The view is valid for as long as the file is alive.
+	/// @note Only valid if isMemoryMapped() returns true.
+	virtual ANKI_USE_RESULT Error readView(PtrSize size, ConstWeakArray<U8>& view)
+	{
+		ANKI_ASSERT(!"Not memory mapped");
+		return Error::FUNCTION_FAILED;
+	}
+
 	Atomic<I32>& getRefcount()
 	{
 		return m_refcount;
@@ -109,6 +125,7 @@ private:
 	public:
 		StringList m_files; ///< Files inside the directory.
 		String m_path; ///< A directory or an archive.
+		MemoryMappedFile m_archiveMapping; ///< The whole archive mapped. Used for the stored (uncompressed) files.
 		Bool m_isArchive = false;
 		Bool m_isCache = false;
 
@@ -117,6 +134,7 @@ private:
 		Path(Path&& b)
 			: m_files(std::move(b.m_files))
 			, m_path(std::move(b.m_path))
+			, m_archiveMapping(std::move(b.m_archiveMapping))
 			, m_isArchive(std::move(b.m_isArchive))
 			, m_isCache(std::move(b.m_isCache))
 		{
@@ -126,6 +144,7 @@ private:
 		{
 			m_files = std::move(b.m_files);
 			m_path = std::move(b.m_path);
+			m_archiveMapping = std::move(b.m_archiveMapping);
 			m_isArchive = std::move(b.m_isArchive);
 			m_isCache = std::move(b.m_isCache);
 			return *this;
@@ -135,6 +154,11 @@ private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	List<Path> m_paths;
 	String m_cacheDir;
+	Bool m_memoryMapFiles = true;
+
+	/// Try to open a file as a memory mapped file.
+	/// @return nullptr if the file can't be mapped and the caller should fallback to the other file types.
+	ResourceFile* tryOpenMemoryMappedFile(const Path& path, const ResourceFilename& filename);
 
 	/// Add a filesystem path or an archive. The path is read-only.
 	ANKI_USE_RESULT Error addNewPath(const CString& path);
@@ -31,10 +31,11 @@ ResourceManager::ResourceManager()
 
 ResourceManager::~ResourceManager()
 {
-	m_cacheDir.destroy(m_alloc);
+	// The loader's tasks might hold the last references of resources. Those might still need the manager's state
 	m_alloc.deleteInstance(m_asyncLoader);
 	m_alloc.deleteInstance(m_shaderProgramSystem);
 	m_alloc.deleteInstance(m_transferGpuAlloc);
+	m_cacheDir.destroy(m_alloc);
 }
 
 Error ResourceManager::init(ResourceManagerInitInfo& init)
@@ -51,6 +52,8 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	// Init some constants
 	m_maxTextureSize = init.m_config->getNumberU32("rsrc_maxTextureSize");
 	m_dumpShaderSource = init.m_config->getBool("rsrc_dumpShaderSources");
+	m_shaderVariantCache = init.m_config->getBool("rsrc_shaderVariantCache");
+	m_asyncShaderVariants = init.m_config->getBool("rsrc_asyncShaderVariants");
 
 	// Init type resource managers
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) TypeResourceManager<rsrc_>::init(m_alloc);
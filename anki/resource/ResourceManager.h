@@ -140,6 +140,16 @@ public:
 		return m_dumpShaderSource;
 	}
 
+	ANKI_INTERNAL Bool getShaderVariantCacheEnabled() const
+	{
+		return m_shaderVariantCache;
+	}
+
+	ANKI_INTERNAL Bool getAsyncShaderVariantsEnabled() const
+	{
+		return m_asyncShaderVariants;
+	}
+
 	ANKI_INTERNAL ResourceAllocator<U8>& getAllocator()
 	{
 		return m_alloc;
@@ -230,6 +240,8 @@ private:
 	U64 m_loadRequestCount = 0;
 	TransferGpuAllocator* m_transferGpuAlloc = nullptr;
 	Bool m_dumpShaderSource = false;
+	Bool m_shaderVariantCache = false;
+	Bool m_asyncShaderVariants = false;
 };
 /// @}
 
@@ -6,14 +6,56 @@
 #include <anki/resource/ShaderProgramResource.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/ShaderProgramResourceSystem.h>
+#include <anki/resource/AsyncLoader.h>
 #include <anki/gr/ShaderProgram.h>
 #include <anki/gr/GrManager.h>
 #include <anki/util/Filesystem.h>
 #include <anki/util/Functions.h>
+#include <anki/util/File.h>
+#include <anki/util/Tracer.h>
 
 namespace anki
 {
 
+/// The header of the file that holds the variant records.
+class ShaderVariantCacheHeader
+{
+public:
+	Array<char, 8> m_magic;
+	U64 m_layoutHash; ///< Hash of the mutators and the constants. Used to identify a stale cache.
+	U32 m_recordSize;
+	U32 m_recordCount;
+};
+
+static const char* SHADER_VARIANT_CACHE_MAGIC = "ANKIVRC1";
+
+/// Creates a variant in the async loader thread.
+class ShaderProgramResource::CreateVariantTask : public AsyncLoaderTask
+{
+public:
+	ShaderProgramResourcePtr m_rsrc; ///< Keep the resource alive.
+	VariantInitInfo m_info;
+	ShaderProgramResourceVariant* m_variant;
+
+	CreateVariantTask(const ShaderProgramResource* rsrc, const VariantInitInfo& info,
+					  ShaderProgramResourceVariant* variant)
+		: m_rsrc(const_cast<ShaderProgramResource*>(rsrc))
+		, m_variant(variant)
+	{
+		// The constant values are not copyable, copy the raw memory
+		memcpy(&m_info.m_constantValues[0], &info.m_constantValues[0], sizeof(info.m_constantValues));
+		m_info.m_setConstants = info.m_setConstants;
+		m_info.m_mutation = info.m_mutation;
+		m_info.m_setMutators = info.m_setMutators;
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		m_rsrc->initPendingVariant(m_info, *m_variant, false);
+		return Error::NONE;
+	}
+};
+
 ShaderProgramResourceVariant::ShaderProgramResourceVariant()
 {
 }
@@ -30,6 +72,13 @@ ShaderProgramResource::ShaderProgramResource(ResourceManager* manager)
 
 ShaderProgramResource::~ShaderProgramResource()
 {
+	if(m_variantCacheDirty)
+	{
+		saveVariantCache();
+	}
+	m_variantCacheRecords.destroy(getAllocator());
+	m_variantCacheFilename.destroy(getAllocator());
+
 	m_mutators.destroy(getAllocator());
 
 	for(ShaderProgramResourceConstant& c : m_consts)
@@ -57,6 +106,13 @@ Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 	ANKI_CHECK(m_binary.deserializeFromFile(binaryFilename));
 	const ShaderProgramBinary& binary = m_binary.getBinary();
 
+	// Build the variant cache filename now. The program might outlive the manager's cache directory
+	if(getManager().getShaderVariantCacheEnabled())
+	{
+		m_variantCacheFilename.sprintf(getAllocator(), "%s/%svariants", getManager().getCacheDirectory().cstr(),
+									   baseFilename.cstr());
+	}
+
 	// Create the mutators
 	if(binary.m_mutators.getSize() > 0)
 	{
@@ -177,6 +233,12 @@ Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 		}
 	}
 
+	// Create the variants that were used in the previous runs
+	if(getManager().getShaderVariantCacheEnabled())
+	{
+		loadVariantCache();
+	}
+
 	return Error::NONE;
 }
 
@@ -206,14 +268,8 @@ Error ShaderProgramResource::parseConst(CString constName, U32& componentIdx, U3
 	return Error::NONE;
 }
 
-void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVariantInitInfo& info,
-											   const ShaderProgramResourceVariant*& variant) const
+U64 ShaderProgramResource::computeVariantHash(const VariantInitInfo& info) const
 {
-	// Sanity checks
-	ANKI_ASSERT(info.m_setMutators.getEnabledBitCount() == m_mutators.getSize());
-	ANKI_ASSERT(info.m_setConstants.getEnabledBitCount() == m_consts.getSize());
-
-	// Compute variant hash
 	U64 hash = 0;
 	if(m_mutators.getSize())
 	{
@@ -226,39 +282,135 @@ void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVarian
 			appendHash(info.m_constantValues.getBegin(), m_consts.getSize() * sizeof(info.m_constantValues[0]), hash);
 	}
 
+	return hash;
+}
+
+Bool ShaderProgramResource::findOrNewVariant(const VariantInitInfo& info, ShaderProgramResourceVariant*& variant) const
+{
+	// Sanity checks
+	ANKI_ASSERT(info.m_setMutators.getEnabledBitCount() == m_mutators.getSize());
+	ANKI_ASSERT(info.m_setConstants.getEnabledBitCount() == m_consts.getSize());
+
+	const U64 hash = computeVariantHash(info);
+
 	// Check if the variant is in the cache
 	{
 		RLockGuard<RWMutex> lock(m_mtx);
 
 		auto it = m_variants.find(hash);
-		variant = (it != m_variants.getEnd()) ? *it : nullptr;
-
-		if(variant != nullptr)
+		if(it != m_variants.getEnd())
 		{
-			// Done
-			return;
+			variant = *it;
+			return false;
 		}
 	}
 
-	// Create the variant
 	WLockGuard<RWMutex> lock(m_mtx);
 
 	// Check again
 	auto it = m_variants.find(hash);
-	variant = (it != m_variants.getEnd()) ? *it : nullptr;
-	if(variant != nullptr)
+	if(it != m_variants.getEnd())
 	{
-		// Done
-		return;
+		variant = *it;
+		return false;
+	}
+
+	// Create a pending variant. It will be initialized outside the lock
+	variant = getAllocator().newInstance<ShaderProgramResourceVariant>();
+	m_variants.emplace(getAllocator(), hash, variant);
+
+	// Remember it for the next runs
+	if(getManager().getShaderVariantCacheEnabled())
+	{
+		const U32 recordSize = getVariantCacheRecordSize();
+		if(recordSize > 0)
+		{
+			const U32 offset = m_variantCacheRecords.getSize();
+			m_variantCacheRecords.resize(getAllocator(), offset + recordSize);
+			U8* record = &m_variantCacheRecords[offset];
+			memcpy(record, info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(MutatorValue));
+			record += m_mutators.getSize() * sizeof(MutatorValue);
+			memcpy(record, info.m_constantValues.getBegin(), m_consts.getSize() * sizeof(info.m_constantValues[0]));
+		}
+
+		++m_variantCacheRecordCount;
+		m_variantCacheDirty = true;
+	}
+
+	return true;
+}
+
+void ShaderProgramResource::initPendingVariant(const VariantInitInfo& info, ShaderProgramResourceVariant& variant,
+											   Bool wait) const
+{
+	Variant::State expected = Variant::State::PENDING;
+	if(variant.m_state.compareExchange(expected, Variant::State::CREATING))
+	{
+		ANKI_TRACE_SCOPED_EVENT(RSRC_SHADER_VARIANT_CREATE);
+		initVariant(info, variant);
+
+		{
+			// Change the state under the lock or a waiter might miss the notification
+			LockGuard<Mutex> lock(m_variantReadyMtx);
+			variant.m_state.store(Variant::State::READY, AtomicMemoryOrder::RELEASE);
+		}
+
+		m_variantReadyCondVar.notifyAll();
+	}
+	else if(wait)
+	{
+		// Some other thread creates it, wait for it. The variant is CREATING here so the creator is already running.
+		// Never wait for a PENDING one because the caller might be the async loader that would create it
+		LockGuard<Mutex> lock(m_variantReadyMtx);
+		while(variant.m_state.load(AtomicMemoryOrder::ACQUIRE) != Variant::State::READY)
+		{
+			m_variantReadyCondVar.wait(m_variantReadyMtx);
+		}
+	}
+}
+
+void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVariantInitInfo& info,
+											   const ShaderProgramResourceVariant*& variant) const
+{
+	ShaderProgramResourceVariant* v;
+	findOrNewVariant(info, v);
+
+	if(v->m_state.load(AtomicMemoryOrder::ACQUIRE) != Variant::State::READY)
+	{
+		// Pending or creating. Don't wait for the async loader, create it in this thread
+		initPendingVariant(info, *v, true);
 	}
 
-	// Create
-	ShaderProgramResourceVariant* v = getAllocator().newInstance<ShaderProgramResourceVariant>();
-	initVariant(info, *v);
-	m_variants.emplace(getAllocator(), hash, v);
 	variant = v;
 }
 
+Bool ShaderProgramResource::getOrCreateVariantAsync(const ShaderProgramResourceVariantInitInfo& info,
+													const ShaderProgramResourceVariantInitInfo& fallback,
+													const ShaderProgramResourceVariant*& variant) const
+{
+	if(!!(m_shaderStages & ShaderTypeBit::ALL_RAY_TRACING))
+	{
+		// Ray tracing variants point to the library's program. There is nothing to create in the background
+		getOrCreateVariant(info, variant);
+		return true;
+	}
+
+	ShaderProgramResourceVariant* v;
+	if(findOrNewVariant(info, v))
+	{
+		getManager().getAsyncLoader().submitNewTask<CreateVariantTask>(this, info, v);
+	}
+
+	if(v->m_state.load(AtomicMemoryOrder::ACQUIRE) == Variant::State::READY)
+	{
+		variant = v;
+		return true;
+	}
+
+	getOrCreateVariant(fallback, variant);
+	return false;
+}
+
 void ShaderProgramResource::initVariant(const ShaderProgramResourceVariantInitInfo& info,
 										ShaderProgramResourceVariant& variant) const
 {
@@ -445,4 +597,143 @@ void ShaderProgramResource::initVariant(const ShaderProgramResourceVariantInitIn
 	}
 }
 
+U64 ShaderProgramResource::computeVariantCacheLayoutHash() const
+{
+	U64 hash = computeHash(&m_shaderStages, sizeof(m_shaderStages));
+	for(const Mutator& m : m_mutators)
+	{
+		hash = appendHash(m.m_name.cstr(), m.m_name.getLength(), hash);
+		hash = appendHash(m.m_values.getBegin(), m.m_values.getSizeInBytes(), hash);
+	}
+
+	for(const Const& c : m_consts)
+	{
+		hash = appendHash(c.m_name.cstr(), c.m_name.getLength(), hash);
+		hash = appendHash(&c.m_dataType, sizeof(c.m_dataType), hash);
+	}
+
+	return hash;
+}
+
+void ShaderProgramResource::loadVariantCache()
+{
+	const CString filename = m_variantCacheFilename;
+	if(!fileExists(filename))
+	{
+		return;
+	}
+
+	// Read the file
+	File file;
+	ShaderVariantCacheHeader header;
+	DynamicArrayAuto<U8> records(getTempAllocator());
+	Error err = file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY);
+	if(!err)
+	{
+		err = file.read(&header, sizeof(header));
+	}
+
+	if(!err
+	   && (memcmp(&header.m_magic[0], SHADER_VARIANT_CACHE_MAGIC, sizeof(header.m_magic)) != 0
+		   || header.m_layoutHash != computeVariantCacheLayoutHash()
+		   || header.m_recordSize != getVariantCacheRecordSize()))
+	{
+		// The program changed since the cache was written. It will be overwritten
+		ANKI_RESOURCE_LOGI("Ignoring stale shader variant cache: %s", filename.cstr());
+		m_variantCacheDirty = true;
+		return;
+	}
+
+	if(!err && header.m_recordCount > 0 && header.m_recordSize > 0)
+	{
+		records.create(header.m_recordSize * header.m_recordCount);
+		err = file.read(&records[0], records.getSizeInBytes());
+	}
+
+	if(err)
+	{
+		ANKI_RESOURCE_LOGW("Failed to read the shader variant cache. Ignoring it: %s", filename.cstr());
+		m_variantCacheDirty = true;
+		return;
+	}
+
+	// Create the variants
+	const ShaderProgramBinary& binary = m_binary.getBinary();
+	Bool droppedRecords = false;
+	for(U32 r = 0; r < header.m_recordCount; ++r)
+	{
+		VariantInitInfo info;
+		if(header.m_recordSize > 0)
+		{
+			const U8* record = &records[r * header.m_recordSize];
+			memcpy(info.m_mutation.getBegin(), record, m_mutators.getSize() * sizeof(MutatorValue));
+			record += m_mutators.getSize() * sizeof(MutatorValue);
+			memcpy(info.m_constantValues.getBegin(), record, m_consts.getSize() * sizeof(info.m_constantValues[0]));
+		}
+
+		for(U32 i = 0; i < m_mutators.getSize(); ++i)
+		{
+			info.m_setMutators.set(i);
+		}
+
+		for(U32 i = 0; i < m_consts.getSize(); ++i)
+		{
+			info.m_setConstants.set(i);
+		}
+
+		// Skip mutations that are not present in the binary. Shouldn't happen but the file might have been tampered
+		if(m_mutators.getSize())
+		{
+			const U64 mutationHash =
+				computeHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+			Bool found = false;
+			for(const ShaderProgramBinaryMutation& mutation : binary.m_mutations)
+			{
+				found = found || mutation.m_hash == mutationHash;
+			}
+
+			if(!found)
+			{
+				droppedRecords = true;
+				continue;
+			}
+		}
+
+		const ShaderProgramResourceVariant* variant;
+		getOrCreateVariant(info, variant);
+	}
+
+	// The variants above added their records again. Nothing new to save
+	m_variantCacheDirty = droppedRecords;
+}
+
+void ShaderProgramResource::saveVariantCache() const
+{
+	ANKI_ASSERT(!m_variantCacheFilename.isEmpty());
+	const CString filename = m_variantCacheFilename;
+
+	ShaderVariantCacheHeader header;
+	memcpy(&header.m_magic[0], SHADER_VARIANT_CACHE_MAGIC, sizeof(header.m_magic));
+	header.m_layoutHash = computeVariantCacheLayoutHash();
+	header.m_recordSize = getVariantCacheRecordSize();
+	header.m_recordCount = m_variantCacheRecordCount;
+
+	File file;
+	Error err = file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY);
+	if(!err)
+	{
+		err = file.write(&header, sizeof(header));
+	}
+
+	if(!err && m_variantCacheRecords.getSize())
+	{
+		err = file.write(&m_variantCacheRecords[0], m_variantCacheRecords.getSizeInBytes());
+	}
+
+	if(err)
+	{
+		ANKI_RESOURCE_LOGW("Failed to write the shader variant cache: %s", filename.cstr());
+	}
+}
+
 } // end namespace anki
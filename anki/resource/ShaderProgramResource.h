@@ -97,12 +97,28 @@ public:
 		return m_hitShaderGroupHandleIndex;
 	}
 
+	/// @memberof ShaderProgramResourceVariant
+	enum class State : U32
+	{
+		PENDING, ///< Waits for someone to create it.
+		CREATING,
+		READY
+	};
+
+	/// The variants returned by ShaderProgramResource are always READY. The rest of the states are visible to the
+	/// variants that ShaderProgramResource::getOrCreateVariantAsync creates in the background.
+	ANKI_INTERNAL State getState() const
+	{
+		return m_state.load(AtomicMemoryOrder::ACQUIRE);
+	}
+
 private:
 	ShaderProgramPtr m_prog;
 	const ShaderProgramBinaryVariant* m_binaryVariant = nullptr;
 	BitSet<128, U64> m_activeConsts = {false};
 	Array<U32, 3> m_workgroupSizes;
 	U32 m_hitShaderGroupHandleIndex = MAX_U32; ///< Cache the index of the handle here.
+	Atomic<State> m_state = {State::PENDING};
 };
 
 /// The value of a constant.
@@ -244,9 +260,22 @@ public:
 		getOrCreateVariant(ShaderProgramResourceVariantInitInfo(), variant);
 	}
 
+	/// Same as getOrCreateVariant but if the variant doesn't exist it will be created in the async loader. In the
+	/// meantime the @a fallback variant is returned. The fallback is created synchronously if it doesn't exist.
+	/// Ray tracing variants are always returned right away because they only reference the library's program.
+	/// @return True if @a variant is the requested variant and false if it's the fallback.
+	/// @note It's thread-safe.
+	Bool getOrCreateVariantAsync(const ShaderProgramResourceVariantInitInfo& info,
+								 const ShaderProgramResourceVariantInitInfo& fallback,
+								 const ShaderProgramResourceVariant*& variant) const;
+
 private:
 	using Mutator = ShaderProgramResourceMutator;
 	using Const = ShaderProgramResourceConstant;
+	using Variant = ShaderProgramResourceVariant;
+	using VariantInitInfo = ShaderProgramResourceVariantInitInfo;
+
+	class CreateVariantTask;
 
 	ShaderProgramBinaryWrapper m_binary;
 
@@ -265,10 +294,41 @@ private:
 	mutable HashMap<U64, ShaderProgramResourceVariant*> m_variants;
 	mutable RWMutex m_mtx;
 
+	/// Threads that need a variant that some other thread creates wait on those.
+	mutable Mutex m_variantReadyMtx;
+	mutable ConditionVariable m_variantReadyCondVar;
+
+	/// The mutations and constant values of all the variants. It's saved in the cache directory and it's used to create
+	/// the same variants the next time the program loads. Protected by m_mtx.
+	mutable DynamicArray<U8> m_variantCacheRecords;
+	mutable U32 m_variantCacheRecordCount = 0;
+	mutable Bool m_variantCacheDirty = false;
+	String m_variantCacheFilename; ///< Built at load time. It doesn't touch the manager when the program is destroyed.
+
 	ShaderTypeBit m_shaderStages = ShaderTypeBit::NONE;
 
+	U64 computeVariantHash(const VariantInitInfo& info) const;
+
+	/// Find a variant or create a new pending one.
+	/// @return True if a new variant was created and it needs to be initialized.
+	Bool findOrNewVariant(const VariantInitInfo& info, ShaderProgramResourceVariant*& variant) const;
+
+	/// Move a pending variant to the ready state.
+	/// @param wait If some other thread is initializing the variant then wait for it.
+	void initPendingVariant(const VariantInitInfo& info, ShaderProgramResourceVariant& variant, Bool wait) const;
+
 	void initVariant(const ShaderProgramResourceVariantInitInfo& info, ShaderProgramResourceVariant& variant) const;
 
+	U32 getVariantCacheRecordSize() const
+	{
+		return m_mutators.getSize() * sizeof(MutatorValue)
+			   + m_consts.getSize() * sizeof(ShaderProgramResourceConstantValue);
+	}
+
+	U64 computeVariantCacheLayoutHash() const;
+	void loadVariantCache();
+	void saveVariantCache() const;
+
 	static ANKI_USE_RESULT Error parseConst(CString constName, U32& componentIdx, U32& componentCount, CString& name);
 };
 
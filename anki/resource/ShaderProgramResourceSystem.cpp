@@ -11,6 +11,7 @@
 #include <anki/util/Filesystem.h>
 #include <anki/util/ThreadHive.h>
 #include <anki/util/System.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
@@ -42,11 +43,230 @@ Error ShaderProgramResourceSystem::init()
 	return Error::NONE;
 }
 
+/// Reads the files of a program and remembers the hash of their contents.
+class ShaderProgramDependencyRecorder : public ShaderProgramFilesystemInterface
+{
+public:
+	ResourceFilesystem* m_fsystem;
+	StringListAuto m_filenames;
+	DynamicArrayAuto<U64> m_contentHashes;
+
+	ShaderProgramDependencyRecorder(ResourceFilesystem& fs, GenericMemoryPoolAllocator<U8> alloc)
+		: m_fsystem(&fs)
+		, m_filenames(alloc)
+		, m_contentHashes(alloc)
+	{
+	}
+
+	Error readAllText(CString filename, StringAuto& txt) final
+	{
+		ResourceFilePtr file;
+		ANKI_CHECK(m_fsystem->openFile(filename, file));
+		ANKI_CHECK(file->readAllText(txt));
+
+		const U64 contentHash = (txt.getLength()) ? computeHash(txt.cstr(), txt.getLength()) : 1;
+		Bool found = false;
+		for(const String& s : m_filenames)
+		{
+			found = found || s == filename;
+		}
+
+		if(!found)
+		{
+			m_filenames.pushBack(filename);
+			m_contentHashes.emplaceBack(contentHash);
+		}
+
+		return Error::NONE;
+	}
+};
+
+/// The state of a program that might need compilation.
+class ShaderProgramCompileJob
+{
+public:
+	StringAuto m_fname;
+	StringAuto m_metaFname;
+	StringAuto m_binaryFname;
+	U64 m_metafileHash = 0;
+	Bool m_compiled = false;
+
+	ShaderProgramCompileJob(GenericMemoryPoolAllocator<U8> alloc)
+		: m_fname(alloc)
+		, m_metaFname(alloc)
+		, m_binaryFname(alloc)
+	{
+	}
+};
+
+/// The layout of the meta file is:
+/// U64 program hash, U64 GPU hash, U32 dependency count and then for each dependency:
+/// U64 content hash, U32 filename length, filename.
+/// @return True if the program and the files it includes didn't change since the last compilation.
+static Bool shaderProgramIsUpToDate(ShaderProgramCompileJob& job, U64 gpuHash, ResourceFilesystem& fs,
+									HashMapAuto<U64, U64>& contentHashCache, GenericMemoryPoolAllocator<U8> alloc)
+{
+	if(!fileExists(job.m_metaFname))
+	{
+		return false;
+	}
+
+	File metaFile;
+	if(metaFile.open(job.m_metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY))
+	{
+		return false;
+	}
+
+	U64 metafileGpuHash;
+	U32 dependencyCount;
+	const PtrSize headerSize = sizeof(job.m_metafileHash) + sizeof(metafileGpuHash) + sizeof(dependencyCount);
+	if(metaFile.getSize() < sizeof(job.m_metafileHash) || metaFile.read(&job.m_metafileHash, sizeof(U64)))
+	{
+		return false;
+	}
+
+	// Old meta files don't have dependencies. Compilation will decide
+	if(metaFile.getSize() < headerSize || metaFile.read(&metafileGpuHash, sizeof(metafileGpuHash))
+	   || metaFile.read(&dependencyCount, sizeof(dependencyCount)))
+	{
+		return false;
+	}
+
+	if(metafileGpuHash != gpuHash || dependencyCount == 0 || !fileExists(job.m_binaryFname))
+	{
+		return false;
+	}
+
+	// Compare the dependencies with their current contents. Includes are shared so hash them only once
+	for(U32 i = 0; i < dependencyCount; ++i)
+	{
+		U64 oldContentHash;
+		U32 fnameLength;
+		if(metaFile.read(&oldContentHash, sizeof(oldContentHash)) || metaFile.read(&fnameLength, sizeof(fnameLength))
+		   || fnameLength == 0 || fnameLength > 1024)
+		{
+			return false;
+		}
+
+		Array<char, 1025> fname;
+		if(metaFile.read(&fname[0], fnameLength))
+		{
+			return false;
+		}
+		fname[fnameLength] = '\0';
+
+		const U64 fnameHash = computeHash(&fname[0], fnameLength);
+		auto it = contentHashCache.find(fnameHash);
+		U64 contentHash;
+		if(it != contentHashCache.getEnd())
+		{
+			contentHash = *it;
+		}
+		else
+		{
+			ResourceFilePtr file;
+			StringAuto txt(alloc);
+			if(fs.openFile(&fname[0], file) || file->readAllText(txt))
+			{
+				contentHash = 0;
+			}
+			else
+			{
+				contentHash = (txt.getLength()) ? computeHash(txt.cstr(), txt.getLength()) : 1;
+			}
+
+			contentHashCache.emplace(fnameHash, contentHash);
+		}
+
+		if(contentHash != oldContentHash)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// Parse the program and compile it if it changed. Then update the meta file and the binary.
+static Error compileShaderProgramJob(ShaderProgramCompileJob& job, U64 gpuHash, const GpuDeviceCapabilities& caps,
+									 const BindlessLimits& limits, ResourceFilesystem& fs,
+									 ShaderProgramAsyncTaskInterface* taskManager,
+									 GenericMemoryPoolAllocator<U8> alloc)
+{
+	ShaderProgramDependencyRecorder fsystem(fs, alloc);
+
+	// Skip interface
+	class Skip : public ShaderProgramPostParseInterface
+	{
+	public:
+		U64 m_metafileHash;
+		U64 m_newHash;
+		U64 m_gpuHash;
+		CString m_fname;
+
+		Bool skipCompilation(U64 hash)
+		{
+			ANKI_ASSERT(hash != 0);
+			const Array<U64, 2> hashes = {hash, m_gpuHash};
+			const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
+
+			m_newHash = finalHash;
+			const Bool skip = finalHash == m_metafileHash;
+
+			if(!skip)
+			{
+				ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
+			}
+
+			return skip;
+		};
+	} skip;
+	skip.m_metafileHash = job.m_metafileHash;
+	skip.m_newHash = 0;
+	skip.m_gpuHash = gpuHash;
+	skip.m_fname = job.m_fname;
+
+	// Compile
+	ShaderProgramBinaryWrapper binary(alloc);
+	ANKI_CHECK(compileShaderProgram(job.m_fname, fsystem, &skip, taskManager, alloc, caps, limits, binary));
+
+	job.m_compiled = job.m_metafileHash != skip.m_newHash;
+
+	// Update the meta file. Even if the binary is up to date the dependencies might be missing
+	{
+		File metaFile;
+		ANKI_CHECK(metaFile.open(job.m_metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_CHECK(metaFile.write(&skip.m_newHash, sizeof(skip.m_newHash)));
+		ANKI_CHECK(metaFile.write(&gpuHash, sizeof(gpuHash)));
+		const U32 dependencyCount = fsystem.m_contentHashes.getSize();
+		ANKI_CHECK(metaFile.write(&dependencyCount, sizeof(dependencyCount)));
+
+		U32 count = 0;
+		for(const String& depFname : fsystem.m_filenames)
+		{
+			const U32 fnameLength = U32(depFname.getLength());
+			ANKI_CHECK(metaFile.write(&fsystem.m_contentHashes[count++], sizeof(U64)));
+			ANKI_CHECK(metaFile.write(&fnameLength, sizeof(fnameLength)));
+			ANKI_CHECK(metaFile.write(depFname.cstr(), fnameLength));
+		}
+	}
+
+	// Save the binary to the cache
+	if(job.m_compiled)
+	{
+		ANKI_CHECK(binary.serializeToFile(job.m_binaryFname));
+	}
+
+	return Error::NONE;
+}
+
 Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager& gr, ResourceFilesystem& fs,
 													 GenericMemoryPoolAllocator<U8>& alloc)
 {
 	ANKI_RESOURCE_LOGI("Compiling shader programs");
+	const Second startTime = HighRezTimer::getCurrentTime();
 	U32 shadersCompileCount = 0;
+	U32 programCount = 0;
 
 	ThreadHive threadHive(getCpuCoresCount(), alloc, false);
 
@@ -57,6 +277,10 @@ Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager
 	gpuHash = appendHash(&limits, sizeof(limits), gpuHash);
 	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
 
+	// Find the programs that might have changed. Use the dependencies in the meta files to skip the unchanged programs
+	// without parsing them
+	HashMapAuto<U64, U64> contentHashCache(alloc); // Filename hash to content hash
+	DynamicArrayAuto<ShaderProgramCompileJob*> jobs(alloc);
 	ANKI_CHECK(fs.iterateAllFilenames([&](CString fname) -> Error {
 		// Check file extension
 		StringAuto extension(alloc);
@@ -72,69 +296,33 @@ Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager
 			return Error::NONE;
 		}
 
+		++programCount;
+
 		// Get some filenames
+		ShaderProgramCompileJob* job = alloc.newInstance<ShaderProgramCompileJob>(alloc);
+		job->m_fname.create(fname);
 		StringAuto baseFname(alloc);
 		getFilepathFilename(fname, baseFname);
-		StringAuto metaFname(alloc);
-		metaFname.sprintf("%s/%smeta", cacheDir.cstr(), baseFname.cstr());
+		job->m_metaFname.sprintf("%s/%smeta", cacheDir.cstr(), baseFname.cstr());
+		job->m_binaryFname.sprintf("%s/%sbin", cacheDir.cstr(), baseFname.cstr());
 
-		// Get the hash from the meta file
-		U64 metafileHash = 0;
-		if(fileExists(metaFname))
+		if(shaderProgramIsUpToDate(*job, gpuHash, fs, contentHashCache, alloc))
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
-			ANKI_CHECK(metaFile.read(&metafileHash, sizeof(metafileHash)));
+			alloc.deleteInstance(job);
 		}
-
-		// Load interface
-		class FSystem : public ShaderProgramFilesystemInterface
+		else
 		{
-		public:
-			ResourceFilesystem* m_fsystem = nullptr;
-
-			Error readAllText(CString filename, StringAuto& txt) final
-			{
-				ResourceFilePtr file;
-				ANKI_CHECK(m_fsystem->openFile(filename, file));
-				ANKI_CHECK(file->readAllText(txt));
-				return Error::NONE;
-			}
-		} fsystem;
-		fsystem.m_fsystem = &fs;
-
-		// Skip interface
-		class Skip : public ShaderProgramPostParseInterface
-		{
-		public:
-			U64 m_metafileHash;
-			U64 m_newHash;
-			U64 m_gpuHash;
-			CString m_fname;
-
-			Bool skipCompilation(U64 hash)
-			{
-				ANKI_ASSERT(hash != 0);
-				const Array<U64, 2> hashes = {hash, m_gpuHash};
-				const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
-
-				m_newHash = finalHash;
-				const Bool skip = finalHash == m_metafileHash;
-
-				if(!skip)
-				{
-					ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
-				}
+			jobs.emplaceBack(job);
+		}
 
-				return skip;
-			};
-		} skip;
-		skip.m_metafileHash = metafileHash;
-		skip.m_newHash = 0;
-		skip.m_gpuHash = gpuHash;
-		skip.m_fname = fname;
+		return Error::NONE;
+	}));
 
-		// Threading interface
+	// Compile the programs that might have changed
+	Error err = Error::NONE;
+	if(jobs.getSize() == 1)
+	{
+		// Only one program, parallelize its variants
 		class TaskManager : public ShaderProgramAsyncTaskInterface
 		{
 		public:
@@ -174,36 +362,63 @@ Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager
 		taskManager.m_hive = &threadHive;
 		taskManager.m_alloc = alloc;
 
-		// Compile
-		ShaderProgramBinaryWrapper binary(alloc);
-		ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, alloc, caps, limits, binary));
-
-		const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
-		if(!cachedBinIsUpToDate)
+		err = compileShaderProgramJob(*jobs[0], gpuHash, caps, limits, fs, &taskManager, alloc);
+	}
+	else if(jobs.getSize() > 1)
+	{
+		// Many programs, compile one program per thread
+		class Ctx
 		{
-			++shadersCompileCount;
-		}
+		public:
+			ShaderProgramCompileJob* m_job;
+			U64 m_gpuHash;
+			const GpuDeviceCapabilities* m_caps;
+			const BindlessLimits* m_limits;
+			ResourceFilesystem* m_fs;
+			GenericMemoryPoolAllocator<U8> m_alloc;
+			Atomic<I32>* m_err;
+		};
 
-		// Update the meta file
-		if(!cachedBinIsUpToDate)
+		Atomic<I32> errAtomic = {0};
+		DynamicArrayAuto<Ctx> ctxs(alloc);
+		ctxs.create(jobs.getSize());
+		for(U32 i = 0; i < jobs.getSize(); ++i)
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-			ANKI_CHECK(metaFile.write(&skip.m_newHash, sizeof(skip.m_newHash)));
-		}
+			ctxs[i] = {jobs[i], gpuHash, &caps, &limits, &fs, alloc, &errAtomic};
 
-		// Save the binary to the cache
-		if(!cachedBinIsUpToDate)
-		{
-			StringAuto storeFname(alloc);
-			storeFname.sprintf("%s/%sbin", cacheDir.cstr(), baseFname.cstr());
-			ANKI_CHECK(binary.serializeToFile(storeFname));
+			threadHive.submitTask(
+				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+					Ctx& ctx = *static_cast<Ctx*>(userData);
+					if(ctx.m_err->load() != 0)
+					{
+						return;
+					}
+
+					const Error err = compileShaderProgramJob(*ctx.m_job, ctx.m_gpuHash, *ctx.m_caps, *ctx.m_limits,
+															  *ctx.m_fs, nullptr, ctx.m_alloc);
+					if(err)
+					{
+						ctx.m_err->store(err._getCode());
+					}
+				},
+				&ctxs[i]);
 		}
 
-		return Error::NONE;
-	}));
+		threadHive.waitAllTasks();
+		err = Error(errAtomic.load());
+	}
+
+	for(ShaderProgramCompileJob* job : jobs)
+	{
+		shadersCompileCount += job->m_compiled;
+		alloc.deleteInstance(job);
+	}
+
+	ANKI_CHECK(err);
 
-	ANKI_RESOURCE_LOGI("Compiled %u shader programs", shadersCompileCount);
+	ANKI_RESOURCE_LOGI("Compiled %u shader programs. %u were up to date, %u parsed. It took %f sec",
+					   shadersCompileCount, programCount - jobs.getSize(), jobs.getSize(),
+					   HighRezTimer::getCurrentTime() - startTime);
 	return Error::NONE;
 }
 
@@ -227,8 +227,8 @@ Error TextureResource::load(LoadingContext& ctx)
 			if(ctx.m_texType == TextureType::_3D)
 			{
 				const auto& vol = ctx.m_loader.getVolume(mip);
-				surfOrVolSize = vol.m_data.getSize();
-				surfOrVolData = &vol.m_data[0];
+				surfOrVolSize = vol.getData().getSize();
+				surfOrVolData = vol.getData().getBegin();
 
 				allocationSize = computeVolumeSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip,
 												   ctx.m_tex->getDepth() >> mip, ctx.m_tex->getFormat());
@@ -236,8 +236,8 @@ Error TextureResource::load(LoadingContext& ctx)
 			else
 			{
 				const auto& surf = ctx.m_loader.getSurface(mip, face, layer);
-				surfOrVolSize = surf.m_data.getSize();
-				surfOrVolData = &surf.m_data[0];
+				surfOrVolSize = surf.getData().getSize();
+				surfOrVolData = surf.getData().getBegin();
 
 				allocationSize = computeSurfaceSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip,
 													ctx.m_tex->getFormat());
@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 ANKI_CONFIG_OPTION(scene_octreeMaxDepth, 5, 2, 10, "The max depth of the octree")
+ANKI_CONFIG_OPTION(scene_looseOctree, 0, 0, 1,
+				   "Use a loose octree. It scales better when a lot of objects move every frame")
 ANKI_CONFIG_OPTION(scene_earlyZDistance, 10.0, 0.0, MAX_F64,
 				   "Objects with distance lower than that will be used in early Z")
 ANKI_CONFIG_OPTION(scene_lod0MaxDistance, 20.0, 1.0, MAX_F64, "Distance that will be used to calculate the LOD 0")
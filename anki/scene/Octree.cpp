@@ -57,19 +57,33 @@ public:
 
 Octree::~Octree()
 {
-	ANKI_ASSERT(m_placeableCount == 0);
+	ANKI_ASSERT(m_placeableCount.getNonAtomically() == 0);
 	cleanupInternal();
 	ANKI_ASSERT(m_rootLeaf == nullptr);
 }
 
-void Octree::init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth)
+void Octree::init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth, Bool loose)
 {
 	ANKI_ASSERT(sceneAabbMin < sceneAabbMax);
-	ANKI_ASSERT(maxDepth > 0);
+	ANKI_ASSERT(maxDepth > 0 && maxDepth < 32);
 
 	m_maxDepth = maxDepth;
 	m_sceneAabbMin = sceneAabbMin;
 	m_sceneAabbMax = sceneAabbMax;
+	m_loose = loose;
+
+	for(U32 i = 0; i < 3; ++i)
+	{
+		m_actualSceneAabbMin[i].setNonAtomically(floatToOrderedU32(MAX_F32));
+		m_actualSceneAabbMax[i].setNonAtomically(floatToOrderedU32(MIN_F32));
+	}
+
+	// The loose mode creates the root leaf once and never deletes it so it can be used without locking
+	if(m_loose)
+	{
+		m_rootLeaf = newLeaf();
+		computeLooseLeafAabb(0, UVec3(0u), m_rootLeaf->m_aabbMin, m_rootLeaf->m_aabbMax);
+	}
 }
 
 void Octree::place(const Aabb& volume, OctreePlaceable* placeable, Bool updateActualSceneBounds)
@@ -77,6 +91,17 @@ void Octree::place(const Aabb& volume, OctreePlaceable* placeable, Bool updateAc
 	ANKI_ASSERT(placeable);
 	ANKI_ASSERT(testCollision(volume, Aabb(m_sceneAabbMin, m_sceneAabbMax)) && "volume is outside the scene");
 
+	if(updateActualSceneBounds)
+	{
+		expandActualSceneBounds(volume);
+	}
+
+	if(m_loose)
+	{
+		placeLoose(volume, *placeable);
+		return;
+	}
+
 	LockGuard<Mutex> lock(m_globalMtx);
 
 	// Remove the placeable from the Octree
@@ -92,22 +117,151 @@ void Octree::place(const Aabb& volume, OctreePlaceable* placeable, Bool updateAc
 
 	// And re-place it
 	placeRecursive(volume, placeable, m_rootLeaf, 0);
-	++m_placeableCount;
-
-	// Update the actual scene bounds
-	if(updateActualSceneBounds)
-	{
-		m_actualSceneAabbMin = m_actualSceneAabbMin.min(volume.getMin().xyz());
-		m_actualSceneAabbMax = m_actualSceneAabbMax.max(volume.getMax().xyz());
-	}
+	m_placeableCount.fetchAdd(1);
 }
 
 void Octree::remove(OctreePlaceable& placeable)
 {
+	if(m_loose)
+	{
+		removeLoose(placeable);
+		return;
+	}
+
 	LockGuard<Mutex> lock(m_globalMtx);
 	removeInternal(placeable);
 }
 
+void Octree::expandActualSceneBounds(const Aabb& volume)
+{
+	// Atomic::min() and max() don't write if the value doesn't change so this is cheap after the first few frames
+	for(U32 i = 0; i < 3; ++i)
+	{
+		m_actualSceneAabbMin[i].min(floatToOrderedU32(volume.getMin()[i]));
+		m_actualSceneAabbMax[i].max(floatToOrderedU32(volume.getMax()[i]));
+	}
+}
+
+void Octree::computeLooseLeafAabb(U32 depth, const UVec3& cell, Vec3& aabbMin, Vec3& aabbMax) const
+{
+	const Vec3 cellSize = (m_sceneAabbMax - m_sceneAabbMin) / F32(1u << depth);
+	aabbMin = m_sceneAabbMin + (Vec3(cell) - 0.5f) * cellSize;
+	aabbMax = aabbMin + 2.0f * cellSize;
+}
+
+void Octree::computeLooseCell(const Aabb& volume, U32& depth, UVec3& cell) const
+{
+	const Vec3 volumeMin = volume.getMin().xyz();
+	const Vec3 volumeMax = volume.getMax().xyz();
+	const Vec3 center = (volumeMin + volumeMax) / 2.0f;
+
+	// Start from the deepest level and go up until a leaf can hold the volume. The root can hold everything
+	for(depth = m_maxDepth; depth > 0; --depth)
+	{
+		const U32 cellCount = 1u << depth;
+		const Vec3 cellSize = (m_sceneAabbMax - m_sceneAabbMin) / F32(cellCount);
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const F32 f = (center[i] - m_sceneAabbMin[i]) / cellSize[i];
+			cell[i] = U32(clamp(f, 0.0f, F32(cellCount - 1)));
+		}
+
+		Vec3 leafMin, leafMax;
+		computeLooseLeafAabb(depth, cell, leafMin, leafMax);
+		if(volumeMin >= leafMin && volumeMax <= leafMax)
+		{
+			return;
+		}
+	}
+
+	cell = UVec3(0u);
+}
+
+Octree::Leaf* Octree::getOrCreateLooseChild(Leaf& parent, U32 childIdx, U32 childDepth, const UVec3& childCell)
+{
+	Leaf* child = parent.m_children[childIdx].load(AtomicMemoryOrder::ACQUIRE);
+	if(child)
+	{
+		return child;
+	}
+
+	Leaf* newChild;
+	{
+		LockGuard<SpinLock> lock(m_leafAllocLock);
+		newChild = newLeaf();
+	}
+	computeLooseLeafAabb(childDepth, childCell, newChild->m_aabbMin, newChild->m_aabbMax);
+
+	Leaf* expected = nullptr;
+	while(!parent.m_children[childIdx].compareExchange(expected, newChild, AtomicMemoryOrder::ACQ_REL,
+													   AtomicMemoryOrder::ACQUIRE))
+	{
+		if(expected)
+		{
+			// Some other thread created it first
+			LockGuard<SpinLock> lock(m_leafAllocLock);
+			releaseLeaf(newChild);
+			return expected;
+		}
+	}
+
+	return newChild;
+}
+
+void Octree::placeLoose(const Aabb& volume, OctreePlaceable& placeable)
+{
+	U32 depth;
+	UVec3 cell;
+	computeLooseCell(volume, depth, cell);
+
+	if(placeable.m_looseLeaf && placeable.m_looseDepth == depth && placeable.m_looseCell == cell)
+	{
+		// Still fits in the same leaf, nothing to do
+		return;
+	}
+
+	removeLoose(placeable);
+
+	// Walk down to the leaf. The bits of the cell coordinates are the path from the root
+	Leaf* leaf = m_rootLeaf;
+	for(U32 d = 1; d <= depth; ++d)
+	{
+		// Same order as LeafMask
+		const UVec3 childCell = cell >> (depth - d);
+		U32 childIdx = (childCell.x() & 1) ? 0 : 4;
+		childIdx += (childCell.y() & 1) ? 0 : 2;
+		childIdx += (childCell.z() & 1) ? 0 : 1;
+		leaf = getOrCreateLooseChild(*leaf, childIdx, d, childCell);
+	}
+
+	{
+		LockGuard<SpinLock> lock(leaf->m_lock);
+		leaf->m_placeables.pushBack(&placeable.m_looseNode);
+	}
+
+	placeable.m_looseLeaf = leaf;
+	placeable.m_looseDepth = depth;
+	placeable.m_looseCell = cell;
+	m_placeableCount.fetchAdd(1);
+}
+
+void Octree::removeLoose(OctreePlaceable& placeable)
+{
+	Leaf* leaf = placeable.m_looseLeaf;
+	if(leaf)
+	{
+		{
+			LockGuard<SpinLock> lock(leaf->m_lock);
+			leaf->m_placeables.erase(&placeable.m_looseNode);
+		}
+
+		placeable.m_looseLeaf = nullptr;
+		const U32 prevCount = m_placeableCount.fetchSub(1);
+		ANKI_ASSERT(prevCount > 0);
+		(void)prevCount;
+	}
+}
+
 Bool Octree::volumeTotallyInsideLeaf(const Aabb& volume, const Leaf& leaf)
 {
 	const Vec4& amin = volume.getMin();
@@ -220,7 +374,7 @@ void Octree::placeRecursive(const Aabb& volume, OctreePlaceable* placeable, Leaf
 			// Inside the leaf, move deeper
 
 			// Create the leaf
-			if(parent->m_children[i] == nullptr)
+			if(parent->getChild(i) == nullptr)
 			{
 				Leaf* child = newLeaf();
 
@@ -229,11 +383,11 @@ void Octree::placeRecursive(const Aabb& volume, OctreePlaceable* placeable, Leaf
 				computeChildAabb(crntBit, parent->m_aabbMin, parent->m_aabbMax, center, child->m_aabbMin,
 								 child->m_aabbMax);
 
-				parent->m_children[i] = child;
+				parent->m_children[i].setNonAtomically(child);
 			}
 
 			// Move deeper
-			placeRecursive(volume, placeable, parent->m_children[i], depth + 1);
+			placeRecursive(volume, placeable, parent->getChild(i), depth + 1);
 		}
 	}
 }
@@ -318,9 +472,9 @@ void Octree::removeInternal(OctreePlaceable& placeable)
 		}
 
 		// Cleanup the tree if there are no placeables
-		ANKI_ASSERT(m_placeableCount > 0);
-		--m_placeableCount;
-		if(m_placeableCount == 0)
+		const U32 prevCount = m_placeableCount.fetchSub(1);
+		ANKI_ASSERT(prevCount > 0);
+		if(prevCount == 1)
 		{
 			cleanupInternal();
 			ANKI_ASSERT(m_rootLeaf == nullptr);
@@ -346,8 +500,9 @@ void Octree::gatherVisibleRecursive(const Plane frustumPlanes[6], U32 testId,
 
 	// Move to children leafs
 	Aabb aabb;
-	for(Leaf* child : leaf->m_children)
+	for(U32 i = 0; i < 8; ++i)
 	{
+		Leaf* const child = leaf->getChild(i);
 		if(child)
 		{
 			aabb.setMin(child->m_aabbMin);
@@ -384,7 +539,7 @@ void Octree::cleanupRecursive(Leaf* leaf, Bool& canDeleteLeafUponReturn)
 	// Do the children
 	for(U i = 0; i < 8; ++i)
 	{
-		Leaf* const child = leaf->m_children[i];
+		Leaf* const child = leaf->getChild(i);
 		if(child)
 		{
 			Bool canDeleteChild;
@@ -393,7 +548,7 @@ void Octree::cleanupRecursive(Leaf* leaf, Bool& canDeleteLeafUponReturn)
 			if(canDeleteChild)
 			{
 				releaseLeaf(child);
-				leaf->m_children[i] = nullptr;
+				leaf->m_children[i].setNonAtomically(nullptr);
 			}
 			else
 			{
@@ -428,7 +583,7 @@ void Octree::debugDrawRecursive(const Leaf& leaf, OctreeDebugDrawer& drawer) con
 
 	for(U i = 0; i < 8; ++i)
 	{
-		Leaf* const child = leaf.m_children[i];
+		Leaf* const child = leaf.getChild(i);
 		if(child)
 		{
 			debugDrawRecursive(*child, drawer);
@@ -510,8 +665,9 @@ void Octree::gatherVisibleParallelTask(U32 threadId, ThreadHive& hive, ThreadHiv
 	Array<ThreadHiveTask, 8> tasks;
 	U32 taskCount = 0;
 	Aabb aabb;
-	for(Leaf* child : leaf->m_children)
+	for(U32 i = 0; i < 8; ++i)
 	{
+		Leaf* const child = leaf->getChild(i);
 		if(child)
 		{
 			aabb.setMin(child->m_aabbMin);
@@ -36,6 +36,11 @@ public:
 };
 
 /// Octree for visibility tests.
+///
+/// It has two modes. The default one places a placeable to all the leafs it overlaps and it uses a global lock. The
+/// loose mode places a placeable to a single leaf whose loose bounds (twice the size of the leaf) contain it. The
+/// loose mode doesn't use a global lock and it doesn't touch the tree at all if the placeable stays in the same leaf
+/// so it scales better when a lot of objects move every frame.
 class Octree : public NonCopyable
 {
 	friend class OctreePlaceable;
@@ -48,7 +53,11 @@ public:
 
 	~Octree();
 
-	void init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth);
+	/// @param sceneAabbMin The min of the scene bounds.
+	/// @param sceneAabbMax The max of the scene bounds.
+	/// @param maxDepth The max depth of the tree.
+	/// @param loose Use the loose mode or not. See Octree.
+	void init(const Vec3& sceneAabbMin, const Vec3& sceneAabbMax, U32 maxDepth, Bool loose = false);
 
 	/// Place or re-place an element in the tree.
 	/// @note It's thread-safe against place and remove methods.
@@ -101,11 +110,19 @@ public:
 	/// Get the bounds of the scene as calculated by the objects that were placed inside the Octree.
 	void getActualSceneBounds(Vec3& min, Vec3& max) const
 	{
-		LockGuard<Mutex> lock(m_globalMtx);
-		ANKI_ASSERT(m_actualSceneAabbMin.x() < MAX_F32);
-		ANKI_ASSERT(m_actualSceneAabbMax.x() > MIN_F32);
-		min = m_actualSceneAabbMin;
-		max = m_actualSceneAabbMax;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			min[i] = orderedU32ToFloat(m_actualSceneAabbMin[i].load());
+			max[i] = orderedU32ToFloat(m_actualSceneAabbMax[i].load());
+		}
+
+		ANKI_ASSERT(min.x() < MAX_F32);
+		ANKI_ASSERT(max.x() > MIN_F32);
+	}
+
+	Bool isLoose() const
+	{
+		return m_loose;
 	}
 
 private:
@@ -132,24 +149,41 @@ private:
 	{
 	public:
 		IntrusiveList<PlaceableNode> m_placeables;
-		Vec3 m_aabbMin;
+		Vec3 m_aabbMin; ///< In loose mode these are the loose bounds.
 		Vec3 m_aabbMax;
-		Array<Leaf*, 8> m_children = {};
+		Array<Atomic<Leaf*>, 8> m_children; ///< Only the loose mode creates them concurrently.
+		SpinLock m_lock; ///< Protects m_placeables in loose mode.
+
+		Leaf()
+		{
+			for(Atomic<Leaf*>& child : m_children)
+			{
+				child.setNonAtomically(nullptr);
+			}
+		}
 
 #if ANKI_ENABLE_ASSERTS
 		~Leaf()
 		{
 			ANKI_ASSERT(m_placeables.isEmpty());
-			m_children = {};
+			for(Atomic<Leaf*>& child : m_children)
+			{
+				child.setNonAtomically(nullptr);
+			}
 			m_aabbMin = m_aabbMax = Vec3(0.0f);
 		}
 #endif
 
+		Leaf* getChild(U32 i) const
+		{
+			return m_children[i].getNonAtomically();
+		}
+
 		Bool hasChildren() const
 		{
-			return m_children[0] != nullptr || m_children[1] != nullptr || m_children[2] != nullptr
-				   || m_children[3] != nullptr || m_children[4] != nullptr || m_children[5] != nullptr
-				   || m_children[6] != nullptr || m_children[7] != nullptr;
+			return getChild(0) != nullptr || getChild(1) != nullptr || getChild(2) != nullptr || getChild(3) != nullptr
+				   || getChild(4) != nullptr || getChild(5) != nullptr || getChild(6) != nullptr
+				   || getChild(7) != nullptr;
 		}
 	};
 
@@ -194,18 +228,21 @@ private:
 	U32 m_maxDepth = 0;
 	Vec3 m_sceneAabbMin = Vec3(0.0f);
 	Vec3 m_sceneAabbMax = Vec3(0.0f);
+	Bool m_loose = false;
 	mutable Mutex m_globalMtx;
 
 	ObjectAllocatorSameType<Leaf, 256> m_leafAlloc;
 	ObjectAllocatorSameType<LeafNode, 128> m_leafNodeAlloc;
 	ObjectAllocatorSameType<PlaceableNode, 256> m_placeableNodeAlloc;
+	SpinLock m_leafAllocLock; ///< Protects m_leafAlloc in loose mode.
 
 	Leaf* m_rootLeaf = nullptr;
-	U32 m_placeableCount = 0;
+	Atomic<U32> m_placeableCount = {0};
 
-	/// Compute the min of the scene bounds based on what is placed inside the octree.
-	Vec3 m_actualSceneAabbMin = Vec3(MAX_F32);
-	Vec3 m_actualSceneAabbMax = Vec3(MIN_F32);
+	/// Compute the min of the scene bounds based on what is placed inside the octree. The floats are stored as ordered
+	/// integers (see floatToOrderedU32()) to be able to update them with atomics.
+	Array<Atomic<U32>, 3> m_actualSceneAabbMin;
+	Array<Atomic<U32>, 3> m_actualSceneAabbMax;
 
 	Leaf* newLeaf()
 	{
@@ -217,6 +254,24 @@ private:
 		m_leafAlloc.deleteInstance(m_alloc, leaf);
 	}
 
+	/// Map a float to an integer that has the same ordering.
+	static U32 floatToOrderedU32(F32 f)
+	{
+		U32 u;
+		memcpy(&u, &f, sizeof(u));
+		return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+	}
+
+	static F32 orderedU32ToFloat(U32 u)
+	{
+		u = (u & 0x80000000u) ? (u & 0x7FFFFFFFu) : ~u;
+		F32 f;
+		memcpy(&f, &u, sizeof(f));
+		return f;
+	}
+
+	void expandActualSceneBounds(const Aabb& volume);
+
 	PlaceableNode* newPlaceableNode(OctreePlaceable* placeable)
 	{
 		ANKI_ASSERT(placeable);
@@ -253,6 +308,24 @@ private:
 	/// Remove a placeable from the tree.
 	void removeInternal(OctreePlaceable& placeable);
 
+	/// place() for the loose mode.
+	void placeLoose(const Aabb& volume, OctreePlaceable& placeable);
+
+	/// remove() for the loose mode.
+	void removeLoose(OctreePlaceable& placeable);
+
+	/// Find the deepest loose leaf that can hold a volume.
+	/// @param volume The volume.
+	/// @param[out] depth The depth of the leaf.
+	/// @param[out] cell The coordinates of the leaf in the grid of its depth.
+	void computeLooseCell(const Aabb& volume, U32& depth, UVec3& cell) const;
+
+	/// Compute the loose bounds of a leaf.
+	void computeLooseLeafAabb(U32 depth, const UVec3& cell, Vec3& aabbMin, Vec3& aabbMax) const;
+
+	/// Get a child of a leaf or create it if it doesn't exist. It's thread-safe.
+	Leaf* getOrCreateLooseChild(Leaf& parent, U32 childIdx, U32 childDepth, const UVec3& childCell);
+
 	static void gatherVisibleRecursive(const Plane frustumPlanes[6], U32 testId,
 									   OctreeNodeVisibilityTestCallback testCallback, void* testCallbackUserData,
 									   Leaf* leaf, DynamicArrayAuto<void*>& out);
@@ -284,6 +357,11 @@ class OctreePlaceable : public NonCopyable
 public:
 	void* m_userData = nullptr;
 
+	OctreePlaceable()
+	{
+		m_looseNode.m_placeable = this;
+	}
+
 	void reset()
 	{
 		m_visitedMask.setNonAtomically(0);
@@ -293,6 +371,14 @@ private:
 	Atomic<U64> m_visitedMask = {0u};
 	IntrusiveList<Octree::LeafNode> m_leafs; ///< A list of leafs this placeable belongs.
 
+	/// @name Loose mode data. A placeable belongs to a single leaf so there is no need to allocate nodes.
+	/// @{
+	Octree::PlaceableNode m_looseNode;
+	Octree::Leaf* m_looseLeaf = nullptr;
+	UVec3 m_looseCell = UVec3(0u);
+	U32 m_looseDepth = 0;
+	/// @}
+
 	/// Check if already visited.
 	/// @note It's thread-safe.
 	Bool alreadyVisited(U32 testId)
@@ -320,8 +406,9 @@ inline void Octree::walkTreeInternal(Leaf& leaf, U32 testId, TTestAabbFunc testF
 	Aabb aabb;
 	U visibleLeafs = 0;
 	(void)visibleLeafs;
-	for(Leaf* child : leaf.m_children)
+	for(U32 i = 0; i < 8; ++i)
 	{
+		Leaf* const child = leaf.getChild(i);
 		if(child)
 		{
 			aabb.setMin(child->m_aabbMin);
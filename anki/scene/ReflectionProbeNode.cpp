@@ -91,6 +91,7 @@ Error ReflectionProbeNode::init(const Vec4& aabbMinLSpace, const Vec4& aabbMaxLS
 		frc->setPerspective(zNear, effectiveDistance, ang, ang);
 		frc->setTransform(m_cubeSides[i].m_localTrf);
 		frc->setEnabledVisibilityTests(FrustumComponentVisibilityTestFlag::NONE);
+		frc->setVisibilityCacheEnabled(true);
 		frc->setEffectiveShadowDistance(getSceneGraph().getConfig().m_reflectionProbeShadowEffectiveDistance);
 	}
 
@@ -33,6 +33,26 @@ public:
 	Second m_crntTime;
 };
 
+class SceneGraph::UpdateComponentBatchesCtx
+{
+public:
+	/// A chunk of components.
+	class Batch
+	{
+	public:
+		const SceneComponentPool* m_pool;
+		U32 m_chunkIdx;
+	};
+
+	SceneGraph* m_scene = nullptr;
+
+	WeakArray<Batch> m_batches;
+	Atomic<U32> m_crntBatch = {0};
+
+	Second m_prevUpdateTime;
+	Second m_crntTime;
+};
+
 SceneGraph::SceneGraph()
 {
 }
@@ -47,6 +67,17 @@ SceneGraph::~SceneGraph()
 
 	deleteNodesMarkedForDeletion();
 
+	for(SceneComponentPool* pool : m_componentPools)
+	{
+		m_alloc.deleteInstance(pool);
+	}
+	m_componentPools.destroy(m_alloc);
+
+	for(MovedSpatials& moved : m_movedSpatials)
+	{
+		moved.m_spatials.destroy(m_alloc);
+	}
+
 	if(m_octree)
 	{
 		m_alloc.deleteInstance(m_octree);
@@ -83,7 +114,8 @@ Error SceneGraph::init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHi
 	ANKI_CHECK(m_events.init(this));
 
 	m_octree = m_alloc.newInstance<Octree>(m_alloc);
-	m_octree->init(m_sceneMin, m_sceneMax, config.getNumberU32("scene_octreeMaxDepth"));
+	m_octree->init(m_sceneMin, m_sceneMax, config.getNumberU32("scene_octreeMaxDepth"),
+				   config.getBool("scene_looseOctree"));
 
 	// Init the default main camera
 	ANKI_CHECK(newSceneNode<PerspectiveCameraNode>("mainCamera", m_defaultMainCam));
@@ -173,6 +205,7 @@ void SceneGraph::deleteNodesMarkedForDeletion()
 				unregisterNode(&node);
 				m_alloc.deleteInstance(&node);
 				m_objectsMarkedForDeletionCount.fetchSub(1);
+				m_lastNodeDeletionTimestamp = m_timestamp;
 				found = true;
 				break;
 			}
@@ -196,6 +229,16 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 	// Reset the framepool
 	m_frameAlloc.getMemoryPool().reset();
 
+	// Reuse the oldest list of moved spatials for this frame
+	MovedSpatials& movedSpatials = m_movedSpatials[m_timestamp % MAX_MOVED_SPATIALS_FRAMES];
+	if(movedSpatials.m_spatials.getSize() < m_movedSpatialsCapacity)
+	{
+		movedSpatials.m_spatials.destroy(m_alloc);
+		movedSpatials.m_spatials.create(m_alloc, m_movedSpatialsCapacity);
+	}
+	movedSpatials.m_count.setNonAtomically(0);
+	movedSpatials.m_timestamp = m_timestamp;
+
 	// Delete stuff
 	{
 		ANKI_TRACE_SCOPED_EVENT(SCENE_MARKED_FOR_DELETION);
@@ -215,6 +258,9 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		ANKI_TRACE_SCOPED_EVENT(SCENE_NODES_UPDATE);
 		ANKI_CHECK(m_events.updateAllEvents(prevUpdateTime, crntTime));
 
+		// Then the components that don't depend on anything
+		updateComponentBatches(prevUpdateTime, crntTime);
+
 		// Then the rest
 		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
 		UpdateSceneNodesCtx updateCtx;
@@ -239,10 +285,31 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		m_threadHive->waitAllTasks();
 	}
 
+	// If the moved spatials didn't fit grow the lists of the next frames
+	const U32 movedSpatialCount = movedSpatials.m_count.getNonAtomically();
+	if(movedSpatialCount > m_movedSpatialsCapacity)
+	{
+		m_movedSpatialsCapacity = U32(nextPowerOfTwo(movedSpatialCount));
+	}
+
 	m_stats.m_updateTime = HighRezTimer::getCurrentTime() - m_stats.m_updateTime;
 	return Error::NONE;
 }
 
+Bool SceneGraph::getMovedSpatialComponents(Timestamp frameTimestamp, ConstWeakArray<SpatialComponent*>& spatials) const
+{
+	const MovedSpatials& moved = m_movedSpatials[frameTimestamp % MAX_MOVED_SPATIALS_FRAMES];
+	const U32 count = moved.m_count.getNonAtomically();
+	if(moved.m_timestamp != frameTimestamp || count > moved.m_spatials.getSize())
+	{
+		return false;
+	}
+
+	spatials = (count) ? ConstWeakArray<SpatialComponent*>(&moved.m_spatials[0], count)
+					   : ConstWeakArray<SpatialComponent*>();
+	return true;
+}
+
 void SceneGraph::doVisibilityTests(RenderQueue& rqueue)
 {
 	m_stats.m_visibilityTestsTime = HighRezTimer::getCurrentTime();
@@ -260,7 +327,16 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 	Timestamp componentTimestamp = 0;
 	err = node.iterateComponents([&](SceneComponent& comp) -> Error {
 		Bool updated = false;
-		Error e = comp.update(node, prevTime, crntTime, updated);
+		Error e = Error::NONE;
+		if(comp.isBatchUpdated())
+		{
+			// Already updated by updateComponentBatches()
+			updated = comp.getTimestamp() == node.getSceneGraph().m_timestamp;
+		}
+		else
+		{
+			e = comp.update(node, prevTime, crntTime, updated);
+		}
 
 		if(updated)
 		{
@@ -347,4 +423,115 @@ Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx) const
 	return err;
 }
 
+void SceneGraph::updateComponentBatches(Second prevTime, Second crntTime)
+{
+	// Gather the chunks of the pools that want batch updates
+	U32 batchCount = 0;
+	for(const SceneComponentPool* pool : m_componentPools)
+	{
+		batchCount += (pool->getBatchUpdate()) ? pool->getChunkCount() : 0;
+	}
+
+	if(batchCount == 0)
+	{
+		return;
+	}
+
+	UpdateComponentBatchesCtx ctx;
+	ctx.m_scene = this;
+	ctx.m_batches = WeakArray<UpdateComponentBatchesCtx::Batch>(
+		m_frameAlloc.newArray<UpdateComponentBatchesCtx::Batch>(batchCount), batchCount);
+	ctx.m_prevUpdateTime = prevTime;
+	ctx.m_crntTime = crntTime;
+
+	batchCount = 0;
+	for(const SceneComponentPool* pool : m_componentPools)
+	{
+		if(pool->getBatchUpdate())
+		{
+			for(U32 i = 0; i < pool->getChunkCount(); ++i)
+			{
+				ctx.m_batches[batchCount].m_pool = pool;
+				ctx.m_batches[batchCount].m_chunkIdx = i;
+				++batchCount;
+			}
+		}
+	}
+
+	// Update them in parallel
+	const U32 taskCount = min(m_threadHive->getThreadCount(), batchCount);
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+	for(U32 i = 0; i < taskCount; i++)
+	{
+		tasks[i] = ANKI_THREAD_HIVE_TASK(
+			{
+				if(self->m_scene->updateComponentBatches(*self))
+				{
+					ANKI_SCENE_LOGF("Will not recover");
+				}
+			},
+			&ctx, nullptr, nullptr);
+	}
+
+	m_threadHive->submitTasks(&tasks[0], taskCount);
+	m_threadHive->waitAllTasks();
+}
+
+Error SceneGraph::updateComponentBatches(UpdateComponentBatchesCtx& ctx) const
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_COMPONENTS_BATCH_UPDATE);
+
+	U32 batchIdx;
+	while((batchIdx = ctx.m_crntBatch.fetchAdd(1)) < ctx.m_batches.getSize())
+	{
+		const UpdateComponentBatchesCtx::Batch& batch = ctx.m_batches[batchIdx];
+		ANKI_CHECK(batch.m_pool->iterateChunkComponents(batch.m_chunkIdx, [&](SceneComponent& comp) -> Error {
+			Bool updated = false;
+			ANKI_CHECK(comp.update(comp.getOwnerNode(), ctx.m_prevUpdateTime, ctx.m_crntTime, updated));
+			if(updated)
+			{
+				comp.setTimestamp(m_timestamp);
+			}
+
+			return Error::NONE;
+		}));
+	}
+
+	return Error::NONE;
+}
+
+SceneComponentPool& SceneGraph::getOrCreateComponentPool(const void* classId, PtrSize componentSize,
+														 PtrSize alignment, Bool batchUpdate)
+{
+	LockGuard<SpinLock> lock(m_componentPoolsMtx);
+
+	for(SceneComponentPool* pool : m_componentPools)
+	{
+		if(pool->getClassId() == classId)
+		{
+			return *pool;
+		}
+	}
+
+	SceneComponentPool* pool =
+		m_alloc.newInstance<SceneComponentPool>(m_alloc, classId, componentSize, alignment, batchUpdate);
+	m_componentPools.emplaceBack(m_alloc, pool);
+	return *pool;
+}
+
+const SceneComponentPool* SceneGraph::tryFindComponentPool(const void* classId) const
+{
+	LockGuard<SpinLock> lock(m_componentPoolsMtx);
+
+	for(const SceneComponentPool* pool : m_componentPools)
+	{
+		if(pool->getClassId() == classId)
+		{
+			return pool;
+		}
+	}
+
+	return nullptr;
+}
+
 } // end namespace anki
@@ -11,6 +11,7 @@
 #include <anki/util/Singleton.h>
 #include <anki/util/HighRezTimer.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/WeakArray.h>
 #include <anki/core/App.h>
 #include <anki/scene/events/EventManager.h>
 #include <anki/resource/Common.h>
@@ -27,6 +28,7 @@ class ConfigSet;
 class PerspectiveCameraNode;
 class UpdateSceneNodesCtx;
 class Octree;
+class SpatialComponent;
 
 /// @addtogroup scene
 /// @{
@@ -149,6 +151,23 @@ public:
 	template<typename Func>
 	ANKI_USE_RESULT Error iterateSceneNodes(PtrSize begin, PtrSize end, Func func);
 
+	/// Iterate all the components of a class in the order they are stored in memory. It's faster than iterating the
+	/// nodes and their components.
+	/// @note It doesn't visit the components of the classes that derive from TComponent.
+	/// @note Don't create or delete components while iterating.
+	template<typename TComponent, typename TFunc>
+	ANKI_USE_RESULT Error iterateComponentsOfType(TFunc func) const
+	{
+		const SceneComponentPool* pool = tryFindComponentPool(SceneComponentClassId<TComponent>::get());
+		if(pool)
+		{
+			ANKI_CHECK(pool->iterateComponents(
+				[&](SceneComponent& comp) -> Error { return func(static_cast<TComponent&>(comp)); }));
+		}
+
+		return Error::NONE;
+	}
+
 	/// Create a new SceneNode
 	template<typename Node, typename... Args>
 	ANKI_USE_RESULT Error newSceneNode(const CString& name, Node*& node, Args&&... args);
@@ -227,8 +246,44 @@ public:
 		return *m_octree;
 	}
 
+	/// The SpatialComponent calls that when it's placed in the octree. It's used by the visibility cache.
+	/// @note It's thread-safe.
+	void notifySpatialComponentMoved(SpatialComponent* sp)
+	{
+		ANKI_ASSERT(sp);
+		MovedSpatials& moved = m_movedSpatials[m_timestamp % MAX_MOVED_SPATIALS_FRAMES];
+		const U32 idx = moved.m_count.fetchAdd(1);
+		if(idx < moved.m_spatials.getSize())
+		{
+			moved.m_spatials[idx] = sp;
+		}
+	}
+
+	/// Get the spatial components that were placed in the octree at a specific frame. It's used by the visibility
+	/// cache.
+	/// @return False if that information is not available because the frame is too old or it didn't fit.
+	Bool getMovedSpatialComponents(Timestamp frameTimestamp, ConstWeakArray<SpatialComponent*>& spatials) const;
+
+	/// Get the last frame some nodes got deleted.
+	Timestamp getLastNodeDeletionTimestamp() const
+	{
+		return m_lastNodeDeletionTimestamp;
+	}
+
 private:
 	class UpdateSceneNodesCtx;
+	class UpdateComponentBatchesCtx;
+
+	/// The spatial components that got placed in the octree in a single frame.
+	class MovedSpatials
+	{
+	public:
+		DynamicArray<SpatialComponent*> m_spatials;
+		Atomic<U32> m_count = {0}; ///< It might be greater than the size of m_spatials.
+		Timestamp m_timestamp = 0;
+	};
+
+	static constexpr U32 MAX_MOVED_SPATIALS_FRAMES = 16;
 
 	const Timestamp* m_globalTimestamp = nullptr;
 	Timestamp m_timestamp = 0; ///< Cached timestamp
@@ -260,9 +315,16 @@ private:
 	Vec3 m_sceneMax = {1000.0f, 200.0f, 1000.0f};
 
 	Atomic<U32> m_objectsMarkedForDeletionCount = {0};
+	Timestamp m_lastNodeDeletionTimestamp = 0;
+
+	Array<MovedSpatials, MAX_MOVED_SPATIALS_FRAMES> m_movedSpatials; ///< A ring buffer indexed by the timestamp.
+	U32 m_movedSpatialsCapacity = 128;
 
 	Atomic<U64> m_nodesUuid = {1};
 
+	DynamicArray<SceneComponentPool*> m_componentPools; ///< One for each component class.
+	mutable SpinLock m_componentPoolsMtx;
+
 	SceneGraphConfig m_config;
 	SceneGraphStats m_stats;
 
@@ -276,6 +338,17 @@ private:
 	ANKI_USE_RESULT Error updateNodes(UpdateSceneNodesCtx& ctx) const;
 	ANKI_USE_RESULT static Error updateNode(Second prevTime, Second crntTime, SceneNode& node);
 
+	/// Update the components that have SceneComponent::BATCH_UPDATE in parallel.
+	void updateComponentBatches(Second prevTime, Second crntTime);
+	ANKI_USE_RESULT Error updateComponentBatches(UpdateComponentBatchesCtx& ctx) const;
+
+	/// @note It's thread-safe.
+	SceneComponentPool& getOrCreateComponentPool(const void* classId, PtrSize componentSize, PtrSize alignment,
+												 Bool batchUpdate);
+
+	/// @note It's thread-safe.
+	const SceneComponentPool* tryFindComponentPool(const void* classId) const;
+
 	/// Do visibility tests.
 	static void doVisibilityTests(SceneNode& frustumable, SceneGraph& scene, RenderQueue& rqueue);
 };
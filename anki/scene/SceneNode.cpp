@@ -28,7 +28,9 @@ SceneNode::~SceneNode()
 	for(; it != end; ++it)
 	{
 		SceneComponent* comp = *it;
-		alloc.deleteInstance(comp);
+		SceneComponentPool& pool = SceneComponentPool::getPoolOf(comp);
+		comp->~SceneComponent();
+		pool.free(comp);
 	}
 
 	Base::destroy(alloc);
@@ -70,6 +72,11 @@ SceneFrameAllocator<U8> SceneNode::getFrameAllocator() const
 	return m_scene->getFrameAllocator();
 }
 
+void* SceneNode::allocateComponent(const void* classId, PtrSize size, PtrSize alignment, Bool batchUpdate)
+{
+	return m_scene->getOrCreateComponentPool(classId, size, alignment, batchUpdate).allocate();
+}
+
 ResourceManager& SceneNode::getResourceManager()
 {
 	return m_scene->getResourceManager();
@@ -12,6 +12,7 @@
 #include <anki/util/List.h>
 #include <anki/util/Enum.h>
 #include <anki/scene/components/SceneComponent.h>
+#include <anki/scene/components/SceneComponentPool.h>
 
 namespace anki
 {
@@ -254,11 +255,20 @@ public:
 	}
 
 protected:
-	/// Create and append a component to the components container. The SceneNode has the ownership.
+	/// Create and append a component to the components container. The SceneNode has the ownership. The component is
+	/// placed next to the other components of the same class.
 	template<typename TComponent, typename... TArgs>
 	TComponent* newComponent(TArgs&&... args)
 	{
-		TComponent* comp = getAllocator().newInstance<TComponent>(std::forward<TArgs>(args)...);
+		static_assert(sizeof(TComponent) <= SceneComponentPool::MAX_COMPONENT_SIZE, "Component too big");
+		static_assert(alignof(TComponent) <= SceneComponentPool::MAX_COMPONENT_ALIGNMENT, "Wrong alignment");
+
+		void* mem = allocateComponent(SceneComponentClassId<TComponent>::get(), sizeof(TComponent),
+									  alignof(TComponent), TComponent::BATCH_UPDATE);
+		TComponent* comp = ::new(mem) TComponent(std::forward<TArgs>(args)...);
+		ANKI_ASSERT(static_cast<SceneComponent*>(comp) == mem && "The pools assume that");
+		comp->m_ownerNode = this;
+		comp->m_batchUpdate = TComponent::BATCH_UPDATE;
 		m_components.emplaceBack(getAllocator(), comp);
 		return comp;
 	}
@@ -340,6 +350,8 @@ private:
 	Timestamp m_maxComponentTimestamp = 0;
 
 	Bool m_markedForDeletion = false;
+
+	void* allocateComponent(const void* classId, PtrSize size, PtrSize alignment, Bool batchUpdate);
 };
 /// @}
 
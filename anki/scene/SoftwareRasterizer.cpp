@@ -11,6 +11,34 @@
 namespace anki
 {
 
+class SoftwareRasterizer::BinnedTriangle
+{
+public:
+	/// The barycentric coordinates of the 3 vertices. Every one of them is a plane equation (x * a + y * b + c) where
+	/// x and y are in window space.
+	Array<Vec3, 3> m_edges;
+
+	/// The depth as a plane equation in window space.
+	Vec3 m_depth;
+
+	/// The tiles that the triangle touches. Min x, min y, max x and max y.
+	UVec4 m_tileRect;
+};
+
+class SoftwareRasterizer::BinNode
+{
+public:
+	const BinnedTriangle* m_triangle;
+	BinNode* m_next;
+};
+
+class SoftwareRasterizer::BinBlock
+{
+public:
+	BinBlock* m_next;
+	PtrSize m_size;
+};
+
 void SoftwareRasterizer::prepare(const Mat4& mv, const Mat4& p, U32 width, U32 height)
 {
 	m_mv = mv;
@@ -20,17 +48,85 @@ void SoftwareRasterizer::prepare(const Mat4& mv, const Mat4& p, U32 width, U32 h
 	extractClipPlanes(p, m_planesL);
 	extractClipPlanes(m_mvp, m_planesW);
 
-	// Reset z buffer
+	// Reset z buffer. Align it to the tile size to avoid special cases when rasterizing tiles
 	ANKI_ASSERT(width > 0 && height > 0);
 	m_width = width;
 	m_height = height;
-	U32 size = width * height;
+	m_tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	m_zbufferStride = m_tileCountX * TILE_SIZE;
+	const U32 size = m_zbufferStride * m_tileCountY * TILE_SIZE;
 	if(m_zbuffer.getSize() < size)
 	{
 		m_zbuffer.destroy(m_alloc);
 		m_zbuffer.create(m_alloc, size);
 	}
 	memset(&m_zbuffer[0], 0xFF, sizeof(m_zbuffer[0]) * size);
+
+	// Reset tiles
+	const U32 tileCount = m_tileCountX * m_tileCountY;
+	if(m_tileBins.getSize() < tileCount)
+	{
+		m_tileBins.destroy(m_alloc);
+		m_tileBins.create(m_alloc, tileCount);
+	}
+
+	for(U32 i = 0; i < tileCount; ++i)
+	{
+		m_tileBins[i].setNonAtomically(nullptr);
+	}
+
+	// Reset the hierarchical depth. The last level is a single cell
+	U32 hizSize = 0;
+	U32 levelWidth = m_tileCountX;
+	U32 levelHeight = m_tileCountY;
+	m_hizLevelCount = 0;
+	while(true)
+	{
+		ANKI_ASSERT(m_hizLevelCount < MAX_HIZ_LEVELS);
+		HizLevel& level = m_hizLevels[m_hizLevelCount++];
+		level.m_offset = hizSize;
+		level.m_width = levelWidth;
+		level.m_height = levelHeight;
+		hizSize += levelWidth * levelHeight;
+
+		if(levelWidth == 1 && levelHeight == 1)
+		{
+			break;
+		}
+
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+
+	if(m_hizMinDepth.getSize() < hizSize)
+	{
+		m_hizMinDepth.destroy(m_alloc);
+		m_hizMinDepth.create(m_alloc, hizSize);
+		m_hizMaxDepth.destroy(m_alloc);
+		m_hizMaxDepth.create(m_alloc, hizSize);
+	}
+
+	for(U32 i = 0; i < hizSize; ++i)
+	{
+		m_hizMinDepth[i].setNonAtomically(MAX_U32);
+		m_hizMaxDepth[i].setNonAtomically(MAX_U32);
+	}
+
+	destroyBins();
+}
+
+void SoftwareRasterizer::destroyBins()
+{
+	BinBlock* block = m_binBlocks.getNonAtomically();
+	while(block)
+	{
+		BinBlock* next = block->m_next;
+		m_alloc.deallocate(block, block->m_size);
+		block = next;
+	}
+
+	m_binBlocks.setNonAtomically(nullptr);
 }
 
 void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& outVertCount) const
@@ -164,12 +260,14 @@ void SoftwareRasterizer::clipTriangle(const Vec4* inVerts, Vec4* outVerts, U& ou
 	}
 }
 
-void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool backfaceCulling)
+template<typename TFunc>
+void SoftwareRasterizer::iterateClippedTriangles(const F32* verts, U32 vertCount, U32 stride, Bool backfaceCulling,
+												 TFunc func) const
 {
 	ANKI_ASSERT(verts && vertCount > 0 && (vertCount % 3) == 0);
 	ANKI_ASSERT(stride >= sizeof(F32) * 3 && (stride % sizeof(F32)) == 0);
 
-	U floatStride = stride / sizeof(F32);
+	U32 floatStride = stride / sizeof(F32);
 	const F32* vertsEnd = verts + vertCount * floatStride;
 	while(verts != vertsEnd)
 	{
@@ -214,7 +312,334 @@ void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool back
 				ANKI_ASSERT(clip[k].w() > 0.0f);
 			}
 
-			rasterizeTriangle(&clip[0]);
+			func(&clip[0]);
+		}
+	}
+}
+
+void SoftwareRasterizer::draw(const F32* verts, U vertCount, U stride, Bool backfaceCulling)
+{
+	iterateClippedTriangles(verts, U32(vertCount), U32(stride), backfaceCulling,
+							[this](const Vec4* clipTri) { rasterizeTriangle(clipTri); });
+}
+
+void SoftwareRasterizer::drawBinned(const F32* verts, U32 vertCount, U32 stride, Bool backfaceCulling)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_RASTERIZER_BIN);
+
+	// Allocate the triangles. Clipping can produce 2 triangles for every input triangle
+	const U32 maxTriangleCount = vertCount / 3 * 2;
+	PtrSize alignment = alignof(BinnedTriangle);
+	const PtrSize trianglesBlockSize = getAlignedRoundUp(alignment, sizeof(BinBlock))
+									   + sizeof(BinnedTriangle) * maxTriangleCount;
+	BinBlock* trianglesBlock = reinterpret_cast<BinBlock*>(m_alloc.allocate(trianglesBlockSize, &alignment));
+	trianglesBlock->m_size = trianglesBlockSize;
+	BinnedTriangle* triangles = reinterpret_cast<BinnedTriangle*>(
+		reinterpret_cast<U8*>(trianglesBlock) + getAlignedRoundUp(alignof(BinnedTriangle), sizeof(BinBlock)));
+
+	// Setup the triangles
+	U32 triangleCount = 0;
+	U32 nodeCount = 0;
+	iterateClippedTriangles(verts, vertCount, stride, backfaceCulling, [&](const Vec4* clipTri) {
+		BinnedTriangle& tri = triangles[triangleCount];
+		if(setupBinnedTriangle(clipTri, tri))
+		{
+			++triangleCount;
+			nodeCount += (tri.m_tileRect.z() - tri.m_tileRect.x() + 1) * (tri.m_tileRect.w() - tri.m_tileRect.y() + 1);
+		}
+	});
+	ANKI_ASSERT(triangleCount <= maxTriangleCount);
+
+	trianglesBlock->m_next = m_binBlocks.exchange(trianglesBlock);
+	if(triangleCount == 0)
+	{
+		return;
+	}
+
+	// Allocate the bin nodes
+	alignment = alignof(BinNode);
+	const PtrSize nodesBlockSize = getAlignedRoundUp(alignment, sizeof(BinBlock)) + sizeof(BinNode) * nodeCount;
+	BinBlock* nodesBlock = reinterpret_cast<BinBlock*>(m_alloc.allocate(nodesBlockSize, &alignment));
+	nodesBlock->m_size = nodesBlockSize;
+	BinNode* nodes = reinterpret_cast<BinNode*>(reinterpret_cast<U8*>(nodesBlock)
+												+ getAlignedRoundUp(alignof(BinNode), sizeof(BinBlock)));
+	nodesBlock->m_next = m_binBlocks.exchange(nodesBlock);
+
+	// Push the triangles to the bins. No one will walk the bins before all drawBinned() calls are done so there is no
+	// need for anything fancier than an exchange
+	for(U32 i = 0; i < triangleCount; ++i)
+	{
+		const BinnedTriangle& tri = triangles[i];
+		for(U32 tileY = tri.m_tileRect.y(); tileY <= tri.m_tileRect.w(); ++tileY)
+		{
+			for(U32 tileX = tri.m_tileRect.x(); tileX <= tri.m_tileRect.z(); ++tileX)
+			{
+				BinNode& node = *(nodes++);
+				node.m_triangle = &tri;
+				node.m_next = m_tileBins[tileY * m_tileCountX + tileX].exchange(&node);
+			}
+		}
+	}
+}
+
+Bool SoftwareRasterizer::setupBinnedTriangle(const Vec4* tri, BinnedTriangle& out) const
+{
+	ANKI_ASSERT(tri);
+
+	// To window space
+	const Vec2 windowSize{F32(m_width), F32(m_height)};
+	Array<Vec3, 3> window;
+	Vec2 bboxMin(MAX_F32), bboxMax(MIN_F32);
+	for(U32 i = 0; i < 3; i++)
+	{
+		const Vec3 ndc = tri[i].xyz() / tri[i].w();
+		window[i] = Vec3((ndc.xy() / 2.0f + 0.5f) * windowSize, ndc.z());
+
+		bboxMin = bboxMin.min(window[i].xy());
+		bboxMax = bboxMax.max(window[i].xy());
+	}
+
+	// Cull if it's outside the window
+	if(bboxMax.x() < 0.0f || bboxMax.y() < 0.0f || bboxMin.x() >= windowSize.x() || bboxMin.y() >= windowSize.y())
+	{
+		return false;
+	}
+
+	// Compute the signed area and drop degenerate triangles
+	const Vec3& v0 = window[0];
+	const Vec3& v1 = window[1];
+	const Vec3& v2 = window[2];
+	const F32 area = (v1.x() - v0.x()) * (v2.y() - v0.y()) - (v1.y() - v0.y()) * (v2.x() - v0.x());
+	if(isZero(area))
+	{
+		return false;
+	}
+	const F32 invArea = 1.0f / area;
+
+	// The edge function of the edge a->b normalized by the area. It's the barycentric of the opposite vertex
+	auto computeEdge = [invArea](const Vec3& a, const Vec3& b) -> Vec3 {
+		const F32 dx = b.x() - a.x();
+		const F32 dy = b.y() - a.y();
+		return Vec3(-dy, dx, dy * a.x() - dx * a.y()) * invArea;
+	};
+
+	out.m_edges[0] = computeEdge(v1, v2);
+	out.m_edges[1] = computeEdge(v2, v0);
+	out.m_edges[2] = computeEdge(v0, v1);
+	out.m_depth = out.m_edges[0] * v0.z() + out.m_edges[1] * v1.z() + out.m_edges[2] * v2.z();
+
+	// Compute the tiles
+	bboxMin = bboxMin.max(Vec2(0.0f));
+	bboxMax = bboxMax.min(windowSize - Vec2(1.0f));
+	out.m_tileRect.x() = U32(bboxMin.x()) / TILE_SIZE;
+	out.m_tileRect.y() = U32(bboxMin.y()) / TILE_SIZE;
+	out.m_tileRect.z() = min(U32(bboxMax.x()) / TILE_SIZE, m_tileCountX - 1);
+	out.m_tileRect.w() = min(U32(bboxMax.y()) / TILE_SIZE, m_tileCountY - 1);
+
+	return true;
+}
+
+void SoftwareRasterizer::rasterizeBinnedTiles(U32 threadId, U32 threadCount)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_RASTERIZER_RASTERIZE);
+	ANKI_ASSERT(threadId < threadCount);
+
+	const U32 tileCount = m_tileCountX * m_tileCountY;
+	for(U32 tileIdx = threadId; tileIdx < tileCount; tileIdx += threadCount)
+	{
+		const BinNode* bin = m_tileBins[tileIdx].getNonAtomically();
+		if(bin == nullptr)
+		{
+			// Nothing to do, the depth bounds are already correct
+			continue;
+		}
+
+		const U32 tileX = tileIdx % m_tileCountX;
+		const U32 tileY = tileIdx / m_tileCountX;
+		rasterizeTile(tileX, tileY, bin);
+		computeTileDepthBounds(tileX, tileY);
+		propagateTileDepthBounds(tileX, tileY);
+	}
+}
+
+void SoftwareRasterizer::rasterizeTile(U32 tileX, U32 tileY, const BinNode* bin)
+{
+	static_assert(TILE_SIZE % 4 == 0, "The tile is processed 4 pixels at a time");
+	static_assert(sizeof(Atomic<U32>) == sizeof(U32), "Will access the depth buffer as plain U32");
+
+	// Only one thread touches that tile so no need for atomics
+	U32* const zbuffer = reinterpret_cast<U32*>(&m_zbuffer[0]);
+	const U32 x0 = tileX * TILE_SIZE;
+	const U32 y0 = tileY * TILE_SIZE;
+
+	const SimdF32x4 zero(0.0f);
+	const SimdF32x4 maxDepth(1.0f - EPSILON); // See rasterizeTriangle() why is that
+	const SimdF32x4 pixelCenterOffsets(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for(; bin; bin = bin->m_next)
+	{
+		const BinnedTriangle& tri = *bin->m_triangle;
+
+		const SimdF32x4 e0a(tri.m_edges[0].x());
+		const SimdF32x4 e1a(tri.m_edges[1].x());
+		const SimdF32x4 e2a(tri.m_edges[2].x());
+		const SimdF32x4 za(tri.m_depth.x());
+
+		for(U32 y = 0; y < TILE_SIZE; ++y)
+		{
+			// Compute the part of the equations that is the same for the whole row
+			const F32 py = F32(y0 + y) + 0.5f;
+			const SimdF32x4 e0y(tri.m_edges[0].y() * py + tri.m_edges[0].z());
+			const SimdF32x4 e1y(tri.m_edges[1].y() * py + tri.m_edges[1].z());
+			const SimdF32x4 e2y(tri.m_edges[2].y() * py + tri.m_edges[2].z());
+			const SimdF32x4 zy(tri.m_depth.y() * py + tri.m_depth.z());
+
+			U32* row = zbuffer + (y0 + y) * m_zbufferStride + x0;
+			for(U32 x = 0; x < TILE_SIZE; x += 4)
+			{
+				const SimdF32x4 px = SimdF32x4(F32(x0 + x)) + pixelCenterOffsets;
+
+				const SimdMask4 inside = (e0a.mad(px, e0y) >= zero) & (e1a.mad(px, e1y) >= zero)
+										 & (e2a.mad(px, e2y) >= zero);
+				if(!inside.any())
+				{
+					continue;
+				}
+
+				const SimdF32x4 depth = za.mad(px, zy).max(zero).min(maxDepth);
+
+				// Store the min of the current value and new one
+				const SimdU32x4 oldDepthi = SimdU32x4::load(row + x);
+				const SimdU32x4 newDepthi = SimdU32x4::select(inside, SimdU32x4::fromUnorm(depth), oldDepthi);
+				oldDepthi.min(newDepthi).store(row + x);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::computeTileDepthBounds(U32 tileX, U32 tileY)
+{
+	const U32* const zbuffer = reinterpret_cast<const U32*>(&m_zbuffer[0]);
+	const U32 x0 = tileX * TILE_SIZE;
+	const U32 y0 = tileY * TILE_SIZE;
+	const U32 x1 = min(x0 + TILE_SIZE, m_width);
+	const U32 y1 = min(y0 + TILE_SIZE, m_height);
+
+	U32 minDepth, maxDepth;
+	if(x1 - x0 == TILE_SIZE && y1 - y0 == TILE_SIZE)
+	{
+		// Fast path for tiles that are fully inside the window
+		SimdU32x4 minDepth4(MAX_U32);
+		SimdU32x4 maxDepth4(0u);
+		for(U32 y = y0; y < y1; ++y)
+		{
+			for(U32 x = x0; x < x1; x += 4)
+			{
+				const SimdU32x4 depth = SimdU32x4::load(zbuffer + y * m_zbufferStride + x);
+				minDepth4 = minDepth4.min(depth);
+				maxDepth4 = maxDepth4.max(depth);
+			}
+		}
+
+		minDepth = minDepth4.horizontalMin();
+		maxDepth = maxDepth4.horizontalMax();
+	}
+	else
+	{
+		// The padding of the depth buffer shouldn't contribute
+		minDepth = MAX_U32;
+		maxDepth = 0;
+		for(U32 y = y0; y < y1; ++y)
+		{
+			for(U32 x = x0; x < x1; ++x)
+			{
+				const U32 depth = zbuffer[y * m_zbufferStride + x];
+				minDepth = min(minDepth, depth);
+				maxDepth = max(maxDepth, depth);
+			}
+		}
+	}
+
+	// Other threads might read them in propagateTileDepthBounds() so make the stores visible before any other load
+	const U32 idx = getHizIndex(0, tileX, tileY);
+	m_hizMinDepth[idx].store(minDepth, AtomicMemoryOrder::SEQ_CST);
+	m_hizMaxDepth[idx].store(maxDepth, AtomicMemoryOrder::SEQ_CST);
+}
+
+void SoftwareRasterizer::propagateTileDepthBounds(U32 tileX, U32 tileY)
+{
+	// The depth of a tile can only decrease while drawing so the cells are updated with an atomic min. Since the max of
+	// the parent is recomputed from the current values of the children, a concurrent update of a sibling might read a
+	// stale (greater) value. That is still conservative and the last thread that updates a sibling will see the
+	// correct values anyway
+	U32 x = tileX;
+	U32 y = tileY;
+	for(U32 level = 1; level < m_hizLevelCount; ++level)
+	{
+		const HizLevel& childLevel = m_hizLevels[level - 1];
+		x /= 2;
+		y /= 2;
+
+		U32 minDepth = MAX_U32;
+		U32 maxDepth = 0;
+		for(U32 childY = y * 2; childY < min(y * 2 + 2, childLevel.m_height); ++childY)
+		{
+			for(U32 childX = x * 2; childX < min(x * 2 + 2, childLevel.m_width); ++childX)
+			{
+				const U32 childIdx = getHizIndex(level - 1, childX, childY);
+				minDepth = min(minDepth, m_hizMinDepth[childIdx].load(AtomicMemoryOrder::SEQ_CST));
+				maxDepth = max(maxDepth, m_hizMaxDepth[childIdx].load(AtomicMemoryOrder::SEQ_CST));
+			}
+		}
+
+		const U32 idx = getHizIndex(level, x, y);
+		m_hizMinDepth[idx].min(minDepth, AtomicMemoryOrder::SEQ_CST);
+		m_hizMaxDepth[idx].min(maxDepth, AtomicMemoryOrder::SEQ_CST);
+	}
+}
+
+void SoftwareRasterizer::propagateTileMinDepth(const UVec4& tileRect, U32 minDepth)
+{
+	UVec4 rect = tileRect;
+	for(U32 level = 1; level < m_hizLevelCount; ++level)
+	{
+		rect /= 2;
+		for(U32 y = rect.y(); y <= rect.w(); ++y)
+		{
+			for(U32 x = rect.x(); x <= rect.z(); ++x)
+			{
+				m_hizMinDepth[getHizIndex(level, x, y)].min(minDepth);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::rebuildHiz()
+{
+	for(U32 level = 1; level < m_hizLevelCount; ++level)
+	{
+		const HizLevel& childLevel = m_hizLevels[level - 1];
+		const HizLevel& crntLevel = m_hizLevels[level];
+		for(U32 y = 0; y < crntLevel.m_height; ++y)
+		{
+			for(U32 x = 0; x < crntLevel.m_width; ++x)
+			{
+				U32 minDepth = MAX_U32;
+				U32 maxDepth = 0;
+				for(U32 childY = y * 2; childY < min(y * 2 + 2, childLevel.m_height); ++childY)
+				{
+					for(U32 childX = x * 2; childX < min(x * 2 + 2, childLevel.m_width); ++childX)
+					{
+						const U32 childIdx = getHizIndex(level - 1, childX, childY);
+						minDepth = min(minDepth, m_hizMinDepth[childIdx].getNonAtomically());
+						maxDepth = max(maxDepth, m_hizMaxDepth[childIdx].getNonAtomically());
+					}
+				}
+
+				const U32 idx = getHizIndex(level, x, y);
+				m_hizMinDepth[idx].setNonAtomically(minDepth);
+				m_hizMaxDepth[idx].setNonAtomically(maxDepth);
+			}
 		}
 	}
 }
@@ -271,6 +696,7 @@ void SoftwareRasterizer::rasterizeTriangle(const Vec4* tri)
 		}
 	}
 
+	U32 triangleMinDepth = MAX_U32;
 	for(F32 y = bboxMin.y() + 0.5f; y < bboxMax.y() + 0.5f; y += 1.0f)
 	{
 		for(F32 x = bboxMin.x() + 0.5f; x < bboxMax.x() + 0.5f; x += 1.0f)
@@ -289,12 +715,26 @@ void SoftwareRasterizer::rasterizeTriangle(const Vec4* tri)
 				// Clamp it to a bit less that 1.0f because 1.0f will produce a 0 depthi
 				depth = min(depth, 1.0f - EPSILON);
 
-				// Store the min of the current value and new one
+				// Store the min of the current value and new one. The max depth of the tile is still conservative
 				const U32 depthi = U32(depth * F32(MAX_U32));
-				m_zbuffer[U32(y) * m_width + U32(x)].min(depthi);
+				m_zbuffer[U32(y) * m_zbufferStride + U32(x)].min(depthi);
+				m_hizMinDepth[getHizIndex(0, U32(x) / TILE_SIZE, U32(y) / TILE_SIZE)].min(depthi);
+				triangleMinDepth = min(triangleMinDepth, depthi);
 			}
 		}
 	}
+
+	// Update the upper levels once per triangle and not per pixel. It's conservative since the min depth of the
+	// triangle might be in another cell
+	if(triangleMinDepth != MAX_U32)
+	{
+		UVec4 tileRect;
+		tileRect.x() = U32(bboxMin.x()) / TILE_SIZE;
+		tileRect.y() = U32(bboxMin.y()) / TILE_SIZE;
+		tileRect.z() = min(U32(bboxMax.x()) / TILE_SIZE, m_tileCountX - 1);
+		tileRect.w() = min(U32(bboxMax.y()) / TILE_SIZE, m_tileCountY - 1);
+		propagateTileMinDepth(tileRect, triangleMinDepth);
+	}
 }
 
 Bool SoftwareRasterizer::visibilityTest(const Aabb& aabb) const
@@ -371,19 +811,98 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 	bboxMax.y() = ceilf(bboxMax.y());
 	bboxMax.y() = clamp(bboxMax.y(), 0.0f, F32(m_height));
 
-	// Loop the tiles
-	F32 minZ = bboxMin.z();
-	for(F32 y = bboxMin.y(); y < bboxMax.y(); y += 1.0f)
+	// Loop the tiles first and then the pixels of the tiles that are inconclusive
+	const F32 minZ = bboxMin.z();
+	const U32 pixelMinX = U32(bboxMin.x());
+	const U32 pixelMinY = U32(bboxMin.y());
+	const U32 pixelMaxX = U32(bboxMax.x());
+	const U32 pixelMaxY = U32(bboxMax.y());
+	if(pixelMinX == pixelMaxX || pixelMinY == pixelMaxY)
+	{
+		// Doesn't cover any pixel
+		return false;
+	}
+
+	const U32 tileMinX = pixelMinX / TILE_SIZE;
+	const U32 tileMinY = pixelMinY / TILE_SIZE;
+	const U32 tileMaxX = (pixelMaxX - 1) / TILE_SIZE;
+	const U32 tileMaxY = (pixelMaxY - 1) / TILE_SIZE;
+
+	// Find the coarsest level of the hierarchical depth where the rect covers at most 2x2 cells and test against it
+	U32 level = 0;
+	UVec4 cellRect(tileMinX, tileMinY, tileMaxX, tileMaxY);
+	while(level + 1 < m_hizLevelCount && (cellRect.z() - cellRect.x() > 1 || cellRect.w() - cellRect.y() > 1))
+	{
+		++level;
+		cellRect /= 2;
+	}
+
+	F32 hizMaxDepth = 0.0f;
+	for(U32 y = cellRect.y(); y <= cellRect.w(); ++y)
+	{
+		for(U32 x = cellRect.x(); x <= cellRect.z(); ++x)
+		{
+			const U32 idx = getHizIndex(level, x, y);
+
+			// In front of everything in the cell. The cell might be bigger than the rect but the min depth of the rect
+			// can't be less than the min of the cell
+			const F32 cellMinDepth = F32(m_hizMinDepth[idx].getNonAtomically()) / F32(MAX_U32);
+			if(minZ < cellMinDepth)
+			{
+				ANKI_TRACE_INC_COUNTER(SCENE_RASTERIZER_EARLY_ACCEPTS, 1);
+				return true;
+			}
+
+			hizMaxDepth = max(hizMaxDepth, F32(m_hizMaxDepth[idx].getNonAtomically()) / F32(MAX_U32));
+		}
+	}
+
+	if(minZ >= hizMaxDepth)
+	{
+		// Behind everything in all the cells
+		ANKI_TRACE_INC_COUNTER(SCENE_RASTERIZER_EARLY_REJECTS, 1);
+		return false;
+	}
+
+	// Inconclusive, do the full test
+	for(U32 tileY = tileMinY; tileY <= tileMaxY; ++tileY)
 	{
-		for(F32 x = bboxMin.x(); x < bboxMax.x(); x += 1.0f)
+		for(U32 tileX = tileMinX; tileX <= tileMaxX; ++tileX)
 		{
-			const U32 idx = U32(y) * m_width + U32(x);
-			const U32 depthi = m_zbuffer[idx].getNonAtomically();
-			const F32 depthf = F32(depthi) / F32(MAX_U32);
-			if(minZ < depthf)
+			const U32 tileIdx = getHizIndex(0, tileX, tileY);
+
+			// Behind everything in the tile
+			const F32 tileMaxDepth = F32(m_hizMaxDepth[tileIdx].getNonAtomically()) / F32(MAX_U32);
+			if(minZ >= tileMaxDepth)
+			{
+				continue;
+			}
+
+			// In front of everything in the tile
+			const F32 tileMinDepth = F32(m_hizMinDepth[tileIdx].getNonAtomically()) / F32(MAX_U32);
+			if(minZ < tileMinDepth)
 			{
 				return true;
 			}
+
+			// Inconclusive, test the pixels
+			const U32 x0 = max(pixelMinX, tileX * TILE_SIZE);
+			const U32 x1 = min(pixelMaxX, (tileX + 1) * TILE_SIZE);
+			const U32 y0 = max(pixelMinY, tileY * TILE_SIZE);
+			const U32 y1 = min(pixelMaxY, (tileY + 1) * TILE_SIZE);
+			for(U32 y = y0; y < y1; ++y)
+			{
+				for(U32 x = x0; x < x1; ++x)
+				{
+					const U32 idx = y * m_zbufferStride + x;
+					const U32 depthi = m_zbuffer[idx].getNonAtomically();
+					const F32 depthf = F32(depthi) / F32(MAX_U32);
+					if(minZ < depthf)
+					{
+						return true;
+					}
+				}
+			}
 		}
 	}
 
@@ -392,19 +911,32 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 
 void SoftwareRasterizer::fillDepthBuffer(ConstWeakArray<F32> depthValues)
 {
-	ANKI_ASSERT(m_zbuffer.getSize() == depthValues.getSize());
+	ANKI_ASSERT(m_width * m_height == depthValues.getSize());
 
-	U32 count = depthValues.getSize();
-	while(count--)
+	for(U32 y = 0; y < m_height; ++y)
 	{
-		F32 depth = depthValues[count];
-		ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
+		for(U32 x = 0; x < m_width; ++x)
+		{
+			F32 depth = depthValues[y * m_width + x];
+			ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
 
-		depth = min(depth, 1.0f - EPSILON); // See a few lines above why is that
+			depth = min(depth, 1.0f - EPSILON); // See a few lines above why is that
 
-		const U32 depthi = U32(depth * F32(MAX_U32));
-		m_zbuffer[count].setNonAtomically(depthi);
+			const U32 depthi = U32(depth * F32(MAX_U32));
+			m_zbuffer[y * m_zbufferStride + x].setNonAtomically(depthi);
+		}
 	}
+
+	// Update the tiles
+	for(U32 tileY = 0; tileY < m_tileCountY; ++tileY)
+	{
+		for(U32 tileX = 0; tileX < m_tileCountX; ++tileX)
+		{
+			computeTileDepthBounds(tileX, tileY);
+		}
+	}
+
+	rebuildHiz();
 }
 
 } // end namespace anki
@@ -17,16 +17,28 @@ namespace anki
 /// @{
 
 /// Software rasterizer for visibility tests.
+///
+/// It has two ways to draw. The first is draw() that rasterizes the triangles immediately one pixel at a time. The
+/// second is drawBinned() that only bins the triangles to TILE_SIZE x TILE_SIZE tiles. The binned triangles are
+/// rasterized later by rasterizeBinnedTiles() using SIMD. Both keep a hierarchical min and max depth (starting from
+/// the tiles and going up to a single cell) up to date. visibilityTest() tests against the coarsest level that covers
+/// the box first and falls back to the tiles and the pixels only if that is inconclusive.
 class SoftwareRasterizer
 {
 public:
+	static constexpr U32 TILE_SIZE = 8;
+
 	SoftwareRasterizer()
 	{
 	}
 
 	~SoftwareRasterizer()
 	{
+		destroyBins();
 		m_zbuffer.destroy(m_alloc);
+		m_hizMinDepth.destroy(m_alloc);
+		m_hizMaxDepth.destroy(m_alloc);
+		m_tileBins.destroy(m_alloc);
 	}
 
 	/// Initialize.
@@ -46,6 +58,15 @@ public:
 	/// @note It's thread-safe against other draw() invocations only.
 	void draw(const F32* verts, U vertCount, U stride, Bool backfaceCulling);
 
+	/// Same as draw() but it only bins the triangles to tiles. Call rasterizeBinnedTiles() to actually draw them.
+	/// @note It's thread-safe against other drawBinned() invocations only.
+	void drawBinned(const F32* verts, U32 vertCount, U32 stride, Bool backfaceCulling);
+
+	/// Rasterize the triangles binned by drawBinned(). It will process every threadCount-th tile starting from
+	/// threadId so it can be split across threads.
+	/// @note It's thread-safe against other rasterizeBinnedTiles() invocations with different threadId.
+	void rasterizeBinnedTiles(U32 threadId, U32 threadCount);
+
 	/// Fill the depth buffer with some values.
 	void fillDepthBuffer(ConstWeakArray<F32> depthValues);
 
@@ -55,6 +76,20 @@ public:
 	Bool visibilityTest(const Aabb& aabb) const;
 
 private:
+	class BinnedTriangle;
+	class BinNode;
+	class BinBlock;
+
+	class HizLevel
+	{
+	public:
+		U32 m_offset; ///< Offset in m_hizMinDepth and m_hizMaxDepth.
+		U32 m_width;
+		U32 m_height;
+	};
+
+	static constexpr U32 MAX_HIZ_LEVELS = 16;
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	Mat4 m_mv; ///< ModelView.
 	Mat4 m_p; ///< Projection.
@@ -63,11 +98,62 @@ private:
 	Array<Plane, 6> m_planesW; ///< In world space.
 	U32 m_width;
 	U32 m_height;
+	U32 m_zbufferStride; ///< The width of the m_zbuffer. It's aligned to TILE_SIZE.
+	U32 m_tileCountX;
+	U32 m_tileCountY;
 	DynamicArray<Atomic<U32>> m_zbuffer;
 
+	/// @name Hierarchical depth. Level 0 has one cell per tile and every next level has one cell per 2x2 cells of the
+	///       previous level.
+	/// @{
+	Array<HizLevel, MAX_HIZ_LEVELS> m_hizLevels;
+	U32 m_hizLevelCount = 0;
+	DynamicArray<Atomic<U32>> m_hizMinDepth; ///< It's always less or equal to the min depth of the cell.
+	DynamicArray<Atomic<U32>> m_hizMaxDepth; ///< It's always greater or equal to the max depth of the cell.
+	/// @}
+
+	DynamicArray<Atomic<BinNode*>> m_tileBins; ///< The triangles of each tile. See drawBinned().
+
+	Atomic<BinBlock*> m_binBlocks = {nullptr}; ///< The memory of drawBinned().
+
 	/// @param tri In clip space.
 	void rasterizeTriangle(const Vec4* tri);
 
+	/// Convert a triangle from clip space to the format rasterizeBinnedTiles() wants.
+	/// @return False if the triangle is degenerate.
+	Bool setupBinnedTriangle(const Vec4* tri, BinnedTriangle& out) const;
+
+	/// Rasterize a single tile with SIMD.
+	void rasterizeTile(U32 tileX, U32 tileY, const BinNode* bin);
+
+	/// Compute the min and max depth of a tile from the depth buffer. It updates level 0 of the hierarchical depth.
+	void computeTileDepthBounds(U32 tileX, U32 tileY);
+
+	/// Update the upper levels of the hierarchical depth after the bounds of a tile changed.
+	/// @note It's thread-safe against other propagateTileDepthBounds() invocations.
+	void propagateTileDepthBounds(U32 tileX, U32 tileY);
+
+	/// Lower the min depth of the upper levels of the hierarchical depth that cover a rect of tiles.
+	void propagateTileMinDepth(const UVec4& tileRect, U32 minDepth);
+
+	/// Rebuild all the upper levels of the hierarchical depth from level 0.
+	void rebuildHiz();
+
+	U32 getHizIndex(U32 level, U32 x, U32 y) const
+	{
+		ANKI_ASSERT(level < m_hizLevelCount);
+		const HizLevel& l = m_hizLevels[level];
+		ANKI_ASSERT(x < l.m_width && y < l.m_height);
+		return l.m_offset + y * l.m_width + x;
+	}
+
+	/// Transform, cull and clip a triangle from the user's vertices. Common code of draw() and drawBinned().
+	template<typename TFunc>
+	void iterateClippedTriangles(const F32* verts, U32 vertCount, U32 stride, Bool backfaceCulling,
+								 TFunc func) const;
+
+	void destroyBins();
+
 	Bool computeBarycetrinc(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& p, Vec3& uvw) const;
 
 	/// Clip triangle in the near plane.
@@ -18,6 +18,7 @@
 #include <anki/scene/components/GlobalIlluminationProbeComponent.h>
 #include <anki/scene/components/GenericGpuComputeJobComponent.h>
 #include <anki/renderer/MainRenderer.h>
+#include <anki/math/Simd.h>
 #include <anki/util/Logger.h>
 #include <anki/util/ThreadHive.h>
 
@@ -46,6 +47,63 @@ static Bool spatialInsideFrustum(const FrustumComponent& frc, const SpatialCompo
 	}
 }
 
+/// Test the AABBs of some spatials against the frustum planes 4 at a time.
+/// @return A bit mask with the spatials that are inside or intersect the frustum.
+static U64 spatialAabbsInsideFrustum(const FrustumComponent& frc, ConstWeakArray<SpatialComponent*> spatials)
+{
+	static_assert(MAX_SPATIALS_PER_VIS_TEST <= 64, "Need to fit in the mask");
+	ANKI_ASSERT(spatials.getSize() > 0 && spatials.getSize() <= MAX_SPATIALS_PER_VIS_TEST);
+
+	// Pack the AABBs in SoA form as centers and extents. The padding lanes are masked out at the end
+	static constexpr U32 MAX_SPATIALS = getAlignedRoundUp(4, MAX_SPATIALS_PER_VIS_TEST);
+	Array<F32, MAX_SPATIALS> centerX, centerY, centerZ, extentX, extentY, extentZ;
+	const U32 count = spatials.getSize();
+	const U32 alignedCount = getAlignedRoundUp(4, count);
+	for(U32 i = 0; i < alignedCount; ++i)
+	{
+		const Aabb& aabb = spatials[min(i, count - 1)]->getAabb();
+		const Vec4 center = (aabb.getMax() + aabb.getMin()) * 0.5f;
+		const Vec4 extent = (aabb.getMax() - aabb.getMin()) * 0.5f;
+		centerX[i] = center.x();
+		centerY[i] = center.y();
+		centerZ[i] = center.z();
+		extentX[i] = extent.x();
+		extentY[i] = extent.y();
+		extentZ[i] = extent.z();
+	}
+
+	const auto& planes = frc.getViewPlanes();
+	U64 insideMask = 0;
+	const SimdF32x4 zero(0.0f);
+	for(U32 i = 0; i < alignedCount; i += 4)
+	{
+		const SimdF32x4 cx = SimdF32x4::load(&centerX[i]);
+		const SimdF32x4 cy = SimdF32x4::load(&centerY[i]);
+		const SimdF32x4 cz = SimdF32x4::load(&centerZ[i]);
+		const SimdF32x4 ex = SimdF32x4::load(&extentX[i]);
+		const SimdF32x4 ey = SimdF32x4::load(&extentY[i]);
+		const SimdF32x4 ez = SimdF32x4::load(&extentZ[i]);
+
+		// An AABB is outside if it's completely behind one of the planes. Same as testPlane()
+		SimdMask4 inside;
+		for(U32 p = 0; p < planes.getSize(); ++p)
+		{
+			const Plane& plane = planes[p];
+			const Vec4& n = plane.getNormal();
+			const SimdF32x4 dist = SimdF32x4(n.x()) * cx + SimdF32x4(n.y()) * cy + SimdF32x4(n.z()) * cz
+								   - SimdF32x4(plane.getOffset());
+			const SimdF32x4 radius =
+				SimdF32x4(absolute(n.x())) * ex + SimdF32x4(absolute(n.y())) * ey + SimdF32x4(absolute(n.z())) * ez;
+			const SimdMask4 planeInside = dist + radius >= zero;
+			inside = (p == 0) ? planeInside : (inside & planeInside);
+		}
+
+		insideMask |= U64(inside.getBitMask()) << U64(i);
+	}
+
+	return (count == 64) ? insideMask : (insideMask & ((U64(1) << U64(count)) - 1));
+}
+
 void VisibilityContext::submitNewWork(const FrustumComponent& frc, const FrustumComponent* primaryFrustum,
 									  RenderQueue& rqueue, ThreadHive& hive)
 {
@@ -103,6 +161,38 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, const Frustum
 	frcCtx->m_visTestsSignalSem = hive.newSemaphore(1);
 	frcCtx->m_renderQueue = &rqueue;
 
+	// Check if the visibility cache can be used. It can't if the frustum changed, if some nodes got deleted (the moved
+	// spatials might be dangling) or if not all spatials that moved since the cache was built are known. The occlusion
+	// tests depend on the coverage buffer of each frame so don't cache anything if there are occluders
+	const auto& visCache = frc.m_visCache;
+	frcCtx->m_fillVisibilityCache =
+		visCache.m_enabled && !(frc.getEnabledVisibilityTests() & FrustumComponentVisibilityTestFlag::OCCLUDERS);
+	if(frcCtx->m_fillVisibilityCache && visCache.m_timestamp > 0
+	   && visCache.m_flags == frc.getEnabledVisibilityTests()
+	   && visCache.m_viewProjMat == frc.getViewProjectionMatrix()
+	   && m_scene->getLastNodeDeletionTimestamp() <= visCache.m_timestamp)
+	{
+		frcCtx->m_useVisibilityCache = true;
+		for(Timestamp t = visCache.m_timestamp + 1; t <= m_scene->getGlobalTimestamp(); ++t)
+		{
+			ConstWeakArray<SpatialComponent*> moved;
+			if(!m_scene->getMovedSpatialComponents(t, moved))
+			{
+				frcCtx->m_useVisibilityCache = false;
+				break;
+			}
+		}
+	}
+
+	if(frcCtx->m_useVisibilityCache)
+	{
+		ANKI_TRACE_INC_COUNTER(SCENE_VIS_CACHE_HITS, 1);
+	}
+	else if(frcCtx->m_fillVisibilityCache)
+	{
+		ANKI_TRACE_INC_COUNTER(SCENE_VIS_CACHE_MISSES, 1);
+	}
+
 	// Submit new work
 	//
 
@@ -167,6 +257,16 @@ void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
 
 	U32 testIdx = m_frcCtx->m_visCtx->m_testsCount.fetchAdd(1);
 
+	if(m_frcCtx->m_useVisibilityCache)
+	{
+		gatherFromCache(hive);
+
+		GatherVisiblesFromOctreeTask* pself = this; // MSVC workaround
+		ThreadHiveTask task = ANKI_THREAD_HIVE_TASK({}, pself, nullptr, m_frcCtx->m_visTestsSignalSem);
+		hive.submitTasks(&task, 1);
+		return;
+	}
+
 	// Walk the tree
 	m_frcCtx->m_visCtx->m_scene->getOctree().walkTree(
 		testIdx,
@@ -181,16 +281,7 @@ void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
 		},
 		[&](void* placeableUserData) {
 			ANKI_ASSERT(placeableUserData);
-			SpatialComponent* scomp = static_cast<SpatialComponent*>(placeableUserData);
-
-			ANKI_ASSERT(m_spatialCount < m_spatials.getSize());
-
-			m_spatials[m_spatialCount++] = scomp;
-
-			if(m_spatialCount == m_spatials.getSize())
-			{
-				flush(hive);
-			}
+			pushSpatial(hive, static_cast<SpatialComponent*>(placeableUserData), false);
 		});
 
 	// Flush the remaining
@@ -202,7 +293,43 @@ void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
 	hive.submitTasks(&task, 1);
 }
 
-void GatherVisiblesFromOctreeTask::flush(ThreadHive& hive)
+void GatherVisiblesFromOctreeTask::gatherFromCache(ThreadHive& hive)
+{
+	const SceneGraph& scene = *m_frcCtx->m_visCtx->m_scene;
+	const auto& visCache = m_frcCtx->m_frc->m_visCache;
+
+	// The frustum didn't move so the spatials that didn't move either are still inside it
+	for(U32 i = 0; i < visCache.m_spatialCount; ++i)
+	{
+		SpatialComponent* sp = visCache.m_spatials[i];
+		if(sp->getTimestamp() <= visCache.m_timestamp)
+		{
+			pushSpatial(hive, sp, true);
+		}
+	}
+	flush(hive, true);
+
+	// Test all the spatials that moved since the cache was built. Take them only from the frame they moved last to
+	// avoid duplicates
+	for(Timestamp t = visCache.m_timestamp + 1; t <= scene.getGlobalTimestamp(); ++t)
+	{
+		ConstWeakArray<SpatialComponent*> moved;
+		const Bool found = scene.getMovedSpatialComponents(t, moved);
+		ANKI_ASSERT(found && "Should have been checked in submitNewWork()");
+		(void)found;
+
+		for(SpatialComponent* sp : moved)
+		{
+			if(sp->getTimestamp() == t)
+			{
+				pushSpatial(hive, sp, false);
+			}
+		}
+	}
+	flush(hive, false);
+}
+
+void GatherVisiblesFromOctreeTask::flush(ThreadHive& hive, Bool insideFrustum)
 {
 	if(m_spatialCount)
 	{
@@ -211,6 +338,7 @@ void GatherVisiblesFromOctreeTask::flush(ThreadHive& hive)
 			m_frcCtx->m_visCtx->m_scene->getFrameAllocator().newInstance<VisibilityTestTask>(m_frcCtx);
 		memcpy(&vis->m_spatialsToTest[0], &m_spatials[0], sizeof(m_spatials[0]) * m_spatialCount);
 		vis->m_spatialToTestCount = m_spatialCount;
+		vis->m_spatialsInsideFrustum = insideFrustum;
 
 		// Increase the semaphore to block the CombineResultsTask
 		m_frcCtx->m_visTestsSignalSem->increaseSemaphore(1);
@@ -242,10 +370,21 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 	const Bool wantsEarlyZ = !!(enabledVisibilityTests & FrustumComponentVisibilityTestFlag::EARLY_Z)
 							 && m_frcCtx->m_visCtx->m_earlyZDist > 0.0f;
 
+	// Cull the AABBs of all spatials in one go. Only the survivors will go through the per component logic
+	const U64 insideMask = (m_spatialsInsideFrustum)
+							   ? MAX_U64
+							   : spatialAabbsInsideFrustum(testedFrc, ConstWeakArray<SpatialComponent*>(
+																		  &m_spatialsToTest[0], m_spatialToTestCount));
+
 	// Iterate
 	RenderQueueView& result = m_frcCtx->m_queueViews[taskId];
 	for(U i = 0; i < m_spatialToTestCount; ++i)
 	{
+		if(!(insideMask & (U64(1) << U64(i))))
+		{
+			continue;
+		}
+
 		SpatialComponent* spatialC = m_spatialsToTest[i];
 		ANKI_ASSERT(spatialC);
 		SceneNode& node = spatialC->getSceneNode();
@@ -256,6 +395,11 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			continue;
 		}
 
+		if(m_frcCtx->m_fillVisibilityCache)
+		{
+			*result.m_visibilityCacheSpatials.newElement(alloc) = spatialC;
+		}
+
 		// Check what components the frustum needs
 		Bool wantNode = false;
 
@@ -317,7 +461,9 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		U32 spIdx = 0;
 		U32 count = 0;
 		Error err = node.iterateComponentsOfType<SpatialComponent>([&](SpatialComponent& sp) {
-			if(spatialInsideFrustum(testedFrc, sp) && testAgainstRasterizer(sp.getAabb()))
+			// The AABB of the spatial that was batch tested is exact if the shape is an AABB
+			const Bool alreadyTested = &sp == spatialC && sp.getCollisionShapeType() == CollisionShapeType::AABB;
+			if((alreadyTested || spatialInsideFrustum(testedFrc, sp)) && testAgainstRasterizer(sp.getAabb()))
 			{
 				// Inside
 				ANKI_ASSERT(spIdx < MAX_U8);
@@ -733,6 +879,43 @@ void CombineResultsTask::combine()
 
 	std::sort(results.m_giProbes.getBegin(), results.m_giProbes.getEnd());
 
+	// Update the visibility cache of the frustum. All the tests of that frustum are done so it's safe to write it
+	if(m_frcCtx->m_fillVisibilityCache)
+	{
+		FrustumComponent& frc = const_cast<FrustumComponent&>(*m_frcCtx->m_frc);
+		auto& visCache = frc.m_visCache;
+
+		U32 count = 0;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			count += m_frcCtx->m_queueViews[i].m_visibilityCacheSpatials.m_elementCount;
+		}
+
+		if(count > visCache.m_spatials.getSize())
+		{
+			visCache.m_spatials.destroy(frc.getSceneNode().getAllocator());
+			visCache.m_spatials.create(frc.getSceneNode().getAllocator(), U32(nextPowerOfTwo(count)));
+		}
+
+		count = 0;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			const TRenderQueueElementStorage<SpatialComponent*>& storage =
+				m_frcCtx->m_queueViews[i].m_visibilityCacheSpatials;
+			if(storage.m_elementCount)
+			{
+				memcpy(&visCache.m_spatials[count], storage.m_elements,
+					   sizeof(SpatialComponent*) * storage.m_elementCount);
+				count += storage.m_elementCount;
+			}
+		}
+
+		visCache.m_spatialCount = count;
+		visCache.m_viewProjMat = frc.getViewProjectionMatrix();
+		visCache.m_flags = frc.getEnabledVisibilityTests();
+		visCache.m_timestamp = m_frcCtx->m_visCtx->m_scene->getGlobalTimestamp();
+	}
+
 	// Cleanup
 	if(m_frcCtx->m_r)
 	{
@@ -119,6 +119,9 @@ public:
 	TRenderQueueElementStorage<GenericGpuComputeJobQueueElement> m_genericGpuComputeJobs;
 	TRenderQueueElementStorage<RayTracingInstanceQueueElement> m_rayTracingInstances;
 
+	/// The spatials that are inside the frustum. They will end up in the visibility cache of the FrustumComponent.
+	TRenderQueueElementStorage<SpatialComponent*> m_visibilityCacheSpatials;
+
 	Timestamp m_timestamp = 0;
 
 	RenderQueueView()
@@ -167,6 +170,10 @@ public:
 
 	// Gather results members
 	RenderQueue* m_renderQueue = nullptr;
+
+	// Visibility cache members
+	Bool m_useVisibilityCache = false; ///< Start from the visibility cache of the m_frc.
+	Bool m_fillVisibilityCache = false; ///< Update the visibility cache of the m_frc.
 };
 
 /// ThreadHive task to set the depth map of the S/W rasterizer.
@@ -205,7 +212,21 @@ private:
 	U32 m_spatialCount = 0;
 
 	/// Submit tasks to test the m_spatials.
-	void flush(ThreadHive& hive);
+	/// @param insideFrustum If true the AABBs of the m_spatials are known to be inside the frustum.
+	void flush(ThreadHive& hive, Bool insideFrustum = false);
+
+	void pushSpatial(ThreadHive& hive, SpatialComponent* sp, Bool insideFrustum)
+	{
+		ANKI_ASSERT(m_spatialCount < m_spatials.getSize());
+		m_spatials[m_spatialCount++] = sp;
+		if(m_spatialCount == m_spatials.getSize())
+		{
+			flush(hive, insideFrustum);
+		}
+	}
+
+	/// Gather the spatials from the visibility cache of the frustum instead of walking the octree.
+	void gatherFromCache(ThreadHive& hive);
 };
 static_assert(std::is_trivially_destructible<GatherVisiblesFromOctreeTask>::value == true,
 			  "Should be trivially destructible");
@@ -218,6 +239,7 @@ public:
 
 	Array<SpatialComponent*, MAX_SPATIALS_PER_VIS_TEST> m_spatialsToTest;
 	U32 m_spatialToTestCount = 0;
+	Bool m_spatialsInsideFrustum = false; ///< If true skip the frustum test of the AABBs of the m_spatialsToTest.
 
 	VisibilityTestTask(FrustumVisibilityContext* frcCtx)
 		: m_frcCtx(frcCtx)
@@ -35,6 +35,7 @@ FrustumComponent::FrustumComponent(SceneNode* node, FrustumType frustumType)
 FrustumComponent::~FrustumComponent()
 {
 	m_coverageBuff.m_depthMap.destroy(m_node->getAllocator());
+	m_visCache.m_spatials.destroy(m_node->getAllocator());
 }
 
 Bool FrustumComponent::updateInternal()
@@ -150,6 +151,17 @@ void FrustumComponent::fillCoverageBufferCallback(void* userData, F32* depthValu
 	self.m_coverageBuff.m_depthMapHeight = height;
 }
 
+void FrustumComponent::setVisibilityCacheEnabled(Bool enable)
+{
+	m_visCache.m_enabled = enable;
+	if(!enable)
+	{
+		m_visCache.m_spatials.destroy(m_node->getAllocator());
+		m_visCache.m_spatialCount = 0;
+		m_visCache.m_timestamp = 0;
+	}
+}
+
 void FrustumComponent::setEnabledVisibilityTests(FrustumComponentVisibilityTestFlag bits)
 {
 	m_flags = FrustumComponentVisibilityTestFlag::NONE;
@@ -17,6 +17,9 @@
 namespace anki
 {
 
+// Forward
+class SpatialComponent;
+
 /// @addtogroup scene
 /// @{
 
@@ -61,6 +64,10 @@ ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(FrustumComponentVisibilityTestFlag)
 /// Frustum component. Useful for nodes that take part in visibility tests like cameras and lights.
 class FrustumComponent : public SceneComponent
 {
+	friend class VisibilityContext;
+	friend class GatherVisiblesFromOctreeTask;
+	friend class CombineResultsTask;
+
 public:
 	static const SceneComponentType CLASS_TYPE = SceneComponentType::FRUSTUM;
 
@@ -240,6 +247,15 @@ public:
 		}
 	}
 
+	/// Keep the visible spatials across frames and test only the spatials that moved since then. It's worth it for
+	/// frustums that rarely move, like the ones of the probes and the lights.
+	void setVisibilityCacheEnabled(Bool enable);
+
+	Bool getVisibilityCacheEnabled() const
+	{
+		return m_visCache.m_enabled;
+	}
+
 	/// Set how far to render shadows for this frustum or set to negative if you want to use the m_frustun's far.
 	void setEffectiveShadowDistance(F32 distance)
 	{
@@ -369,6 +385,17 @@ private:
 		U32 m_depthMapHeight = 0;
 	} m_coverageBuff; ///< Coverage buffer for extra visibility tests.
 
+	class
+	{
+	public:
+		DynamicArray<SpatialComponent*> m_spatials;
+		U32 m_spatialCount = 0;
+		Mat4 m_viewProjMat = Mat4::getIdentity(); ///< The frustum the cache was built for.
+		Timestamp m_timestamp = 0; ///< When the cache was built. Zero if it's invalid.
+		FrustumComponentVisibilityTestFlag m_flags = FrustumComponentVisibilityTestFlag::NONE;
+		Bool m_enabled = false;
+	} m_visCache; ///< See setVisibilityCacheEnabled().
+
 	FrustumComponentVisibilityTestFlag m_flags = FrustumComponentVisibilityTestFlag::NONE;
 	Bool m_shapeMarkedForUpdate = true;
 	Bool m_trfMarkedForUpdate = true;
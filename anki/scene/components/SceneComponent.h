@@ -45,7 +45,13 @@ enum class SceneComponentType : U8
 /// Scene node component
 class SceneComponent
 {
+	friend class SceneNode;
+
 public:
+	/// Components of classes that set that to true don't depend on other components or other nodes. The SceneGraph
+	/// updates them in batches, following the order they are stored in memory, before it walks the node hierarchy.
+	static constexpr Bool BATCH_UPDATE = false;
+
 	/// Construct the scene component.
 	SceneComponent(SceneComponentType type)
 		: m_type(type)
@@ -61,6 +67,19 @@ public:
 		return m_type;
 	}
 
+	/// See BATCH_UPDATE.
+	Bool isBatchUpdated() const
+	{
+		return m_batchUpdate;
+	}
+
+	/// Get the node that owns the component.
+	SceneNode& getOwnerNode() const
+	{
+		ANKI_ASSERT(m_ownerNode);
+		return *m_ownerNode;
+	}
+
 	Timestamp getTimestamp() const
 	{
 		return m_timestamp;
@@ -89,8 +108,10 @@ public:
 	}
 
 private:
+	SceneNode* m_ownerNode = nullptr;
 	Timestamp m_timestamp = 1; ///< Indicates when an update happened
 	SceneComponentType m_type;
+	Bool m_batchUpdate = false;
 };
 /// @}
 
@@ -0,0 +1,114 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/components/SceneComponentPool.h>
+
+namespace anki
+{
+
+SceneComponentPool::SceneComponentPool(SceneAllocator<U8> alloc, const void* classId, PtrSize componentSize,
+									   PtrSize alignment, Bool batchUpdate)
+	: m_alloc(alloc)
+	, m_classId(classId)
+	, m_batchUpdate(batchUpdate)
+{
+	ANKI_ASSERT(classId);
+	ANKI_ASSERT(componentSize > 0 && componentSize <= MAX_COMPONENT_SIZE);
+	ANKI_ASSERT(isPowerOfTwo(alignment) && alignment <= MAX_COMPONENT_ALIGNMENT);
+
+	m_slotSize = getAlignedRoundUp(alignment, componentSize);
+	m_firstSlotOffset = getAlignedRoundUp(alignment, sizeof(Chunk));
+	m_slotsPerChunk = U32(min<PtrSize>((CHUNK_SIZE - m_firstSlotOffset) / m_slotSize, MAX_COMPONENTS_PER_CHUNK));
+	ANKI_ASSERT(m_slotsPerChunk > 0);
+}
+
+SceneComponentPool::~SceneComponentPool()
+{
+	// Don't use the allocator's pool directly because it might add a header to the allocations and that will break
+	// the alignment
+	AllocAlignedCallback allocCb = m_alloc.getMemoryPool().getAllocationCallback();
+	void* allocCbData = m_alloc.getMemoryPool().getAllocationCallbackUserData();
+
+	for(Chunk* chunk : m_chunks)
+	{
+		ANKI_ASSERT(chunk->m_usedCount == 0 && "Forgot to delete some components");
+		chunk->~Chunk();
+		allocCb(allocCbData, chunk, 0, 0);
+	}
+
+	m_chunks.destroy(m_alloc);
+}
+
+void* SceneComponentPool::allocate()
+{
+	LockGuard<SpinLock> lock(m_mtx);
+
+	// Find a chunk with free space
+	while(m_firstChunkWithSpace < m_chunks.getSize()
+		  && m_chunks[m_firstChunkWithSpace]->m_usedCount == m_slotsPerChunk)
+	{
+		++m_firstChunkWithSpace;
+	}
+
+	if(m_firstChunkWithSpace == m_chunks.getSize())
+	{
+		// Need a new chunk
+		AllocAlignedCallback allocCb = m_alloc.getMemoryPool().getAllocationCallback();
+		void* allocCbData = m_alloc.getMemoryPool().getAllocationCallbackUserData();
+		void* mem = allocCb(allocCbData, nullptr, CHUNK_SIZE, CHUNK_SIZE);
+		if(ANKI_UNLIKELY(mem == nullptr))
+		{
+			ANKI_SCENE_LOGF("Out of memory");
+		}
+
+		Chunk* chunk = ::new(mem) Chunk();
+		chunk->m_pool = this;
+		chunk->m_usedMask = {};
+		chunk->m_usedCount = 0;
+		chunk->m_index = m_chunks.getSize();
+
+		m_chunks.emplaceBack(m_alloc, chunk);
+	}
+
+	// Allocate from the first free slot of the chunk
+	Chunk& chunk = *m_chunks[m_firstChunkWithSpace];
+	for(U32 m = 0; m < chunk.m_usedMask.getSize(); ++m)
+	{
+		const U64 freeMask = ~chunk.m_usedMask[m];
+		if(freeMask == 0)
+		{
+			continue;
+		}
+
+		const U32 slot = m * 64 + findFirstSetBit(freeMask);
+		ANKI_ASSERT(slot < m_slotsPerChunk);
+		chunk.m_usedMask[m] |= U64(1) << (slot % 64);
+		++chunk.m_usedCount;
+		return getSlot(chunk, slot);
+	}
+
+	ANKI_ASSERT(!"Shouldn't reach that");
+	return nullptr;
+}
+
+void SceneComponentPool::free(void* ptr)
+{
+	ANKI_ASSERT(ptr);
+	Chunk& chunk = getChunkOf(ptr);
+	ANKI_ASSERT(chunk.m_pool == this);
+	const U32 slot = getSlotIndex(chunk, ptr);
+
+	LockGuard<SpinLock> lock(m_mtx);
+
+	const U64 bit = U64(1) << (slot % 64);
+	ANKI_ASSERT((chunk.m_usedMask[slot / 64] & bit) && "Double free");
+	chunk.m_usedMask[slot / 64] &= ~bit;
+	ANKI_ASSERT(chunk.m_usedCount > 0);
+	--chunk.m_usedCount;
+
+	m_firstChunkWithSpace = min(m_firstChunkWithSpace, chunk.m_index);
+}
+
+} // end namespace anki
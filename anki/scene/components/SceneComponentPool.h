@@ -0,0 +1,149 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/components/SceneComponent.h>
+#include <anki/util/Thread.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/NonCopyable.h>
+
+namespace anki
+{
+
+/// @addtogroup scene
+/// @{
+
+/// Keeps the components of a single class in contiguous chunks of memory. The chunks are aligned to their size so the
+/// chunk of a component can be found without searching. Components never move after they are allocated.
+class SceneComponentPool : public NonCopyable
+{
+public:
+	static constexpr PtrSize CHUNK_SIZE = 16_KB;
+	static constexpr U32 MAX_COMPONENTS_PER_CHUNK = 256;
+	static constexpr PtrSize MAX_COMPONENT_SIZE = CHUNK_SIZE / 4;
+	static constexpr PtrSize MAX_COMPONENT_ALIGNMENT = 64;
+
+	SceneComponentPool(SceneAllocator<U8> alloc, const void* classId, PtrSize componentSize, PtrSize alignment,
+					   Bool batchUpdate);
+
+	~SceneComponentPool();
+
+	const void* getClassId() const
+	{
+		return m_classId;
+	}
+
+	/// See SceneComponent::BATCH_UPDATE.
+	Bool getBatchUpdate() const
+	{
+		return m_batchUpdate;
+	}
+
+	/// Allocate memory for a component.
+	/// @note It's thread-safe.
+	void* allocate();
+
+	/// Free the memory of a component. The component should be already destroyed.
+	/// @note It's thread-safe.
+	void free(void* ptr);
+
+	/// Get the pool that allocated a component.
+	static SceneComponentPool& getPoolOf(const SceneComponent* comp)
+	{
+		return *getChunkOf(comp).m_pool;
+	}
+
+	/// Iterate the live components in memory order.
+	/// @note It's not thread-safe. Don't allocate or free while iterating.
+	template<typename TFunc>
+	ANKI_USE_RESULT Error iterateComponents(TFunc func) const
+	{
+		for(U32 i = 0; i < m_chunks.getSize(); ++i)
+		{
+			ANKI_CHECK(iterateChunkComponents(i, func));
+		}
+		return Error::NONE;
+	}
+
+	U32 getChunkCount() const
+	{
+		return m_chunks.getSize();
+	}
+
+	/// Iterate the live components of a single chunk. It's used to split the work between threads.
+	/// @note It's not thread-safe. Don't allocate or free while iterating.
+	template<typename TFunc>
+	ANKI_USE_RESULT Error iterateChunkComponents(U32 chunkIdx, TFunc func) const
+	{
+		const Chunk& chunk = *m_chunks[chunkIdx];
+		for(U32 m = 0; m < chunk.m_usedMask.getSize(); ++m)
+		{
+			U64 mask = chunk.m_usedMask[m];
+			while(mask)
+			{
+				const U32 slot = m * 64 + findFirstSetBit(mask);
+				mask &= mask - 1;
+				ANKI_CHECK(func(*reinterpret_cast<SceneComponent*>(getSlot(chunk, slot))));
+			}
+		}
+		return Error::NONE;
+	}
+
+private:
+	/// The header of a chunk. The components follow it.
+	class Chunk
+	{
+	public:
+		SceneComponentPool* m_pool;
+		Array<U64, MAX_COMPONENTS_PER_CHUNK / 64> m_usedMask;
+		U32 m_usedCount;
+		U32 m_index; ///< Index in m_chunks.
+	};
+
+	SceneAllocator<U8> m_alloc;
+	const void* m_classId; ///< Identifies the class of the components.
+	PtrSize m_slotSize;
+	PtrSize m_firstSlotOffset;
+	U32 m_slotsPerChunk;
+	Bool m_batchUpdate;
+
+	DynamicArray<Chunk*> m_chunks;
+	U32 m_firstChunkWithSpace = 0; ///< All chunks before this are full.
+	SpinLock m_mtx;
+
+	static Chunk& getChunkOf(const void* ptr)
+	{
+		return *numberToPtr<Chunk*>(ptrToNumber(ptr) & ~PtrSize(CHUNK_SIZE - 1));
+	}
+
+	U32 getSlotIndex(const Chunk& chunk, const void* ptr) const
+	{
+		const PtrSize offset = ptrToNumber(ptr) - ptrToNumber(&chunk) - m_firstSlotOffset;
+		ANKI_ASSERT((offset % m_slotSize) == 0 && offset < m_slotSize * m_slotsPerChunk);
+		return U32(offset / m_slotSize);
+	}
+
+	U8* getSlot(const Chunk& chunk, U32 slot) const
+	{
+		ANKI_ASSERT(slot < m_slotsPerChunk);
+		return const_cast<U8*>(reinterpret_cast<const U8*>(&chunk)) + m_firstSlotOffset + m_slotSize * slot;
+	}
+};
+
+/// Gives a unique identifier to every component class.
+template<typename TComponent>
+class SceneComponentClassId
+{
+public:
+	static const void* get()
+	{
+		static const U8 tag = 0;
+		return &tag;
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -7,6 +7,7 @@
 #include <anki/scene/SceneNode.h>
 #include <anki/resource/SkeletonResource.h>
 #include <anki/resource/AnimationResource.h>
+#include <anki/math/BatchFunctions.h>
 #include <anki/util/BitSet.h>
 
 namespace anki
@@ -23,6 +24,12 @@ SkinComponent::SkinComponent(SceneNode* node, SkeletonResourcePtr skeleton)
 	m_boneTrfs[1].create(m_node->getAllocator(), m_skeleton->getBones().getSize(), Mat4::getIdentity());
 	m_animationTrfs.create(m_node->getAllocator(), m_skeleton->getBones().getSize(),
 						   {Vec3(0.0f), Quat::getIdentity(), 1.0f});
+
+	m_boneVertexTrfs.create(m_node->getAllocator(), m_skeleton->getBones().getSize());
+	for(const Bone& bone : m_skeleton->getBones())
+	{
+		m_boneVertexTrfs[bone.getIndex()] = bone.getVertexTransform();
+	}
 }
 
 SkinComponent::~SkinComponent()
@@ -30,6 +37,14 @@ SkinComponent::~SkinComponent()
 	m_boneTrfs[0].destroy(m_node->getAllocator());
 	m_boneTrfs[1].destroy(m_node->getAllocator());
 	m_animationTrfs.destroy(m_node->getAllocator());
+	m_boneVertexTrfs.destroy(m_node->getAllocator());
+	m_animationSamples.destroy(m_node->getAllocator());
+
+	for(Track& track : m_tracks)
+	{
+		track.m_cursor.destroy(m_node->getAllocator());
+		track.m_channelBones.destroy(m_node->getAllocator());
+	}
 }
 
 void SkinComponent::playAnimation(U32 track, AnimationResourcePtr anim, const AnimationPlayInfo& info)
@@ -50,6 +65,32 @@ void SkinComponent::playAnimation(U32 track, AnimationResourcePtr anim, const An
 		m_tracks[track].m_blendOutTime = 0.0; // Irrelevant
 	}
 	m_tracks[track].m_repeatTimes = info.m_repeatTimes;
+
+	// Cache the bone of every channel to avoid the searches during the update
+	const U32 channelCount = anim->getChannels().getSize();
+	DynamicArray<I32>& channelBones = m_tracks[track].m_channelBones;
+	channelBones.resize(m_node->getAllocator(), channelCount);
+	for(U32 i = 0; i < channelCount; ++i)
+	{
+		const AnimationChannel& channel = anim->getChannels()[i];
+		const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
+		if(bone)
+		{
+			channelBones[i] = I32(bone->getIndex());
+		}
+		else
+		{
+			ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
+			channelBones[i] = -1;
+		}
+	}
+
+	anim->createCursor(m_node->getAllocator(), m_tracks[track].m_cursor);
+
+	if(m_animationSamples.getSize() < channelCount)
+	{
+		m_animationSamples.resize(m_node->getAllocator(), channelCount);
+	}
 }
 
 Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
@@ -91,23 +132,22 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 		const Second animTime = track.m_relativeTimePassed;
 		track.m_relativeTimePassed += dt;
 
-		// Iterate the animation channels and interpolate
-		for(U32 i = 0; i < track.m_anim->getChannels().getSize(); ++i)
+		// Interpolate all the channels of the animation
+		const U32 channelCount = track.m_channelBones.getSize();
+		WeakArray<AnimationSample> samples(&m_animationSamples[0], channelCount);
+		track.m_anim->interpolateAll(animTime, track.m_cursor, samples);
+
+		for(U32 i = 0; i < channelCount; ++i)
 		{
-			const AnimationChannel& channel = track.m_anim->getChannels()[i];
-			const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
-			if(!bone)
+			if(track.m_channelBones[i] < 0)
 			{
-				ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
 				continue;
 			}
-			const U32 boneIdx = bone->getIndex();
+			const U32 boneIdx = U32(track.m_channelBones[i]);
 
-			// Interpolate
-			Vec3 position;
-			Quat rotation;
-			F32 scale;
-			track.m_anim->interpolate(i, animTime, position, rotation, scale);
+			Vec3 position = samples[i].m_position;
+			Quat rotation = samples[i].m_rotation;
+			F32 scale = samples[i].m_scale;
 
 			// Blend with previous track
 			if(bonesAnimated.get(boneIdx) && (track.m_blendInTime > 0.0 || track.m_blendOutTime > 0.0))
@@ -161,6 +201,10 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 		// Walk the bone hierarchy to add additional transforms
 		visitBones(m_skeleton->getRootBone(), Mat4::getIdentity(), bonesAnimated, minExtend, maxExtend);
 
+		// The walk stored the bone poses. Move them to the space of the vertices in one go
+		WeakArray<Mat4> boneTrfs(m_boneTrfs[m_crntBoneTrfs]);
+		multiplyMatrices(boneTrfs, m_boneVertexTrfs, boneTrfs);
+
 		const Vec4 E(EPSILON, EPSILON, EPSILON, 0.0f);
 		m_boneBoundingVolume.setMin(minExtend - E);
 		m_boneBoundingVolume.setMax(maxExtend + E);
@@ -190,7 +234,8 @@ void SkinComponent::visitBones(const Bone& bone, const Mat4& parentTrf, const Bi
 		outMat = parentTrf * bone.getTransform();
 	}
 
-	m_boneTrfs[m_crntBoneTrfs][bone.getIndex()] = outMat * bone.getVertexTransform();
+	// The vertex transform is applied to all bones at once after the walk
+	m_boneTrfs[m_crntBoneTrfs][bone.getIndex()] = outMat;
 
 	// Update volume
 	const Vec4 bonePos = outMat * Vec4(0.0f, 0.0f, 0.0f, 1.0f);
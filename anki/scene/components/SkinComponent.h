@@ -7,6 +7,7 @@
 
 #include <anki/scene/components/SceneComponent.h>
 #include <anki/resource/Forward.h>
+#include <anki/resource/AnimationResource.h>
 #include <anki/collision/Aabb.h>
 #include <anki/util/Forward.h>
 #include <anki/util/WeakArray.h>
@@ -40,6 +41,7 @@ class SkinComponent : public SceneComponent
 {
 public:
 	static constexpr SceneComponentType CLASS_TYPE = SceneComponentType::SKIN;
+	static constexpr Bool BATCH_UPDATE = true;
 	static constexpr U32 MAX_ANIMATION_TRACKS = 4;
 
 	SkinComponent(SceneNode* node, SkeletonResourcePtr skeleton);
@@ -80,6 +82,8 @@ private:
 		Second m_blendInTime = 0.0;
 		Second m_blendOutTime = 0.0f;
 		F32 m_repeatTimes = 1.0f;
+		AnimationCursor m_cursor;
+		DynamicArray<I32> m_channelBones; ///< The bone of each animation channel. Negative if there is no bone.
 	};
 
 	class Trf
@@ -94,6 +98,8 @@ private:
 	SkeletonResourcePtr m_skeleton;
 	Array<DynamicArray<Mat4>, 2> m_boneTrfs;
 	DynamicArray<Trf> m_animationTrfs;
+	DynamicArray<Mat4> m_boneVertexTrfs; ///< A copy of the skeleton's vertex transforms to multiply them in batch.
+	DynamicArray<AnimationSample> m_animationSamples; ///< Temp storage for the samples of a track.
 	Aabb m_boneBoundingVolume{Vec3(-1.0f), Vec3(1.0f)};
 	Array<Track, MAX_ANIMATION_TRACKS> m_tracks;
 	Second m_absoluteTime = 0.0;
@@ -96,6 +96,7 @@ Error SpatialComponent::update(SceneNode& node, Second prevTime, Second crntTime
 
 		m_node->getSceneGraph().getOctree().place(m_derivedAabb, &m_octreeInfo, m_updateOctreeBounds);
 		m_placed = true;
+		m_node->getSceneGraph().notifySpatialComponentMoved(this);
 	}
 
 	m_octreeInfo.reset();
@@ -6,6 +6,7 @@
 // WARNING: This file is auto generated.
 
 #include <anki/script/LuaBinder.h>
+#include <anki/util/Tracer.h>
 
 namespace anki
 {
@@ -133,12 +134,47 @@ static int wraplogw(lua_State* l)
 	return 0;
 }
 
+/// Pre-wrap function requestTraceDump.
+static inline int pwraprequestTraceDump(lua_State* l)
+{
+	LuaUserData* ud;
+	(void)ud;
+	void* voidp;
+	(void)voidp;
+	PtrSize size;
+	(void)size;
+
+	if(ANKI_UNLIKELY(LuaBinder::checkArgsCount(l, 0)))
+	{
+		return -1;
+	}
+
+	// Call the function
+	ANKI_TRACE_REQUEST_FLIGHT_RECORDER_DUMP();
+
+	return 0;
+}
+
+/// Wrap function requestTraceDump.
+static int wraprequestTraceDump(lua_State* l)
+{
+	int res = pwraprequestTraceDump(l);
+	if(res >= 0)
+	{
+		return res;
+	}
+
+	lua_error(l);
+	return 0;
+}
+
 /// Wrap the module.
 void wrapModuleLogger(lua_State* l)
 {
 	LuaBinder::pushLuaCFunc(l, "logi", wraplogi);
 	LuaBinder::pushLuaCFunc(l, "loge", wraploge);
 	LuaBinder::pushLuaCFunc(l, "logw", wraplogw);
+	LuaBinder::pushLuaCFunc(l, "requestTraceDump", wraprequestTraceDump);
 }
 
 } // end namespace anki
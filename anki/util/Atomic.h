@@ -118,19 +118,19 @@ public:
 	}
 
 	/// Store the minimum using compare-and-swap.
-	void min(Value a)
+	void min(Value a, AtomicMemoryOrder memOrd = MEMORY_ORDER)
 	{
 		Value prev = load();
-		while(a < prev && !compareExchange(prev, a))
+		while(a < prev && !compareExchange(prev, a, memOrd))
 		{
 		}
 	}
 
 	/// Store the maximum using compare-and-swap.
-	void max(Value a)
+	void max(Value a, AtomicMemoryOrder memOrd = MEMORY_ORDER)
 	{
 		Value prev = load();
-		while(a > prev && !compareExchange(prev, a))
+		while(a > prev && !compareExchange(prev, a, memOrd))
 		{
 		}
 	}
@@ -544,4 +544,32 @@ Error File::readAllText(StringAuto& out)
 	return err;
 }
 
+Error MemoryMappedFile::open(const CString& filename)
+{
+	return openInternal(filename, true);
+}
+
+Bool MemoryMappedFile::tryOpen(const CString& filename)
+{
+	return !openInternal(filename, false);
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& b)
+{
+	close();
+
+	m_data = b.m_data;
+	m_size = b.m_size;
+	b.m_data = nullptr;
+	b.m_size = 0;
+#if ANKI_OS_WINDOWS
+	m_fileHandle = b.m_fileHandle;
+	m_mappingHandle = b.m_mappingHandle;
+	b.m_fileHandle = nullptr;
+	b.m_mappingHandle = nullptr;
+#endif
+
+	return *this;
+}
+
 } // end namespace anki
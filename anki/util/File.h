@@ -149,6 +149,68 @@ private:
 		m_size = 0;
 	}
 };
+
+/// A read-only memory mapping of a whole regular file. The pages are loaded lazily by the OS the first time they are
+/// touched so mapping a big file is cheap.
+class MemoryMappedFile : public NonCopyable
+{
+public:
+	MemoryMappedFile() = default;
+
+	/// Move
+	MemoryMappedFile(MemoryMappedFile&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// Unmaps the file if it's mapped.
+	~MemoryMappedFile()
+	{
+		close();
+	}
+
+	/// Move
+	MemoryMappedFile& operator=(MemoryMappedFile&& b);
+
+	/// Map a file. Empty files can't be mapped.
+	ANKI_USE_RESULT Error open(const CString& filename);
+
+	/// Same as open() but it doesn't log anything if the file can't be mapped. Use it when there is a fallback.
+	/// @return True if the file got mapped.
+	Bool tryOpen(const CString& filename);
+
+	/// Unmap the file.
+	void close();
+
+	Bool isOpen() const
+	{
+		return m_data != nullptr;
+	}
+
+	/// Get the mapped memory.
+	const U8* getData() const
+	{
+		ANKI_ASSERT(isOpen());
+		return static_cast<const U8*>(m_data);
+	}
+
+	/// Get the size of the file.
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(isOpen());
+		return m_size;
+	}
+
+private:
+	void* m_data = nullptr;
+	PtrSize m_size = 0;
+#if ANKI_OS_WINDOWS
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+
+	ANKI_USE_RESULT Error openInternal(const CString& filename, Bool logErrors);
+};
 /// @}
 
 } // end namespace anki
@@ -9,11 +9,15 @@
 #define _FILE_OFFSET_BITS 64
 
 #include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
 #include <anki/util/Assert.h>
 #include <anki/util/Thread.h>
 #include <cstring>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <dirent.h>
 #include <cerrno>
 #include <ftw.h> // For walkDirectoryTree
@@ -228,4 +232,58 @@ Error getFileModificationTime(CString filename, U32& year, U32& month, U32& day,
 	return Error::NONE;
 }
 
+Error MemoryMappedFile::openInternal(const CString& filename, Bool logErrors)
+{
+	ANKI_ASSERT(!isOpen());
+
+	const int fd = ::open(filename.cstr(), O_RDONLY);
+	if(fd < 0)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("open() failed for %s: %s", filename.cstr(), strerror(errno));
+		}
+		return Error::FILE_ACCESS;
+	}
+
+	struct stat s;
+	if(fstat(fd, &s) != 0 || !S_ISREG(s.st_mode) || s.st_size == 0)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("Can't map an empty or a non-regular file: %s", filename.cstr());
+		}
+		::close(fd);
+		return Error::FILE_ACCESS;
+	}
+
+	void* data = mmap(nullptr, PtrSize(s.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping holds a reference to the file, no need to keep the descriptor
+	::close(fd);
+
+	if(data == MAP_FAILED)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("mmap() failed for %s: %s", filename.cstr(), strerror(errno));
+		}
+		return Error::FILE_ACCESS;
+	}
+
+	m_data = data;
+	m_size = PtrSize(s.st_size);
+	return Error::NONE;
+}
+
+void MemoryMappedFile::close()
+{
+	if(m_data)
+	{
+		munmap(m_data, m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
+
 } // end namespace anki
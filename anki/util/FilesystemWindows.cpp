@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
 #include <anki/util/Assert.h>
 #include <anki/util/Logger.h>
 #include <anki/util/Win32Minimal.h>
@@ -183,4 +184,76 @@ Error walkDirectoryTree(const CString& dir, void* userData, WalkDirectoryTreeCal
 	return walkDirectoryTreeInternal(dir, userData, callback, baseDirLen);
 }
 
+Error MemoryMappedFile::openInternal(const CString& filename, Bool logErrors)
+{
+	ANKI_ASSERT(!isOpen());
+
+	HANDLE file =
+		CreateFileA(filename.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("CreateFileA() failed for %s: %u", filename.cstr(), GetLastError());
+		}
+		return Error::FILE_ACCESS;
+	}
+
+	DWORD sizeHigh;
+	const DWORD sizeLow = GetFileSize(file, &sizeHigh);
+	const PtrSize size = (PtrSize(sizeHigh) << PtrSize(32)) | PtrSize(sizeLow);
+	if(size == 0)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("Can't map an empty file: %s", filename.cstr());
+		}
+		CloseHandle(file);
+		return Error::FILE_ACCESS;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == nullptr)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("CreateFileMappingA() failed for %s: %u", filename.cstr(), GetLastError());
+		}
+		CloseHandle(file);
+		return Error::FILE_ACCESS;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(data == nullptr)
+	{
+		if(logErrors)
+		{
+			ANKI_UTIL_LOGE("MapViewOfFile() failed for %s: %u", filename.cstr(), GetLastError());
+		}
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return Error::FILE_ACCESS;
+	}
+
+	m_data = data;
+	m_size = size;
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	return Error::NONE;
+}
+
+void MemoryMappedFile::close()
+{
+	if(m_data)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mappingHandle);
+		CloseHandle(m_fileHandle);
+		m_data = nullptr;
+		m_size = 0;
+		m_fileHandle = nullptr;
+		m_mappingHandle = nullptr;
+	}
+}
+
 } // end namespace anki
@@ -0,0 +1,495 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/HashMap.h>
+
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#endif
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// FlatHashMap iterator.
+template<typename TValuePointer, typename TValueReference, typename TMapPtr>
+class FlatHashMapIterator
+{
+	template<typename, typename, typename>
+	friend class FlatHashMap;
+
+	template<typename, typename, typename>
+	friend class FlatHashMapIterator;
+
+public:
+	/// Default constructor.
+	FlatHashMapIterator()
+		: m_map(nullptr)
+		, m_slotIdx(MAX_U32)
+	{
+	}
+
+	/// Copy.
+	FlatHashMapIterator(const FlatHashMapIterator& b)
+		: m_map(b.m_map)
+		, m_slotIdx(b.m_slotIdx)
+	{
+	}
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YValuePointer, typename YValueReference, typename YMapPtr>
+	FlatHashMapIterator(const FlatHashMapIterator<YValuePointer, YValueReference, YMapPtr>& b)
+		: m_map(b.m_map)
+		, m_slotIdx(b.m_slotIdx)
+	{
+	}
+
+	FlatHashMapIterator(TMapPtr map, U32 slotIdx)
+		: m_map(map)
+		, m_slotIdx(slotIdx)
+	{
+		ANKI_ASSERT(map);
+	}
+
+	FlatHashMapIterator& operator=(const FlatHashMapIterator& b)
+	{
+		m_map = b.m_map;
+		m_slotIdx = b.m_slotIdx;
+		return *this;
+	}
+
+	TValueReference operator*() const
+	{
+		check();
+		return m_map->m_slots[m_slotIdx].m_value;
+	}
+
+	TValuePointer operator->() const
+	{
+		check();
+		return &m_map->m_slots[m_slotIdx].m_value;
+	}
+
+	FlatHashMapIterator& operator++()
+	{
+		check();
+		m_slotIdx = m_map->findNextFull(m_slotIdx + 1);
+		return *this;
+	}
+
+	FlatHashMapIterator operator++(int)
+	{
+		check();
+		FlatHashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	Bool operator==(const FlatHashMapIterator& b) const
+	{
+		ANKI_ASSERT(m_map == b.m_map);
+		return m_slotIdx == b.m_slotIdx;
+	}
+
+	Bool operator!=(const FlatHashMapIterator& b) const
+	{
+		return !(*this == b);
+	}
+
+	/// Get the key of the element.
+	decltype(auto) getKey() const
+	{
+		check();
+		return (m_map->m_slots[m_slotIdx].m_key);
+	}
+
+private:
+	TMapPtr m_map;
+	U32 m_slotIdx;
+
+	void check() const
+	{
+		ANKI_ASSERT(m_map);
+		ANKI_ASSERT(m_slotIdx < m_map->m_capacity && m_map->isFull(m_map->m_ctrl[m_slotIdx]));
+	}
+};
+
+/// Open addressing hash map that keeps the keys and the values in a flat array. It's similar to the SwissTable. Every
+/// slot has a control byte that holds 7 bits of the hash. The lookups compare a group of GROUP_SIZE control bytes at
+/// once (using SIMD if available) and only touch the slots whose control byte matches. Unlike HashMap it stores the keys
+/// and compares them so different keys that have the same hash can co-exist.
+/// @note Iterators are invalidated on emplace.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class FlatHashMap
+{
+	template<typename, typename, typename>
+	friend class FlatHashMapIterator;
+
+public:
+	// Typedefs
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+	using Iterator = FlatHashMapIterator<TValue*, TValue&, FlatHashMap*>;
+	using ConstIterator = FlatHashMapIterator<const TValue*, const TValue&, const FlatHashMap*>;
+
+	// Consts
+	static constexpr U32 GROUP_SIZE = 16; ///< Number of control bytes that are tested at once.
+	static constexpr U32 INITIAL_STORAGE_SIZE = GROUP_SIZE; ///< The initial number of slots.
+
+	/// Default constructor.
+	/// @param initialStorageSize The number of slots to allocate on the first insertion. Needs to be a power of two.
+	FlatHashMap(U32 initialStorageSize = INITIAL_STORAGE_SIZE)
+		: m_initialStorageSize(max(initialStorageSize, U32(GROUP_SIZE)))
+	{
+		ANKI_ASSERT(isPowerOfTwo(initialStorageSize));
+	}
+
+	/// Non-copyable.
+	FlatHashMap(const FlatHashMap&) = delete;
+
+	/// Move.
+	FlatHashMap(FlatHashMap&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// You need to manually destroy the map.
+	/// @see FlatHashMap::destroy
+	~FlatHashMap()
+	{
+		ANKI_ASSERT(m_slots == nullptr && m_ctrl == nullptr && "Forgot to call destroy");
+	}
+
+	/// Non-copyable.
+	FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+	/// Move.
+	FlatHashMap& operator=(FlatHashMap&& b)
+	{
+		ANKI_ASSERT(m_slots == nullptr && m_ctrl == nullptr && "Forgot to call destroy");
+		m_slots = b.m_slots;
+		m_ctrl = b.m_ctrl;
+		m_capacity = b.m_capacity;
+		m_size = b.m_size;
+		m_growthLeft = b.m_growthLeft;
+		m_initialStorageSize = b.m_initialStorageSize;
+		b.resetMembers();
+		return *this;
+	}
+
+	/// Get begin.
+	Iterator getBegin()
+	{
+		return Iterator(this, findNextFull(0));
+	}
+
+	/// Get begin.
+	ConstIterator getBegin() const
+	{
+		return ConstIterator(this, findNextFull(0));
+	}
+
+	/// Get end.
+	Iterator getEnd()
+	{
+		return Iterator(this, m_capacity);
+	}
+
+	/// Get end.
+	ConstIterator getEnd() const
+	{
+		return ConstIterator(this, m_capacity);
+	}
+
+	/// Get begin.
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	/// Get begin.
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	/// Get end.
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	/// Get end.
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	/// Get the number of elements.
+	U32 getSize() const
+	{
+		return m_size;
+	}
+
+	/// Return true if map is empty.
+	Bool isEmpty() const
+	{
+		return m_size == 0;
+	}
+
+	/// Destroy the map.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Construct an element inside the map. If the key is already there the old value will be replaced.
+	template<typename TAllocator, typename... TArgs>
+	Iterator emplace(TAllocator alloc, const TKey& key, TArgs&&... args);
+
+	/// Erase element.
+	template<typename TAllocator>
+	void erase(TAllocator alloc, Iterator it);
+
+	/// Find a value using a key.
+	Iterator find(const Key& key)
+	{
+		return Iterator(this, findInternal(key));
+	}
+
+	/// Find a value using a key.
+	ConstIterator find(const Key& key) const
+	{
+		return ConstIterator(this, findInternal(key));
+	}
+
+	/// Create a copy of this.
+	template<typename TAllocator>
+	void clone(TAllocator alloc, FlatHashMap& b) const;
+
+protected:
+	/// A key and a value.
+	class Slot
+	{
+	public:
+		TKey m_key;
+		TValue m_value;
+
+		template<typename... TArgs>
+		Slot(const TKey& key, TArgs&&... args)
+			: m_key(key)
+			, m_value(std::forward<TArgs>(args)...)
+		{
+		}
+	};
+
+	/// @name Control byte values. A full slot has the 7 low bits of the hash and the MSB set to zero.
+	/// @{
+	static constexpr U8 CTRL_EMPTY = 0x80;
+	static constexpr U8 CTRL_DELETED = 0xFE;
+	/// @}
+
+	Slot* m_slots = nullptr;
+
+	/// One byte per slot plus a copy of the first GROUP_SIZE at the end so groups can be loaded without wrapping.
+	U8* m_ctrl = nullptr;
+
+	U32 m_capacity = 0;
+	U32 m_size = 0;
+
+	/// How many empty slots can be filled before the load factor gets too high. Deleted slots don't count.
+	U32 m_growthLeft = 0;
+
+	U32 m_initialStorageSize = 0;
+
+	static Bool isFull(U8 ctrl)
+	{
+		return (ctrl & 0x80) == 0;
+	}
+
+	/// Mix the user hash since the DefaultHasher of integers may return the key as is.
+	static U64 mixHash(U64 hash)
+	{
+		hash *= 0x9E3779B97F4A7C15;
+		return hash ^ (hash >> 32);
+	}
+
+	/// The part of the hash that gives the start of the probe sequence.
+	static U64 getH1(U64 hash)
+	{
+		return hash >> 7;
+	}
+
+	/// The part of the hash that goes to the control bytes.
+	static U8 getH2(U64 hash)
+	{
+		return U8(hash & 0x7F);
+	}
+
+	/// Max number of elements before growing.
+	static U32 computeMaxSize(U32 capacity)
+	{
+		return capacity - capacity / 8;
+	}
+
+	void setCtrl(U32 slotIdx, U8 ctrl)
+	{
+		ANKI_ASSERT(slotIdx < m_capacity);
+		m_ctrl[slotIdx] = ctrl;
+		if(slotIdx < GROUP_SIZE)
+		{
+			m_ctrl[m_capacity + slotIdx] = ctrl;
+		}
+	}
+
+	/// Return a bitmask where bit N is set if the control byte N of the group is equal to @a ctrl.
+	static U32 matchGroup(const U8* group, U8 ctrl)
+	{
+#if ANKI_SIMD_SSE
+		const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+		return U32(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(I8(ctrl)))));
+#else
+		U32 mask = 0;
+		for(U32 i = 0; i < GROUP_SIZE; ++i)
+		{
+			mask |= U32(group[i] == ctrl) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// Return a bitmask where bit N is set if the control byte N of the group is empty or deleted.
+	static U32 matchGroupEmptyOrDeleted(const U8* group)
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+		U32 mask = 0;
+		for(U32 i = 0; i < GROUP_SIZE; ++i)
+		{
+			mask |= U32(!isFull(group[i])) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// Return the slot index of the key or m_capacity if not found.
+	U32 findInternal(const TKey& key) const;
+
+	/// Find a slot that is empty or deleted for a given hash.
+	U32 findInsertSlot(U64 hash) const;
+
+	/// Find the next full slot starting from a slot. Return m_capacity if there is none.
+	U32 findNextFull(U32 slotIdx) const
+	{
+		while(slotIdx < m_capacity && !isFull(m_ctrl[slotIdx]))
+		{
+			++slotIdx;
+		}
+
+		return min(slotIdx, m_capacity);
+	}
+
+	/// Allocate new storage and move the elements there.
+	template<typename TAllocator>
+	void rehash(TAllocator& alloc, U32 newCapacity);
+
+	void resetMembers()
+	{
+		m_slots = nullptr;
+		m_ctrl = nullptr;
+		m_capacity = 0;
+		m_size = 0;
+		m_growthLeft = 0;
+	}
+};
+
+/// Flat hash map template with automatic cleanup.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class FlatHashMapAuto : public FlatHashMap<TKey, TValue, THasher>
+{
+public:
+	using Base = FlatHashMap<TKey, TValue, THasher>;
+
+	/// Default constructor.
+	/// @copydoc FlatHashMap::FlatHashMap
+	FlatHashMapAuto(const GenericMemoryPoolAllocator<U8>& alloc, U32 initialStorageSize = Base::INITIAL_STORAGE_SIZE)
+		: Base(initialStorageSize)
+		, m_alloc(alloc)
+	{
+	}
+
+	/// Move.
+	FlatHashMapAuto(FlatHashMapAuto&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// Copy.
+	FlatHashMapAuto(const FlatHashMapAuto& b)
+		: Base()
+	{
+		copy(b);
+	}
+
+	/// Destructor.
+	~FlatHashMapAuto()
+	{
+		destroy();
+	}
+
+	/// Move.
+	FlatHashMapAuto& operator=(FlatHashMapAuto&& b)
+	{
+		destroy();
+		m_alloc = std::move(b.m_alloc);
+		static_cast<Base&>(*this) = std::move(static_cast<Base&>(b));
+		return *this;
+	}
+
+	/// Copy.
+	FlatHashMapAuto& operator=(const FlatHashMapAuto& b)
+	{
+		copy(b);
+		return *this;
+	}
+
+	/// Construct an element inside the map.
+	template<typename... TArgs>
+	typename Base::Iterator emplace(const TKey& key, TArgs&&... args)
+	{
+		return Base::emplace(m_alloc, key, std::forward<TArgs>(args)...);
+	}
+
+	/// Erase element.
+	void erase(typename Base::Iterator it)
+	{
+		Base::erase(m_alloc, it);
+	}
+
+	/// Clean up the map.
+	void destroy()
+	{
+		Base::destroy(m_alloc);
+	}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+
+	void copy(const FlatHashMapAuto& b)
+	{
+		destroy();
+		m_alloc = b.m_alloc;
+		b.clone(m_alloc, *this);
+	}
+};
+/// @}
+
+} // end namespace anki
+
+#include <anki/util/FlatHashMap.inl.h>
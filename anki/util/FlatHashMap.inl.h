@@ -0,0 +1,219 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/FlatHashMap.h>
+
+namespace anki
+{
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::destroy(TAllocator alloc)
+{
+	if(m_slots)
+	{
+		for(U32 i = 0; i < m_capacity; ++i)
+		{
+			if(isFull(m_ctrl[i]))
+			{
+				m_slots[i].~Slot();
+			}
+		}
+
+		alloc.deallocate(m_slots, m_capacity);
+		alloc.deallocate(m_ctrl, m_capacity + GROUP_SIZE);
+	}
+
+	resetMembers();
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findInternal(const TKey& key) const
+{
+	if(m_size == 0)
+	{
+		return m_capacity;
+	}
+
+	const U64 hash = mixHash(THasher()(key));
+	const U8 h2 = getH2(hash);
+	const U32 mask = m_capacity - 1;
+	U32 pos = U32(getH1(hash)) & mask;
+
+	// Triangular probing over groups. It visits all groups since the capacity is a power of two
+	for(U32 step = GROUP_SIZE;; step += GROUP_SIZE)
+	{
+		const U8* group = &m_ctrl[pos];
+
+		U32 matches = matchGroup(group, h2);
+		while(matches)
+		{
+			const U32 slotIdx = (pos + findFirstSetBit(matches)) & mask;
+			if(m_slots[slotIdx].m_key == key)
+			{
+				return slotIdx;
+			}
+
+			matches &= matches - 1;
+		}
+
+		// An empty slot means that the key was never pushed further
+		if(matchGroup(group, CTRL_EMPTY))
+		{
+			return m_capacity;
+		}
+
+		ANKI_ASSERT(step <= m_capacity && "The map should always have an empty slot");
+		pos = (pos + step) & mask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findInsertSlot(U64 hash) const
+{
+	ANKI_ASSERT(m_capacity > 0);
+	const U32 mask = m_capacity - 1;
+	U32 pos = U32(getH1(hash)) & mask;
+
+	for(U32 step = GROUP_SIZE;; step += GROUP_SIZE)
+	{
+		const U32 matches = matchGroupEmptyOrDeleted(&m_ctrl[pos]);
+		if(matches)
+		{
+			return (pos + findFirstSetBit(matches)) & mask;
+		}
+
+		ANKI_ASSERT(step <= m_capacity);
+		pos = (pos + step) & mask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator, typename... TArgs>
+typename FlatHashMap<TKey, TValue, THasher>::Iterator
+FlatHashMap<TKey, TValue, THasher>::emplace(TAllocator alloc, const TKey& key, TArgs&&... args)
+{
+	U32 slotIdx = findInternal(key);
+	if(slotIdx != m_capacity)
+	{
+		// Already there, replace the value
+		m_slots[slotIdx].~Slot();
+		::new(&m_slots[slotIdx]) Slot(key, std::forward<TArgs>(args)...);
+		return Iterator(this, slotIdx);
+	}
+
+	if(m_growthLeft == 0)
+	{
+		// Grow if it's really full or just cleanup the deleted slots
+		const U32 newCapacity =
+			(m_capacity == 0) ? m_initialStorageSize
+							  : ((m_size + 1 > computeMaxSize(m_capacity) / 2) ? m_capacity * 2 : m_capacity);
+		rehash(alloc, newCapacity);
+	}
+
+	const U64 hash = mixHash(THasher()(key));
+	slotIdx = findInsertSlot(hash);
+	if(m_ctrl[slotIdx] == CTRL_EMPTY)
+	{
+		ANKI_ASSERT(m_growthLeft > 0);
+		--m_growthLeft;
+	}
+
+	setCtrl(slotIdx, getH2(hash));
+	::new(&m_slots[slotIdx]) Slot(key, std::forward<TArgs>(args)...);
+	++m_size;
+
+	return Iterator(this, slotIdx);
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::erase(TAllocator alloc, Iterator it)
+{
+	ANKI_ASSERT(it.m_map == this);
+	it.check();
+	const U32 slotIdx = it.m_slotIdx;
+
+	m_slots[slotIdx].~Slot();
+	--m_size;
+
+	// If the group that starts from the slot has an empty slot and so does the group that ends to it then no probe
+	// sequence could have passed from it. Mark it empty instead of deleted
+	const U32 mask = m_capacity - 1;
+	const U32 emptyAfter = matchGroup(&m_ctrl[slotIdx], CTRL_EMPTY);
+	const U32 emptyBefore = matchGroup(&m_ctrl[(slotIdx - GROUP_SIZE) & mask], CTRL_EMPTY);
+	const Bool wasNeverFull =
+		emptyBefore && emptyAfter
+		&& findFirstSetBit(emptyAfter) + (GROUP_SIZE - 1 - findLastSetBit(emptyBefore)) < GROUP_SIZE;
+
+	if(wasNeverFull)
+	{
+		setCtrl(slotIdx, CTRL_EMPTY);
+		++m_growthLeft;
+	}
+	else
+	{
+		setCtrl(slotIdx, CTRL_DELETED);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::rehash(TAllocator& alloc, U32 newCapacity)
+{
+	ANKI_ASSERT(isPowerOfTwo(newCapacity) && newCapacity >= GROUP_SIZE);
+	ANKI_ASSERT(m_size < computeMaxSize(newCapacity));
+
+	Slot* oldSlots = m_slots;
+	U8* oldCtrl = m_ctrl;
+	const U32 oldCapacity = m_capacity;
+
+	m_slots = static_cast<Slot*>(alloc.getMemoryPool().allocate(newCapacity * sizeof(Slot), alignof(Slot)));
+	m_ctrl = static_cast<U8*>(alloc.getMemoryPool().allocate(newCapacity + GROUP_SIZE, alignof(U8)));
+	memset(m_ctrl, CTRL_EMPTY, newCapacity + GROUP_SIZE);
+	m_capacity = newCapacity;
+	m_growthLeft = computeMaxSize(newCapacity) - m_size;
+
+	for(U32 i = 0; i < oldCapacity; ++i)
+	{
+		if(isFull(oldCtrl[i]))
+		{
+			const U64 hash = mixHash(THasher()(oldSlots[i].m_key));
+			const U32 slotIdx = findInsertSlot(hash);
+			setCtrl(slotIdx, getH2(hash));
+			::new(&m_slots[slotIdx]) Slot(std::move(oldSlots[i]));
+			oldSlots[i].~Slot();
+		}
+	}
+
+	if(oldSlots)
+	{
+		alloc.deallocate(oldSlots, oldCapacity);
+		alloc.deallocate(oldCtrl, oldCapacity + GROUP_SIZE);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::clone(TAllocator alloc, FlatHashMap& b) const
+{
+	ANKI_ASSERT(b.m_slots == nullptr && b.m_ctrl == nullptr);
+	b.m_initialStorageSize = m_initialStorageSize;
+	if(m_size == 0)
+	{
+		return;
+	}
+
+	b.rehash(alloc, m_capacity);
+	for(U32 i = 0; i < m_capacity; ++i)
+	{
+		if(isFull(m_ctrl[i]))
+		{
+			b.emplace(alloc, m_slots[i].m_key, m_slots[i].m_value);
+		}
+	}
+}
+
+} // end namespace anki
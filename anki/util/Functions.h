@@ -269,6 +269,58 @@ inline constexpr TPtr numberToPtr(PtrSize num)
 	return ptr;
 }
 
+/// The index of the least significant bit that is set. The number shouldn't be zero.
+inline U32 findFirstSetBit(U32 x)
+{
+	ANKI_ASSERT(x != 0);
+#if ANKI_COMPILER_GCC_COMPATIBLE
+	return U32(__builtin_ctz(x));
+#else
+	unsigned long idx;
+	_BitScanForward(&idx, x);
+	return U32(idx);
+#endif
+}
+
+/// @copydoc findFirstSetBit(U32)
+inline U32 findFirstSetBit(U64 x)
+{
+	ANKI_ASSERT(x != 0);
+#if ANKI_COMPILER_GCC_COMPATIBLE
+	return U32(__builtin_ctzll(x));
+#else
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return U32(idx);
+#endif
+}
+
+/// The index of the most significant bit that is set. The number shouldn't be zero.
+inline U32 findLastSetBit(U32 x)
+{
+	ANKI_ASSERT(x != 0);
+#if ANKI_COMPILER_GCC_COMPATIBLE
+	return 31u - U32(__builtin_clz(x));
+#else
+	unsigned long idx;
+	_BitScanReverse(&idx, x);
+	return U32(idx);
+#endif
+}
+
+/// @copydoc findLastSetBit(U32)
+inline U32 findLastSetBit(U64 x)
+{
+	ANKI_ASSERT(x != 0);
+#if ANKI_COMPILER_GCC_COMPATIBLE
+	return 63u - U32(__builtin_clzll(x));
+#else
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return U32(idx);
+#endif
+}
+
 /// A simple template trick to remove the pointer from one type
 ///
 /// Example:
@@ -60,6 +60,37 @@ void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callb
 	}
 }
 
+void Logger::addFatalErrorHandler(void* data, LoggerFatalErrorHandlerCallback callback)
+{
+	LockGuard<Mutex> lock(m_mutex);
+	m_fatalErrorHandlers[m_fatalErrorHandlerCount].m_data = data;
+	m_fatalErrorHandlers[m_fatalErrorHandlerCount].m_callback = callback;
+	++m_fatalErrorHandlerCount;
+}
+
+void Logger::removeFatalErrorHandler(void* data, LoggerFatalErrorHandlerCallback callback)
+{
+	LockGuard<Mutex> lock(m_mutex);
+
+	U32 i;
+	for(i = 0; i < m_fatalErrorHandlerCount; ++i)
+	{
+		if(m_fatalErrorHandlers[i].m_callback == callback && m_fatalErrorHandlers[i].m_data == data)
+		{
+			break;
+		}
+	}
+
+	if(i < m_fatalErrorHandlerCount)
+	{
+		for(U32 j = i + 1; j < m_fatalErrorHandlerCount; ++j)
+		{
+			m_fatalErrorHandlers[j - 1] = m_fatalErrorHandlers[j];
+		}
+		--m_fatalErrorHandlerCount;
+	}
+}
+
 void Logger::write(const char* file, int line, const char* func, const char* subsystem, LoggerMessageType type,
 				   ThreadId tid, const char* msg)
 {
@@ -73,10 +104,28 @@ void Logger::write(const char* file, int line, const char* func, const char* sub
 		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
 	}
 
+	// Copy the fatal error handlers. They run unlocked
+	Array<FatalErrorHandler, 4> fatalErrorHandlers;
+	U32 fatalErrorHandlerCount = 0;
+	if(type == LoggerMessageType::FATAL)
+	{
+		fatalErrorHandlers = m_fatalErrorHandlers;
+		fatalErrorHandlerCount = m_fatalErrorHandlerCount;
+	}
+
 	m_mutex.unlock();
 
 	if(type == LoggerMessageType::FATAL)
 	{
+		// Only the first fatal error runs the handlers. A fatal error inside a handler aborts right away
+		if(!m_fatalErrorRaised.exchange(true))
+		{
+			for(U32 i = 0; i < fatalErrorHandlerCount; ++i)
+			{
+				fatalErrorHandlers[i].m_callback(fatalErrorHandlers[i].m_data);
+			}
+		}
+
 		abort();
 	}
 }
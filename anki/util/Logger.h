@@ -47,6 +47,10 @@ public:
 /// @memberof Logger
 using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& info);
 
+/// The callback that runs before a fatal error aborts.
+/// @memberof Logger
+using LoggerFatalErrorHandlerCallback = void (*)(void*);
+
 /// The logger singleton class. The logger cannot print errors or throw exceptions, it has to recover somehow. It's
 /// thread safe.
 /// To add a new signal:
@@ -68,6 +72,13 @@ public:
 	/// Add file message handler.
 	void addFileMessageHandler(File* file);
 
+	/// Add a handler that runs after a fatal message is written and before the process aborts. Unlike the message
+	/// handlers it runs without holding the logger's lock so it can log. It runs only for the first fatal error.
+	void addFatalErrorHandler(void* data, LoggerFatalErrorHandlerCallback callback);
+
+	/// Remove a fatal error handler.
+	void removeFatalErrorHandler(void* data, LoggerFatalErrorHandlerCallback callback);
+
 	/// Send a message
 	void write(const char* file, int line, const char* func, const char* subsystem, LoggerMessageType type,
 			   ThreadId tid, const char* msg);
@@ -95,10 +106,21 @@ private:
 		}
 	};
 
+	class FatalErrorHandler
+	{
+	public:
+		void* m_data = nullptr;
+		LoggerFatalErrorHandlerCallback m_callback = nullptr;
+	};
+
 	Mutex m_mutex; ///< For thread safety
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 
+	Array<FatalErrorHandler, 4> m_fatalErrorHandlers; ///< Protected by m_mutex.
+	U32 m_fatalErrorHandlerCount = 0;
+	Atomic<Bool> m_fatalErrorRaised = {false};
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
 };
@@ -13,6 +13,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
+#if ANKI_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 
 namespace anki
 {
@@ -742,4 +745,586 @@ void ChainMemoryPool::destroyChunk(Chunk* ch)
 	m_allocCb(m_allocCbUserData, ch, 0, 0);
 }
 
+/// A block of the TlsfMemoryPool. The header is followed by the payload. When the block is free the payload holds the
+/// links of the free list.
+class TlsfMemoryPool::Block
+{
+public:
+	/// The block that is physically before this one in the chunk. It's nullptr for the 1st block of a chunk.
+	Block* m_prevPhys;
+
+	/// The size of the payload. The 1st bit is the free flag.
+	PtrSize m_sizeAndFlags;
+
+	static const PtrSize FREE_FLAG = 1;
+
+	PtrSize getSize() const
+	{
+		return m_sizeAndFlags & ~FREE_FLAG;
+	}
+
+	void setSize(PtrSize size)
+	{
+		ANKI_ASSERT((size & FREE_FLAG) == 0);
+		m_sizeAndFlags = size | (m_sizeAndFlags & FREE_FLAG);
+	}
+
+	Bool isFree() const
+	{
+		return (m_sizeAndFlags & FREE_FLAG) != 0;
+	}
+
+	void setFree(Bool free)
+	{
+		m_sizeAndFlags = (free) ? (m_sizeAndFlags | FREE_FLAG) : (m_sizeAndFlags & ~FREE_FLAG);
+	}
+
+	void* getPayload();
+
+	static Block* fromPayload(void* ptr);
+
+	Block* getNextPhys()
+	{
+		return reinterpret_cast<Block*>(static_cast<U8*>(getPayload()) + getSize());
+	}
+
+	Block*& getNextFree()
+	{
+		return static_cast<Block**>(getPayload())[0];
+	}
+
+	Block*& getPrevFree()
+	{
+		return static_cast<Block**>(getPayload())[1];
+	}
+};
+
+/// The header of a chunk of the TlsfMemoryPool. It's followed by the 1st block and the chunk ends with a used block of
+/// zero size to stop the merging.
+class TlsfMemoryPool::Chunk
+{
+public:
+	Chunk* m_next;
+	PtrSize m_size;
+};
+
+/// The small free blocks of a thread.
+class alignas(ANKI_CACHE_LINE_SIZE) TlsfMemoryPool::ThreadCache
+{
+public:
+	/// Singly linked lists of free blocks. The blocks of the Nth list are at least (N + 1) * BLOCK_ALIGNMENT big.
+	Array<Block*, CACHE_SIZE_CLASS_COUNT> m_blocks;
+	Array<U32, CACHE_SIZE_CLASS_COUNT> m_blockCounts;
+};
+
+static constexpr PtrSize TLSF_BLOCK_HEADER_SIZE = getAlignedRoundUp(ANKI_SAFE_ALIGNMENT, 2 * sizeof(void*));
+static constexpr PtrSize TLSF_MIN_BLOCK_SIZE = getAlignedRoundUp(ANKI_SAFE_ALIGNMENT, 2 * sizeof(void*));
+
+inline void* TlsfMemoryPool::Block::getPayload()
+{
+	return reinterpret_cast<U8*>(this) + TLSF_BLOCK_HEADER_SIZE;
+}
+
+inline TlsfMemoryPool::Block* TlsfMemoryPool::Block::fromPayload(void* ptr)
+{
+	return reinterpret_cast<Block*>(static_cast<U8*>(ptr) - TLSF_BLOCK_HEADER_SIZE);
+}
+
+/// Bit N is set if the Nth thread cache slot is in use.
+static Atomic<U64> g_tlsfThreadCacheSlotMask = {0};
+
+/// The thread cache slot of the current thread. MAX_U32 if it doesn't have one and MAX_U32 - 1 if it didn't try to
+/// get one yet.
+static thread_local U32 g_tlsfThreadCacheSlot = MAX_U32 - 1;
+
+/// Gives the slot back when the thread exits.
+class TlsfThreadCacheSlotReleaser
+{
+public:
+	U32 m_idx = MAX_U32;
+
+	~TlsfThreadCacheSlotReleaser()
+	{
+		if(m_idx != MAX_U32)
+		{
+			g_tlsfThreadCacheSlotMask.fetchAnd(~(U64(1) << m_idx), AtomicMemoryOrder::RELEASE);
+		}
+	}
+};
+
+static thread_local TlsfThreadCacheSlotReleaser g_tlsfThreadCacheSlotReleaser;
+
+TlsfMemoryPool::TlsfMemoryPool()
+	: BaseMemoryPool(Type::TLSF)
+{
+	static_assert(TLSF_BLOCK_HEADER_SIZE == BLOCK_ALIGNMENT, "Wrong assumption");
+	static_assert(MAX_THREAD_CACHES <= sizeof(U64) * 8, "See g_tlsfThreadCacheSlotMask");
+	static_assert(SL_INDEX_COUNT <= sizeof(U32) * 8 && FL_INDEX_COUNT <= sizeof(U32) * 8, "See the bitmaps");
+}
+
+TlsfMemoryPool::~TlsfMemoryPool()
+{
+	if(m_allocationsCount.load() != 0)
+	{
+		ANKI_UTIL_LOGW("Memory pool destroyed before all memory being released");
+	}
+
+	Chunk* chunk = m_chunks;
+	while(chunk)
+	{
+		Chunk* next = chunk->m_next;
+		invalidateMemory(chunk, chunk->m_size);
+		m_allocCb(m_allocCbUserData, chunk, 0, 0);
+		chunk = next;
+	}
+
+	if(m_threadCaches)
+	{
+		m_allocCb(m_allocCbUserData, m_threadCaches, 0, 0);
+	}
+
+	if(m_lock)
+	{
+		m_lock->~SpinLock();
+		m_allocCb(m_allocCbUserData, m_lock, 0, 0);
+	}
+}
+
+void TlsfMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData, PtrSize initialChunkSize,
+							F32 nextChunkScale, PtrSize nextChunkBias)
+{
+	ANKI_ASSERT(!isCreated());
+	ANKI_ASSERT(allocCb);
+	ANKI_ASSERT(initialChunkSize > 0);
+	ANKI_ASSERT(nextChunkScale >= 1.0);
+
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+	m_initSize = initialChunkSize;
+	m_scale = nextChunkScale;
+	m_bias = nextChunkBias;
+
+	m_lock = static_cast<SpinLock*>(m_allocCb(m_allocCbUserData, nullptr, sizeof(SpinLock), alignof(SpinLock)));
+	if(!m_lock)
+	{
+		ANKI_CREATION_OOM_ACTION();
+	}
+	::new(m_lock) SpinLock();
+
+	const PtrSize cachesSize = sizeof(ThreadCache) * MAX_THREAD_CACHES;
+	m_threadCaches = static_cast<ThreadCache*>(m_allocCb(m_allocCbUserData, nullptr, cachesSize, alignof(ThreadCache)));
+	if(!m_threadCaches)
+	{
+		ANKI_CREATION_OOM_ACTION();
+	}
+	memset(static_cast<void*>(m_threadCaches), 0, cachesSize);
+}
+
+void* TlsfMemoryPool::allocate(PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(isCreated());
+	ANKI_ASSERT(alignment > 0 && isPowerOfTwo(alignment));
+
+	size = max(getAlignedRoundUp(BLOCK_ALIGNMENT, size), TLSF_MIN_BLOCK_SIZE);
+	Block* block = nullptr;
+
+	const Bool cacheable = alignment <= BLOCK_ALIGNMENT && size <= MAX_CACHED_BLOCK_SIZE;
+	const U32 slot = (cacheable) ? acquireThreadCacheSlot() : MAX_U32;
+	if(slot != MAX_U32)
+	{
+		// Fast path, get it from the thread cache
+		ThreadCache& cache = m_threadCaches[slot];
+		const U32 sizeClass = U32(size >> BLOCK_ALIGNMENT_LOG2) - 1;
+
+		if(cache.m_blockCounts[sizeClass] == 0)
+		{
+			// Empty, grab a few blocks in one go
+			LockGuard<SpinLock> lock(*m_lock);
+			for(U32 i = 0; i < CACHE_REFILL_BLOCK_COUNT; ++i)
+			{
+				Block* newBlock = allocateBlock(size, BLOCK_ALIGNMENT);
+				if(!newBlock)
+				{
+					break;
+				}
+
+				newBlock->getNextFree() = cache.m_blocks[sizeClass];
+				cache.m_blocks[sizeClass] = newBlock;
+				++cache.m_blockCounts[sizeClass];
+			}
+		}
+
+		if(cache.m_blockCounts[sizeClass] > 0)
+		{
+			block = cache.m_blocks[sizeClass];
+			cache.m_blocks[sizeClass] = block->getNextFree();
+			--cache.m_blockCounts[sizeClass];
+		}
+	}
+	else
+	{
+		LockGuard<SpinLock> lock(*m_lock);
+		block = allocateBlock(size, alignment);
+	}
+
+	if(ANKI_UNLIKELY(block == nullptr))
+	{
+		ANKI_OOM_ACTION();
+		return nullptr;
+	}
+
+	ANKI_ASSERT(!block->isFree() && block->getSize() >= size);
+	ANKI_ASSERT(isAligned(alignment, block->getPayload()));
+	m_allocationsCount.fetchAdd(1);
+	return block->getPayload();
+}
+
+void TlsfMemoryPool::free(void* ptr)
+{
+	ANKI_ASSERT(isCreated());
+
+	if(ANKI_UNLIKELY(ptr == nullptr))
+	{
+		return;
+	}
+
+	Block* block = Block::fromPayload(ptr);
+	ANKI_ASSERT(!block->isFree() && "Double free or wrong pointer");
+	const PtrSize size = block->getSize();
+	invalidateMemory(ptr, size);
+
+	const U32 count = m_allocationsCount.fetchSub(1);
+	ANKI_ASSERT(count > 0);
+	(void)count;
+
+	const U32 slot = (size <= MAX_CACHED_BLOCK_SIZE) ? acquireThreadCacheSlot() : MAX_U32;
+	if(slot != MAX_U32)
+	{
+		ThreadCache& cache = m_threadCaches[slot];
+		const U32 sizeClass = U32(size >> BLOCK_ALIGNMENT_LOG2) - 1;
+
+		block->getNextFree() = cache.m_blocks[sizeClass];
+		cache.m_blocks[sizeClass] = block;
+		++cache.m_blockCounts[sizeClass];
+
+		if(cache.m_blockCounts[sizeClass] > MAX_CACHED_BLOCKS_PER_SIZE_CLASS)
+		{
+			// Too many, give half of them back
+			LockGuard<SpinLock> lock(*m_lock);
+			while(cache.m_blockCounts[sizeClass] > MAX_CACHED_BLOCKS_PER_SIZE_CLASS / 2)
+			{
+				Block* oldBlock = cache.m_blocks[sizeClass];
+				cache.m_blocks[sizeClass] = oldBlock->getNextFree();
+				--cache.m_blockCounts[sizeClass];
+
+				freeBlock(oldBlock);
+			}
+		}
+	}
+	else
+	{
+		LockGuard<SpinLock> lock(*m_lock);
+		freeBlock(block);
+	}
+}
+
+PtrSize TlsfMemoryPool::getMemoryCapacity() const
+{
+	PtrSize sum = 0;
+	const Chunk* chunk = m_chunks;
+	while(chunk)
+	{
+		sum += chunk->m_size;
+		chunk = chunk->m_next;
+	}
+
+	return sum;
+}
+
+PtrSize TlsfMemoryPool::getChunksCount() const
+{
+	PtrSize count = 0;
+	const Chunk* chunk = m_chunks;
+	while(chunk)
+	{
+		++count;
+		chunk = chunk->m_next;
+	}
+
+	return count;
+}
+
+/// Compute the first and second level indices of the list a block of that size belongs to.
+template<U32 SL_INDEX_COUNT_LOG2, U32 BLOCK_ALIGNMENT_LOG2, U32 FL_INDEX_SHIFT>
+static void tlsfMappingInsert(PtrSize size, U32& fl, U32& sl)
+{
+	if(size < (PtrSize(1) << FL_INDEX_SHIFT))
+	{
+		fl = 0;
+		sl = U32(size >> BLOCK_ALIGNMENT_LOG2);
+	}
+	else
+	{
+		const U32 msb = findLastSetBit(U64(size));
+		sl = U32(size >> (msb - SL_INDEX_COUNT_LOG2)) ^ (1u << SL_INDEX_COUNT_LOG2);
+		fl = msb - (FL_INDEX_SHIFT - 1);
+	}
+}
+
+void TlsfMemoryPool::insertFreeBlock(Block* block)
+{
+	U32 fl, sl;
+	tlsfMappingInsert<SL_INDEX_COUNT_LOG2, BLOCK_ALIGNMENT_LOG2, FL_INDEX_SHIFT>(block->getSize(), fl, sl);
+	ANKI_ASSERT(fl < FL_INDEX_COUNT && sl < SL_INDEX_COUNT);
+
+	Block* head = m_freeLists[fl][sl];
+	block->setFree(true);
+	block->getNextFree() = head;
+	block->getPrevFree() = nullptr;
+	if(head)
+	{
+		head->getPrevFree() = block;
+	}
+	m_freeLists[fl][sl] = block;
+
+	m_flBitmap |= 1u << fl;
+	m_slBitmaps[fl] |= 1u << sl;
+}
+
+void TlsfMemoryPool::removeFreeBlock(Block* block)
+{
+	ANKI_ASSERT(block->isFree());
+
+	U32 fl, sl;
+	tlsfMappingInsert<SL_INDEX_COUNT_LOG2, BLOCK_ALIGNMENT_LOG2, FL_INDEX_SHIFT>(block->getSize(), fl, sl);
+
+	Block* prev = block->getPrevFree();
+	Block* next = block->getNextFree();
+	if(prev)
+	{
+		prev->getNextFree() = next;
+	}
+
+	if(next)
+	{
+		next->getPrevFree() = prev;
+	}
+
+	if(m_freeLists[fl][sl] == block)
+	{
+		m_freeLists[fl][sl] = next;
+
+		if(next == nullptr)
+		{
+			m_slBitmaps[fl] &= ~(1u << sl);
+			if(m_slBitmaps[fl] == 0)
+			{
+				m_flBitmap &= ~(1u << fl);
+			}
+		}
+	}
+
+	block->setFree(false);
+}
+
+/// Round up the size to the next free list so any block of that list is big enough.
+template<U32 SL_INDEX_COUNT_LOG2, U32 FL_INDEX_SHIFT>
+static PtrSize tlsfMappingSearchSize(PtrSize size)
+{
+	if(size >= (PtrSize(1) << FL_INDEX_SHIFT))
+	{
+		size += (PtrSize(1) << (findLastSetBit(U64(size)) - SL_INDEX_COUNT_LOG2)) - 1;
+	}
+
+	return size;
+}
+
+TlsfMemoryPool::Block* TlsfMemoryPool::locateFreeBlock(PtrSize size)
+{
+	size = tlsfMappingSearchSize<SL_INDEX_COUNT_LOG2, FL_INDEX_SHIFT>(size);
+
+	U32 fl, sl;
+	tlsfMappingInsert<SL_INDEX_COUNT_LOG2, BLOCK_ALIGNMENT_LOG2, FL_INDEX_SHIFT>(size, fl, sl);
+	if(fl >= FL_INDEX_COUNT)
+	{
+		return nullptr;
+	}
+
+	U32 slBitmap = m_slBitmaps[fl] & (MAX_U32 << sl);
+	if(slBitmap == 0)
+	{
+		// Nothing in this first level, search the next ones
+		const U32 flBitmap = (fl + 1 < FL_INDEX_COUNT) ? (m_flBitmap & (MAX_U32 << (fl + 1))) : 0;
+		if(flBitmap == 0)
+		{
+			return nullptr;
+		}
+
+		fl = findFirstSetBit(flBitmap);
+		slBitmap = m_slBitmaps[fl];
+	}
+
+	sl = findFirstSetBit(slBitmap);
+	Block* block = m_freeLists[fl][sl];
+	ANKI_ASSERT(block);
+	removeFreeBlock(block);
+	return block;
+}
+
+void TlsfMemoryPool::trimBlock(Block* block, PtrSize size)
+{
+	ANKI_ASSERT(!block->isFree() && block->getSize() >= size);
+
+	if(block->getSize() >= size + TLSF_BLOCK_HEADER_SIZE + TLSF_MIN_BLOCK_SIZE)
+	{
+		Block* remaining = reinterpret_cast<Block*>(static_cast<U8*>(block->getPayload()) + size);
+		remaining->m_prevPhys = block;
+		remaining->m_sizeAndFlags = block->getSize() - size - TLSF_BLOCK_HEADER_SIZE;
+		remaining->getNextPhys()->m_prevPhys = remaining;
+
+		block->setSize(size);
+		insertFreeBlock(remaining);
+	}
+}
+
+TlsfMemoryPool::Block* TlsfMemoryPool::allocateBlock(PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(size >= TLSF_MIN_BLOCK_SIZE && isAligned(BLOCK_ALIGNMENT, size));
+
+	// For big alignments ask for more to have room for a free block in front of the aligned one
+	const PtrSize minGap = TLSF_BLOCK_HEADER_SIZE + TLSF_MIN_BLOCK_SIZE;
+	const PtrSize searchSize = (alignment <= BLOCK_ALIGNMENT) ? size : (size + alignment + minGap);
+
+	Block* block = locateFreeBlock(searchSize);
+	if(block == nullptr)
+	{
+		if(!createNewChunk(tlsfMappingSearchSize<SL_INDEX_COUNT_LOG2, FL_INDEX_SHIFT>(searchSize)))
+		{
+			return nullptr;
+		}
+
+		block = locateFreeBlock(searchSize);
+		ANKI_ASSERT(block);
+	}
+
+	if(alignment > BLOCK_ALIGNMENT)
+	{
+		const PtrSize payload = ptrToNumber(block->getPayload());
+		PtrSize gap = getAlignedRoundUp(alignment, payload) - payload;
+		if(gap > 0 && gap < minGap)
+		{
+			gap = getAlignedRoundUp(alignment, payload + minGap) - payload;
+		}
+
+		if(gap > 0)
+		{
+			// Split the front and give it back
+			Block* alignedBlock = reinterpret_cast<Block*>(reinterpret_cast<U8*>(block) + gap);
+			alignedBlock->m_prevPhys = block;
+			alignedBlock->m_sizeAndFlags = block->getSize() - gap;
+			alignedBlock->getNextPhys()->m_prevPhys = alignedBlock;
+
+			block->setSize(gap - TLSF_BLOCK_HEADER_SIZE);
+			insertFreeBlock(block);
+
+			block = alignedBlock;
+		}
+	}
+
+	trimBlock(block, size);
+	return block;
+}
+
+void TlsfMemoryPool::freeBlock(Block* block)
+{
+	ANKI_ASSERT(!block->isFree());
+
+	// Merge with the previous
+	Block* prev = block->m_prevPhys;
+	if(prev && prev->isFree())
+	{
+		removeFreeBlock(prev);
+		prev->setSize(prev->getSize() + TLSF_BLOCK_HEADER_SIZE + block->getSize());
+		block = prev;
+		block->getNextPhys()->m_prevPhys = block;
+	}
+
+	// Merge with the next. The last block of the chunk is never free so no need to check the bounds
+	Block* next = block->getNextPhys();
+	if(next->isFree())
+	{
+		removeFreeBlock(next);
+		block->setSize(block->getSize() + TLSF_BLOCK_HEADER_SIZE + next->getSize());
+		block->getNextPhys()->m_prevPhys = block;
+	}
+
+	insertFreeBlock(block);
+}
+
+Bool TlsfMemoryPool::createNewChunk(PtrSize blockSize)
+{
+	const PtrSize chunkHeaderSize = getAlignedRoundUp(BLOCK_ALIGNMENT, sizeof(Chunk));
+	const PtrSize overhead = chunkHeaderSize + 2 * TLSF_BLOCK_HEADER_SIZE;
+
+	PtrSize chunkSize = (m_chunks) ? (PtrSize(F32(m_lastChunkSize) * m_scale) + m_bias) : m_initSize;
+	chunkSize = max(chunkSize, blockSize + overhead);
+	alignRoundUp(BLOCK_ALIGNMENT, chunkSize);
+
+	if(chunkSize - overhead >= (PtrSize(1) << FL_INDEX_MAX))
+	{
+		ANKI_UTIL_LOGE("Allocation too big");
+		return false;
+	}
+
+	Chunk* chunk = static_cast<Chunk*>(m_allocCb(m_allocCbUserData, nullptr, chunkSize, BLOCK_ALIGNMENT));
+	if(!chunk)
+	{
+		return false;
+	}
+
+	invalidateMemory(chunk, chunkSize);
+	chunk->m_next = m_chunks;
+	chunk->m_size = chunkSize;
+	m_chunks = chunk;
+	m_lastChunkSize = chunkSize;
+
+	// One big block
+	Block* block = reinterpret_cast<Block*>(reinterpret_cast<U8*>(chunk) + chunkHeaderSize);
+	block->m_prevPhys = nullptr;
+	block->m_sizeAndFlags = chunkSize - overhead;
+
+	// And the terminator
+	Block* lastBlock = block->getNextPhys();
+	lastBlock->m_prevPhys = block;
+	lastBlock->m_sizeAndFlags = 0;
+
+	insertFreeBlock(block);
+	return true;
+}
+
+U32 TlsfMemoryPool::acquireThreadCacheSlot()
+{
+	if(ANKI_LIKELY(g_tlsfThreadCacheSlot != MAX_U32 - 1))
+	{
+		return g_tlsfThreadCacheSlot;
+	}
+
+	g_tlsfThreadCacheSlot = MAX_U32;
+
+	U64 mask = g_tlsfThreadCacheSlotMask.load(AtomicMemoryOrder::ACQUIRE);
+	while(mask != MAX_U64)
+	{
+		const U32 idx = findFirstSetBit(~mask);
+		if(g_tlsfThreadCacheSlotMask.compareExchange(mask, mask | (U64(1) << idx), AtomicMemoryOrder::ACQUIRE,
+													 AtomicMemoryOrder::ACQUIRE))
+		{
+			g_tlsfThreadCacheSlot = idx;
+			g_tlsfThreadCacheSlotReleaser.m_idx = idx;
+			break;
+		}
+	}
+
+	return g_tlsfThreadCacheSlot;
+}
+
 } // end namespace anki
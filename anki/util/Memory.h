@@ -49,7 +49,7 @@ using AllocationSignature = U32;
 ///         returns nullptr
 void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 
-/// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool or ChainMemoryPool.
+/// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool or ChainMemoryPool or TlsfMemoryPool.
 class BaseMemoryPool : public NonCopyable
 {
 public:
@@ -102,7 +102,8 @@ protected:
 		NONE,
 		HEAP,
 		STACK,
-		CHAIN
+		CHAIN,
+		TLSF
 	};
 
 	/// User allocation function.
@@ -363,6 +364,143 @@ private:
 	void destroyChunk(Chunk* ch);
 };
 
+/// Two-level segregated fit memory pool. It's a general purpose pool that gives O(1) allocations and deallocations of
+/// any size and bounded fragmentation. The memory is sub-allocated from chunks that are requested from the allocation
+/// callback on demand.
+///
+/// The TLSF structures are protected by a spinlock. On top of them every thread has a cache of small free blocks so
+/// the most common allocations and deallocations don't touch the lock at all. Every pool has its own array of caches
+/// indexed by a thread slot. A thread acquires a slot the first time it touches any TLSF pool and keeps it until it
+/// exits. A freed block goes to the cache of the freeing thread in the pool that owns the block, no matter which thread
+/// allocated it. Cached blocks are only reused by the thread that holds the slot, until the cache overflows and gives
+/// half of them back to the TLSF structures or the thread exits and its slot (with its blocks) passes to a new thread.
+class TlsfMemoryPool final : public BaseMemoryPool
+{
+public:
+	/// Default constructor
+	TlsfMemoryPool();
+
+	/// Destroy
+	~TlsfMemoryPool();
+
+	/// Creates the pool.
+	/// @param allocCb The allocation function callback.
+	/// @param allocCbUserData The user data to pass to the allocation function.
+	/// @param initialChunkSize The size of the first chunk.
+	/// @param nextChunkScale Value that controls the next chunk.
+	/// @param nextChunkBias Value that controls the next chunk.
+	void create(AllocAlignedCallback allocCb, void* allocCbUserData, PtrSize initialChunkSize = 1_MB,
+				F32 nextChunkScale = 2.0, PtrSize nextChunkBias = 0);
+
+	/// Allocate memory. This operation is thread safe.
+	/// @param size The size to allocate
+	/// @param alignmentBytes The alignment of the returned address
+	/// @return The allocated memory or nullptr on failure
+	void* allocate(PtrSize size, PtrSize alignmentBytes);
+
+	/// Free memory. This operation is thread safe.
+	/// @param[in, out] ptr Memory block to deallocate
+	void free(void* ptr);
+
+	/// Get the memory that was requested from the allocation callback. It's not thread safe.
+	PtrSize getMemoryCapacity() const;
+
+	/// Get the number of chunks. It's not thread safe.
+	PtrSize getChunksCount() const;
+
+private:
+	class Block;
+	class Chunk;
+	class ThreadCache;
+
+	/// Number of second level lists per first level in log2.
+	static const U32 SL_INDEX_COUNT_LOG2 = 4;
+	static const U32 SL_INDEX_COUNT = 1u << SL_INDEX_COUNT_LOG2;
+
+	/// All blocks are aligned to that and their sizes are a multiple of that.
+	static const U32 BLOCK_ALIGNMENT_LOG2 = 4;
+	static const U32 BLOCK_ALIGNMENT = 1u << BLOCK_ALIGNMENT_LOG2;
+
+	/// Blocks smaller than that go to the first first level list.
+	static const U32 FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + BLOCK_ALIGNMENT_LOG2;
+	static const U32 SMALL_BLOCK_SIZE = 1u << FL_INDEX_SHIFT;
+
+	/// The max block size is 2^FL_INDEX_MAX.
+	static const U32 FL_INDEX_MAX = 36;
+	static const U32 FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+	/// @name Thread cache constants.
+	/// @{
+
+	/// The max number of threads that have a cache. The rest always go to the TLSF structures.
+	static const U32 MAX_THREAD_CACHES = 64;
+
+	/// Blocks up to that size are cached.
+	static const U32 MAX_CACHED_BLOCK_SIZE = 256;
+	static const U32 CACHE_SIZE_CLASS_COUNT = MAX_CACHED_BLOCK_SIZE / BLOCK_ALIGNMENT;
+
+	/// When a thread cache has that many blocks of a size class it will give half of them back.
+	static const U32 MAX_CACHED_BLOCKS_PER_SIZE_CLASS = 64;
+
+	/// On a cache miss grab that many blocks from the TLSF structures.
+	static const U32 CACHE_REFILL_BLOCK_COUNT = 16;
+	/// @}
+
+	/// Bit N is set if m_slBitmaps[N] is not zero.
+	U32 m_flBitmap = 0;
+
+	/// Bit N is set if the m_freeLists[fl][N] is not empty.
+	Array<U32, FL_INDEX_COUNT> m_slBitmaps = {};
+
+	/// The heads of the free lists.
+	Array2d<Block*, FL_INDEX_COUNT, SL_INDEX_COUNT> m_freeLists = {};
+
+	/// All the chunks.
+	Chunk* m_chunks = nullptr;
+
+	/// Size of the first chunk.
+	PtrSize m_initSize = 0;
+
+	/// Chunk scale.
+	F32 m_scale = 2.0;
+
+	/// Chunk bias.
+	PtrSize m_bias = 0;
+
+	/// The size of the last chunk.
+	PtrSize m_lastChunkSize = 0;
+
+	/// Protects the TLSF structures and the chunks.
+	SpinLock* m_lock = nullptr;
+
+	/// One per thread slot. See acquireThreadCacheSlot().
+	ThreadCache* m_threadCaches = nullptr;
+
+	/// Allocate a block from the TLSF structures.
+	/// @note Needs to be called with the lock held.
+	Block* allocateBlock(PtrSize size, PtrSize alignment);
+
+	/// Return a block to the TLSF structures.
+	/// @note Needs to be called with the lock held.
+	void freeBlock(Block* block);
+
+	/// Create a new chunk that can hold a block of a given size.
+	/// @note Needs to be called with the lock held.
+	Bool createNewChunk(PtrSize blockSize);
+
+	void insertFreeBlock(Block* block);
+	void removeFreeBlock(Block* block);
+
+	/// Find a free block that is at least that big and remove it from the free lists.
+	Block* locateFreeBlock(PtrSize size);
+
+	/// Split the tail of a block if it's big enough and return the tail to the free lists.
+	void trimBlock(Block* block, PtrSize size);
+
+	/// Get the index of the thread cache the current thread owns or MAX_U32 if it doesn't have one.
+	static U32 acquireThreadCacheSlot();
+};
+
 inline void* BaseMemoryPool::allocate(PtrSize size, PtrSize alignmentBytes)
 {
 	void* out = nullptr;
@@ -374,6 +512,9 @@ inline void* BaseMemoryPool::allocate(PtrSize size, PtrSize alignmentBytes)
 	case Type::STACK:
 		out = static_cast<StackMemoryPool*>(this)->allocate(size, alignmentBytes);
 		break;
+	case Type::TLSF:
+		out = static_cast<TlsfMemoryPool*>(this)->allocate(size, alignmentBytes);
+		break;
 	default:
 		ANKI_ASSERT(m_type == Type::CHAIN);
 		out = static_cast<ChainMemoryPool*>(this)->allocate(size, alignmentBytes);
@@ -392,6 +533,9 @@ inline void BaseMemoryPool::free(void* ptr)
 	case Type::STACK:
 		static_cast<StackMemoryPool*>(this)->free(ptr);
 		break;
+	case Type::TLSF:
+		static_cast<TlsfMemoryPool*>(this)->free(ptr);
+		break;
 	default:
 		ANKI_ASSERT(m_type == Type::CHAIN);
 		static_cast<ChainMemoryPool*>(this)->free(ptr);
@@ -88,6 +88,7 @@ public:
 		if(m_instance)
 		{
 			delete m_instance;
+			m_instance = nullptr;
 		}
 	}
 
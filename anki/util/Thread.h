@@ -93,6 +93,12 @@ public:
 #endif
 	}
 
+	/// Get the name of the current thread. It's empty if it's not an anki::Thread or if it doesn't have a name.
+	static const char* getCurrentThreadName()
+	{
+		return (m_currentThreadName) ? m_currentThreadName : "";
+	}
+
 private:
 	/// The system native type.
 #if ANKI_POSIX
@@ -105,6 +111,8 @@ private:
 	Array<char, 32> m_name; ///< The name of the thread.
 	ThreadCallback m_callback = nullptr; ///< The callback.
 
+	static thread_local const char* m_currentThreadName;
+
 #if ANKI_EXTRA_CHECKS
 	Bool m_started = false;
 #endif
@@ -571,9 +579,19 @@ public:
 
 	RWLockGuard(const RWLockGuard& b) = delete;
 
+	RWLockGuard(RWLockGuard&& b)
+	{
+		m_mtx = b.m_mtx;
+		b.m_mtx = nullptr;
+	}
+
 	~RWLockGuard()
 	{
-		if(READER)
+		if(m_mtx == nullptr)
+		{
+			// Moved
+		}
+		else if(READER)
 		{
 			m_mtx->unlockRead();
 		}
@@ -583,6 +601,8 @@ public:
 		}
 	}
 
+	RWLockGuard& operator=(RWLockGuard&& b) = delete;
+
 	RWLockGuard& operator=(const RWLockGuard& b) = delete;
 
 private:
@@ -18,23 +18,143 @@ namespace anki
 #	define ANKI_HIVE_DEBUG_PRINT(...) ((void)0)
 #endif
 
-class ThreadHive::Thread
+/// The hive and the thread ID of the current thread. Used to find the deque of the running thread.
+static thread_local ThreadHive* g_currentHive = nullptr;
+static thread_local U32 g_currentThreadId = MAX_U32;
+
+class ThreadHive::Task : public NonCopyable
+{
+public:
+	Task* m_next; ///< Next in the deque.
+	Task* m_prev; ///< Previous in the deque.
+
+	ThreadHiveTaskCallback m_cb; ///< Callback that defines the task.
+	void* m_arg; ///< Args for the callback.
+
+	ThreadHiveSemaphore* m_waitSemaphore;
+	ThreadHiveSemaphore* m_signalSemaphore;
+
+	Bool isReady() const
+	{
+		return m_waitSemaphore == nullptr || m_waitSemaphore->m_atomic.load(AtomicMemoryOrder::ACQUIRE) == 0;
+	}
+};
+
+class alignas(ANKI_CACHE_LINE_SIZE) ThreadHive::Thread
 {
 public:
 	U32 m_id; ///< An ID
 	anki::Thread m_thread; ///< Runs the workingFunc
 	ThreadHive* m_hive;
 
+	/// @name Work-stealing deque. The owner works at the front and the thieves at the back.
+	/// @{
+	SpinLock m_dequeLock;
+	Task* m_head = nullptr;
+	Task* m_tail = nullptr;
+	Atomic<U32> m_dequeSize = {0}; ///< A hint to avoid locking empty deques.
+	/// @}
+
 	/// Constructor
-	Thread(U32 id, ThreadHive* hive, Bool pinToCores)
+	Thread(U32 id, ThreadHive* hive)
 		: m_id(id)
 		, m_thread("anki_threadhive")
 		, m_hive(hive)
 	{
 		ANKI_ASSERT(hive);
+	}
+
+	void start(Bool pinToCores)
+	{
 		m_thread.start(this, threadCallback, (pinToCores) ? I32(m_id) : -1);
 	}
 
+	/// Push a list of tasks to the front of the deque.
+	void pushFront(Task* first, Task* last, U32 count)
+	{
+		LockGuard<SpinLock> lock(m_dequeLock);
+
+		first->m_prev = nullptr;
+		last->m_next = m_head;
+		if(m_head)
+		{
+			m_head->m_prev = last;
+		}
+		else
+		{
+			m_tail = last;
+		}
+		m_head = first;
+
+		m_dequeSize.fetchAdd(count);
+	}
+
+	/// Push a list of tasks to the back of the deque.
+	void pushBack(Task* first, Task* last, U32 count)
+	{
+		LockGuard<SpinLock> lock(m_dequeLock);
+
+		last->m_next = nullptr;
+		first->m_prev = m_tail;
+		if(m_tail)
+		{
+			m_tail->m_next = first;
+		}
+		else
+		{
+			m_head = first;
+		}
+		m_tail = last;
+
+		m_dequeSize.fetchAdd(count);
+	}
+
+	/// Pop the first task that is ready to run starting from the front. Used by the owner of the deque.
+	Task* popFront()
+	{
+		if(m_dequeSize.load() == 0)
+		{
+			return nullptr;
+		}
+
+		LockGuard<SpinLock> lock(m_dequeLock);
+		Task* task = m_head;
+		while(task && !task->isReady())
+		{
+			task = task->m_next;
+		}
+
+		if(task)
+		{
+			unlink(*task);
+		}
+
+		return task;
+	}
+
+	/// Pop the first task that is ready to run starting from the back. Used by the other threads.
+	Task* steal()
+	{
+		if(m_dequeSize.load() == 0)
+		{
+			return nullptr;
+		}
+
+		LockGuard<SpinLock> lock(m_dequeLock);
+		Task* task = m_tail;
+		while(task && !task->isReady())
+		{
+			task = task->m_prev;
+		}
+
+		if(task)
+		{
+			unlink(*task);
+		}
+
+		return task;
+	}
+
 private:
 	/// Thread callaback
 	static Error threadCallback(anki::ThreadCallbackInfo& info)
@@ -44,18 +164,38 @@ private:
 		self.m_hive->threadRun(self.m_id);
 		return Error::NONE;
 	}
-};
 
-class ThreadHive::Task : public NonCopyable
-{
-public:
-	Task* m_next; ///< Next in the list.
+	void unlink(Task& task)
+	{
+		if(task.m_prev)
+		{
+			task.m_prev->m_next = task.m_next;
+		}
+		else
+		{
+			ANKI_ASSERT(m_head == &task);
+			m_head = task.m_next;
+		}
 
-	ThreadHiveTaskCallback m_cb; ///< Callback that defines the task.
-	void* m_arg; ///< Args for the callback.
+		if(task.m_next)
+		{
+			task.m_next->m_prev = task.m_prev;
+		}
+		else
+		{
+			ANKI_ASSERT(m_tail == &task);
+			m_tail = task.m_prev;
+		}
 
-	ThreadHiveSemaphore* m_waitSemaphore;
-	ThreadHiveSemaphore* m_signalSemaphore;
+#if ANKI_EXTRA_CHECKS
+		task.m_next = nullptr;
+		task.m_prev = nullptr;
+#endif
+
+		const U32 prevSize = m_dequeSize.fetchSub(1);
+		ANKI_ASSERT(prevSize > 0);
+		(void)prevSize;
+	}
 };
 
 ThreadHive::ThreadHive(U32 threadCount, GenericMemoryPoolAllocator<U8> alloc, Bool pinToCores)
@@ -64,10 +204,19 @@ ThreadHive::ThreadHive(U32 threadCount, GenericMemoryPoolAllocator<U8> alloc, Bo
 			  1024 * 4)
 	, m_threadCount(threadCount)
 {
-	m_threads = reinterpret_cast<Thread*>(m_slowAlloc.allocate(sizeof(Thread) * threadCount));
+	ANKI_ASSERT(threadCount > 0);
+
+	// Create all threads before starting them because they will try to steal work from each other
+	PtrSize alignment = alignof(Thread);
+	m_threads = reinterpret_cast<Thread*>(m_slowAlloc.allocate(sizeof(Thread) * threadCount, &alignment));
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		::new(&m_threads[i]) Thread(i, this);
+	}
+
 	for(U32 i = 0; i < threadCount; ++i)
 	{
-		::new(&m_threads[i]) Thread(i, this, pinToCores);
+		m_threads[i].start(pinToCores);
 	}
 }
 
@@ -83,12 +232,17 @@ ThreadHive::~ThreadHive()
 			m_cvar.notifyAll();
 		}
 
-		// Join and destroy
+		// Join
+		for(U32 i = 0; i < m_threadCount; ++i)
+		{
+			Error err = m_threads[i].m_thread.join();
+			(void)err;
+		}
+
+		// Destroy
 		U32 threadCount = m_threadCount;
 		while(threadCount-- != 0)
 		{
-			Error err = m_threads[threadCount].m_thread.join();
-			(void)err;
 			m_threads[threadCount].~Thread();
 		}
 
@@ -104,163 +258,178 @@ void ThreadHive::submitTasks(ThreadHiveTask* tasks, const U32 taskCount)
 	Task* const htasks = m_alloc.newArray<Task>(taskCount);
 
 	// Initialize tasks
-	Task* prevTask = nullptr;
 	for(U32 i = 0; i < taskCount; ++i)
 	{
 		const ThreadHiveTask& inTask = tasks[i];
 		Task& outTask = htasks[i];
 
-		outTask.m_next = nullptr;
+		outTask.m_next = (i + 1 < taskCount) ? &htasks[i + 1] : nullptr;
+		outTask.m_prev = (i > 0) ? &htasks[i - 1] : nullptr;
 		outTask.m_cb = inTask.m_callback;
 		outTask.m_arg = inTask.m_argument;
 		outTask.m_waitSemaphore = inTask.m_waitSemaphore;
 		outTask.m_signalSemaphore = inTask.m_signalSemaphore;
-
-		// Connect tasks
-		if(prevTask)
-		{
-			prevTask->m_next = &outTask;
-		}
-		prevTask = &outTask;
 	}
 
+	// Account the tasks before they become visible to the other threads
+	m_pendingTasks.fetchAdd(taskCount, AtomicMemoryOrder::RELAXED);
+
 	// Push work
+	if(g_currentHive == this)
 	{
-		LockGuard<Mutex> lock(m_mtx);
-
-		if(m_head != nullptr)
-		{
-			ANKI_ASSERT(m_tail && m_head);
-			m_tail->m_next = &htasks[0];
-			m_tail = &htasks[taskCount - 1];
-		}
-		else
+		// Called from inside a task, push everything to the local deque. The rest of the threads will steal if needed
+		m_threads[g_currentThreadId].pushFront(&htasks[0], &htasks[taskCount - 1], taskCount);
+		ANKI_HIVE_DEBUG_PRINT("tid: %u submit tasks locally\n", g_currentThreadId);
+	}
+	else
+	{
+		// Called from outside the hive, spread the tasks to all deques
+		const U32 tasksPerThread = (taskCount + m_threadCount - 1) / m_threadCount;
+		U32 threadId = m_nextThread.fetchAdd(1) % m_threadCount;
+		for(U32 first = 0; first < taskCount; first += tasksPerThread)
 		{
-			ANKI_ASSERT(m_tail == nullptr);
-			m_head = &htasks[0];
-			m_tail = &htasks[taskCount - 1];
+			const U32 count = min(tasksPerThread, taskCount - first);
+			Task& firstTask = htasks[first];
+			Task& lastTask = htasks[first + count - 1];
+			firstTask.m_prev = nullptr;
+			lastTask.m_next = nullptr;
+
+			m_threads[threadId].pushBack(&firstTask, &lastTask, count);
+			threadId = (threadId + 1) % m_threadCount;
 		}
 
-		m_pendingTasks += taskCount;
-
 		ANKI_HIVE_DEBUG_PRINT("submit tasks\n");
 	}
 
-	// Notify all threads
-	m_cvar.notifyAll();
+	wakeThreads(taskCount > 1);
 }
 
-void ThreadHive::threadRun(U32 threadId)
+void ThreadHive::wakeThreads(Bool all)
 {
-	Task* task = nullptr;
+	m_workGeneration.fetchAdd(1, AtomicMemoryOrder::SEQ_CST);
 
-	while(!waitForWork(threadId, task))
+	if(m_sleepingThreadCount.load(AtomicMemoryOrder::SEQ_CST) > 0)
 	{
-		// Run the task
-		ANKI_ASSERT(task && task->m_cb);
-		ANKI_HIVE_DEBUG_PRINT("tid: %lu will exec %p (udata: %p)\n", threadId, static_cast<void*>(task),
-							  static_cast<void*>(task->m_arg));
-		task->m_cb(task->m_arg, threadId, *this, task->m_signalSemaphore);
-
-#if ANKI_EXTRA_CHECKS
-		task->m_cb = nullptr;
-#endif
-
-		// Signal the semaphore as early as possible
-		if(task->m_signalSemaphore)
+		LockGuard<Mutex> lock(m_mtx);
+		if(all)
+		{
+			m_cvar.notifyAll();
+		}
+		else
 		{
-			const U32 out = task->m_signalSemaphore->m_atomic.fetchSub(1);
-			(void)out;
-			ANKI_ASSERT(out > 0u);
-			ANKI_HIVE_DEBUG_PRINT("\tsem is %u\n", out - 1u);
+			m_cvar.notifyOne();
 		}
 	}
-
-	ANKI_HIVE_DEBUG_PRINT("tid: %lu thread quits!\n", threadId);
 }
 
-Bool ThreadHive::waitForWork(U32 threadId, Task*& task)
+void ThreadHive::threadRun(U32 threadId)
 {
-	LockGuard<Mutex> lock(m_mtx);
-
-	ANKI_HIVE_DEBUG_PRINT("tid: %lu locking\n", threadId);
+	g_currentHive = this;
+	g_currentThreadId = threadId;
 
-	// Complete the previous task
-	if(task)
+	while(true)
 	{
-		--m_pendingTasks;
+		// Get the generation before looking for work. If it changes later on there might be new work
+		const U64 generation = m_workGeneration.load(AtomicMemoryOrder::SEQ_CST);
 
-		if(task->m_signalSemaphore || m_pendingTasks == 0)
+		Task* task = getNewTask(threadId);
+		if(task)
 		{
-			// A dependency maybe got resolved or we are out of tasks. Wake them all
-			ANKI_HIVE_DEBUG_PRINT("tid: %lu wake all\n", threadId);
-			m_cvar.notifyAll();
+			runTask(threadId, *task);
+			continue;
 		}
-	}
 
-	while(!m_quit && (task = getNewTask()) == nullptr)
-	{
-		ANKI_HIVE_DEBUG_PRINT("tid: %lu waiting\n", threadId);
+		// Found nothing, sleep until there is new work
+		LockGuard<Mutex> lock(m_mtx);
+
+		if(m_quit)
+		{
+			break;
+		}
 
-		// Wait if there is no work.
-		m_cvar.wait(m_mtx);
+		m_sleepingThreadCount.fetchAdd(1, AtomicMemoryOrder::SEQ_CST);
+		if(m_workGeneration.load(AtomicMemoryOrder::SEQ_CST) == generation)
+		{
+			ANKI_HIVE_DEBUG_PRINT("tid: %u waiting\n", threadId);
+			m_cvar.wait(m_mtx);
+		}
+		m_sleepingThreadCount.fetchSub(1, AtomicMemoryOrder::SEQ_CST);
 	}
 
-	return m_quit;
+	g_currentHive = nullptr;
+	g_currentThreadId = MAX_U32;
+
+	ANKI_HIVE_DEBUG_PRINT("tid: %u thread quits!\n", threadId);
 }
 
-ThreadHive::Task* ThreadHive::getNewTask()
+ThreadHive::Task* ThreadHive::getNewTask(U32 threadId)
 {
-	Task* prevTask = nullptr;
-	Task* task = m_head;
-	while(task)
+	// First the local deque
+	Task* task = m_threads[threadId].popFront();
+
+	// Then steal from the others
+	for(U32 i = 1; i < m_threadCount && task == nullptr; ++i)
 	{
-		// Check if there are dependencies
-		const Bool allDepsCompleted = task->m_waitSemaphore == nullptr || task->m_waitSemaphore->m_atomic.load() == 0;
+		task = m_threads[(threadId + i) % m_threadCount].steal();
+	}
 
-		if(allDepsCompleted)
-		{
-			// Found something, pop it
-			if(prevTask)
-			{
-				prevTask->m_next = task->m_next;
-			}
-
-			if(m_head == task)
-			{
-				m_head = task->m_next;
-			}
-
-			if(m_tail == task)
-			{
-				m_tail = prevTask;
-			}
+	return task;
+}
+
+void ThreadHive::runTask(U32 threadId, Task& task)
+{
+	ANKI_ASSERT(task.m_cb);
+	ANKI_HIVE_DEBUG_PRINT("tid: %u will exec %p (udata: %p)\n", threadId, static_cast<void*>(&task),
+						  static_cast<void*>(task.m_arg));
+	task.m_cb(task.m_arg, threadId, *this, task.m_signalSemaphore);
 
 #if ANKI_EXTRA_CHECKS
-			task->m_next = nullptr;
+	task.m_cb = nullptr;
 #endif
-			break;
-		}
 
-		prevTask = task;
-		task = task->m_next;
+	// Signal the semaphore as early as possible
+	if(task.m_signalSemaphore)
+	{
+		const U32 out = task.m_signalSemaphore->m_atomic.fetchSub(1, AtomicMemoryOrder::ACQ_REL);
+		ANKI_ASSERT(out > 0u);
+		ANKI_HIVE_DEBUG_PRINT("\tsem is %u\n", out - 1u);
+
+		if(out == 1)
+		{
+			// A dependency got resolved, wake everyone to have a look
+			wakeThreads(true);
+		}
 	}
 
-	return task;
+	// Complete the task. Don't touch the task after that since it might be deleted
+	const U32 pendingTasks = m_pendingTasks.fetchSub(1, AtomicMemoryOrder::ACQ_REL);
+	ANKI_ASSERT(pendingTasks > 0u);
+	if(pendingTasks == 1)
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_waitAllCvar.notifyAll();
+	}
 }
 
 void ThreadHive::waitAllTasks()
 {
 	ANKI_HIVE_DEBUG_PRINT("mt: waiting all\n");
 
-	LockGuard<Mutex> lock(m_mtx);
-	while(m_pendingTasks > 0)
 	{
-		m_cvar.wait(m_mtx);
+		LockGuard<Mutex> lock(m_mtx);
+		while(m_pendingTasks.load(AtomicMemoryOrder::ACQUIRE) > 0)
+		{
+			m_waitAllCvar.wait(m_mtx);
+		}
 	}
 
-	m_head = nullptr;
-	m_tail = nullptr;
+#if ANKI_EXTRA_CHECKS
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		ANKI_ASSERT(m_threads[i].m_dequeSize.load() == 0);
+	}
+#endif
+
 	m_alloc.getMemoryPool().reset();
 
 	ANKI_HIVE_DEBUG_PRINT("mt: done waiting all\n");
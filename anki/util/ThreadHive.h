@@ -75,6 +75,10 @@ public:
 
 /// A scheduler of small tasks. It takes a number of tasks and schedules them in one of the threads. The tasks can
 /// depend on previously submitted tasks or be completely independent.
+///
+/// Every thread owns a work-stealing deque. Tasks submitted from inside a task go to the deque of the thread that runs
+/// it, tasks submitted from other threads get distributed to all the deques. Threads that run out of work steal from
+/// the deques of the others.
 class ThreadHive : public NonCopyable
 {
 public:
@@ -140,24 +144,28 @@ private:
 	Thread* m_threads = nullptr;
 	U32 m_threadCount = 0;
 
-	Task* m_head = nullptr; ///< Head of the task list.
-	Task* m_tail = nullptr; ///< Tail of the task list.
+	Atomic<U32> m_pendingTasks = {0};
+	Atomic<U32> m_nextThread = {0}; ///< Where to push the next tasks that were submitted outside the hive.
+
+	/// Changes every time new work becomes available. It's used to avoid missed wakeups.
+	Atomic<U64> m_workGeneration = {0};
+	Atomic<U32> m_sleepingThreadCount = {0};
 	Bool m_quit = false;
-	U32 m_pendingTasks = 0;
 
 	Mutex m_mtx;
-	ConditionVariable m_cvar;
+	ConditionVariable m_cvar; ///< The threads wait for work on this one.
+	ConditionVariable m_waitAllCvar; ///< waitAllTasks() waits on this one.
 
 	void threadRun(U32 threadId);
 
-	/// Wait for more tasks.
-	Bool waitForWork(U32 threadId, Task*& task);
+	/// Get a task from the thread's deque or steal one from the other threads.
+	Task* getNewTask(U32 threadId);
 
-	/// Get new work from the queue.
-	Task* getNewTask();
+	/// Run a task and complete it.
+	void runTask(U32 threadId, Task& task);
 
-	/// Complete a task.
-	void completeTask(U32 taskId);
+	/// Inform the sleeping threads that there is new work.
+	void wakeThreads(Bool all);
 };
 /// @}
 
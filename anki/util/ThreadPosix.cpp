@@ -9,6 +9,8 @@
 namespace anki
 {
 
+thread_local const char* Thread::m_currentThreadName = nullptr;
+
 void Thread::start(void* userData, ThreadCallback callback, I32 pinToCore)
 {
 	ANKI_ASSERT(!m_started);
@@ -39,6 +41,7 @@ void Thread::start(void* userData, ThreadCallback callback, I32 pinToCore)
 		{
 			pthread_setname_np(pthread_self(), &thread->m_name[0]);
 		}
+		m_currentThreadName = &thread->m_name[0];
 
 		// Call the callback
 		ThreadCallbackInfo info;
@@ -12,6 +12,8 @@
 namespace anki
 {
 
+thread_local const char* Thread::m_currentThreadName = nullptr;
+
 DWORD ANKI_WINAPI Thread::threadCallback(LPVOID ud)
 {
 	ANKI_ASSERT(ud != nullptr);
@@ -22,6 +24,7 @@ DWORD ANKI_WINAPI Thread::threadCallback(LPVOID ud)
 	{
 		// TODO
 	}
+	m_currentThreadName = &thread->m_name[0];
 
 	// Call the callback
 	ThreadCallbackInfo info;
@@ -18,6 +18,7 @@ public:
 	U32 m_eventCount = 0;
 	Array<TracerCounter, COUNTERS_PER_CHUNK> m_counters;
 	U32 m_counterCount = 0;
+	Second m_latestTime = 0.0; ///< The time of the latest event or counter. Used by the flight recorder.
 };
 
 /// Thread local storage.
@@ -25,19 +26,28 @@ class alignas(ANKI_CACHE_LINE_SIZE) Tracer::ThreadLocal
 {
 public:
 	ThreadId m_tid = 0;
+	Array<char, 32> m_threadName;
 
 	Chunk* m_currentChunk = nullptr;
 	IntrusiveList<Chunk> m_allChunks;
+	U32 m_chunkCount = 0;
 	SpinLock m_currentChunkLock;
 };
 
 thread_local Tracer::ThreadLocal* Tracer::m_threadLocal = nullptr;
+thread_local U64 Tracer::m_threadLocalTracerUuid = 0;
+Atomic<U64> Tracer::m_nextUuid = {1};
 
 Tracer::~Tracer()
 {
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
+		while(!tlocal->m_allChunks.isEmpty())
+		{
+			m_alloc.deleteInstance(tlocal->m_allChunks.popFront());
+		}
+
 		m_alloc.deleteInstance(tlocal);
 	}
 	m_allThreadLocal.destroy(m_alloc);
@@ -45,12 +55,17 @@ Tracer::~Tracer()
 
 Tracer::ThreadLocal& Tracer::getThreadLocal()
 {
-	ThreadLocal* out = m_threadLocal;
+	ThreadLocal* out = (m_threadLocalTracerUuid == m_uuid) ? m_threadLocal : nullptr;
 	if(ANKI_UNLIKELY(out == nullptr))
 	{
 		out = m_alloc.newInstance<ThreadLocal>();
 		out->m_tid = Thread::getCurrentThreadId();
+		const char* threadName = Thread::getCurrentThreadName();
+		const PtrSize len = min<PtrSize>(std::strlen(threadName), out->m_threadName.getSize() - 1);
+		memcpy(&out->m_threadName[0], threadName, len);
+		out->m_threadName[len] = '\0';
 		m_threadLocal = out;
+		m_threadLocalTracerUuid = m_uuid;
 
 		// Store it
 		LockGuard<Mutex> lock(m_allThreadLocalMtx);
@@ -70,17 +85,44 @@ Tracer::Chunk& Tracer::getOrCreateChunk(ThreadLocal& tlocal)
 		// There is a chunk and it has enough space
 		out = tlocal.m_currentChunk;
 	}
+	else if(m_flightRecorderEnabled && !tlocal.m_allChunks.isEmpty()
+			&& (tlocal.m_chunkCount >= m_flightRecorderMaxChunksPerThread
+				|| tlocal.m_allChunks.getFront().m_latestTime
+					   < HighRezTimer::getCurrentTime() - m_flightRecorderDuration))
+	{
+		// Recycle the oldest chunk
+		out = tlocal.m_allChunks.popFront();
+		out->m_eventCount = 0;
+		out->m_counterCount = 0;
+		out->m_latestTime = 0.0;
+		tlocal.m_currentChunk = out;
+		tlocal.m_allChunks.pushBack(out);
+	}
 	else
 	{
 		// Create a new
 		out = m_alloc.newInstance<Chunk>();
 		tlocal.m_currentChunk = out;
 		tlocal.m_allChunks.pushBack(out);
+		++tlocal.m_chunkCount;
 	}
 
 	return *out;
 }
 
+void Tracer::setFlightRecorderEnabled(Bool enabled, Second duration)
+{
+	ANKI_ASSERT(!enabled || duration > 0.0);
+	m_flightRecorderEnabled = enabled;
+	m_flightRecorderDuration = duration;
+	m_flightRecorderMaxChunksPerThread = 0;
+	if(enabled)
+	{
+		const U32 chunkCount = U32(duration * F64(FLIGHT_RECORDER_CHUNKS_PER_SECOND)) + 1;
+		m_flightRecorderMaxChunksPerThread = max(MIN_FLIGHT_RECORDER_CHUNKS_PER_THREAD, chunkCount);
+	}
+}
+
 TracerEventHandle Tracer::beginEvent()
 {
 	TracerEventHandle out;
@@ -126,6 +168,9 @@ void Tracer::endEvent(const char* eventName, TracerEventHandle event)
 	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
 	writeCounter.m_name = eventName;
 	writeCounter.m_value = U64(writeEvent.m_duration * 1000000000.0);
+	writeCounter.m_time = (m_flightRecorderEnabled) ? event.m_start + duration : 0.0;
+
+	chunk.m_latestTime = max(chunk.m_latestTime, event.m_start + duration);
 }
 
 void Tracer::addCustomEvent(const char* eventName, Second start, Second duration)
@@ -151,6 +196,9 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
 	writeCounter.m_name = eventName;
 	writeCounter.m_value = U64(duration * 1000000000.0);
+	writeCounter.m_time = (m_flightRecorderEnabled) ? start + duration : 0.0;
+
+	chunk.m_latestTime = max(chunk.m_latestTime, start + duration);
 }
 
 void Tracer::incrementCounter(const char* counterName, U64 value)
@@ -168,11 +216,19 @@ void Tracer::incrementCounter(const char* counterName, U64 value)
 	TracerCounter& writeTo = chunk.m_counters[chunk.m_counterCount++];
 	writeTo.m_name = counterName;
 	writeTo.m_value = value;
+	writeTo.m_time = 0.0;
+
+	if(m_flightRecorderEnabled)
+	{
+		writeTo.m_time = HighRezTimer::getCurrentTime();
+		chunk.m_latestTime = max(chunk.m_latestTime, writeTo.m_time);
+	}
 }
 
 void Tracer::flush(TracerFlushCallback callback, void* callbackUserData)
 {
 	ANKI_ASSERT(callback);
+	ANKI_ASSERT(!m_flightRecorderEnabled && "Use readFlightRecorder()");
 
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
@@ -190,7 +246,51 @@ void Tracer::flush(TracerFlushCallback callback, void* callbackUserData)
 		}
 
 		tlocal->m_currentChunk = nullptr;
+		tlocal->m_chunkCount = 0;
 	}
 }
 
+void Tracer::readFlightRecorder(TracerFlightRecorderCallback callback, void* callbackUserData, Bool skipLocked)
+{
+	ANKI_ASSERT(callback);
+
+	if(skipLocked)
+	{
+		if(!m_allThreadLocalMtx.tryLock())
+		{
+			return;
+		}
+	}
+	else
+	{
+		m_allThreadLocalMtx.lock();
+	}
+
+	for(ThreadLocal* tlocal : m_allThreadLocal)
+	{
+		if(skipLocked)
+		{
+			if(!tlocal->m_currentChunkLock.tryLock())
+			{
+				continue;
+			}
+		}
+		else
+		{
+			tlocal->m_currentChunkLock.lock();
+		}
+
+		for(const Chunk& chunk : tlocal->m_allChunks)
+		{
+			callback(callbackUserData, tlocal->m_tid, &tlocal->m_threadName[0],
+					 ConstWeakArray<TracerEvent>(&chunk.m_events[0], chunk.m_eventCount),
+					 ConstWeakArray<TracerCounter>(&chunk.m_counters[0], chunk.m_counterCount));
+		}
+
+		tlocal->m_currentChunkLock.unlock();
+	}
+
+	m_allThreadLocalMtx.unlock();
+}
+
 } // end namespace anki
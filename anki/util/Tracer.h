@@ -46,6 +46,7 @@ class TracerCounter
 public:
 	CString m_name;
 	U64 m_value;
+	Second m_time; ///< When it was incremented. It's zero if the flight recorder is disabled.
 
 	TracerCounter()
 	{
@@ -58,12 +59,19 @@ public:
 using TracerFlushCallback = void (*)(void* userData, ThreadId tid, ConstWeakArray<TracerEvent> events,
 									 ConstWeakArray<TracerCounter> counters);
 
+/// Tracer flight recorder callback.
+/// @memberof Tracer
+using TracerFlightRecorderCallback = void (*)(void* userData, ThreadId tid, CString threadName,
+											  ConstWeakArray<TracerEvent> events,
+											  ConstWeakArray<TracerCounter> counters);
+
 /// Tracer.
 class Tracer : public NonCopyable
 {
 public:
 	Tracer(GenericMemoryPoolAllocator<U8> alloc)
 		: m_alloc(alloc)
+		, m_uuid(m_nextUuid.fetchAdd(1))
 	{
 	}
 
@@ -99,9 +107,53 @@ public:
 		m_enabled = enabled;
 	}
 
+	/// Enable the flight recorder mode. In that mode flush() shouldn't be used. Every thread keeps the events and
+	/// counters of the last few seconds in a bounded number of chunks that get recycled so there are no allocations
+	/// after a while. Use readFlightRecorder() to get them.
+	/// @param duration How many seconds to keep. The number of chunks per thread is derived from it (see
+	///        FLIGHT_RECORDER_CHUNKS_PER_SECOND). A thread that fills its chunks faster than that keeps less than
+	///        duration seconds.
+	/// @note It's not thread-safe. Set it before tracing anything.
+	void setFlightRecorderEnabled(Bool enabled, Second duration);
+
+	Bool getFlightRecorderEnabled() const
+	{
+		return m_flightRecorderEnabled;
+	}
+
+	/// The max number of chunks every thread keeps in flight recorder mode.
+	U32 getFlightRecorderMaxChunksPerThread() const
+	{
+		return m_flightRecorderMaxChunksPerThread;
+	}
+
+	/// Read the events and counters of the flight recorder without removing them. The callback will be called
+	/// multiple times.
+	/// @param skipLocked Don't wait for the locks. The threads whose events are locked at that moment are skipped. Use
+	///                   it when the caller might be holding one of the tracer's locks already (eg on fatal errors).
+	/// @note It's thread-safe.
+	void readFlightRecorder(TracerFlightRecorderCallback callback, void* callbackUserData, Bool skipLocked = false);
+
+	/// Ask for a dump of the flight recorder. The owner of the tracer is responsible for doing the actual dump.
+	/// @note It's thread-safe.
+	void requestFlightRecorderDump()
+	{
+		m_flightRecorderDumpRequested.store(true);
+	}
+
+	/// Return true if someone asked for a dump of the flight recorder and reset the request.
+	/// @note It's thread-safe.
+	Bool consumeFlightRecorderDumpRequest()
+	{
+		return m_flightRecorderDumpRequested.exchange(false);
+	}
+
 private:
 	static constexpr U32 EVENTS_PER_CHUNK = 256;
 	static constexpr U32 COUNTERS_PER_CHUNK = 512;
+	/// The chunk budget of a thread for every second of the flight recorder.
+	static constexpr U32 FLIGHT_RECORDER_CHUNKS_PER_SECOND = 16;
+	static constexpr U32 MIN_FLIGHT_RECORDER_CHUNKS_PER_THREAD = 16;
 
 	class ThreadLocal;
 	class Chunk;
@@ -109,11 +161,19 @@ private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
 	static thread_local ThreadLocal* m_threadLocal;
+	static thread_local U64 m_threadLocalTracerUuid; ///< The tracer that owns the m_threadLocal.
+	static Atomic<U64> m_nextUuid;
+	U64 m_uuid; ///< Used to detect the m_threadLocal of a different (possibly deleted) tracer.
 	DynamicArray<ThreadLocal*> m_allThreadLocal; ///< The Tracer should know about all the ThreadLocal.
 	Mutex m_allThreadLocalMtx;
 
 	Bool m_enabled = false;
 
+	Bool m_flightRecorderEnabled = false;
+	Second m_flightRecorderDuration = 0.0;
+	U32 m_flightRecorderMaxChunksPerThread = 0;
+	Atomic<Bool> m_flightRecorderDumpRequested = {false};
+
 	/// Get the thread local ThreadLocal structure.
 	/// @note Thread-safe.
 	ThreadLocal& getThreadLocal();
@@ -152,10 +212,12 @@ private:
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) \
 		TracerSingleton::get().addCustomEvent(#name_, start_, duration_)
 #	define ANKI_TRACE_INC_COUNTER(name_, val_) TracerSingleton::get().incrementCounter(#    name_, val_)
+#	define ANKI_TRACE_REQUEST_FLIGHT_RECORDER_DUMP() TracerSingleton::get().requestFlightRecorderDump()
 #else
 #	define ANKI_TRACE_SCOPED_EVENT(name_) ((void)0)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) ((void)0)
 #	define ANKI_TRACE_INC_COUNTER(name_, val_) ((void)0)
+#	define ANKI_TRACE_REQUEST_FLIGHT_RECORDER_DUMP() ((void)0)
 #endif
 /// @}
 
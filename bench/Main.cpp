@@ -0,0 +1,405 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/AnKi.h>
+
+using namespace anki;
+
+/// The scripted scenes of the benchmark. They are built procedurally so every run is the same.
+enum class BenchScenario : U8
+{
+	MODELS, ///< Lots of static models.
+	LIGHTS, ///< Some models and lots of point and spot lights.
+	PARTICLES, ///< Lots of particle emitters.
+	SKINNED, ///< Lots of animated skinned characters.
+
+	COUNT
+};
+
+static const Array<CString, U(BenchScenario::COUNT)> SCENARIO_NAMES = {{"models", "lights", "particles", "skinned"}};
+static const Array<U32, U(BenchScenario::COUNT)> SCENARIO_DEFAULT_COUNTS = {{4096, 1024, 256, 128}};
+
+/// Accumulates the timings of a single subsystem.
+class BenchTiming
+{
+public:
+	CString m_name;
+	Second m_total = 0.0;
+	Second m_min = MAX_SECOND;
+	Second m_max = 0.0;
+	U32 m_count = 0;
+
+	BenchTiming(CString name)
+		: m_name(name)
+	{
+	}
+
+	void add(Second t)
+	{
+		// Negative means that the timing is not available (eg GPU timestamps not ready yet)
+		if(t < 0.0)
+		{
+			return;
+		}
+
+		m_total += t;
+		m_min = min(m_min, t);
+		m_max = max(m_max, t);
+		++m_count;
+	}
+
+	Second getAverage() const
+	{
+		return (m_count) ? m_total / Second(m_count) : 0.0;
+	}
+};
+
+class BenchApp : public App
+{
+public:
+	BenchScenario m_scenario = BenchScenario::MODELS;
+	U32 m_objectCount = 0;
+	U32 m_warmupFrameCount = 32;
+	U32 m_frameCount = 512;
+	CString m_outputFilename;
+
+	U32 m_crntFrame = 0;
+	Second m_prevFrameStartTime = 0.0;
+	SceneNode* m_camera = nullptr;
+
+	BenchTiming m_frameTiming = {"frame"};
+	BenchTiming m_sceneUpdateTiming = {"sceneUpdate"};
+	BenchTiming m_physicsTiming = {"physics"};
+	BenchTiming m_visibilityTiming = {"visibility"};
+	BenchTiming m_clusterBinningTiming = {"clusterBinning"};
+	BenchTiming m_commandRecordingTiming = {"commandRecording"};
+	BenchTiming m_gpuTiming = {"gpu"};
+
+	Error init(int argc, char* argv[]);
+	Error userMainLoop(Bool& quit, Second elapsedTime) override;
+
+private:
+	Error parseCommandLineArgs(int argc, char* argv[], DynamicArrayAuto<char*>& configArgs);
+	Error createScene();
+	Error writeResults();
+
+	/// Place objects in a grid in front of the camera.
+	static Transform computeGridTransform(U32 idx, U32 count, F32 spacing, F32 height);
+};
+
+Error BenchApp::parseCommandLineArgs(int argc, char* argv[], DynamicArrayAuto<char*>& configArgs)
+{
+	for(I32 i = 1; i < argc; ++i)
+	{
+		const CString arg = argv[i];
+		const Bool isBenchArg =
+			arg == "-scenario" || arg == "-count" || arg == "-frames" || arg == "-warmup" || arg == "-output";
+		if(!isBenchArg)
+		{
+			// Not ours, pass it to the config
+			configArgs.emplaceBack(argv[i]);
+			continue;
+		}
+
+		if(i + 1 >= argc)
+		{
+			ANKI_LOGE("Expecting a value after %s", arg.cstr());
+			return Error::USER_DATA;
+		}
+
+		const CString value = argv[++i];
+		if(arg == "-scenario")
+		{
+			m_scenario = BenchScenario::COUNT;
+			for(U32 s = 0; s < U32(BenchScenario::COUNT); ++s)
+			{
+				if(value == SCENARIO_NAMES[s])
+				{
+					m_scenario = BenchScenario(s);
+				}
+			}
+
+			if(m_scenario == BenchScenario::COUNT)
+			{
+				ANKI_LOGE("Unknown scenario: %s", value.cstr());
+				return Error::USER_DATA;
+			}
+		}
+		else if(arg == "-count")
+		{
+			ANKI_CHECK(value.toNumber(m_objectCount));
+		}
+		else if(arg == "-frames")
+		{
+			ANKI_CHECK(value.toNumber(m_frameCount));
+		}
+		else if(arg == "-warmup")
+		{
+			ANKI_CHECK(value.toNumber(m_warmupFrameCount));
+		}
+		else
+		{
+			m_outputFilename = value;
+		}
+	}
+
+	if(m_objectCount == 0)
+	{
+		m_objectCount = SCENARIO_DEFAULT_COUNTS[m_scenario];
+	}
+
+	return Error::NONE;
+}
+
+Error BenchApp::init(int argc, char* argv[])
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	DynamicArrayAuto<char*> configArgs(alloc);
+	ANKI_CHECK(parseCommandLineArgs(argc, argv, configArgs));
+
+	// Config. Don't throttle the frame rate and advance the time by a fixed amount so every run updates the scene the
+	// same way
+	ConfigSet config = DefaultConfigSet::get();
+	config.set("rsrc_dataPaths",
+			   StringAuto(alloc).sprintf("%s:%s/samples/physics_playground:%s/samples/skeletal_animation",
+										 ANKI_SOURCE_DIRECTORY, ANKI_SOURCE_DIRECTORY, ANKI_SOURCE_DIRECTORY));
+	config.set("width", 1280);
+	config.set("height", 720);
+	config.set("gr_vsync", 0);
+	config.set("gr_debugContext", 0);
+	config.set("core_targetFps", 10000u);
+	config.set("core_fixedTimeStep", 1.0 / 60.0);
+	if(configArgs.getSize())
+	{
+		ANKI_CHECK(config.setFromCommandLineArguments(configArgs.getSize(), &configArgs[0]));
+	}
+
+	ANKI_CHECK(App::init(config, allocAligned, nullptr));
+
+	// The renderer collects its timings only when the stats are displayed
+	setDisplayStats(true);
+
+	ANKI_CHECK(createScene());
+
+	ANKI_LOGI("Running the \"%s\" scenario with %u objects for %u frames (%u warmup)",
+			  SCENARIO_NAMES[m_scenario].cstr(), m_objectCount, m_frameCount, m_warmupFrameCount);
+	return Error::NONE;
+}
+
+Transform BenchApp::computeGridTransform(U32 idx, U32 count, F32 spacing, F32 height)
+{
+	const U32 side = U32(ceil(sqrt(F32(count))));
+	const F32 x = (F32(idx % side) - F32(side) / 2.0f) * spacing;
+	const F32 z = -F32(idx / side) * spacing - 5.0f;
+	return Transform(Vec4(x, height, z, 0.0f), Mat3x4::getIdentity(), 1.0f);
+}
+
+Error BenchApp::createScene()
+{
+	SceneGraph& scene = getSceneGraph();
+	StringAuto name(scene.getFrameAllocator());
+
+	// Camera
+	PerspectiveCameraNode* cam;
+	ANKI_CHECK(scene.newSceneNode<PerspectiveCameraNode>("bench_camera", cam));
+	const F32 fovY = toRad(60.0f);
+	cam->getFirstComponentOfType<FrustumComponent>().setPerspective(0.1f, 500.0f,
+																	  getMainRenderer().getAspectRatio() * fovY, fovY);
+	cam->getFirstComponentOfType<MoveComponent>().setLocalOrigin(Vec4(0.0f, 10.0f, 10.0f, 0.0f));
+	scene.setActiveCameraNode(cam);
+	m_camera = cam;
+
+	// Something to light
+	if(m_scenario == BenchScenario::LIGHTS)
+	{
+		const U32 modelCount = m_objectCount / 4;
+		for(U32 i = 0; i < modelCount; ++i)
+		{
+			ModelNode* node;
+			name.destroy();
+			name.sprintf("bench_model%u", i);
+			ANKI_CHECK(
+				scene.newSceneNode<ModelNode>(name.toCString(), node, "assets/Suzannedynamic-material.ankimdl"));
+			node->getFirstComponentOfType<MoveComponent>().setLocalTransform(
+				computeGridTransform(i, modelCount, 6.0f, 1.0f));
+		}
+	}
+
+	for(U32 i = 0; i < m_objectCount; ++i)
+	{
+		name.destroy();
+		name.sprintf("bench_obj%u", i);
+
+		SceneNode* node = nullptr;
+		F32 spacing = 3.0f;
+		switch(m_scenario)
+		{
+		case BenchScenario::MODELS:
+		{
+			ModelNode* model;
+			ANKI_CHECK(
+				scene.newSceneNode<ModelNode>(name.toCString(), model, "assets/Suzannedynamic-material.ankimdl"));
+			node = model;
+			break;
+		}
+		case BenchScenario::LIGHTS:
+		{
+			const Vec4 color(F32(i % 3 == 0), F32(i % 3 == 1), F32(i % 3 == 2), 0.0f);
+			if(i % 4 != 0)
+			{
+				PointLightNode* light;
+				ANKI_CHECK(scene.newSceneNode<PointLightNode>(name.toCString(), light));
+				LightComponent& lc = light->getFirstComponentOfType<LightComponent>();
+				lc.setDiffuseColor(color * 5.0f);
+				lc.setRadius(4.0f);
+				node = light;
+			}
+			else
+			{
+				SpotLightNode* light;
+				ANKI_CHECK(scene.newSceneNode<SpotLightNode>(name.toCString(), light));
+				LightComponent& lc = light->getFirstComponentOfType<LightComponent>();
+				lc.setDiffuseColor(color * 10.0f);
+				lc.setDistance(8.0f);
+				lc.setInnerAngle(toRad(20.0f));
+				lc.setOuterAngle(toRad(40.0f));
+				node = light;
+			}
+			break;
+		}
+		case BenchScenario::PARTICLES:
+		{
+			ParticleEmitterNode* emitter;
+			ANKI_CHECK(scene.newSceneNode<ParticleEmitterNode>(name.toCString(), emitter, "assets/smoke.ankipart"));
+			node = emitter;
+			spacing = 5.0f;
+			break;
+		}
+		case BenchScenario::SKINNED:
+		{
+			ModelNode* model;
+			ANKI_CHECK(scene.newSceneNode<ModelNode>(name.toCString(), model, "assets/Mesh_Robot.001.ankimdl"));
+
+			AnimationResourcePtr anim;
+			ANKI_CHECK(getResourceManager().loadResource("assets/float.001.ankianim", anim));
+			AnimationPlayInfo animInfo;
+			animInfo.m_startTime = Second(i % 16) / 16.0; // Desync them a bit
+			animInfo.m_repeatTimes = -1.0f;
+			model->getFirstComponentOfType<SkinComponent>().playAnimation(0, anim, animInfo);
+			node = model;
+			break;
+		}
+		default:
+			ANKI_ASSERT(0);
+		}
+
+		node->getFirstComponentOfType<MoveComponent>().setLocalTransform(
+			computeGridTransform(i, m_objectCount, spacing, (m_scenario == BenchScenario::LIGHTS) ? 3.0f : 0.0f));
+	}
+
+	return Error::NONE;
+}
+
+Error BenchApp::userMainLoop(Bool& quit, Second elapsedTime)
+{
+	quit = false;
+
+	const Second now = HighRezTimer::getCurrentTime();
+
+	// The stats are the ones of the previous frame
+	if(m_crntFrame > m_warmupFrameCount)
+	{
+		const SceneGraphStats& sceneStats = getSceneGraph().getStats();
+		const MainRendererStats& rendererStats = getMainRenderer().getStats();
+
+		m_frameTiming.add(now - m_prevFrameStartTime);
+		m_sceneUpdateTiming.add(sceneStats.m_updateTime);
+		m_physicsTiming.add(sceneStats.m_physicsUpdate);
+		m_visibilityTiming.add(sceneStats.m_visibilityTestsTime);
+		m_clusterBinningTiming.add(rendererStats.m_lightBinTime);
+		m_commandRecordingTiming.add(rendererStats.m_renderingCpuTime - rendererStats.m_lightBinTime);
+		m_gpuTiming.add(rendererStats.m_renderingGpuTime);
+	}
+
+	if(m_crntFrame == m_warmupFrameCount + m_frameCount)
+	{
+		ANKI_CHECK(writeResults());
+		quit = true;
+		return Error::NONE;
+	}
+
+	// Pan the camera slowly so the visible set changes the same way every run
+	const F32 ang = toRad(30.0f) * sin(F32(m_crntFrame) / 60.0f);
+	m_camera->getFirstComponentOfType<MoveComponent>().setLocalRotation(
+		Mat3x4(Vec3(0.0f), Euler(toRad(-20.0f), ang, 0.0f)));
+
+	m_prevFrameStartTime = now;
+	++m_crntFrame;
+	return Error::NONE;
+}
+
+Error BenchApp::writeResults()
+{
+	const Array<const BenchTiming*, 7> timings = {{&m_frameTiming, &m_sceneUpdateTiming, &m_physicsTiming,
+												   &m_visibilityTiming, &m_clusterBinningTiming,
+												   &m_commandRecordingTiming, &m_gpuTiming}};
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StringListAuto lines(alloc);
+	lines.pushBackSprintf("{\n");
+	lines.pushBackSprintf("\t\"scenario\": \"%s\",\n", SCENARIO_NAMES[m_scenario].cstr());
+	lines.pushBackSprintf("\t\"objectCount\": %u,\n", m_objectCount);
+	lines.pushBackSprintf("\t\"frameCount\": %u,\n", m_frameCount);
+	lines.pushBackSprintf("\t\"timingsMs\": {\n");
+	for(U32 i = 0; i < timings.getSize(); ++i)
+	{
+		const BenchTiming& t = *timings[i];
+		lines.pushBackSprintf("\t\t\"%s\": {\"avg\": %f, \"min\": %f, \"max\": %f, \"samples\": %u}%s\n",
+							  t.m_name.cstr(), t.getAverage() * 1000.0, (t.m_count) ? t.m_min * 1000.0 : 0.0,
+							  t.m_max * 1000.0, t.m_count, (i + 1 < timings.getSize()) ? "," : "");
+	}
+	lines.pushBackSprintf("\t}\n");
+	lines.pushBackSprintf("}\n");
+
+	StringAuto json(alloc);
+	lines.join("", json);
+
+	if(m_outputFilename.isEmpty())
+	{
+		printf("%s", json.cstr());
+	}
+	else
+	{
+		File file;
+		ANKI_CHECK(file.open(m_outputFilename, FileOpenFlag::WRITE));
+		ANKI_CHECK(file.writeText("%s", json.cstr()));
+		ANKI_LOGI("Results written to %s", m_outputFilename.cstr());
+	}
+
+	return Error::NONE;
+}
+
+int main(int argc, char* argv[])
+{
+	Error err = Error::NONE;
+
+	BenchApp* app = new BenchApp;
+	err = app->init(argc, argv);
+	if(!err)
+	{
+		err = app->mainLoop();
+	}
+
+	if(err)
+	{
+		ANKI_LOGE("Error reported. Usage: %s [-scenario models|lights|particles|skinned] [-count N] [-frames N] "
+				  "[-warmup N] [-output results.json] [anki config options]",
+				  argv[0]);
+	}
+
+	delete app;
+	return err ? 1 : 0;
+}
@@ -0,0 +1,274 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <vector>
+
+namespace anki
+{
+
+namespace
+{
+
+/// Shapes that are that close to passing or failing a test are ignored because the SIMD and scalar paths might round
+/// differently.
+const F32 EPSILON = 0.001f;
+
+class AabbArrays
+{
+public:
+	std::vector<F32> m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ;
+
+	AabbSoa getSoa() const
+	{
+		AabbSoa soa;
+		soa.m_minX = ConstWeakArray<F32>(&m_minX[0], U32(m_minX.size()));
+		soa.m_minY = ConstWeakArray<F32>(&m_minY[0], U32(m_minY.size()));
+		soa.m_minZ = ConstWeakArray<F32>(&m_minZ[0], U32(m_minZ.size()));
+		soa.m_maxX = ConstWeakArray<F32>(&m_maxX[0], U32(m_maxX.size()));
+		soa.m_maxY = ConstWeakArray<F32>(&m_maxY[0], U32(m_maxY.size()));
+		soa.m_maxZ = ConstWeakArray<F32>(&m_maxZ[0], U32(m_maxZ.size()));
+		return soa;
+	}
+
+	Aabb getAabb(U32 i, F32 grow) const
+	{
+		return Aabb(Vec3(m_minX[i], m_minY[i], m_minZ[i]) - grow, Vec3(m_maxX[i], m_maxY[i], m_maxZ[i]) + grow);
+	}
+};
+
+class SphereArrays
+{
+public:
+	std::vector<F32> m_centerX, m_centerY, m_centerZ, m_radius;
+
+	SphereSoa getSoa() const
+	{
+		SphereSoa soa;
+		soa.m_centerX = ConstWeakArray<F32>(&m_centerX[0], U32(m_centerX.size()));
+		soa.m_centerY = ConstWeakArray<F32>(&m_centerY[0], U32(m_centerY.size()));
+		soa.m_centerZ = ConstWeakArray<F32>(&m_centerZ[0], U32(m_centerZ.size()));
+		soa.m_radius = ConstWeakArray<F32>(&m_radius[0], U32(m_radius.size()));
+		return soa;
+	}
+
+	Sphere getSphere(U32 i, F32 grow) const
+	{
+		return Sphere(Vec4(m_centerX[i], m_centerY[i], m_centerZ[i], 0.0f), m_radius[i] + grow);
+	}
+};
+
+F32 randomF32(F32 min, F32 max)
+{
+	return getRandomRange(min, max);
+}
+
+Vec3 randomVec3(F32 min, F32 max)
+{
+	return Vec3(randomF32(min, max), randomF32(min, max), randomF32(min, max));
+}
+
+Vec3 randomDirection()
+{
+	Vec3 dir;
+	do
+	{
+		dir = randomVec3(-1.0f, 1.0f);
+
+		// Test the axis aligned cases as well
+		for(U32 i = 0; i < 3; ++i)
+		{
+			if((getRandom() % 8) == 0)
+			{
+				dir[i] = 0.0f;
+			}
+		}
+	} while(dir.getLengthSquared() < 0.01f);
+
+	return dir.getNormalized();
+}
+
+Plane randomPlane()
+{
+	return Plane(randomDirection().xyz0(), randomF32(-10.0f, 10.0f));
+}
+
+AabbArrays randomAabbs(U32 count)
+{
+	AabbArrays arrays;
+	for(U32 i = 0; i < count; ++i)
+	{
+		const Vec3 min = randomVec3(-20.0f, 20.0f);
+		const Vec3 max = min + randomVec3(0.1f, 10.0f);
+		arrays.m_minX.push_back(min.x());
+		arrays.m_minY.push_back(min.y());
+		arrays.m_minZ.push_back(min.z());
+		arrays.m_maxX.push_back(max.x());
+		arrays.m_maxY.push_back(max.y());
+		arrays.m_maxZ.push_back(max.z());
+	}
+	return arrays;
+}
+
+SphereArrays randomSpheres(U32 count)
+{
+	SphereArrays arrays;
+	for(U32 i = 0; i < count; ++i)
+	{
+		const Vec3 center = randomVec3(-20.0f, 20.0f);
+		arrays.m_centerX.push_back(center.x());
+		arrays.m_centerY.push_back(center.y());
+		arrays.m_centerZ.push_back(center.z());
+		arrays.m_radius.push_back(randomF32(0.1f, 5.0f));
+	}
+	return arrays;
+}
+
+/// Compare the mask of a batch function with the scalar results. The scalar test is called with a shape that is a bit
+/// bigger and a bit smaller and the shapes that give different results are skipped.
+template<typename TScalarTest>
+void checkMask(U32 count, const std::vector<U64>& mask, U32 passCount, TScalarTest scalarTest)
+{
+	U32 bitCount = 0;
+	for(U32 i = 0; i < count; ++i)
+	{
+		const Bool bit = (mask[i / 64] & (U64(1) << (i % 64))) != 0;
+		bitCount += bit;
+
+		const Bool bigger = scalarTest(i, EPSILON);
+		const Bool smaller = scalarTest(i, -EPSILON);
+		if(bigger == smaller)
+		{
+			ANKI_TEST_EXPECT_EQ(bit, bigger);
+		}
+	}
+
+	// The bits past the end should be zero
+	if(count % 64)
+	{
+		ANKI_TEST_EXPECT_EQ(mask[count / 64] >> (count % 64), 0);
+	}
+
+	ANKI_TEST_EXPECT_EQ(passCount, bitCount);
+}
+
+} // end namespace
+
+ANKI_TEST(Collision, BatchPlane)
+{
+	for(U32 count : {1u, 3u, 4u, 63u, 64u, 65u, 1001u})
+	{
+		const Plane plane = randomPlane();
+		std::vector<U64> mask(computeBatchMaskSize(count));
+
+		const AabbArrays aabbs = randomAabbs(count);
+		U32 passCount = testPlaneBatch(plane, aabbs.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount,
+				  [&](U32 i, F32 grow) { return testPlane(plane, aabbs.getAabb(i, grow)) >= 0.0f; });
+
+		const SphereArrays spheres = randomSpheres(count);
+		passCount = testPlaneBatch(plane, spheres.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount,
+				  [&](U32 i, F32 grow) { return testPlane(plane, spheres.getSphere(i, grow)) >= 0.0f; });
+	}
+}
+
+ANKI_TEST(Collision, BatchFrustum)
+{
+	for(U32 count : {2u, 4u, 127u, 128u, 1001u})
+	{
+		Array<Plane, 6> planes;
+		for(Plane& plane : planes)
+		{
+			plane = randomPlane();
+		}
+
+		// Make sure the planes enclose some volume around the origin so some shapes pass
+		for(Plane& plane : planes)
+		{
+			plane = Plane(plane.getNormal(), -absolute(plane.getOffset()) - 10.0f);
+		}
+
+		std::vector<U64> mask(computeBatchMaskSize(count));
+
+		const AabbArrays aabbs = randomAabbs(count);
+		U32 passCount = testFrustumBatch(planes, aabbs.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount, [&](U32 i, F32 grow) {
+			for(const Plane& plane : planes)
+			{
+				if(testPlane(plane, aabbs.getAabb(i, grow)) < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		});
+
+		const SphereArrays spheres = randomSpheres(count);
+		passCount = testFrustumBatch(planes, spheres.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount, [&](U32 i, F32 grow) {
+			for(const Plane& plane : planes)
+			{
+				if(testPlane(plane, spheres.getSphere(i, grow)) < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		});
+	}
+}
+
+ANKI_TEST(Collision, BatchAabb)
+{
+	for(U32 count : {1u, 5u, 64u, 1001u})
+	{
+		const Vec3 min = randomVec3(-15.0f, 15.0f);
+		const Aabb aabb(min, min + randomVec3(0.1f, 15.0f));
+		std::vector<U64> mask(computeBatchMaskSize(count));
+
+		const AabbArrays aabbs = randomAabbs(count);
+		U32 passCount = testCollisionBatch(aabb, aabbs.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount,
+				  [&](U32 i, F32 grow) { return testCollision(aabb, aabbs.getAabb(i, grow)); });
+
+		const SphereArrays spheres = randomSpheres(count);
+		passCount = testCollisionBatch(aabb, spheres.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount,
+				  [&](U32 i, F32 grow) { return testCollision(aabb, spheres.getSphere(i, grow)); });
+	}
+}
+
+ANKI_TEST(Collision, BatchRay)
+{
+	// Some rays with known results first
+	{
+		const Ray ray(Vec3(0.0f), Vec3(1.0f, 0.0f, 0.0f));
+		ANKI_TEST_EXPECT_EQ(testCollision(Aabb(Vec3(1.0f, -1.0f, -1.0f), Vec3(2.0f, 1.0f, 1.0f)), ray), true);
+		ANKI_TEST_EXPECT_EQ(testCollision(Aabb(Vec3(-2.0f, -1.0f, -1.0f), Vec3(-1.0f, 1.0f, 1.0f)), ray), false);
+		ANKI_TEST_EXPECT_EQ(testCollision(Aabb(Vec3(1.0f, 1.0f, -1.0f), Vec3(2.0f, 2.0f, 1.0f)), ray), false);
+		ANKI_TEST_EXPECT_EQ(testCollision(Sphere(Vec4(5.0f, 0.5f, 0.0f, 0.0f), 1.0f), ray), true);
+		ANKI_TEST_EXPECT_EQ(testCollision(Sphere(Vec4(-5.0f, 0.0f, 0.0f, 0.0f), 1.0f), ray), false);
+		ANKI_TEST_EXPECT_EQ(testCollision(Sphere(Vec4(0.5f, 0.0f, 0.0f, 0.0f), 1.0f), ray), true);
+	}
+
+	for(U32 count : {1u, 6u, 64u, 1001u})
+	{
+		const Ray ray(randomVec3(-10.0f, 10.0f), randomDirection());
+		std::vector<U64> mask(computeBatchMaskSize(count));
+
+		const AabbArrays aabbs = randomAabbs(count);
+		U32 passCount = testCollisionBatch(ray, aabbs.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount, [&](U32 i, F32 grow) { return testCollision(aabbs.getAabb(i, grow), ray); });
+
+		const SphereArrays spheres = randomSpheres(count);
+		passCount = testCollisionBatch(ray, spheres.getSoa(), WeakArray<U64>(&mask[0], U32(mask.size())));
+		checkMask(count, mask, passCount,
+				  [&](U32 i, F32 grow) { return testCollision(spheres.getSphere(i, grow), ray); });
+	}
+}
+
+} // end namespace anki
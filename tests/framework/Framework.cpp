@@ -256,7 +256,7 @@ GrManager* createGrManager(const ConfigSet& cfg, NativeWindow* win)
 }
 
 ResourceManager* createResourceManager(const ConfigSet& cfg, GrManager* gr, PhysicsWorld*& physics,
-									   ResourceFilesystem*& resourceFs)
+									   ResourceFilesystem*& resourceFs, CString cacheDir)
 {
 	HeapAllocator<U8> alloc(allocAligned, nullptr);
 
@@ -272,7 +272,7 @@ ResourceManager* createResourceManager(const ConfigSet& cfg, GrManager* gr, Phys
 	rinit.m_physics = physics;
 	rinit.m_resourceFs = resourceFs;
 	rinit.m_config = &cfg;
-	rinit.m_cacheDir = "./";
+	rinit.m_cacheDir = cacheDir;
 	rinit.m_allocCallback = allocAligned;
 	rinit.m_allocCallbackData = nullptr;
 	ResourceManager* resources = new ResourceManager();
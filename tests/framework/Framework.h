@@ -228,6 +228,6 @@ NativeWindow* createWindow(const ConfigSet& cfg);
 GrManager* createGrManager(const ConfigSet& cfg, NativeWindow* win);
 
 ResourceManager* createResourceManager(const ConfigSet& cfg, GrManager* gr, PhysicsWorld*& physics,
-									   ResourceFilesystem*& resourceFs);
+									   ResourceFilesystem*& resourceFs, CString cacheDir = "./");
 
 } // end namespace anki
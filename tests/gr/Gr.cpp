@@ -1692,7 +1692,51 @@ ANKI_TEST(Gr, RenderGraph)
 		pass.newDependency({taaHistoryRt, TextureUsageBit::SAMPLED_FRAGMENT});
 	}
 
+	RenderGraphStatistics stats;
 	rgraph->compileNewGraph(descr, alloc);
+	rgraph->getStatistics(stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_bakeCacheHit, false);
+	const U64 bakedGraphHash = stats.m_bakedGraphHash;
+	rgraph->reset();
+
+	// Compile the same description again. This time it should use the cached batches and barriers
+	rgraph->compileNewGraph(descr, alloc);
+	rgraph->getStatistics(stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_bakeCacheHit, true);
+	ANKI_TEST_EXPECT_EQ(stats.m_bakedGraphHash, bakedGraphHash);
+	rgraph->reset();
+
+	// A new graph doesn't have a cache. It should bake the same batches and barriers
+	{
+		RenderGraphPtr rgraph2 = gr->newRenderGraph();
+		rgraph2->compileNewGraph(descr, alloc);
+		rgraph2->getStatistics(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_bakeCacheHit, false);
+		ANKI_TEST_EXPECT_EQ(stats.m_bakedGraphHash, bakedGraphHash);
+		rgraph2->reset();
+	}
+
+	// Change the topology. The cache should miss
+	{
+		RenderTargetHandle extraRt = descr.newRenderTarget(newRTDescr("Extra"));
+		GraphicsRenderPassDescription& pass = descr.newGraphicsRenderPass("Extra");
+		pass.newDependency({taaRt, TextureUsageBit::SAMPLED_FRAGMENT});
+		pass.newDependency({extraRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+	}
+
+	rgraph->compileNewGraph(descr, alloc);
+	rgraph->getStatistics(stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_bakeCacheHit, false);
+	ANKI_TEST_EXPECT_NEQ(stats.m_bakedGraphHash, bakedGraphHash);
+	const U64 newBakedGraphHash = stats.m_bakedGraphHash;
+	rgraph->reset();
+
+	// And the new topology should hit
+	rgraph->compileNewGraph(descr, alloc);
+	rgraph->getStatistics(stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_bakeCacheHit, true);
+	ANKI_TEST_EXPECT_EQ(stats.m_bakedGraphHash, newBakedGraphHash);
+	rgraph->reset();
 	COMMON_END()
 }
 
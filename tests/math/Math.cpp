@@ -5,6 +5,7 @@
 
 #include "tests/framework/Framework.h"
 #include "anki/Math.h"
+#include "anki/util/HighRezTimer.h"
 
 using namespace anki;
 
@@ -376,3 +377,153 @@ ANKI_TEST(Math, Mat3x4)
 		ANKI_TEST_EXPECT_EQ(m * v, Vec3(20, 44, 68));
 	}
 }
+
+static Mat4 getRandomMat4()
+{
+	Mat4 m;
+	for(U i = 0; i < 16; ++i)
+	{
+		m[i] = getRandomRange(-2.0f, 2.0f);
+	}
+	return m;
+}
+
+/// FMA rounds differently so compare with a relative epsilon.
+template<typename T>
+static Bool closeEnough(const T& a, const T& b)
+{
+	for(U i = 0; i < sizeof(T) / sizeof(F32); ++i)
+	{
+		if(absolute(a[i] - b[i]) > 1.0e-5f * max(1.0f, absolute(b[i])))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static const char* getSimdBackendName()
+{
+#if ANKI_SIMD_AVX2
+	return "AVX2/FMA";
+#elif ANKI_SIMD_SSE
+	return "SSE";
+#elif ANKI_SIMD_NEON
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+
+ANKI_TEST(Math, BatchFunctions)
+{
+	// Odd count on purpose to test the remainders
+	const U32 COUNT = 37;
+	Array<Mat4, COUNT> as, bs, outs;
+	Array<Vec4, COUNT> points, outPoints;
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		as[i] = getRandomMat4();
+		bs[i] = getRandomMat4();
+		points[i] = Vec4(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f),
+						 getRandomRange(0.0f, 1.0f));
+	}
+
+	// Transform points
+	transformPoints(as[0], points, outPoints);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(closeEnough(outPoints[i], as[0] * points[i]), true);
+	}
+
+	// In place
+	outPoints = points;
+	transformPoints(as[0], outPoints, outPoints);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(closeEnough(outPoints[i], as[0] * points[i]), true);
+	}
+
+	// One matrix times many
+	multiplyMatrices(as[0], bs, outs);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(closeEnough(outs[i], as[0] * bs[i]), true);
+	}
+
+	// Pairs
+	multiplyMatrices(as, bs, outs);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(closeEnough(outs[i], as[i] * bs[i]), true);
+	}
+
+	// Pairs in place
+	outs = bs;
+	multiplyMatrices(as, outs, outs);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(closeEnough(outs[i], as[i] * bs[i]), true);
+	}
+}
+
+ANKI_TEST(Math, BatchFunctionsBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 COUNT = 1024 * 16;
+	const U32 ITERATION_COUNT = 32;
+
+	DynamicArrayAuto<Mat4> as(alloc), bs(alloc), outs(alloc);
+	DynamicArrayAuto<Vec4> points(alloc), outPoints(alloc);
+	as.create(COUNT);
+	bs.create(COUNT);
+	outs.create(COUNT);
+	points.create(COUNT);
+	outPoints.create(COUNT);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		as[i] = getRandomMat4();
+		bs[i] = getRandomMat4();
+		points[i] = Vec4(getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f), getRandomRange(-10.0f, 10.0f),
+						 1.0f);
+	}
+
+	Second loopTime = 0.0;
+	Second batchTime = 0.0;
+	Second loopPointsTime = 0.0;
+	Second batchPointsTime = 0.0;
+	for(U32 it = 0; it < ITERATION_COUNT; ++it)
+	{
+		Second begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			outs[i] = as[i] * bs[i];
+		}
+		loopTime += HighRezTimer::getCurrentTime() - begin;
+
+		begin = HighRezTimer::getCurrentTime();
+		multiplyMatrices(ConstWeakArray<Mat4>(as), ConstWeakArray<Mat4>(bs), WeakArray<Mat4>(outs));
+		batchTime += HighRezTimer::getCurrentTime() - begin;
+
+		begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			outPoints[i] = as[0] * points[i];
+		}
+		loopPointsTime += HighRezTimer::getCurrentTime() - begin;
+
+		begin = HighRezTimer::getCurrentTime();
+		transformPoints(as[0], ConstWeakArray<Vec4>(points), WeakArray<Vec4>(outPoints));
+		batchPointsTime += HighRezTimer::getCurrentTime() - begin;
+	}
+
+	const F64 mega = F64(COUNT) * ITERATION_COUNT / 1000000.0;
+	ANKI_TEST_LOGI("Backend %s. Mat4*Mat4: loop %f M/sec, batch %f M/sec. Mat4*Vec4: loop %f M/sec, batch %f M/sec",
+				   getSimdBackendName(), mega / loopTime, mega / batchTime, mega / loopPointsTime,
+				   mega / batchPointsTime);
+
+	// Use the results so nothing gets optimized away
+	ANKI_TEST_EXPECT_EQ(closeEnough(outs[COUNT - 1], as[COUNT - 1] * bs[COUNT - 1]), true);
+	ANKI_TEST_EXPECT_EQ(closeEnough(outPoints[COUNT - 1], as[0] * points[COUNT - 1]), true);
+}
@@ -0,0 +1,141 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/physics/PhysicsWorld.h>
+#include <anki/physics/PhysicsBody.h>
+#include <anki/physics/PhysicsCollisionShape.h>
+#include <anki/physics/PhysicsTrigger.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+namespace
+{
+
+/// Keeps the closest hit. Only one thread touches a ray at a time so there is no need to lock.
+class TestRayCastCallback final : public PhysicsWorldRayCastCallback
+{
+public:
+	const PhysicsFilteredObject* m_obj = nullptr;
+	Vec3 m_normal = Vec3(0.0f);
+	Vec3 m_position = Vec3(0.0f);
+	F32 m_distance = MAX_F32;
+
+	TestRayCastCallback(const Vec3& from, const Vec3& to)
+		: PhysicsWorldRayCastCallback(from, to, PhysicsMaterialBit::STATIC_GEOMETRY)
+	{
+	}
+
+	void processResult(PhysicsFilteredObject& obj, const Vec3& worldNormal, const Vec3& worldPosition) override
+	{
+		const F32 dist = (worldPosition - m_from).getLength();
+		if(dist < m_distance)
+		{
+			m_obj = &obj;
+			m_normal = worldNormal;
+			m_position = worldPosition;
+			m_distance = dist;
+		}
+	}
+};
+
+} // end anonymous namespace
+
+static void castRaysAndCompare(PhysicsWorld& world, HeapAllocator<U8>& alloc)
+{
+	const U32 RAY_COUNT_PER_AXIS = 24;
+	const U32 RAY_COUNT = RAY_COUNT_PER_AXIS * RAY_COUNT_PER_AXIS;
+
+	DynamicArrayAuto<TestRayCastCallback> batch(alloc);
+	DynamicArrayAuto<TestRayCastCallback> serial(alloc);
+	DynamicArrayAuto<PhysicsWorldRayCastCallback*> batchPtrs(alloc);
+	batchPtrs.create(RAY_COUNT);
+
+	for(U32 z = 0; z < RAY_COUNT_PER_AXIS; ++z)
+	{
+		for(U32 x = 0; x < RAY_COUNT_PER_AXIS; ++x)
+		{
+			const Vec3 from(-12.0f + F32(x) + 0.3f, 10.0f, -12.0f + F32(z) + 0.7f);
+			const Vec3 to = from - Vec3(0.0f, 20.0f, 0.0f);
+			batch.emplaceBack(from, to);
+			serial.emplaceBack(from, to);
+		}
+	}
+
+	for(U32 i = 0; i < RAY_COUNT; ++i)
+	{
+		batchPtrs[i] = &batch[i];
+	}
+
+	world.rayCast(WeakArray<PhysicsWorldRayCastCallback*>(batchPtrs));
+
+	for(U32 i = 0; i < RAY_COUNT; ++i)
+	{
+		world.rayCast(serial[i]);
+	}
+
+	U32 hitCount = 0;
+	for(U32 i = 0; i < RAY_COUNT; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(batch[i].m_obj, serial[i].m_obj);
+		ANKI_TEST_EXPECT_EQ(batch[i].m_distance, serial[i].m_distance);
+		ANKI_TEST_EXPECT_EQ(batch[i].m_position, serial[i].m_position);
+		ANKI_TEST_EXPECT_EQ(batch[i].m_normal, serial[i].m_normal);
+
+		hitCount += batch[i].m_obj != nullptr;
+	}
+
+	// Some rays hit and some miss
+	ANKI_TEST_EXPECT_GT(hitCount, 0);
+	ANKI_TEST_EXPECT_LT(hitCount, RAY_COUNT);
+}
+
+ANKI_TEST(Physics, RayCastBatchMatchesSerial)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc);
+
+	PhysicsWorld world;
+	ANKI_TEST_EXPECT_NO_ERR(world.create(allocAligned, nullptr, &hive));
+
+	{
+		// Boxes of different heights in a checkerboard so neighbouring rays hit different bodies or nothing
+		PhysicsCollisionShapePtr shape = world.newInstance<PhysicsBox>(Vec3(0.5f));
+		DynamicArrayAuto<PhysicsBodyPtr> bodies(alloc);
+		for(I32 z = -8; z < 8; ++z)
+		{
+			for(I32 x = -8; x < 8; ++x)
+			{
+				if(((x + z) & 1) != 0)
+				{
+					continue;
+				}
+
+				PhysicsBodyInitInfo init;
+				init.m_shape = shape;
+				init.m_transform.setOrigin(Vec4(F32(x), F32((x * 7 + z * 3) & 3), F32(z), 0.0f));
+				bodies.emplaceBack(world.newInstance<PhysicsBody>(init));
+			}
+		}
+
+		// Parallel path
+		castRaysAndCompare(world, alloc);
+
+		// A trigger with a GImpact shape forces the serial path. Rays ignore triggers so the results must not change
+		const Array<Vec3, 3> positions = {{Vec3(0.0f), Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f)}};
+		const Array<U32, 3> indices = {{0, 1, 2}};
+		PhysicsCollisionShapePtr soup = world.newInstance<PhysicsTriangleSoup>(
+			ConstWeakArray<Vec3>(&positions[0], 3), ConstWeakArray<U32>(&indices[0], 3));
+		PhysicsTriggerPtr trigger = world.newInstance<PhysicsTrigger>(soup);
+
+		castRaysAndCompare(world, alloc);
+	}
+
+	hive.waitAllTasks();
+}
+
+} // end namespace anki
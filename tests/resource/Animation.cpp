@@ -0,0 +1,265 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/resource/AnimationResource.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
+
+namespace anki
+{
+
+static Quat getRandomRotation()
+{
+	const Vec3 axis = Vec3(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), 1.0f).getNormalized();
+	return Quat(Axisang(getRandomRange(-PI, PI), axis));
+}
+
+/// Create channels that look like the ones of a skeletal animation.
+static void createChannels(ResourceAllocator<U8> alloc, U32 channelCount, U32 keyCount, Second keyInterval,
+						   DynamicArrayAuto<AnimationChannel>& channels)
+{
+	channels.create(channelCount);
+	for(U32 c = 0; c < channelCount; ++c)
+	{
+		AnimationChannel& ch = channels[c];
+
+		// Vary the number of keys between the channels and drop some of them to test the corner cases
+		const U32 posKeyCount = (c % 7 == 6) ? 0 : keyCount;
+		const U32 rotKeyCount = (c % 5 == 4) ? 1 : keyCount - c % 3;
+		const U32 scaleKeyCount = (c % 2) ? 0 : keyCount / 2;
+
+		ch.m_positions.create(alloc, posKeyCount);
+		for(U32 k = 0; k < posKeyCount; ++k)
+		{
+			ch.m_positions[k] = AnimationKeyframe<Vec3>(
+				keyInterval * k, Vec3(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f)));
+		}
+
+		ch.m_rotations.create(alloc, rotKeyCount);
+		for(U32 k = 0; k < rotKeyCount; ++k)
+		{
+			ch.m_rotations[k] = AnimationKeyframe<Quat>(keyInterval * k, getRandomRotation());
+		}
+
+		ch.m_scales.create(alloc, scaleKeyCount);
+		for(U32 k = 0; k < scaleKeyCount; ++k)
+		{
+			ch.m_scales[k] = AnimationKeyframe<F32>(keyInterval * 2 * k, getRandomRange(0.5f, 2.0f));
+		}
+	}
+}
+
+static void destroyChannels(ResourceAllocator<U8> alloc, DynamicArrayAuto<AnimationChannel>& channels)
+{
+	for(AnimationChannel& ch : channels)
+	{
+		ch.destroy(alloc);
+	}
+	channels.destroy();
+}
+
+ANKI_TEST(Resource, AnimationKeyframeSoa)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 CHANNEL_COUNT = 30;
+	const U32 KEY_COUNT = 20;
+	const Second KEY_INTERVAL = 1.0 / 30.0;
+	const Second duration = KEY_INTERVAL * (KEY_COUNT - 1);
+
+	DynamicArrayAuto<AnimationChannel> channels(alloc);
+	createChannels(alloc, CHANNEL_COUNT, KEY_COUNT, KEY_INTERVAL, channels);
+
+	AnimationKeyframeSoa soa;
+	soa.create(alloc, channels, 0.0, duration);
+	ANKI_TEST_EXPECT_EQ(soa.getChannelCount(), CHANNEL_COUNT);
+
+	AnimationCursor cursor;
+	soa.createCursor(alloc, cursor);
+
+	DynamicArrayAuto<AnimationSample> samples(alloc);
+	samples.create(CHANNEL_COUNT);
+
+	// Play forward for a few loops with an uneven step and then go back in time a few times
+	Array<Second, 3> timeSteps = {{0.007, 0.05, -0.33}};
+	Second time = 0.0;
+	for(U32 i = 0; i < 300; ++i)
+	{
+		time = max(0.0, time + timeSteps[(i % 50 == 49) ? 2 : i % 2]);
+
+		soa.interpolateAll(time, cursor, WeakArray<AnimationSample>(samples));
+
+		const Second wrappedTime = (time > duration) ? mod(time, duration) : time;
+		for(U32 c = 0; c < CHANNEL_COUNT; ++c)
+		{
+			Vec3 pos;
+			Quat rot;
+			F32 scale;
+			channels[c].interpolate(wrappedTime, pos, rot, scale);
+
+			ANKI_TEST_EXPECT_NEAR(samples[c].m_position.x(), pos.x(), 1.0e-4f);
+			ANKI_TEST_EXPECT_NEAR(samples[c].m_position.y(), pos.y(), 1.0e-4f);
+			ANKI_TEST_EXPECT_NEAR(samples[c].m_position.z(), pos.z(), 1.0e-4f);
+			ANKI_TEST_EXPECT_NEAR(samples[c].m_scale, scale, 1.0e-4f);
+
+			// The rotations are quantized so the error is larger. Also q and -q are the same rotation
+			const F32 cosAngle =
+				samples[c].m_rotation.dot(rot) / (samples[c].m_rotation.getLength() * rot.getLength());
+			ANKI_TEST_EXPECT_GEQ(absolute(cosAngle), 0.9999f);
+		}
+	}
+
+	// Before the start everything should be identity
+	soa.destroy(alloc);
+	soa.create(alloc, channels, 1.0, duration);
+	soa.interpolateAll(0.5, cursor, WeakArray<AnimationSample>(samples));
+	for(const AnimationSample& sample : samples)
+	{
+		ANKI_TEST_EXPECT_EQ(sample.m_position, Vec3(0.0f));
+		ANKI_TEST_EXPECT_EQ(sample.m_rotation, Quat::getIdentity());
+		ANKI_TEST_EXPECT_EQ(sample.m_scale, 1.0f);
+	}
+
+	cursor.destroy(alloc);
+	soa.destroy(alloc);
+	destroyChannels(alloc, channels);
+}
+
+namespace
+{
+
+/// An animated character of the benchmark.
+class Character
+{
+public:
+	AnimationCursor m_cursor;
+	DynamicArray<AnimationSample> m_samples;
+	const AnimationKeyframeSoa* m_soa;
+	Second m_time;
+};
+
+} // end namespace
+
+ANKI_TEST(Resource, AnimationKeyframeSoaBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Something like 200 characters with 60 bones, a 4 second clip and 60FPS playback
+	const U32 CHARACTER_COUNT = 200;
+	const U32 CHANNEL_COUNT = 60;
+	const U32 KEY_COUNT = 120;
+	const Second KEY_INTERVAL = 1.0 / 30.0;
+	const Second duration = KEY_INTERVAL * (KEY_COUNT - 1);
+	const U32 FRAME_COUNT = 240;
+	const Second FRAME_TIME = 1.0 / 60.0;
+
+	DynamicArrayAuto<AnimationChannel> channels(alloc);
+	createChannels(alloc, CHANNEL_COUNT, KEY_COUNT, KEY_INTERVAL, channels);
+
+	AnimationKeyframeSoa soa;
+	soa.create(alloc, channels, 0.0, duration);
+
+	Array<Character, CHARACTER_COUNT> characters;
+	for(U32 i = 0; i < CHARACTER_COUNT; ++i)
+	{
+		soa.createCursor(alloc, characters[i].m_cursor);
+		characters[i].m_samples.create(alloc, CHANNEL_COUNT);
+		characters[i].m_soa = &soa;
+		characters[i].m_time = F64(i) / F64(CHARACTER_COUNT) * duration; // Don't play in sync
+	}
+
+	// The old path: search all keys of every channel
+	F32 checksum = 0.0f;
+	Second begin = HighRezTimer::getCurrentTime();
+	for(U32 f = 0; f < FRAME_COUNT; ++f)
+	{
+		for(Character& character : characters)
+		{
+			const Second time = mod(character.m_time + FRAME_TIME * f, duration);
+			for(U32 c = 0; c < CHANNEL_COUNT; ++c)
+			{
+				AnimationSample& sample = character.m_samples[c];
+				channels[c].interpolate(time, sample.m_position, sample.m_rotation, sample.m_scale);
+			}
+			checksum += character.m_samples[0].m_scale;
+		}
+	}
+	const Second oldTime = HighRezTimer::getCurrentTime() - begin;
+
+	// SoA and cursors in a single thread
+	begin = HighRezTimer::getCurrentTime();
+	for(U32 f = 0; f < FRAME_COUNT; ++f)
+	{
+		for(Character& character : characters)
+		{
+			soa.interpolateAll(character.m_time + FRAME_TIME * f, character.m_cursor,
+							   WeakArray<AnimationSample>(character.m_samples));
+			checksum += character.m_samples[0].m_scale;
+		}
+	}
+	const Second soaTime = HighRezTimer::getCurrentTime() - begin;
+
+	// SoA and cursors using all cores. One task per group of characters
+	const U32 threadCount = max(1u, getCpuCoresCount());
+	ThreadHive hive(threadCount, alloc);
+	const U32 CHARACTERS_PER_TASK = 16;
+	const U32 taskCount = (CHARACTER_COUNT + CHARACTERS_PER_TASK - 1) / CHARACTERS_PER_TASK;
+
+	class TaskContext
+	{
+	public:
+		Character* m_characters;
+		U32 m_count;
+		Second m_timeOffset;
+	};
+
+	Array<TaskContext, (CHARACTER_COUNT + CHARACTERS_PER_TASK - 1) / CHARACTERS_PER_TASK> contexts;
+	Array<ThreadHiveTask, (CHARACTER_COUNT + CHARACTERS_PER_TASK - 1) / CHARACTERS_PER_TASK> tasks;
+
+	begin = HighRezTimer::getCurrentTime();
+	for(U32 f = 0; f < FRAME_COUNT; ++f)
+	{
+		for(U32 t = 0; t < taskCount; ++t)
+		{
+			TaskContext& ctx = contexts[t];
+			ctx.m_characters = &characters[t * CHARACTERS_PER_TASK];
+			ctx.m_count = min(CHARACTERS_PER_TASK, CHARACTER_COUNT - t * CHARACTERS_PER_TASK);
+			ctx.m_timeOffset = FRAME_TIME * f;
+
+			tasks[t] = ANKI_THREAD_HIVE_TASK(
+				{
+					for(U32 i = 0; i < self->m_count; ++i)
+					{
+						Character& character = self->m_characters[i];
+						character.m_soa->interpolateAll(character.m_time + self->m_timeOffset, character.m_cursor,
+														WeakArray<AnimationSample>(character.m_samples));
+					}
+				},
+				&ctx, nullptr, nullptr);
+		}
+
+		hive.submitTasks(&tasks[0], taskCount);
+		hive.waitAllTasks();
+		checksum += characters[0].m_samples[0].m_scale;
+	}
+	const Second hiveTime = HighRezTimer::getCurrentTime() - begin;
+
+	const F64 mega = F64(FRAME_COUNT) * CHARACTER_COUNT * CHANNEL_COUNT / 1000000.0;
+	ANKI_TEST_LOGI("Channel samples: search %f M/sec, SoA+cursors %f M/sec, SoA+cursors on %u threads %f M/sec "
+				   "(checksum %f)",
+				   mega / oldTime, mega / soaTime, threadCount, mega / hiveTime, checksum);
+
+	for(Character& character : characters)
+	{
+		character.m_cursor.destroy(alloc);
+		character.m_samples.destroy(alloc);
+	}
+	soa.destroy(alloc);
+	destroyChannels(alloc, channels);
+}
+
+} // end namespace anki
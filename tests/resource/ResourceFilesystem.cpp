@@ -35,4 +35,46 @@ ANKI_TEST(Resource, ResourceFilesystem)
 	}
 }
 
+ANKI_TEST(Resource, ResourceFilesystemMemoryMapped)
+{
+	printf("Test requires the data dir\n");
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// A stored file of an archive is a slice of the mapping of the archive
+	{
+		ResourceFilesystem fs(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./data/dir.ankizip"));
+
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir0/hello.txt", file));
+		ANKI_TEST_EXPECT_EQ(file->isMemoryMapped(), true);
+		ANKI_TEST_EXPECT_EQ(file->getSize(), 5);
+
+		ConstWeakArray<U8> view;
+		ANKI_TEST_EXPECT_NO_ERR(file->readView(2, view));
+		ANKI_TEST_EXPECT_EQ(view.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(memcmp(view.getBegin(), "he", 2), 0);
+
+		ANKI_TEST_EXPECT_NO_ERR(file->readView(3, view));
+		ANKI_TEST_EXPECT_EQ(memcmp(view.getBegin(), "ll\n", 3), 0);
+
+		// Past the end
+		ANKI_TEST_EXPECT_ERR(file->readView(1, view), Error::FILE_ACCESS);
+	}
+
+	// Empty files can't be mapped. They should quietly fall back to the regular files
+	{
+		ResourceFilesystem fs(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("data/dir"));
+
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir0/hello.txt", file));
+		ANKI_TEST_EXPECT_EQ(file->isMemoryMapped(), true);
+
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("a.txt", file));
+		ANKI_TEST_EXPECT_EQ(file->isMemoryMapped(), false);
+	}
+}
+
 } // end namespace anki
@@ -0,0 +1,137 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ShaderProgramResource.h>
+#include <anki/resource/AsyncLoader.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/HighRezTimer.h>
+#include <cstdio>
+
+namespace anki
+{
+
+ANKI_TEST(Resource, ShaderProgramResourceVariants)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+	cfg.set("rsrc_dataPaths", "engine_data");
+	cfg.set("rsrc_shaderVariantCache", 1);
+
+	// Use a cache directory of its own. The shader binaries it holds are kept between runs
+	const CString CACHE_DIR = "./ShaderProgramResourceVariantsCache";
+	if(!directoryExists(CACHE_DIR))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory(CACHE_DIR));
+	}
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs, CACHE_DIR);
+	AsyncLoader& loader = resources->getAsyncLoader();
+
+	// Start without a variant cache
+	const CString PROG_FNAME = "shaders/TonemappingAverageLuminance.ankiprog";
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StringAuto cacheFname(alloc);
+	cacheFname.sprintf("%s/TonemappingAverageLuminance.ankiprogvariants", CACHE_DIR.cstr());
+	std::remove(cacheFname.cstr());
+
+	using State = ShaderProgramResourceVariant::State;
+
+	// State transitions
+	{
+		ShaderProgramResourcePtr prog;
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource(PROG_FNAME, prog));
+
+		ShaderProgramResourceVariantInitInfo fallbackInfo(prog);
+		fallbackInfo.addConstant("INPUT_TEX_SIZE", UVec2(16u));
+		ShaderProgramResourceVariantInitInfo infoA(prog);
+		infoA.addConstant("INPUT_TEX_SIZE", UVec2(32u));
+		ShaderProgramResourceVariantInitInfo infoB(prog);
+		infoB.addConstant("INPUT_TEX_SIZE", UVec2(64u));
+
+		// The loader doesn't run so A stays pending and the fallback is returned
+		loader.pause();
+		const U64 completedTaskCount = loader.getCompletedTaskCount();
+
+		const ShaderProgramResourceVariant* fallbackVariant;
+		ANKI_TEST_EXPECT_EQ(prog->getOrCreateVariantAsync(infoA, fallbackInfo, fallbackVariant), false);
+		ANKI_TEST_EXPECT_EQ(fallbackVariant->getState(), State::READY);
+
+		const ShaderProgramResourceVariant* variant;
+		ANKI_TEST_EXPECT_EQ(prog->getOrCreateVariantAsync(infoA, fallbackInfo, variant), false);
+		ANKI_TEST_EXPECT_EQ(variant, fallbackVariant);
+
+		// A synchronous request doesn't wait for the paused loader. It creates the pending variant in place
+		const ShaderProgramResourceVariant* variantA;
+		prog->getOrCreateVariant(infoA, variantA);
+		ANKI_TEST_EXPECT_NEQ(variantA, fallbackVariant);
+		ANKI_TEST_EXPECT_EQ(variantA->getState(), State::READY);
+
+		ANKI_TEST_EXPECT_EQ(prog->getOrCreateVariantAsync(infoA, fallbackInfo, variant), true);
+		ANKI_TEST_EXPECT_EQ(variant, variantA);
+
+		// B is created by the loader once it resumes
+		ANKI_TEST_EXPECT_EQ(prog->getOrCreateVariantAsync(infoB, fallbackInfo, variant), false);
+		ANKI_TEST_EXPECT_EQ(variant, fallbackVariant);
+
+		loader.resume();
+		while(loader.getCompletedTaskCount() < completedTaskCount + 2)
+		{
+			HighRezTimer::sleep(1.0_ms);
+		}
+
+		const ShaderProgramResourceVariant* variantB;
+		ANKI_TEST_EXPECT_EQ(prog->getOrCreateVariantAsync(infoB, fallbackInfo, variantB), true);
+		ANKI_TEST_EXPECT_EQ(variantB->getState(), State::READY);
+		ANKI_TEST_EXPECT_NEQ(variantB, variantA);
+
+		// The loader found A ready and left it alone
+		prog->getOrCreateVariant(infoA, variant);
+		ANKI_TEST_EXPECT_EQ(variant, variantA);
+		ANKI_TEST_EXPECT_EQ(variant->getProgram().get(), variantA->getProgram().get());
+	}
+
+	// The program saved its variants when it was destroyed
+	ANKI_TEST_EXPECT_EQ(fileExists(cacheFname), true);
+
+	// Load the cache
+	{
+		// Nothing can be created in the background. All the variants should be created while loading
+		loader.pause();
+
+		ShaderProgramResourcePtr prog;
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource(PROG_FNAME, prog));
+
+		ShaderProgramResourceVariantInitInfo fallbackInfo(prog);
+		fallbackInfo.addConstant("INPUT_TEX_SIZE", UVec2(8u));
+
+		for(U32 size : {16u, 32u, 64u})
+		{
+			ShaderProgramResourceVariantInitInfo info(prog);
+			info.addConstant("INPUT_TEX_SIZE", UVec2(size));
+
+			const ShaderProgramResourceVariant* variant;
+			ANKI_TEST_EXPECT_EQ(prog->getOrCreateVariantAsync(info, fallbackInfo, variant), true);
+			ANKI_TEST_EXPECT_EQ(variant->getState(), State::READY);
+		}
+
+		loader.resume();
+	}
+
+	delete resources;
+	std::remove(cacheFname.cstr());
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
+
+} // end namespace anki
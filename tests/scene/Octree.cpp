@@ -5,6 +5,10 @@
 
 #include <tests/framework/Framework.h>
 #include <anki/scene/Octree.h>
+#include <anki/collision/Functions.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
 
 namespace anki
 {
@@ -86,4 +90,191 @@ ANKI_TEST(Scene, Octree)
 #endif
 }
 
+
+static Aabb createRandomVolume(F32 sceneSize, F32 maxVolumeSize)
+{
+	const Vec3 center(getRandomRange(-sceneSize, sceneSize), getRandomRange(-sceneSize, sceneSize),
+					  getRandomRange(-sceneSize, sceneSize));
+	const Vec3 halfSize(getRandomRange(0.01f, maxVolumeSize), getRandomRange(0.01f, maxVolumeSize),
+						getRandomRange(0.01f, maxVolumeSize));
+	return Aabb((center - halfSize).max(Vec3(-sceneSize)), (center + halfSize).min(Vec3(sceneSize)));
+}
+
+ANKI_TEST(Scene, OctreeModes)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const F32 SCENE_SIZE = 100.0f;
+	const U32 PLACEABLE_COUNT = 1000;
+	const U32 QUERY_COUNT = 100;
+
+	for(U32 loose = 0; loose < 2; ++loose)
+	{
+		Octree octree(alloc);
+		octree.init(Vec3(-SCENE_SIZE), Vec3(SCENE_SIZE), 5, loose != 0);
+		ANKI_TEST_EXPECT_EQ(octree.isLoose(), loose != 0);
+
+		DynamicArrayAuto<OctreePlaceable> placeables(alloc);
+		placeables.create(PLACEABLE_COUNT);
+		DynamicArrayAuto<Aabb> volumes(alloc);
+		volumes.create(PLACEABLE_COUNT);
+
+		// Place and then move everything a few times
+		for(U32 iteration = 0; iteration < 4; ++iteration)
+		{
+			for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+			{
+				volumes[i] = createRandomVolume(SCENE_SIZE, (i % 10 == 0) ? 80.0f : 2.0f);
+				placeables[i].m_userData = &placeables[i];
+				octree.place(volumes[i], &placeables[i], true);
+			}
+		}
+
+		Vec3 sceneMin, sceneMax;
+		octree.getActualSceneBounds(sceneMin, sceneMax);
+		ANKI_TEST_EXPECT_EQ(sceneMin >= Vec3(-SCENE_SIZE), true);
+		ANKI_TEST_EXPECT_EQ(sceneMax <= Vec3(SCENE_SIZE), true);
+
+		// Everything that collides with the query volume should be gathered
+		for(U32 q = 0; q < QUERY_COUNT; ++q)
+		{
+			const Aabb query = createRandomVolume(SCENE_SIZE, 30.0f);
+
+			for(OctreePlaceable& placeable : placeables)
+			{
+				placeable.reset();
+			}
+
+			DynamicArrayAuto<void*> visible(alloc);
+			octree.walkTree(0, [&](const Aabb& leafBox) { return testCollision(leafBox, query); },
+							[&](void* userData) { visible.emplaceBack(userData); });
+
+			U32 missing = 0;
+			for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+			{
+				if(!testCollision(volumes[i], query))
+				{
+					continue;
+				}
+
+				Bool found = false;
+				for(void* userData : visible)
+				{
+					found = found || userData == &placeables[i];
+				}
+
+				missing += !found;
+			}
+
+			ANKI_TEST_EXPECT_EQ(missing, 0u);
+		}
+
+		for(OctreePlaceable& placeable : placeables)
+		{
+			octree.remove(placeable);
+		}
+	}
+}
+
+ANKI_TEST(Scene, OctreeBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const F32 SCENE_SIZE = 1000.0f;
+	const U32 PLACEABLE_COUNT = 100 * 1000;
+	const U32 FRAME_COUNT = 8;
+	const U32 TASK_COUNT = 64;
+
+	// Same movement for both modes
+	DynamicArrayAuto<Vec3> initialPositions(alloc);
+	initialPositions.create(PLACEABLE_COUNT);
+	DynamicArrayAuto<Vec3> positions(alloc);
+	positions.create(PLACEABLE_COUNT);
+	DynamicArrayAuto<Vec3> velocities(alloc);
+	velocities.create(PLACEABLE_COUNT);
+	for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+	{
+		initialPositions[i] = Vec3(getRandomRange(-SCENE_SIZE, SCENE_SIZE), getRandomRange(-SCENE_SIZE, SCENE_SIZE),
+								   getRandomRange(-SCENE_SIZE, SCENE_SIZE));
+		velocities[i] = Vec3(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f));
+	}
+
+	const U32 threadCount = min(getCpuCoresCount(), ThreadHive::MAX_THREADS);
+	ThreadHive hive(threadCount, alloc, true);
+
+	class PlaceTask
+	{
+	public:
+		Octree* m_octree;
+		OctreePlaceable* m_placeables;
+		Vec3* m_positions;
+		const Vec3* m_velocities;
+		U32 m_first;
+		U32 m_count;
+		F32 m_sceneSize;
+	};
+
+	for(U32 loose = 0; loose < 2; ++loose)
+	{
+		Octree octree(alloc);
+		octree.init(Vec3(-SCENE_SIZE), Vec3(SCENE_SIZE), 5, loose != 0);
+
+		DynamicArrayAuto<OctreePlaceable> placeables(alloc);
+		placeables.create(PLACEABLE_COUNT);
+
+		for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+		{
+			positions[i] = initialPositions[i];
+			placeables[i].m_userData = &placeables[i];
+		}
+
+		Array<PlaceTask, TASK_COUNT> placeTasks;
+		Array<ThreadHiveTask, TASK_COUNT> hiveTasks;
+		const U32 placeablesPerTask = (PLACEABLE_COUNT + TASK_COUNT - 1) / TASK_COUNT;
+		for(U32 t = 0; t < TASK_COUNT; ++t)
+		{
+			placeTasks[t].m_octree = &octree;
+			placeTasks[t].m_placeables = &placeables[0];
+			placeTasks[t].m_positions = &positions[0];
+			placeTasks[t].m_velocities = &velocities[0];
+			placeTasks[t].m_first = min(t * placeablesPerTask, PLACEABLE_COUNT);
+			placeTasks[t].m_count = min(placeablesPerTask, PLACEABLE_COUNT - placeTasks[t].m_first);
+			placeTasks[t].m_sceneSize = SCENE_SIZE;
+		}
+
+		Second time = 0.0;
+		for(U32 frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			for(U32 t = 0; t < TASK_COUNT; ++t)
+			{
+				hiveTasks[t] = ANKI_THREAD_HIVE_TASK(
+					{
+						for(U32 i = self->m_first; i < self->m_first + self->m_count; ++i)
+						{
+							const F32 size = self->m_sceneSize - 1.0f;
+							Vec3& pos = self->m_positions[i];
+							pos = (pos + self->m_velocities[i]).max(Vec3(-size)).min(Vec3(size));
+							self->m_octree->place(Aabb(pos - Vec3(0.5f), pos + Vec3(0.5f)), &self->m_placeables[i],
+												  true);
+						}
+					},
+					&placeTasks[t], nullptr, nullptr);
+			}
+
+			const Second begin = HighRezTimer::getCurrentTime();
+			hive.submitTasks(&hiveTasks[0], TASK_COUNT);
+			hive.waitAllTasks();
+			time += HighRezTimer::getCurrentTime() - begin;
+		}
+
+		ANKI_TEST_LOGI("%s octree: placing %u moving objects took %fms per frame (threads %u)",
+					   (loose) ? "Loose" : "Regular", PLACEABLE_COUNT, time / FRAME_COUNT * 1000.0, threadCount);
+
+		for(OctreePlaceable& placeable : placeables)
+		{
+			octree.remove(placeable);
+		}
+	}
+}
+
 } // end namespace anki
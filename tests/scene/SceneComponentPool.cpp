@@ -0,0 +1,110 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/components/SceneComponentPool.h>
+#include <vector>
+
+namespace anki
+{
+
+namespace
+{
+
+class TestComponent : public SceneComponent
+{
+public:
+	U32 m_value;
+	Array<U8, 100> m_padding;
+
+	TestComponent(U32 value)
+		: SceneComponent(SceneComponentType::NONE)
+		, m_value(value)
+	{
+	}
+};
+
+} // end namespace
+
+ANKI_TEST(Scene, SceneComponentPool)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		SceneComponentPool pool(alloc, SceneComponentClassId<TestComponent>::get(), sizeof(TestComponent),
+								alignof(TestComponent), false);
+
+		const U32 COUNT = 1000;
+		std::vector<TestComponent*> comps;
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			TestComponent* comp = ::new(pool.allocate()) TestComponent(i);
+			ANKI_TEST_EXPECT_EQ(isAligned(alignof(TestComponent), comp), true);
+			ANKI_TEST_EXPECT_EQ(&SceneComponentPool::getPoolOf(comp), &pool);
+			comps.push_back(comp);
+		}
+
+		// Free every other component
+		for(U32 i = 0; i < COUNT; i += 2)
+		{
+			comps[i]->~TestComponent();
+			pool.free(comps[i]);
+			comps[i] = nullptr;
+		}
+
+		// Iterate. The components were allocated chunk after chunk and slot after slot so they should be visited in
+		// allocation order. Chunks are separate allocations so only the addresses inside a chunk are ordered
+		std::vector<U32> visited;
+		for(U32 chunkIdx = 0; chunkIdx < pool.getChunkCount(); ++chunkIdx)
+		{
+			const TestComponent* prev = nullptr;
+			ANKI_TEST_EXPECT_NO_ERR(pool.iterateChunkComponents(chunkIdx, [&](SceneComponent& comp) -> Error {
+				const TestComponent& tcomp = static_cast<const TestComponent&>(comp);
+				if(prev)
+				{
+					ANKI_TEST_EXPECT_GT(ptrToNumber(&tcomp), ptrToNumber(prev));
+				}
+				prev = &tcomp;
+				visited.push_back(tcomp.m_value);
+				return Error::NONE;
+			}));
+		}
+
+		std::vector<U32> visitedAll;
+		ANKI_TEST_EXPECT_NO_ERR(pool.iterateComponents([&](SceneComponent& comp) -> Error {
+			visitedAll.push_back(static_cast<const TestComponent&>(comp).m_value);
+			return Error::NONE;
+		}));
+		ANKI_TEST_EXPECT_EQ(visitedAll == visited, true);
+
+		ANKI_TEST_EXPECT_EQ(visited.size(), COUNT / 2);
+		for(U32 i = 0; i < visited.size(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(visited[i], i * 2 + 1);
+		}
+
+		// The freed slots should be reused
+		for(U32 i = 0; i < COUNT; i += 2)
+		{
+			comps[i] = ::new(pool.allocate()) TestComponent(i);
+		}
+
+		visited.clear();
+		ANKI_TEST_EXPECT_NO_ERR(pool.iterateComponents([&](SceneComponent& comp) -> Error {
+			visited.push_back(static_cast<const TestComponent&>(comp).m_value);
+			return Error::NONE;
+		}));
+		ANKI_TEST_EXPECT_EQ(visited.size(), COUNT);
+
+		// Cleanup
+		for(TestComponent* comp : comps)
+		{
+			comp->~TestComponent();
+			pool.free(comp);
+		}
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,214 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SoftwareRasterizer.h>
+#include <anki/collision/Aabb.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
+
+namespace anki
+{
+
+/// Create random triangles in front of a camera that looks at -Z.
+static void createRandomOccluders(U32 triangleCount, DynamicArrayAuto<Vec3>& verts)
+{
+	verts.create(triangleCount * 3);
+	for(U32 i = 0; i < triangleCount; ++i)
+	{
+		const F32 z = getRandomRange(-60.0f, -5.0f);
+		const Vec3 center(getRandomRange(z, -z), getRandomRange(z, -z) * 0.6f, z);
+		const F32 size = getRandomRange(0.5f, 8.0f);
+		for(U32 j = 0; j < 3; ++j)
+		{
+			verts[i * 3 + j] = center + Vec3(getRandomRange(-size, size), getRandomRange(-size, size), 0.0f);
+		}
+	}
+}
+
+static Aabb createRandomBox()
+{
+	const F32 z = getRandomRange(-80.0f, -2.0f);
+	const Vec4 center(getRandomRange(z, -z), getRandomRange(z, -z) * 0.6f, z, 0.0f);
+	const F32 size = getRandomRange(0.1f, 3.0f);
+	return Aabb(center - Vec4(size, size, size, 0.0f), center + Vec4(size, size, size, 0.0f));
+}
+
+ANKI_TEST(Scene, SoftwareRasterizer)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 width = 83; // Not a multiple of the tile size on purpose
+	const U32 height = 45;
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(60.0f), 0.5f, 100.0f);
+
+	DynamicArrayAuto<Vec3> verts(alloc);
+	createRandomOccluders(128, verts);
+
+	SoftwareRasterizer scalar;
+	scalar.init(alloc);
+	scalar.prepare(Mat4::getIdentity(), proj, width, height);
+	scalar.draw(&verts[0][0], verts.getSize(), sizeof(Vec3), false);
+
+	SoftwareRasterizer binned;
+	binned.init(alloc);
+	binned.prepare(Mat4::getIdentity(), proj, width, height);
+	binned.drawBinned(&verts[0][0], verts.getSize() / 2, sizeof(Vec3), false);
+	binned.drawBinned(&verts[verts.getSize() / 2][0], verts.getSize() / 2, sizeof(Vec3), false);
+	binned.rasterizeBinnedTiles(0, 2);
+	binned.rasterizeBinnedTiles(1, 2);
+
+	// The two should agree apart from a few pixels in the edges of the triangles
+	const U32 TEST_COUNT = 10000;
+	U32 mismatchCount = 0;
+	U32 visibleCount = 0;
+	for(U32 i = 0; i < TEST_COUNT; ++i)
+	{
+		const Aabb box = createRandomBox();
+		const Bool visible = scalar.visibilityTest(box);
+		mismatchCount += visible != binned.visibilityTest(box);
+		visibleCount += visible;
+	}
+
+	ANKI_TEST_LOGI("Visible %u/%u, mismatches %u", visibleCount, TEST_COUNT, mismatchCount);
+	ANKI_TEST_EXPECT_GT(visibleCount, 0u);
+	ANKI_TEST_EXPECT_LT(visibleCount, TEST_COUNT);
+	ANKI_TEST_EXPECT_LEQ(mismatchCount, TEST_COUNT / 100);
+}
+
+ANKI_TEST(Scene, SoftwareRasterizerHiz)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 width = 83;
+	const U32 height = 45;
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(60.0f), 0.5f, 100.0f);
+
+	// Fill the left half with a near depth and the right half with a far depth
+	const Vec4 nearPoint = proj * Vec4(0.0f, 0.0f, -10.0f, 1.0f);
+	const Vec4 farPoint = proj * Vec4(0.0f, 0.0f, -50.0f, 1.0f);
+	DynamicArrayAuto<F32> depths(alloc);
+	depths.create(width * height);
+	for(U32 y = 0; y < height; ++y)
+	{
+		for(U32 x = 0; x < width; ++x)
+		{
+			depths[y * width + x] = (x < width / 2) ? nearPoint.z() / nearPoint.w() : farPoint.z() / farPoint.w();
+		}
+	}
+
+	SoftwareRasterizer r;
+	r.init(alloc);
+	r.prepare(Mat4::getIdentity(), proj, width, height);
+	r.fillDepthBuffer(ConstWeakArray<F32>(&depths[0], depths.getSize()));
+
+	// Small boxes
+	ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec4(-6.0f, -1.0f, -31.0f, 0.0f), Vec4(-4.0f, 1.0f, -30.0f, 0.0f))), false);
+	ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec4(4.0f, -1.0f, -31.0f, 0.0f), Vec4(6.0f, 1.0f, -30.0f, 0.0f))), true);
+	ANKI_TEST_EXPECT_EQ(r.visibilityTest(Aabb(Vec4(-6.0f, -1.0f, -6.0f, 0.0f), Vec4(-4.0f, 1.0f, -5.0f, 0.0f))), true);
+
+	// Boxes that cover most of the screen
+	ANKI_TEST_EXPECT_EQ(
+		r.visibilityTest(Aabb(Vec4(-60.0f, -30.0f, -71.0f, 0.0f), Vec4(60.0f, 30.0f, -70.0f, 0.0f))), false);
+	ANKI_TEST_EXPECT_EQ(
+		r.visibilityTest(Aabb(Vec4(-60.0f, -30.0f, -31.0f, 0.0f), Vec4(60.0f, 30.0f, -30.0f, 0.0f))), true);
+}
+
+ANKI_TEST(Scene, SoftwareRasterizerBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 width = 320;
+	const U32 height = 192;
+	const U32 TRIANGLE_COUNT = 1024 * 16;
+	const U32 ITERATION_COUNT = 16;
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(60.0f), 0.5f, 100.0f);
+
+	DynamicArrayAuto<Vec3> verts(alloc);
+	createRandomOccluders(TRIANGLE_COUNT, verts);
+
+	// Scalar
+	SoftwareRasterizer r;
+	r.init(alloc);
+	Second scalarTime = 0.0;
+	for(U32 i = 0; i < ITERATION_COUNT; ++i)
+	{
+		const Second begin = HighRezTimer::getCurrentTime();
+		r.prepare(Mat4::getIdentity(), proj, width, height);
+		r.draw(&verts[0][0], verts.getSize(), sizeof(Vec3), false);
+		scalarTime += HighRezTimer::getCurrentTime() - begin;
+	}
+
+	// Binned. Bin and rasterize in parallel
+	static const U32 MAX_TASKS = 64;
+
+	class BinTask
+	{
+	public:
+		SoftwareRasterizer* m_r;
+		const Vec3* m_verts;
+		U32 m_vertCount;
+		U32 m_taskIdx;
+		U32 m_taskCount;
+	};
+
+	const U32 threadCount = min(getCpuCoresCount(), ThreadHive::MAX_THREADS);
+	ThreadHive hive(threadCount, alloc, true);
+	const U32 taskCount = min(threadCount * 4, MAX_TASKS);
+
+	Array<BinTask, MAX_TASKS> binTasks;
+	Array<ThreadHiveTask, MAX_TASKS> hiveTasks;
+	const U32 trianglesPerTask = (TRIANGLE_COUNT + taskCount - 1) / taskCount;
+	for(U32 t = 0; t < taskCount; ++t)
+	{
+		const U32 firstTriangle = min(t * trianglesPerTask, TRIANGLE_COUNT);
+		const U32 lastTriangle = min(firstTriangle + trianglesPerTask, TRIANGLE_COUNT);
+
+		binTasks[t].m_r = &r;
+		binTasks[t].m_verts = &verts[firstTriangle * 3];
+		binTasks[t].m_vertCount = (lastTriangle - firstTriangle) * 3;
+		binTasks[t].m_taskIdx = t;
+		binTasks[t].m_taskCount = taskCount;
+	}
+
+	Second binnedTime = 0.0;
+	for(U32 i = 0; i < ITERATION_COUNT; ++i)
+	{
+		const Second begin = HighRezTimer::getCurrentTime();
+		r.prepare(Mat4::getIdentity(), proj, width, height);
+
+		ThreadHiveSemaphore* binSem = hive.newSemaphore(taskCount);
+		for(U32 t = 0; t < taskCount; ++t)
+		{
+			hiveTasks[t] = ANKI_THREAD_HIVE_TASK(
+				{
+					if(self->m_vertCount)
+					{
+						self->m_r->drawBinned(&self->m_verts[0][0], self->m_vertCount, sizeof(Vec3), false);
+					}
+				},
+				&binTasks[t], nullptr, binSem);
+		}
+		hive.submitTasks(&hiveTasks[0], taskCount);
+
+		for(U32 t = 0; t < taskCount; ++t)
+		{
+			hiveTasks[t] = ANKI_THREAD_HIVE_TASK(
+				{ self->m_r->rasterizeBinnedTiles(self->m_taskIdx, self->m_taskCount); }, &binTasks[t], binSem,
+				nullptr);
+		}
+		hive.submitTasks(&hiveTasks[0], taskCount);
+
+		hive.waitAllTasks();
+		binnedTime += HighRezTimer::getCurrentTime() - begin;
+	}
+
+	ANKI_TEST_LOGI("Triangles %u, threads %u. Scalar %fms, binned SIMD %fms (speedup %f)", TRIANGLE_COUNT,
+				   threadCount, scalarTime / ITERATION_COUNT * 1000.0, binnedTime / ITERATION_COUNT * 1000.0,
+				   scalarTime / binnedTime);
+}
+
+} // end namespace anki
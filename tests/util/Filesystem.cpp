@@ -131,3 +131,37 @@ ANKI_TEST(Util, WalkDir)
 
 	ANKI_TEST_EXPECT_EQ(count, 1);
 }
+
+ANKI_TEST(Util, MemoryMappedFile)
+{
+	// Create a file
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_mmap", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_TEST_EXPECT_NO_ERR(file.write("Hello mmap", 10));
+	}
+
+	// Map it
+	MemoryMappedFile mapping;
+	ANKI_TEST_EXPECT_NO_ERR(mapping.open("./tmp_mmap"));
+	ANKI_TEST_EXPECT_EQ(mapping.isOpen(), true);
+	ANKI_TEST_EXPECT_EQ(mapping.getSize(), 10);
+	ANKI_TEST_EXPECT_EQ(memcmp(mapping.getData(), "Hello mmap", 10), 0);
+
+	// Move it
+	MemoryMappedFile mapping2(std::move(mapping));
+	ANKI_TEST_EXPECT_EQ(mapping.isOpen(), false);
+	ANKI_TEST_EXPECT_EQ(mapping2.getSize(), 10);
+	mapping2.close();
+	ANKI_TEST_EXPECT_EQ(mapping2.isOpen(), false);
+
+	// Empty and missing files can't be mapped
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_mmap", FileOpenFlag::WRITE));
+	}
+	ANKI_TEST_EXPECT_ERR(mapping.open("./tmp_mmap"), Error::FILE_ACCESS);
+	ANKI_TEST_EXPECT_ERR(mapping.open("./does_not_exist"), Error::FILE_ACCESS);
+	ANKI_TEST_EXPECT_EQ(mapping.tryOpen("./tmp_mmap"), false);
+	ANKI_TEST_EXPECT_EQ(mapping.isOpen(), false);
+}
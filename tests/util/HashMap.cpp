@@ -6,6 +6,7 @@
 #include "tests/framework/Framework.h"
 #include "tests/util/Foo.h"
 #include "anki/util/HashMap.h"
+#include "anki/util/FlatHashMap.h"
 #include "anki/util/DynamicArray.h"
 #include "anki/util/HighRezTimer.h"
 #include <unordered_map>
@@ -254,3 +255,248 @@ ANKI_TEST(Util, HashMap)
 		akMap.destroy(alloc);
 	}
 }
+
+/// A bad hasher to test collisions.
+class CollidingHasher
+{
+public:
+	U64 operator()(int x) const
+	{
+		return U64(x % 7);
+	}
+};
+
+ANKI_TEST(Util, FlatHashMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	int vals[] = {20, 15, 5, 1, 10, 0, 18, 6, 7, 11, 13, 3};
+	U valsSize = sizeof(vals) / sizeof(vals[0]);
+
+	// Simple
+	{
+		FlatHashMap<int, int, Hasher> map;
+		map.emplace(alloc, 20, 1);
+		map.emplace(alloc, 21, 1);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		map.emplace(alloc, 21, 2);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(21), 2);
+		map.destroy(alloc);
+	}
+
+	// Add more and iterate
+	{
+		FlatHashMap<int, int, Hasher> map;
+
+		for(U i = 0; i < valsSize; ++i)
+		{
+			map.emplace(alloc, vals[i], vals[i] * 10);
+		}
+
+		U count = 0;
+		for(auto it = map.getBegin(); it != map.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(*it, it.getKey() * 10);
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, valsSize);
+
+		map.destroy(alloc);
+	}
+
+	// Keys with the same hash
+	{
+		FlatHashMap<int, int, CollidingHasher> map;
+
+		for(int i = 0; i < 100; ++i)
+		{
+			map.emplace(alloc, i, i * 10);
+		}
+
+		for(int i = 0; i < 100; ++i)
+		{
+			auto it = map.find(i);
+			ANKI_TEST_EXPECT_NEQ(it, map.getEnd());
+			ANKI_TEST_EXPECT_EQ(*it, i * 10);
+		}
+		ANKI_TEST_EXPECT_EQ(map.find(100), map.getEnd());
+
+		for(int i = 0; i < 100; i += 2)
+		{
+			map.erase(alloc, map.find(i));
+		}
+
+		for(int i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(map.find(i) != map.getEnd(), (i % 2) == 1);
+		}
+
+		map.destroy(alloc);
+	}
+
+	// Auto
+	{
+		FlatHashMapAuto<int, int, Hasher> map(alloc);
+		map.emplace(1, 10);
+		map.emplace(2, 20);
+
+		FlatHashMapAuto<int, int, Hasher> map2(map);
+		ANKI_TEST_EXPECT_EQ(map2.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map2.find(2), 20);
+
+		map.erase(map.find(1));
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(map2.getSize(), 2);
+	}
+
+	// Fuzzy test against the STL
+	{
+		FlatHashMap<U32, int> akMap;
+		std::unordered_map<U32, int> stdMap;
+
+		for(U i = 0; i < 100000; ++i)
+		{
+			const U32 key = U32(rand() % 5000);
+			if(rand() % 3 == 0)
+			{
+				auto it = akMap.find(key);
+				auto stdIt = stdMap.find(key);
+				ANKI_TEST_EXPECT_EQ(it != akMap.getEnd(), stdIt != stdMap.end());
+				if(stdIt != stdMap.end())
+				{
+					ANKI_TEST_EXPECT_EQ(*it, stdIt->second);
+					akMap.erase(alloc, it);
+					stdMap.erase(stdIt);
+				}
+			}
+			else
+			{
+				const int val = rand();
+				akMap.emplace(alloc, key, val);
+				stdMap[key] = val;
+			}
+
+			ANKI_TEST_EXPECT_EQ(akMap.getSize(), stdMap.size());
+		}
+
+		for(auto& it : stdMap)
+		{
+			auto akIt = akMap.find(it.first);
+			ANKI_TEST_EXPECT_NEQ(akIt, akMap.getEnd());
+			ANKI_TEST_EXPECT_EQ(*akIt, it.second);
+		}
+
+		akMap.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, FlatHashMapBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	HighRezTimer timer;
+
+	// The keys look like the U64 hashes the caches use
+	const U32 COUNT = 1024 * 1024;
+	DynamicArrayAuto<U64> vals(alloc);
+	vals.create(COUNT);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		vals[i] = computeHash(&i, sizeof(i));
+	}
+
+	HashMap<U64, U64> akMap;
+	FlatHashMap<U64, U64> flatMap;
+
+	// Insertion
+	{
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			akMap.emplace(alloc, vals[i], vals[i]);
+		}
+		timer.stop();
+		const Second akTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			flatMap.emplace(alloc, vals[i], vals[i]);
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Inserting bench: HashMap %f FlatHashMap %f | %f%%", akTime, flatTime,
+					   akTime / flatTime * 100.0);
+	}
+
+	// Search
+	{
+		U64 count = 0; // To avoid compiler opts
+		std::random_shuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *akMap.find(vals[i]);
+		}
+		timer.stop();
+		const Second akTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *flatMap.find(vals[i]);
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		// Misses
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += akMap.find(vals[i] + 1) != akMap.getEnd();
+		}
+		timer.stop();
+		const Second akMissTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += flatMap.find(vals[i] + 1) != flatMap.getEnd();
+		}
+		timer.stop();
+		const Second flatMissTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Find bench: HashMap %f FlatHashMap %f | %f%% (%lu)", akTime, flatTime,
+					   akTime / flatTime * 100.0, count);
+		ANKI_TEST_LOGI("Find miss bench: HashMap %f FlatHashMap %f | %f%%", akMissTime, flatMissTime,
+					   akMissTime / flatMissTime * 100.0);
+	}
+
+	// Delete
+	{
+		std::random_shuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			akMap.erase(alloc, akMap.find(vals[i]));
+		}
+		timer.stop();
+		const Second akTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			flatMap.erase(alloc, flatMap.find(vals[i]));
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Deleting bench: HashMap %f FlatHashMap %f | %f%%", akTime, flatTime,
+					   akTime / flatTime * 100.0);
+	}
+
+	akMap.destroy(alloc);
+	flatMap.destroy(alloc);
+}
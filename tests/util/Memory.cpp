@@ -7,6 +7,10 @@
 #include "tests/util/Foo.h"
 #include "anki/util/Memory.h"
 #include "anki/util/ThreadPool.h"
+#include "anki/util/Allocator.h"
+#include "anki/util/DynamicArray.h"
+#include "anki/util/HighRezTimer.h"
+#include "anki/util/System.h"
 #include <type_traits>
 #include <cstring>
 
@@ -218,3 +222,294 @@ ANKI_TEST(Util, ChainMemoryPool)
 		ANKI_TEST_EXPECT_EQ(pool.getChunksCount(), 0);
 	}
 }
+
+ANKI_TEST(Util, TlsfMemoryPool)
+{
+	// Basic test
+	{
+		TlsfMemoryPool pool;
+		pool.create(allocAligned, nullptr, 1024);
+
+		void* a = pool.allocate(5, 1);
+		ANKI_TEST_EXPECT_NEQ(a, nullptr);
+		void* b = pool.allocate(1000, 16);
+		ANKI_TEST_EXPECT_NEQ(b, nullptr);
+		void* c = pool.allocate(100, 256);
+		ANKI_TEST_EXPECT_NEQ(c, nullptr);
+		ANKI_TEST_EXPECT_EQ(isAligned(256, c), true);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 3);
+
+		pool.free(a);
+		pool.free(b);
+		pool.free(c);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+	}
+
+	// Free blocks get merged
+	{
+		TlsfMemoryPool pool;
+		pool.create(allocAligned, nullptr, 64_KB);
+
+		Array<void*, 32> ptrs;
+		for(void*& ptr : ptrs)
+		{
+			ptr = pool.allocate(1000, 16);
+			ANKI_TEST_EXPECT_NEQ(ptr, nullptr);
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getChunksCount(), 1);
+
+		for(U32 i = 0; i < ptrs.getSize(); i += 2)
+		{
+			pool.free(ptrs[i]);
+		}
+		for(U32 i = 1; i < ptrs.getSize(); i += 2)
+		{
+			pool.free(ptrs[i]);
+		}
+
+		// The whole chunk should be free so that should fit without a new one
+		void* big = pool.allocate(60_KB, 16);
+		ANKI_TEST_EXPECT_NEQ(big, nullptr);
+		ANKI_TEST_EXPECT_EQ(pool.getChunksCount(), 1);
+		pool.free(big);
+	}
+
+	// Random allocations and frees
+	{
+		TlsfMemoryPool pool;
+		pool.create(allocAligned, nullptr, 4_KB);
+
+		class Alloc
+		{
+		public:
+			U8* m_ptr;
+			U32 m_size;
+		};
+
+		DynamicArrayAuto<Alloc> allocs(HeapAllocator<U8>(allocAligned, nullptr));
+		for(U32 i = 0; i < 10000; ++i)
+		{
+			if(allocs.getSize() > 0 && (getRandom() % 3) == 0)
+			{
+				const U32 idx = U32(getRandom() % allocs.getSize());
+				const Alloc alloc = allocs[idx];
+				for(U32 j = 0; j < alloc.m_size; ++j)
+				{
+					ANKI_TEST_EXPECT_EQ(alloc.m_ptr[j], U8(alloc.m_size));
+				}
+				pool.free(alloc.m_ptr);
+
+				allocs[idx] = allocs.getBack();
+				allocs.resize(allocs.getSize() - 1);
+			}
+			else
+			{
+				const U32 size = U32(getRandom() % ((getRandom() % 8) ? 256 : 8_KB)) + 1;
+				const PtrSize alignment = PtrSize(1) << (getRandom() % 8);
+				Alloc alloc;
+				alloc.m_ptr = static_cast<U8*>(pool.allocate(size, alignment));
+				alloc.m_size = size;
+				ANKI_TEST_EXPECT_NEQ(alloc.m_ptr, nullptr);
+				ANKI_TEST_EXPECT_EQ(isAligned(alignment, alloc.m_ptr), true);
+				memset(alloc.m_ptr, U8(size), size);
+				allocs.emplaceBack(alloc);
+			}
+		}
+
+		for(const Alloc& alloc : allocs)
+		{
+			pool.free(alloc.m_ptr);
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+	}
+
+	// Parallel
+	{
+		const U32 THREAD_COUNT = 8;
+		const U32 ALLOC_COUNT = 512;
+		TlsfMemoryPool pool;
+		pool.create(allocAligned, nullptr, 16_KB);
+		ThreadPool threadPool(THREAD_COUNT);
+
+		class AllocateTask : public ThreadPoolTask
+		{
+		public:
+			TlsfMemoryPool* m_pool = nullptr;
+			Array<U8*, ALLOC_COUNT> m_allocations;
+
+			Error operator()(U32 taskId, PtrSize threadsCount)
+			{
+				for(U32 i = 0; i < ALLOC_COUNT; ++i)
+				{
+					m_allocations[i] = static_cast<U8*>(m_pool->allocate(i % 300 + 1, 8));
+					memset(m_allocations[i], U8(taskId), i % 300 + 1);
+				}
+
+				// Free half of them, including the ones of the next thread
+				for(U32 i = 0; i < ALLOC_COUNT; i += 2)
+				{
+					m_pool->free(m_allocations[i]);
+				}
+
+				return Error::NONE;
+			}
+		};
+
+		Array<AllocateTask, THREAD_COUNT> tasks;
+		for(U32 i = 0; i < THREAD_COUNT; ++i)
+		{
+			tasks[i].m_pool = &pool;
+			threadPool.assignNewTask(i, &tasks[i]);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+
+		// Check and free the rest from this thread
+		for(U32 i = 0; i < THREAD_COUNT; ++i)
+		{
+			for(U32 j = 1; j < ALLOC_COUNT; j += 2)
+			{
+				for(U32 k = 0; k < j % 300 + 1; ++k)
+				{
+					ANKI_TEST_EXPECT_EQ(tasks[i].m_allocations[j][k], U8(i));
+				}
+
+				pool.free(tasks[i].m_allocations[j]);
+			}
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+	}
+
+	// Through the generic allocator
+	{
+		GenericMemoryPoolAllocator<U8> alloc = TlsfAllocator<U8>(allocAligned, nullptr, 1_KB);
+		DynamicArrayAuto<Foo> arr(alloc);
+		arr.create(100);
+		arr.resize(1000);
+		ANKI_TEST_EXPECT_EQ(alloc.getMemoryPool().getAllocationsCount(), 1);
+	}
+}
+
+/// Run a trace of allocations and deallocations that resembles what the engine does. Mostly small objects (nodes,
+/// strings, small arrays) that die young and some larger buffers that live longer.
+template<typename TPool>
+static Second runMemoryPoolTrace(TPool& pool, U32 seed, U32 opCount)
+{
+	const U32 MAX_LIVE = 2048;
+	Array<void*, MAX_LIVE> live;
+	U32 liveCount = 0;
+
+	U32 rnd = seed;
+	auto next = [&]() {
+		rnd ^= rnd << 13;
+		rnd ^= rnd >> 17;
+		rnd ^= rnd << 5;
+		return rnd;
+	};
+
+	const Second begin = HighRezTimer::getCurrentTime();
+	for(U32 i = 0; i < opCount; ++i)
+	{
+		const U32 r = next();
+		if(liveCount == MAX_LIVE || (liveCount > 0 && (r % 100) < 45))
+		{
+			// Free. Prefer the young allocations
+			const U32 idx = ((r >> 8) % 4) ? (liveCount - 1) : ((r >> 10) % liveCount);
+			pool.free(live[idx]);
+			live[idx] = live[--liveCount];
+		}
+		else
+		{
+			const U32 bucket = (r >> 8) % 100;
+			PtrSize size;
+			if(bucket < 70)
+			{
+				size = 8 + (r >> 16) % 120;
+			}
+			else if(bucket < 95)
+			{
+				size = 128 + (r >> 16) % (4_KB - 128);
+			}
+			else
+			{
+				size = 4_KB + (r >> 12) % 60_KB;
+			}
+
+			void* ptr = pool.allocate(size, ANKI_SAFE_ALIGNMENT);
+			static_cast<U8*>(ptr)[0] = 1;
+			live[liveCount++] = ptr;
+		}
+	}
+
+	while(liveCount)
+	{
+		pool.free(live[--liveCount]);
+	}
+
+	return HighRezTimer::getCurrentTime() - begin;
+}
+
+template<typename TPool>
+class MemoryPoolTraceTask : public ThreadPoolTask
+{
+public:
+	TPool* m_pool = nullptr;
+	U32 m_opCount = 0;
+
+	Error operator()(U32 taskId, PtrSize threadsCount)
+	{
+		runMemoryPoolTrace(*m_pool, taskId * 7919 + 1, m_opCount);
+		return Error::NONE;
+	}
+};
+
+/// Run the trace once in this thread and then in all threads of the thread pool at the same time.
+template<typename TPool>
+static void benchMemoryPool(TPool& pool, ThreadPool& threadPool, U32 opCount, Second& singleThreadTime,
+							Second& multiThreadTime)
+{
+	singleThreadTime = runMemoryPoolTrace(pool, 1, opCount);
+
+	Array<MemoryPoolTraceTask<TPool>, ThreadPool::MAX_THREADS> tasks;
+	const Second begin = HighRezTimer::getCurrentTime();
+	for(U32 i = 0; i < threadPool.getThreadCount(); ++i)
+	{
+		tasks[i].m_pool = &pool;
+		tasks[i].m_opCount = opCount;
+		threadPool.assignNewTask(i, &tasks[i]);
+	}
+	ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+	multiThreadTime = HighRezTimer::getCurrentTime() - begin;
+}
+
+ANKI_TEST(Util, MemoryPoolBench)
+{
+	const U32 OP_COUNT = 1000000;
+	const U32 threadCount = min(getCpuCoresCount(), 8u);
+	ThreadPool threadPool(threadCount);
+
+	Second heapTime, heapTimeMt;
+	{
+		HeapMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+		benchMemoryPool(pool, threadPool, OP_COUNT, heapTime, heapTimeMt);
+	}
+
+	Second chainTime, chainTimeMt;
+	{
+		ChainMemoryPool pool;
+		pool.create(allocAligned, nullptr, 1_MB, 1.0, 0, ANKI_SAFE_ALIGNMENT);
+		benchMemoryPool(pool, threadPool, OP_COUNT, chainTime, chainTimeMt);
+	}
+
+	Second tlsfTime, tlsfTimeMt;
+	{
+		TlsfMemoryPool pool;
+		pool.create(allocAligned, nullptr, 1_MB);
+		benchMemoryPool(pool, threadPool, OP_COUNT, tlsfTime, tlsfTimeMt);
+	}
+
+	ANKI_TEST_LOGI("%u operations, 1 thread: heap %fms, chain %fms, TLSF %fms", OP_COUNT, heapTime * 1000.0,
+				   chainTime * 1000.0, tlsfTime * 1000.0);
+	ANKI_TEST_LOGI("%u operations, %u threads: heap %fms, chain %fms, TLSF %fms", OP_COUNT, threadCount,
+				   heapTimeMt * 1000.0, chainTimeMt * 1000.0, tlsfTimeMt * 1000.0);
+}
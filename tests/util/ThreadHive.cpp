@@ -245,4 +245,76 @@ ANKI_TEST(Util, ThreadHiveBench)
 	ANKI_TEST_EXPECT_EQ(sum.getNonAtomically(), serialFib);
 }
 
+class ThroughputTask
+{
+public:
+	static const U32 CHILD_TASK_COUNT = 16;
+
+	Atomic<U64>* m_sum;
+
+	/// A fine-grained task that does almost nothing. It measures the overhead of the hive.
+	static void leafCallback(void* arg, U32, ThreadHive& hive, ThreadHiveSemaphore* sem)
+	{
+		static_cast<ThroughputTask*>(arg)->m_sum->fetchAdd(1);
+	}
+
+	/// A task that spawns fine-grained tasks from inside the hive.
+	static void rootCallback(void* arg, U32, ThreadHive& hive, ThreadHiveSemaphore* sem)
+	{
+		Array<ThreadHiveTask, CHILD_TASK_COUNT> tasks;
+		for(ThreadHiveTask& task : tasks)
+		{
+			task.m_callback = leafCallback;
+			task.m_argument = arg;
+		}
+
+		hive.submitTasks(&tasks[0], tasks.getSize());
+	}
+};
+
+ANKI_TEST(Util, ThreadHiveThroughputBench)
+{
+	const U32 ROOT_TASK_COUNT = 64;
+	const U32 ITERATION_COUNT = 1024;
+	const U32 maxThreadCount = min(getCpuCoresCount(), ThreadHive::MAX_THREADS);
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	U32 threadCount = 1;
+	while(true)
+	{
+		ThreadHive hive(threadCount, alloc, true);
+
+		Atomic<U64> sum = {0};
+		ThroughputTask ctx;
+		ctx.m_sum = &sum;
+
+		Array<ThreadHiveTask, ROOT_TASK_COUNT> tasks;
+		for(ThreadHiveTask& task : tasks)
+		{
+			task.m_callback = ThroughputTask::rootCallback;
+			task.m_argument = &ctx;
+		}
+
+		const Second begin = HighRezTimer::getCurrentTime();
+		for(U32 i = 0; i < ITERATION_COUNT; ++i)
+		{
+			hive.submitTasks(&tasks[0], tasks.getSize());
+			hive.waitAllTasks();
+		}
+		const Second end = HighRezTimer::getCurrentTime();
+
+		const U64 taskCount = U64(ITERATION_COUNT) * ROOT_TASK_COUNT * (ThroughputTask::CHILD_TASK_COUNT + 1);
+		ANKI_TEST_LOGI("Threads %u: %f tasks/sec (%fms)", threadCount, F64(taskCount) / (end - begin),
+					   (end - begin) * 1000.0);
+		ANKI_TEST_EXPECT_EQ(sum.getNonAtomically(),
+							U64(ITERATION_COUNT) * ROOT_TASK_COUNT * ThroughputTask::CHILD_TASK_COUNT);
+
+		if(threadCount == maxThreadCount)
+		{
+			break;
+		}
+		threadCount = min(threadCount * 2, maxThreadCount);
+	}
+}
+
 } // end namespace anki
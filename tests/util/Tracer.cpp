@@ -6,14 +6,16 @@
 #include <tests/framework/Framework.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/CoreTracer.h>
+#include <anki/core/ConfigSet.h>
 #include <anki/util/HighRezTimer.h>
+#include <anki/util/Filesystem.h>
 
 #if ANKI_ENABLE_TRACE
 ANKI_TEST(Util, Tracer)
 {
 	HeapAllocator<U8> alloc(allocAligned, nullptr);
 	CoreTracer tracer;
-	ANKI_TEST_EXPECT_NO_ERR(tracer.init(alloc, "./"));
+	ANKI_TEST_EXPECT_NO_ERR(tracer.init(alloc, "./", DefaultConfigSet::get()));
 	TracerSingleton::get().setEnabled(true);
 
 	// 1st frame
@@ -53,4 +55,109 @@ ANKI_TEST(Util, Tracer)
 	ANKI_TRACE_INC_COUNTER(COUNTER, 150);
 	tracer.flushFrame(4);
 }
+
+ANKI_TEST(Util, TracerFlightRecorder)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// The tracer should recycle the chunks older than the duration
+	{
+		Tracer tracer(alloc);
+		tracer.setEnabled(true);
+		tracer.setFlightRecorderEnabled(true, 0.05);
+
+		const U32 EVENT_COUNT = 1000;
+		for(U32 i = 0; i < EVENT_COUNT; ++i)
+		{
+			tracer.addCustomEvent("OLD", HighRezTimer::getCurrentTime(), 0.000001);
+		}
+
+		HighRezTimer::sleep(0.1);
+
+		for(U32 i = 0; i < EVENT_COUNT; ++i)
+		{
+			tracer.addCustomEvent("NEW", HighRezTimer::getCurrentTime(), 0.000001);
+		}
+
+		class Ctx
+		{
+		public:
+			U32 m_oldCount = 0;
+			U32 m_newCount = 0;
+		} ctx;
+
+		auto countEvents = [](void* ud, ThreadId tid, CString threadName, ConstWeakArray<TracerEvent> events,
+							  ConstWeakArray<TracerCounter> counters) {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			for(const TracerEvent& event : events)
+			{
+				ctx.m_oldCount += event.m_name == "OLD";
+				ctx.m_newCount += event.m_name == "NEW";
+			}
+		};
+
+		tracer.readFlightRecorder(countEvents, &ctx);
+
+		ANKI_TEST_EXPECT_EQ(ctx.m_newCount, EVENT_COUNT);
+		ANKI_TEST_EXPECT_LT(ctx.m_oldCount, EVENT_COUNT);
+
+		// Nothing holds the locks so reading without waiting for them sees the same events
+		Ctx ctx2;
+		tracer.readFlightRecorder(countEvents, &ctx2, true);
+		ANKI_TEST_EXPECT_EQ(ctx2.m_newCount, ctx.m_newCount);
+		ANKI_TEST_EXPECT_EQ(ctx2.m_oldCount, ctx.m_oldCount);
+	}
+
+	// The memory should be sized from the duration
+	{
+		Tracer tracer(alloc);
+		tracer.setFlightRecorderEnabled(true, 1.0);
+		const U32 shortCount = tracer.getFlightRecorderMaxChunksPerThread();
+		tracer.setFlightRecorderEnabled(true, 60.0);
+		const U32 longCount = tracer.getFlightRecorderMaxChunksPerThread();
+
+		ANKI_TEST_EXPECT_GT(shortCount, 0u);
+		ANKI_TEST_EXPECT_GEQ(longCount, shortCount * 30);
+	}
+
+	// Dump on request
+	const CString dir = "./flight_recorder";
+	if(directoryExists(dir))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+	}
+	ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+	{
+		ConfigSet config = DefaultConfigSet::get();
+		config.set("core_traceFlightRecorderDuration", 10.0);
+
+		CoreTracer tracer;
+		ANKI_TEST_EXPECT_NO_ERR(tracer.init(alloc, dir, config));
+		ANKI_TEST_EXPECT_EQ(TracerSingleton::get().getFlightRecorderEnabled(), true);
+
+		for(U32 frame = 0; frame < 4; ++frame)
+		{
+			{
+				ANKI_TRACE_SCOPED_EVENT(EVENT);
+				HighRezTimer::sleep(0.01);
+			}
+
+			ANKI_TRACE_INC_COUNTER(COUNTER, 10);
+
+			if(frame == 2)
+			{
+				ANKI_TRACE_REQUEST_FLIGHT_RECORDER_DUMP();
+			}
+
+			tracer.flushFrame(frame);
+		}
+	}
+
+	U32 dumpCount = 0;
+	ANKI_TEST_EXPECT_NO_ERR(walkDirectoryTree(dir, &dumpCount, [](const CString& fname, void* ud, Bool isDir) -> Error {
+		*static_cast<U32*>(ud) += fname.find("flight_recorder_0_request.json") != CString::NPOS;
+		return Error::NONE;
+	}));
+	ANKI_TEST_EXPECT_EQ(dumpCount, 1u);
+}
 #endif